@@ -33,6 +33,7 @@ struct alsa_wrapper {
     snd_pcm_format_t format;
     size_t bits_per_sample;
     size_t bits_per_frame;
+    int underruns;
 };
 
 const char *alsa_wrapper_name()
@@ -158,6 +159,7 @@ int alsa_wrapper_write(sink_handle_t handle, char *buffer, int size)
             snd_pcm_wait(alsa->pcm, 1000);
         } else if (ret == -EPIPE) {
             OS_LOGW(TAG, "Underrun");
+            __atomic_add_fetch(&alsa->underruns, 1, __ATOMIC_RELAXED);
             snd_pcm_prepare(alsa->pcm);
         } else if (ret == -ESTRPIPE) {
             OS_LOGW(TAG, "Need suspend");
@@ -173,6 +175,12 @@ int alsa_wrapper_write(sink_handle_t handle, char *buffer, int size)
     return size;
 }
 
+int alsa_wrapper_xruns(sink_handle_t handle)
+{
+    struct alsa_wrapper *alsa = (struct alsa_wrapper *)handle;
+    return __atomic_load_n(&alsa->underruns, __ATOMIC_RELAXED);
+}
+
 void alsa_wrapper_close(sink_handle_t handle)
 {
     OS_LOGD(TAG, "closing alsa");
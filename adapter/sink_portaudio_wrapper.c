@@ -29,6 +29,7 @@ struct portaudio_priv {
     int samplerate;
     int channels;
     int bits;
+    int underflows;
 };
 
 const char *portaudio_wrapper_name()
@@ -89,11 +90,19 @@ int portaudio_wrapper_write(sink_handle_t handle, char *buffer, int size)
     struct portaudio_priv *portaudio = (struct portaudio_priv *)handle;
     unsigned long frames = size/(portaudio->channels*portaudio->bits/8);
     PaErrorCode ret = Pa_WriteStream(portaudio->out_stream, buffer, frames);
+    if (ret == paOutputUnderflowed)
+        __atomic_add_fetch(&portaudio->underflows, 1, __ATOMIC_RELAXED);
     if (ret == paNoError || ret == paOutputUnderflowed)
         return size;
     return -1;
 }
 
+int portaudio_wrapper_xruns(sink_handle_t handle)
+{
+    struct portaudio_priv *portaudio = (struct portaudio_priv *)handle;
+    return __atomic_load_n(&portaudio->underflows, __ATOMIC_RELAXED);
+}
+
 void portaudio_wrapper_close(sink_handle_t handle)
 {
     OS_LOGD(TAG, "closing portaudio");
@@ -29,6 +29,8 @@ int portaudio_wrapper_write(sink_handle_t handle, char *buffer, int size);
 
 void portaudio_wrapper_close(sink_handle_t handle);
 
+int portaudio_wrapper_xruns(sink_handle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,122 @@
+// BatchWorkerPool.h
+// 批量工作线程池 - 多线程处理任务，结果在调用线程按批提交
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace music_player {
+
+/**
+ * @brief 多线程处理任务、按批提交结果
+ *
+ * 工作线程按下标逐个取任务调用 process，结果放入待提交队列；调用线程每攒够
+ * batch_size 条（或任务全部完成）调用一次 commit。数据库只在调用线程写入，
+ * 每批一个事务，工作线程不需要自己的数据库连接。
+ */
+template <typename Result>
+class BatchWorkerPool {
+public:
+    using Process = std::function<Result(size_t index)>;
+    using Commit = std::function<void(std::vector<Result>& batch)>;
+
+    /**
+     * @param threads    工作线程数，0 表示 CPU 核数
+     * @param batch_size 每批提交的结果数，0 按 1 处理
+     * @param stop       非空时每个任务开始前检查，置位后不再取新任务
+     */
+    BatchWorkerPool(int threads, size_t batch_size, const std::atomic<bool>* stop = nullptr)
+        : threads_(threads)
+        , batch_size_(std::max<size_t>(batch_size, 1))
+        , stop_(stop)
+        , next_task_(0)
+        , active_workers_(0)
+    {
+    }
+
+    // 禁止拷贝
+    BatchWorkerPool(const BatchWorkerPool&) = delete;
+    BatchWorkerPool& operator=(const BatchWorkerPool&) = delete;
+
+    // 处理 task_count 个任务实际使用的线程数
+    size_t threadCount(size_t task_count) const {
+        size_t count = threads_ > 0 ? static_cast<size_t>(threads_) : std::thread::hardware_concurrency();
+        return std::max<size_t>(std::min(count, task_count), 1);
+    }
+
+    /**
+     * @brief 处理下标 [0, task_count) 的任务，返回时已处理的结果都已提交
+     */
+    void run(size_t task_count, const Process& process, const Commit& commit) {
+        if (task_count == 0) {
+            return;
+        }
+
+        size_t thread_count = threadCount(task_count);
+        next_task_ = 0;
+        active_workers_ = static_cast<int>(thread_count);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < thread_count; i++) {
+            workers.emplace_back([this, task_count, &process] { worker(task_count, process); });
+        }
+
+        // 数据库只在本线程写入，每批一个事务
+        while (true) {
+            std::vector<Result> batch;
+            bool finished;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this] { return pending_.size() >= batch_size_ || active_workers_ == 0; });
+                batch.swap(pending_);
+                finished = (active_workers_ == 0);
+            }
+            if (!batch.empty()) {
+                commit(batch);
+            }
+            if (finished) break;
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+private:
+    void worker(size_t task_count, const Process& process) {
+        while (stop_ == nullptr || !*stop_) {
+            size_t index = next_task_++;
+            if (index >= task_count) break;
+
+            Result result = process(index);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(std::move(result));
+            if (pending_.size() >= batch_size_) {
+                cond_.notify_one();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_workers_--;
+        cond_.notify_one();
+    }
+
+    int threads_;
+    size_t batch_size_;
+    const std::atomic<bool>* stop_;
+    std::atomic<size_t> next_task_;
+
+    // 待提交的结果
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Result> pending_;
+    int active_workers_;
+};
+
+} // namespace music_player
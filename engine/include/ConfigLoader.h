@@ -14,6 +14,7 @@ struct DatabaseConfig {
     std::string path;
     std::string test_path;
     std::string backup_dir;
+    std::string index_cache_dir;
     bool auto_backup_enabled;
     int backup_interval_days;
     int max_backups;
@@ -23,6 +24,7 @@ struct DatabaseConfig {
 struct ZmqConfig {
     std::string command_endpoint;
     std::string event_endpoint;
+    int query_workers;                  // 只读查询的工作线程数，0 表示在命令线程内执行
 };
 
 // 音频输出配置
@@ -37,6 +39,37 @@ struct PlayerConfig {
     AudioConfig audio_output;
     int progress_update_interval;
     bool preload_next_track;
+    int crossfade_ms;                   // 0 表示硬切换，最长 12000
+    std::string crossfade_curve;        // "equal_power" 或 "linear"
+};
+
+// 响度分析配置
+struct LoudnessConfig {
+    bool enabled;
+    int threads;        // 0 表示 CPU 核数
+    int batch_size;     // 每个事务写入的曲目数
+};
+
+// 扫描配置
+struct ScannerConfig {
+    int threads;        // 0 表示 CPU 核数，网络存储上可以设得更大
+    int batch_size;     // 每个事务写入的曲目数
+};
+
+// 自动扫描配置
+struct AutoScanConfig {
+    bool enabled;
+    int interval_seconds;   // 比较目录快照的间隔，0 表示只在启动时比较
+    bool watch_directories; // 用 inotify 监控目录，不可用时退回快照比较
+    int fallback_poll_seconds; // 没有 inotify 时比较快照的间隔，0 表示同 interval_seconds
+    int debounce_ms;        // 最后一个文件事件之后等待多久再写入数据库
+};
+
+// 播放统计写入配置
+struct StatisticsConfig {
+    bool write_behind;          // 播放次数、坏轨标记由后台线程按批写入
+    int flush_interval_ms;      // 第一条更新之后最多等待多久提交
+    int checkpoint_interval_s;  // WAL 检查点间隔，0 表示按页数自动检查点
 };
 
 // 服务配置
@@ -52,6 +85,10 @@ struct MusicPlayerConfig {
     ZmqConfig zmq;
     DatabaseConfig database;
     PlayerConfig player;
+    LoudnessConfig loudness;
+    ScannerConfig scanner;
+    AutoScanConfig auto_scan;
+    StatisticsConfig statistics;
     ServiceConfig service;
     std::vector<std::string> scan_directories;
     std::vector<std::string> supported_formats;
@@ -0,0 +1,98 @@
+// LibraryScanner.h
+// 音乐库扫描 - 多线程读取标签和时长，批量写入数据库
+
+#pragma once
+
+#include "MusicLibrary.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace music_player {
+
+/**
+ * @brief 音乐库扫描器
+ *
+ * 调用线程遍历目录，大小和修改时间与库中指纹一致的文件只 stat 一次就跳过。
+ * 工作线程先计算新文件的内容哈希（文件头尾各 64KB 加大小），与已经不存在的
+ * 曲目相同时视为移动，只改写原记录的路径，不重新解析；其余文件读取标签
+ * （TagReader）并用 liteplayer 的解析器计算时长，几者共用一次读入的文件头。
+ * 结果由调用线程按批在一个事务中写入数据库。
+ */
+class LibraryScanner {
+public:
+    struct Options {
+        int threads = 0;                    // 工作线程数，0 表示 CPU 核数
+        size_t batch_size = 500;            // 每个事务写入的曲目数
+        std::vector<std::string> formats;   // 支持的扩展名（不含点）
+    };
+
+    struct Result {
+        int found = 0;                      // 新增、变化或缺少指纹的文件数
+        int added = 0;                      // 写入数据库的曲目数（新增或重新解析）
+        int moved = 0;                      // 按内容哈希关联到原记录的文件数
+        int failed = 0;                     // 解析失败的文件数（仍按文件名入库）
+    };
+
+    explicit LibraryScanner(MusicLibrary& library);
+
+    // 禁止拷贝
+    LibraryScanner(const LibraryScanner&) = delete;
+    LibraryScanner& operator=(const LibraryScanner&) = delete;
+
+    /**
+     * @brief 扫描目录并把新文件写入数据库，完成后返回
+     */
+    Result scan(const std::vector<std::string>& directories, const Options& options);
+
+    /**
+     * @brief 读取单个文件的指纹、标签和时长，不访问数据库
+     * @return 时长解析成功返回 true；失败时 track 仍以文件名作为标题
+     */
+    static bool readTrack(const std::string& path, Track& track);
+
+    /**
+     * @brief 只读取文件指纹（大小、修改时间、内容哈希）
+     * @return 文件无法打开返回 false
+     */
+    static bool readFingerprint(const std::string& path, Track& track);
+
+private:
+    struct Task {
+        std::string path;
+        int64_t track_id = 0;               // 已入库的曲目，0 表示新文件
+        bool changed = false;               // 已入库且大小或修改时间变化，需要重新解析
+    };
+
+    struct TaskResult {
+        Track track;
+        int64_t relink_id = 0;              // 非 0 时只改写该曲目的路径和指纹
+    };
+
+    // 遍历目录，收集支持格式且新增、变化或缺少指纹的文件
+    void collectFiles(const std::string& directory, const Options& options);
+
+    // 工作线程：读取一个文件
+    TaskResult readTask(const Task& task);
+
+    // 调用线程：一批结果写入数据库，返回写入的曲目数
+    int commitBatch(std::vector<TaskResult>& batch);
+
+    // 新文件与已不存在的曲目内容相同时取走该曲目，返回其ID，否则返回 0
+    int64_t claimMovedTrack(const Track& track);
+
+    MusicLibrary& library_;
+
+    // 任务队列
+    std::vector<Task> tasks_;
+    std::unordered_map<std::string, FileFingerprint> known_;             // 路径 -> 指纹，遍历时取走见到的
+    std::unordered_multimap<std::string, FileFingerprint> missing_;      // 内容哈希 -> 文件已不存在的曲目
+    std::mutex missing_mutex_;
+
+    std::atomic<int> failed_;
+    std::atomic<int> moved_;
+};
+
+} // namespace music_player
@@ -0,0 +1,111 @@
+// LibraryWatcher.h
+// 音乐库监控 - 目录变化增量写入数据库
+
+#pragma once
+
+#include "MusicLibrary.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace music_player {
+
+/**
+ * @brief 音乐库目录监控
+ *
+ * 后台线程用 inotify 监控扫描目录（新建的子目录自动加入），把创建、写入完成、
+ * 移动和删除事件按路径合并，最后一个事件之后 debounce_ms 内没有新事件再提交，
+ * 持续写入时最多延迟 max_delay_ms。提交时读取变化文件的标签和时长，
+ * 在独立的数据库连接上按批插入/更新/删除，再通过回调通知服务线程更新播放列表。
+ * 同一批中删除的曲目与新文件内容哈希相同时按移动处理，保留原记录的统计和标签。
+ *
+ * 不支持 inotify、监控数达到上限或事件队列溢出时，改为比较目录快照
+ * （路径、大小、修改时间），每 fallback_poll_interval_s 比较一次；inotify 模式下
+ * 也按 rescan_interval_s 比较一次，补上网络文件系统上其他主机的修改。
+ */
+class LibraryWatcher {
+public:
+    struct Options {
+        std::vector<std::string> directories;
+        std::vector<std::string> formats;   // 支持的扩展名（小写，不含点）
+        bool use_inotify = true;
+        int debounce_ms = 2000;
+        int max_delay_ms = 10000;
+        int rescan_interval_s = 3600;       // 快照比较间隔，0 表示只在启动和队列溢出时比较
+        int fallback_poll_interval_s = 30;  // 没有 inotify 时的快照比较间隔，0 表示同 rescan_interval_s
+    };
+
+    // 一次提交的变化，updated 已写入数据库并带有曲目ID
+    struct Changes {
+        std::vector<Track> updated;
+        std::vector<std::string> removed;   // 删除的文件或目录
+    };
+    using ChangeCallback = std::function<void(const Changes& changes)>;
+
+    // 使用独立的数据库连接，不和服务线程共享 MusicLibrary
+    explicit LibraryWatcher(const std::string& db_path);
+    ~LibraryWatcher();
+
+    // 禁止拷贝
+    LibraryWatcher(const LibraryWatcher&) = delete;
+    LibraryWatcher& operator=(const LibraryWatcher&) = delete;
+
+    /**
+     * @brief 启动后台监控，callback 在监控线程上调用
+     */
+    bool start(const Options& options, ChangeCallback callback);
+
+    void stop();
+
+    bool isRunning() const { return running_; }
+    bool isUsingInotify() const { return inotify_fd_ >= 0; }
+
+private:
+    struct FileStamp {
+        int64_t size;
+        int64_t mtime;
+    };
+    using Clock = std::chrono::steady_clock;
+
+    void run();
+
+    // inotify
+    bool initInotify();
+    void closeInotify();
+    bool addWatchRecursive(const std::string& dir, bool queue_files);
+    void removeWatchesUnder(const std::string& dir);
+    void readInotifyEvents();
+
+    // 快照
+    void walk(const std::string& dir, std::map<std::string, FileStamp>& files) const;
+    void diffSnapshot();
+    int rescanIntervalSeconds() const;
+
+    void queueChange(const std::string& path, bool removed);
+    void flush();
+
+    bool isSupported(const std::string& path) const;
+
+    std::string db_path_;
+    Options options_;
+    ChangeCallback callback_;
+    MusicLibrary library_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    int stop_pipe_[2];
+    int inotify_fd_;
+
+    std::map<int, std::string> watches_;            // wd -> 目录
+    std::map<std::string, FileStamp> snapshot_;     // 已知文件
+    std::map<std::string, bool> pending_;           // 路径 -> 是否删除，后到的事件覆盖先到的
+    Clock::time_point first_pending_;
+    Clock::time_point last_pending_;
+    Clock::time_point next_rescan_;
+};
+
+} // namespace music_player
@@ -4,6 +4,8 @@
 #include "MusicPlayerTypes.h"
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
 
 extern "C" {
 #include "liteplayer_listplayer.h"
@@ -14,6 +16,9 @@ namespace music_player {
 // 状态回调函数类型
 using StateCallback = std::function<void(PlayState state, int error_code)>;
 
+// 通知回调（PREPARED / NEARLYCOMPLETED 等不改变 PlayState 的底层事件）
+using NotifyCallback = std::function<void()>;
+
 /**
  * @brief LitePlayer C API 的 C++ 包装器
  * 
@@ -30,15 +35,33 @@ public:
     
     /**
      * @brief 初始化播放器
+     * @param async_source 是否使用异步文件源（大缓冲，才会上报 NEARLYCOMPLETED）
+     * @param sink_session 共享的输出会话（nullptr 则使用播放器私有的会话）
      * @return true 成功，false 失败
      */
-    bool initialize();
+    bool initialize(bool async_source = false, sink_session_handle_t sink_session = nullptr);
+    
+    /**
+     * @brief 创建基于 ALSA 的输出会话，可在多个播放器间共享，格式不变时设备保持打开
+     * @return 会话句柄，由调用者通过 sink_session_destroy 释放（须晚于所有使用它的播放器）
+     */
+    static sink_session_handle_t createSinkSession();
     
     /**
      * @brief 设置状态回调
      */
     void setStateCallback(StateCallback callback);
     
+    /**
+     * @brief 设置准备完成回调（底层进入 PREPARED）
+     */
+    void setPreparedCallback(NotifyCallback callback);
+    
+    /**
+     * @brief 设置即将播放完成回调（异步源读取完毕，解码器仍在排空）
+     */
+    void setNearlyCompletedCallback(NotifyCallback callback);
+    
     /**
      * @brief 加载播放列表
      * @param playlist_file 播放列表文件路径
@@ -99,6 +122,28 @@ public:
      */
     bool setSingleLooping(bool enable);
     
+    /**
+     * @brief 设置解析结果缓存目录，再次播放同一文件时跳过头部解析（需在空闲状态下设置）
+     */
+    bool setIndexCacheDir(const std::string& dir);
+    
+    /**
+     * @brief 固定输出格式，格式不同的曲目重采样后输出（需在空闲状态下设置）
+     */
+    bool setSinkFormat(int samplerate, int channels, int bits);
+    
+    /**
+     * @brief 设置软件音量，任意状态可调，下一个周期起平滑生效
+     * @param volume 线性音量 [0.0, 1.0]
+     */
+    bool setVolume(float volume);
+    
+    /**
+     * @brief 设置当前曲目增益（响度均衡），叠加在音量之上
+     * @param gain_db 增益（dB），范围 ±18
+     */
+    bool setTrackGain(float gain_db);
+    
     /**
      * @brief 获取当前播放位置
      * @return 位置（毫秒），-1表示失败
@@ -111,11 +156,33 @@ public:
      */
     int getDuration() const;
     
+    /**
+     * @brief 获取当前曲目的运行统计（解码字节、缓冲水位、写设备延迟等），不加锁，可高频采样
+     */
+    bool getStats(liteplayer_stats& stats) const;
+    
     /**
      * @brief 获取当前状态
      */
     PlayState getState() const { return current_state_; }
     
+    /**
+     * @brief 是否已完成准备（可立即 start）
+     */
+    bool isPrepared() const;
+    
+    /**
+     * @brief 等待底层进入 IDLE（reset 完成）
+     * @return true 已空闲，false 超时
+     */
+    bool waitForIdle(int timeout_ms);
+    
+    /**
+     * @brief 等待底层进入 PREPARED
+     * @return true 已准备好，false 出错或超时
+     */
+    bool waitForPrepared(int timeout_ms);
+    
 private:
     // liteplayer状态回调（C风格）
     static int stateCallbackC(enum liteplayer_state state, int errcode, void* priv);
@@ -125,8 +192,15 @@ private:
     
     listplayer_handle_t player_handle_;
     StateCallback state_callback_;
+    NotifyCallback prepared_callback_;
+    NotifyCallback nearly_completed_callback_;
     PlayState current_state_;
     bool initialized_;
+    
+    // 底层 liteplayer 状态（用于替代固定时长的 sleep 等待）
+    mutable std::mutex raw_state_mutex_;
+    std::condition_variable raw_state_cv_;
+    enum liteplayer_state raw_state_;
 };
 
 } // namespace music_player
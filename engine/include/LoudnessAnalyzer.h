@@ -0,0 +1,83 @@
+// LoudnessAnalyzer.h
+// 响度分析 - 多线程离线解码音乐库中的曲目，测量积分响度和真峰值
+
+#pragma once
+
+#include "MusicLibrary.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace music_player {
+
+/**
+ * @brief 响度分析器
+ *
+ * 后台线程对比数据库中的指纹和磁盘上的文件，只分析新增或变化的曲目。
+ * 工作线程从任务队列取曲目，用 liteplayer 的解析器和解码器无 sink、不限速地解码，
+ * 结果由后台线程按批在事务中写入数据库。中途停止时已提交的批次保留，
+ * 下次启动从剩余的曲目继续。
+ */
+class LoudnessAnalyzer {
+public:
+    struct Options {
+        int threads = 0;            // 工作线程数，0 表示 CPU 核数
+        size_t batch_size = 32;     // 每个事务写入的曲目数
+    };
+
+    struct Progress {
+        int total = 0;              // 本次需要分析的曲目数
+        int analyzed = 0;
+        int failed = 0;
+        bool running = false;
+    };
+
+    // 使用独立的数据库连接，不和服务线程共享 MusicLibrary
+    explicit LoudnessAnalyzer(const std::string& db_path);
+    ~LoudnessAnalyzer();
+
+    // 禁止拷贝
+    LoudnessAnalyzer(const LoudnessAnalyzer&) = delete;
+    LoudnessAnalyzer& operator=(const LoudnessAnalyzer&) = delete;
+
+    /**
+     * @brief 在后台开始分析，已在运行时返回 false
+     */
+    bool start(const Options& options);
+
+    /**
+     * @brief 停止分析：不再取新任务，等正在解码的曲目完成并提交后返回
+     */
+    void stop();
+
+    /**
+     * @brief 等待本次分析全部完成
+     */
+    void wait();
+
+    bool isRunning() const { return running_; }
+
+    Progress getProgress() const;
+
+private:
+    // 后台线程：收集任务、启动工作线程、批量提交结果
+    void run(Options options);
+
+    // 工作线程：解码一首曲目
+    LoudnessResult analyzeTrack(const LoudnessFingerprint& task);
+
+    std::string db_path_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_requested_;
+
+    // 任务队列，file_size/file_mtime 为磁盘上的当前值
+    std::vector<LoudnessFingerprint> tasks_;
+
+    std::atomic<int> total_;
+    std::atomic<int> analyzed_;
+    std::atomic<int> failed_;
+};
+
+} // namespace music_player
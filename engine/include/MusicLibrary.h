@@ -7,10 +7,13 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include <ctime>
+#include <unordered_map>
 
 // 前向声明
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace music_player {
 
@@ -42,6 +45,46 @@ struct TrackInfo : public Track {
     bool is_favorite = false;
 };
 
+// 响度分析的文件指纹（大小 + 修改时间），与磁盘上的文件不一致时需要重新分析
+struct LoudnessFingerprint {
+    int64_t track_id = 0;
+    std::string file_path;
+    int64_t file_size = -1;   // 从未分析过为 -1
+    int64_t file_mtime = -1;
+};
+
+// 扫描时记录的文件指纹，见 Track::content_hash
+struct FileFingerprint {
+    int64_t track_id = 0;
+    std::string file_path;
+    int64_t file_size = -1;   // 旧版本入库、从未记录过为 -1
+    int64_t file_mtime = -1;
+    std::string content_hash;
+};
+
+// 单个曲目的响度分析结果
+struct LoudnessResult {
+    int64_t track_id = 0;
+    bool success = false;     // 解码失败只记录指纹，文件变化之前不再重试
+    double loudness_lufs = 0.0;
+    double true_peak_dbtp = 0.0;
+    int duration_ms = 0;
+    int64_t file_size = 0;
+    int64_t file_mtime = 0;
+};
+
+// 延迟写入的播放统计，由 StatisticsWriter 按批提交
+struct StatisticsUpdate {
+    enum class Kind {
+        Play,                 // play_count + 1，更新 last_played
+        MarkBad               // 同 markTrackBadByPath
+    };
+    Kind kind = Kind::Play;
+    std::string file_path;
+    std::string reason;       // 仅 MarkBad
+    time_t time = 0;          // 事件发生的时间，不是写入的时间
+};
+
 // 播放列表信息
 struct PlaylistInfo {
     int64_t id = 0;
@@ -86,6 +129,13 @@ public:
      */
     bool open(const std::string& db_path);
 
+    /**
+     * @brief 只读方式打开已有数据库，不建表也不迁移，供并发查询使用
+     * @param db_path 数据库文件路径
+     * @return true 成功，false 失败（文件不存在等）
+     */
+    bool openReadOnly(const std::string& db_path);
+
     /**
      * @brief 关闭数据库
      */
@@ -96,6 +146,16 @@ public:
      */
     bool isOpen() const;
 
+    /**
+     * @brief 设置本连接的自动检查点阈值（WAL 页数），0 表示本连接提交时不做检查点
+     */
+    void setAutoCheckpoint(int pages);
+
+    /**
+     * @brief 把 WAL 中已提交的内容写回数据库文件（PASSIVE，不等待读连接）
+     */
+    bool checkpoint();
+
     // ========== 坏轨隔离（兜底） ==========
     /**
      * @brief 标记某个文件为“坏轨”，后续将默认从播放/列表查询中排除
@@ -162,6 +222,13 @@ public:
      */
     int addTracks(const std::vector<Track>& tracks);
 
+    /**
+     * @brief 在一个事务中按文件路径插入或更新曲目（文件监控用）
+     * @param tracks 曲目列表，成功后写回曲目ID
+     * @return 成功写入的数量，库未打开返回 -1
+     */
+    int upsertTracks(std::vector<Track>& tracks);
+
     /**
      * @brief 更新曲目信息
      * @param id 曲目ID
@@ -170,6 +237,25 @@ public:
      */
     bool updateTrack(int64_t id, const Track& track);
 
+    /**
+     * @brief 写入曲目响度，播放时据此做响度均衡
+     * @param id 曲目ID
+     * @param loudness_lufs 积分响度（LUFS）
+     * @return true 成功，false 失败
+     */
+    bool setTrackLoudness(int64_t id, double loudness_lufs);
+
+    /**
+     * @brief 获取所有非坏轨曲目的响度分析指纹，用于增量分析
+     */
+    std::vector<LoudnessFingerprint> getLoudnessFingerprints();
+
+    /**
+     * @brief 在一个事务中批量写入响度分析结果（响度、真峰值、时长和指纹）
+     * @return 成功更新的曲目数量，事务失败返回 -1
+     */
+    int saveLoudnessResults(const std::vector<LoudnessResult>& results);
+
     /**
      * @brief 删除曲目
      * @param id 曲目ID
@@ -177,6 +263,12 @@ public:
      */
     bool deleteTrack(int64_t id);
 
+    /**
+     * @brief 在一个事务中删除路径为 path 或位于目录 path 之下的曲目
+     * @return 删除的曲目数量，库未打开返回 -1
+     */
+    int deleteTracksByPath(const std::vector<std::string>& paths);
+
     /**
      * @brief 根据ID获取曲目
      * @param id 曲目ID
@@ -192,6 +284,18 @@ public:
      */
     std::vector<TrackInfo> getAllTracks(int limit = 0);
 
+    /**
+     * @brief 获取曲目的文件指纹，扫描时据此跳过未变化的文件、识别移动的文件
+     * @param paths 只返回路径为其中之一或位于其下的曲目，为空时返回全部
+     */
+    std::vector<FileFingerprint> getFileFingerprints(const std::vector<std::string>& paths = {});
+
+    /**
+     * @brief 在一个事务中按曲目ID改写文件路径和指纹，文件移动后保留播放次数、收藏和情绪标签
+     * @return 成功更新的曲目数量，库未打开返回 -1
+     */
+    int relinkTracks(const std::vector<FileFingerprint>& moves);
+
     // ========== 搜索 ==========
 
     /**
@@ -224,6 +328,12 @@ public:
      */
     bool setFavorite(int64_t track_id, bool is_favorite);
 
+    /**
+     * @brief 在一个事务中写入一批延迟的播放统计和坏轨标记（按文件路径）
+     * @return 更新的曲目数，失败返回 -1
+     */
+    int applyStatistics(const std::vector<StatisticsUpdate>& updates);
+
     /**
      * @brief 获取收藏列表
      */
@@ -320,11 +430,43 @@ private:
     // 获取或创建专辑ID
     int64_t getOrCreateAlbum(const std::string& album_name, const std::string& artist_name, int year);
 
+    // 在数据库中查找或创建（批量导入时由上面两个函数缓存结果）
+    int64_t resolveArtist(const std::string& artist_name);
+    int64_t resolveAlbum(const std::string& album_name, const std::string& artist_name, int year);
+
     // 执行SQL语句
     bool execute(const std::string& sql);
 
+    /**
+     * @brief 取得预编译语句，同一条 SQL 在被淘汰前只编译一次
+     * @param cache 拼接了参数值、不会重复出现的 SQL 传 false，用完即 finalize
+     * @return SQLite 返回码，成功时 *stmt 为可绑定参数的语句
+     */
+    int prepareStatement(const std::string& sql, sqlite3_stmt** stmt, bool cache = true);
+
+    // 用完语句：缓存的语句 reset 并清除绑定，未缓存的直接 finalize
+    void releaseStatement(sqlite3_stmt* stmt);
+
+    // 批量导入开始/结束：期间艺术家、专辑ID缓存在内存中，不逐行查询
+    void beginBulkImport();
+    void endBulkImport();
+
     sqlite3* db_;
     bool is_open_;
+
+    // 语句缓存（SQL -> 语句），满了淘汰最久未用的
+    struct CachedStatement {
+        sqlite3_stmt* stmt;
+        bool in_use;
+        uint64_t last_used;
+    };
+    std::unordered_map<std::string, CachedStatement> statements_;
+    uint64_t statement_clock_ = 0;
+    static constexpr size_t MAX_CACHED_STATEMENTS = 64;
+
+    bool bulk_import_ = false;
+    std::unordered_map<std::string, int64_t> artist_ids_;
+    std::unordered_map<std::string, int64_t> album_ids_;     // 专辑名 + '\x1f' + 艺术家
 };
 
 } // namespace music_player
@@ -6,6 +6,10 @@
 #include "ConfigLoader.h"
 #include "JsonProtocol.h"
 #include "MusicLibrary.h"
+#include "LoudnessAnalyzer.h"
+#include "LibraryScanner.h"
+#include "LibraryWatcher.h"
+#include "StatisticsWriter.h"
 #include "PlaybackController.h"
 #include <zmq.hpp>
 #include <memory>
@@ -13,6 +17,9 @@
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <deque>
+#include <vector>
+#include <condition_variable>
 
 namespace music_player {
 
@@ -37,18 +44,40 @@ public:
     bool isRunning() const { return running_; }
 
 private:
-    // 命令处理循环
+    // 服务主循环：zmq_poll 同时等待命令、控制器事件唤醒和进度/心跳定时
     void commandLoop();
     
-    // 事件发布循环
-    void eventLoop();
+    // 唤醒 commandLoop（任意线程可调用）
+    void wakeCommandLoop();
+    
+    // 读取 ROUTER 上的一条命令：只读查询交给工作线程，其余在本线程执行并应答
+    void handleCommandMessage();
+    
+    // 按信封（客户端标识及分隔帧）应答
+    void sendReply(const std::vector<std::string>& envelope, const std::string& response);
+    
+    // 只读查询工作线程，各自持有只读数据库连接
+    void startQueryWorkers();
+    void stopQueryWorkers();
+    void queryWorkerLoop();
+    void sendQueryReplies();
+    
+    // 发布播放进度，与上次发布相比没有变化时跳过（慢订阅者只会积压最新状态）
+    void publishProgress();
 
     // 处理 PlaybackController 事件（从回调线程转发到 commandLoop 线程）
     void processPendingControllerEvents();
     
+    // 把 LibraryWatcher 已写入数据库的变化同步到播放列表（commandLoop 线程）
+    void applyLibraryChanges();
+    
     // 处理单个命令
     CommandResponse handleCommand(const CommandRequest& request);
     
+    // 处理只读查询（可在工作线程上执行，只访问传入的 library）
+    static bool isQueryCommand(const std::string& command);
+    CommandResponse handleQuery(const CommandRequest& request, MusicLibrary& library);
+    
     // 发布事件
     void publishEvent(const std::string& event_type, const json& data);
     
@@ -59,35 +88,75 @@ private:
     CommandResponse handleNext(const json& params);
     CommandResponse handlePrevious(const json& params);
     CommandResponse handleGetStatus(const json& params);
-    CommandResponse handleGetTrack(const json& params);
-    CommandResponse handleSearchTracks(const json& params);
+    CommandResponse handleGetMetrics(const json& params);
+    CommandResponse handleGetTrack(const json& params, MusicLibrary& library);
+    CommandResponse handleSearchTracks(const json& params, MusicLibrary& library);
     CommandResponse handleAddTrack(const json& params);
-    CommandResponse handleGetAllTracks(const json& params);
+    CommandResponse handleGetAllTracks(const json& params, MusicLibrary& library);
+    CommandResponse handleGetLibraryStats(const json& params, MusicLibrary& library);
+    CommandResponse handleAnalyzeLoudness(const json& params);
     
     // 辅助方法
     bool syncDatabaseTracksToPlaylist();
     bool scanMusicDirectories();
-    std::vector<Track> scanDirectory(const std::string& directory);
+    bool startLoudnessAnalysis();
+    bool startLibraryWatcher();
+    bool startStatisticsWriter();
     
     // ZMQ上下文和socket
     std::unique_ptr<zmq::context_t> zmq_context_;
     std::unique_ptr<zmq::socket_t> cmd_socket_;
     std::unique_ptr<zmq::socket_t> event_socket_;
+    std::unique_ptr<zmq::socket_t> wake_recv_;   // inproc PAIR，commandLoop 线程读取
+    std::unique_ptr<zmq::socket_t> wake_send_;   // inproc PAIR，由 wake_mutex_ 保护
+    std::mutex wake_mutex_;
     
     // 核心组件
     std::unique_ptr<MusicLibrary> library_;
     std::unique_ptr<PlaybackController> controller_;
+    std::unique_ptr<LoudnessAnalyzer> loudness_analyzer_;
+    std::unique_ptr<LibraryWatcher> library_watcher_;
+    std::unique_ptr<StatisticsWriter> statistics_writer_;
 
     // PlaybackController 事件队列（回调线程入队，commandLoop 出队）
     std::mutex event_queue_mutex_;
     std::queue<std::pair<PlayerEvent, std::string>> pending_events_;
     
+    // 音乐库变化（监控线程入队，commandLoop 出队）
+    std::mutex library_changes_mutex_;
+    std::vector<LibraryWatcher::Changes> pending_library_changes_;
+    
+    // 只读查询：命令线程入队，工作线程执行，应答经 wakeCommandLoop 交回命令线程发送
+    struct QueryJob {
+        std::vector<std::string> envelope;
+        CommandRequest request;
+    };
+    struct QueryReply {
+        std::vector<std::string> envelope;
+        std::string response;
+    };
+    std::mutex query_mutex_;
+    std::condition_variable query_cv_;
+    std::deque<QueryJob> query_jobs_;
+    bool query_stop_ = false;
+    std::mutex query_reply_mutex_;
+    std::queue<QueryReply> query_replies_;
+    std::vector<std::thread> query_workers_;
+    static constexpr size_t MAX_PENDING_QUERIES = 64;
+    
     // 配置
     MusicPlayerConfig config_;
     
+    // 上次发布的进度
+    PlayState last_progress_state_ = PlayState::Idle;
+    size_t last_progress_index_ = 0;
+    int last_progress_position_ = -1;
+    int last_progress_duration_ = -1;
+    
     // 线程
     std::thread cmd_thread_;
-    std::thread event_thread_;
+    
+    static constexpr int HEARTBEAT_INTERVAL_MS = 5000;
     
     // 运行状态
     std::atomic<bool> running_;
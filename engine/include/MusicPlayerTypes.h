@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <optional>
 
 namespace music_player {
 
@@ -39,7 +40,16 @@ struct Track {
     int year;
     int duration_ms;
     
-    Track() : id(-1), year(0), duration_ms(0) {}
+    // 响度（LUFS，EBU R128 积分响度），未测量为空（0 LUFS 是合法的测量值）
+    std::optional<double> loudness_lufs;
+    
+    // 扫描时的文件指纹：大小、修改时间和内容哈希（文件头尾和大小），
+    // 用于跳过未变化的文件和识别移动过的文件，content_hash 为空表示未记录
+    int64_t file_size;
+    int64_t file_mtime;
+    std::string content_hash;
+    
+    Track() : id(-1), year(0), duration_ms(0), file_size(0), file_mtime(0) {}
 };
 
 } // namespace music_player
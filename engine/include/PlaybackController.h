@@ -9,6 +9,7 @@
 #include <functional>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
 
 namespace music_player {
 
@@ -21,22 +22,51 @@ enum class PlayerEvent {
     StateChanged       // 状态变化
 };
 
+// 交叉淡化曲线
+enum class CrossfadeCurve {
+    Linear,            // 线性，增益之和为 1
+    EqualPower         // 等功率，cos/sin，过渡中段响度不下陷
+};
+
 // 事件回调
 using EventCallback = std::function<void(PlayerEvent event, const std::string& info)>;
 
 class PlaybackController {
 public:
     PlaybackController();
-    ~PlaybackController() = default;
+    ~PlaybackController();
 
     // 初始化
     bool initialize();
     
+    // 无缝预加载下一首（对应配置 player.preload_next_track，需在 initialize() 之前设置）
+    void setPreloadNextTrack(bool enable);
+    
+    // 解析结果与 seek 索引缓存目录（需在 initialize() 之前设置，空字符串表示不缓存）
+    void setIndexCacheDir(const std::string& dir);
+    
+    // 响度均衡目标（LUFS），曲目增益 = 目标 - 曲目响度；未测量的曲目不做调整
+    void setLoudnessTarget(double lufs);
+    
+    // 交叉淡化（对应配置 player.crossfade_ms / crossfade_curve），0 表示硬切换，最长 12 秒。
+    // initialize() 之前设置为非 0 才会启用第二个播放器并固定输出格式；之后只能调整时长和曲线
+    bool setCrossfade(int durationMs, CrossfadeCurve curve);
+    int getCrossfade() const;
+    
+    // 软件音量 [0.0, 1.0]，对所有播放器生效
+    bool setVolume(float volume);
+    float getVolume() const;
+    
     // 播放列表管理
     bool loadPlaylist(const std::string& path);  // 加载目录或文件
     void setPlayMode(PlayMode mode);
     PlayMode getPlayMode() const;
     
+    // 媒体库变化同步到播放列表（与回调线程的预加载/接续互斥；预加载的曲目受影响时取消预加载）
+    void addTrack(const Track& track);
+    bool updateTrack(const Track& track);           // 按文件路径替换曲目信息，不存在返回 false
+    size_t removeTracks(const std::string& path);   // 移除该文件或目录下的曲目，返回移除数量
+    
     // 播放控制
     bool play();           // 播放当前曲目
     bool playTrack(size_t index);  // 播放指定曲目
@@ -54,6 +84,7 @@ public:
     size_t getPlaylistSize() const;
     int getPosition() const;     // 当前位置（毫秒）
     int getDuration() const;     // 总时长（毫秒）
+    bool getStats(liteplayer_stats& stats) const;  // 活动播放器的运行统计
     
     // 播放列表访问（用于高级操作）
     PlaylistManager& getPlaylistManager() { return playlist_; }
@@ -64,8 +95,30 @@ public:
 private:
     // 状态处理（由回调线程调用）
     void onPlayerStateChanged(PlayState newState);
+    void onStandbyStateChanged(PlayState newState);
+    void onPlayerNearlyCompleted(size_t playerIndex);
+    void onPlayerPrepared(size_t playerIndex);
     void handleError(const std::string& error);
     
+    // 预加载（调用时必须持有 mutex_；只向 listplayer 投递消息，不做任何等待）
+    void preloadNextLocked();
+    void cancelPreloadLocked();
+    bool dropStalePreloadLocked(const std::string& changedPath);
+    bool handoverLocked();
+    
+    // 交叉淡化调度：按剩余时长预加载下一首，并提前启动其解码器以便淡入前缓冲就绪
+    void crossfadeMonitorLoop();
+    void scheduleCrossfadeLocked();
+    
+    // 曲目增益（dB），装载曲目前设置到对应播放器
+    float trackGainDbLocked(const Track& track) const;
+    
+    size_t activePlayerIndex() const;
+    // 需持有 mutex_（handoverLocked 会切换 activeIndex_）
+    LitePlayerWrapper& activePlayer() { return players_[activeIndex_]; }
+    const LitePlayerWrapper& activePlayer() const { return players_[activeIndex_]; }
+    LitePlayerWrapper& standbyPlayer() { return players_[1 - activeIndex_]; }
+    
     // 播放流程（由命令线程调用）
     bool startCurrentTrack();
     
@@ -79,7 +132,10 @@ private:
      */
     bool safeStopInternal(std::unique_lock<std::mutex>& lock);
     
-    LitePlayerWrapper player_;       // liteplayer包装器
+    // 共享输出会话：两个播放器写同一个设备；须先于 players_ 声明，以便在其之后析构
+    std::unique_ptr<struct sink_session, void (*)(sink_session_handle_t)> sinkSession_;
+    LitePlayerWrapper players_[2];   // liteplayer包装器（活动 + 预加载备用）
+    size_t activeIndex_;             // 当前活动播放器下标
     PlaylistManager playlist_;       // 播放列表管理器
     PlayState currentState_;         // 当前状态
     EventCallback eventCallback_;    // 事件回调
@@ -89,6 +145,33 @@ private:
     int errorRetryCount_;            // 错误重试计数
     static constexpr int MAX_RETRIES = 3;
     
+    bool preloadEnabled_;            // 是否启用下一首预加载
+    bool preloadPending_;            // 备用播放器已装载下一首（准备中或已准备）
+    bool handoverPending_;           // 当前曲目已结束，等待备用播放器准备完成后接续
+    size_t preloadTrackIndex_;       // 备用播放器装载的曲目索引
+    std::string preloadTrackPath_;   // 备用播放器装载的文件
+    std::string indexCacheDir_;      // 解析结果缓存目录
+    double loudnessTarget_;          // 响度均衡目标（LUFS）
+    float volume_;                   // 软件音量
+    int crossfadeMs_;                // 交叉淡化时长（毫秒）
+    CrossfadeCurve crossfadeCurve_;  // 交叉淡化曲线
+    bool crossfadeCapable_;          // 初始化时已启用交叉淡化（双播放器 + 固定输出格式）
+    bool crossfadeStarted_;          // 备用播放器已启动，正在输出会话中缓冲或淡入
+    bool monitorStop_;               // 通知调度线程退出
+    std::condition_variable monitorCv_;
+    std::thread monitorThread_;      // 交叉淡化调度线程
+    
+    static constexpr int RESET_TIMEOUT_MS = 3000;
+    static constexpr int PREPARE_TIMEOUT_MS = 5000;
+    static constexpr double DEFAULT_LOUDNESS_TARGET = -18.0;  // ReplayGain 2.0 参考响度
+    static constexpr float MAX_TRACK_GAIN_DB = 18.0f;         // 与 liteplayer 的限制一致
+    static constexpr int CROSSFADE_POLL_MS = 100;             // 调度线程查询播放位置的间隔
+    static constexpr int CROSSFADE_PRELOAD_LEAD_MS = 5000;    // 淡化开始前多久装载下一首
+    static constexpr int CROSSFADE_START_LEAD_MS = 500;       // 淡化开始前多久启动解码，须大于会话的预缓冲
+    static constexpr int CROSSFADE_SAMPLERATE = 44100;        // 两首曲目混合前统一的输出格式
+    static constexpr int CROSSFADE_CHANNELS = 2;
+    static constexpr int CROSSFADE_BITS = 16;
+    
     mutable std::mutex mutex_;            // 状态锁（保护状态变量）
     mutable std::mutex playerOpMutex_;    // 播放器操作锁（保护player_对象的调用）
     std::condition_variable cvState_;     // 状态变化通知变量
@@ -20,6 +20,8 @@ public:
     bool loadFromDirectory(const std::string& dirPath);
     bool loadFromFile(const std::string& filePath);
     void addTrack(const Track& track);
+    bool updateTrack(const Track& track);             // 按文件路径替换曲目信息，不存在返回 false
+    size_t removeTracks(const std::string& path);     // 移除该文件或目录下的曲目，返回移除数量
     void clear();
     
     // 播放模式
@@ -36,6 +38,10 @@ public:
     bool prev();  // 移动到上一首，返回是否成功
     bool seekTo(size_t index);  // 跳转到指定曲目
     
+    // 预取下一首索引（用于预加载）：结果会被缓存，随后的 next() 落到同一索引，
+    // 保证随机模式下预加载的曲目与实际切换的曲目一致
+    bool peekNext(size_t& index) const;
+    
     // 随机播放
     void shuffle();  // 打乱播放列表
     void unshuffle();  // 恢复原始顺序
@@ -69,6 +75,9 @@ private:
     
     mutable std::mt19937 randomEngine_;   // 随机数生成器（mutable因为在const方法中使用）
     bool isShuffled_;                     // 是否处于随机状态
+    
+    mutable bool hasPeekedNext_;          // peekNext() 结果是否有效
+    mutable size_t peekedNextIndex_;      // peekNext() 缓存的下一首索引
 };
 
 } // namespace music_player
@@ -0,0 +1,76 @@
+// StatisticsWriter.h
+// 播放统计写入 - 播放次数、最近播放和坏轨标记在后台线程按批提交
+
+#pragma once
+
+#include "MusicLibrary.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace music_player {
+
+/**
+ * @brief 播放统计的延迟写入
+ *
+ * 命令线程只把更新放进队列，不访问磁盘。后台线程收到第一条更新后再等
+ * flush_interval_ms（积压到 max_pending 条时提前），把期间的更新在一个事务中写入。
+ * 服务连接关闭了自动检查点，由这里每 checkpoint_interval_s 做一次 PASSIVE 检查点，
+ * SD 卡上的 fsync 都落在后台线程。
+ *
+ * 更新按文件路径写入；写入前读数据库看不到队列中的更新。
+ */
+class StatisticsWriter {
+public:
+    struct Options {
+        int flush_interval_ms = 2000;
+        size_t max_pending = 256;
+        int checkpoint_interval_s = 60;     // 0 表示不定时检查点，只靠本连接的自动检查点
+    };
+
+    // 使用独立的数据库连接，不和服务线程共享 MusicLibrary
+    explicit StatisticsWriter(const std::string& db_path);
+    ~StatisticsWriter();
+
+    // 禁止拷贝
+    StatisticsWriter(const StatisticsWriter&) = delete;
+    StatisticsWriter& operator=(const StatisticsWriter&) = delete;
+
+    /**
+     * @brief 打开数据库连接并启动后台线程
+     */
+    bool start(const Options& options);
+
+    /**
+     * @brief 提交队列中剩余的更新后返回
+     */
+    void stop();
+
+    bool isRunning() const { return running_; }
+
+    // 入队，只加锁，不访问磁盘
+    void recordPlay(const std::string& file_path);
+    void markTrackBad(const std::string& file_path, const std::string& reason);
+
+private:
+    void run();
+
+    void enqueue(StatisticsUpdate update);
+
+    std::string db_path_;
+    Options options_;
+    MusicLibrary library_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<StatisticsUpdate> pending_;
+    bool stop_requested_;
+};
+
+} // namespace music_player
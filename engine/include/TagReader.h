@@ -0,0 +1,88 @@
+// TagReader.h
+// 标签读取 - ID3v1/v2、MP4 ilst、RIFF INFO
+
+#pragma once
+
+#include "MusicPlayerTypes.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace music_player {
+
+/**
+ * @brief 扫描时对单个文件的只读访问
+ *
+ * 打开时把文件头读入内存，标签解析和时长解析都先从这里取数据，
+ * 文件头之外的区域（尾部的 moov、data 之后的 LIST 等）按需读入一块缓存，
+ * 同一个文件不会重复读取同一段数据。
+ */
+class MediaFile {
+public:
+    MediaFile() = default;
+    ~MediaFile();
+
+    // 禁止拷贝
+    MediaFile(const MediaFile&) = delete;
+    MediaFile& operator=(const MediaFile&) = delete;
+
+    bool open(const std::string& path, size_t head_size = DEFAULT_HEAD_SIZE);
+    void close();
+
+    const std::string& path() const { return path_; }
+    int64_t size() const { return size_; }
+    int64_t mtime() const { return mtime_; }
+    size_t headSize() const { return head_.size(); }
+
+    /**
+     * @brief 读取 [offset, offset+len)，命中文件头或缓存区域时不访问磁盘，
+     *        未命中的小块读取会预读 READ_AHEAD_SIZE 到缓存区域
+     * @return 实际读取的字节数，文件尾或失败时小于 len
+     */
+    int readAt(int64_t offset, char* buf, int len);
+
+    /**
+     * @brief 把一段区域读入缓存（替换上一次的缓存区域），超过 MAX_REGION_SIZE 时失败
+     */
+    bool cacheRegion(int64_t offset, size_t len);
+
+    // 访问磁盘的次数（含打开时读取文件头）
+    int diskReads() const { return disk_reads_; }
+
+    static constexpr size_t DEFAULT_HEAD_SIZE = 64 * 1024;
+    static constexpr size_t MAX_REGION_SIZE = 8 * 1024 * 1024;
+    static constexpr size_t READ_AHEAD_SIZE = 64 * 1024;
+
+private:
+    bool inRegion(int64_t offset, size_t len) const;
+    int64_t readFromDisk(int64_t offset, char* buf, size_t len);
+
+    std::string path_;
+    int fd_ = -1;
+    int64_t size_ = 0;
+    int64_t mtime_ = 0;
+    std::vector<char> head_;
+    int64_t region_offset_ = 0;
+    std::vector<char> region_;
+    int disk_reads_ = 0;
+};
+
+/**
+ * @brief 从文件中读取标题、艺术家、专辑、年份和流派
+ *
+ * MP3/AAC 读 ID3v2（2.2~2.4），缺少的字段再用文件尾的 ID3v1 补全；
+ * M4A 读 moov/udta/meta/ilst；WAV 读 LIST/INFO。文本统一转换为 UTF-8，
+ * 只写入标签中存在的字段。
+ */
+class TagReader {
+public:
+    static bool read(MediaFile& file, Track& track);
+
+private:
+    static bool readId3v2(MediaFile& file, Track& track);
+    static bool readId3v1(MediaFile& file, Track& track);
+    static bool readMp4(MediaFile& file, Track& track);
+    static bool readRiffInfo(MediaFile& file, Track& track);
+};
+
+} // namespace music_player
@@ -1,6 +1,7 @@
 #include "LitePlayerWrapper.h"
 #include <iostream>
 #include <cstring>
+#include <chrono>
 #include <unistd.h>
 
 extern "C" {
@@ -13,7 +14,8 @@ namespace music_player {
 LitePlayerWrapper::LitePlayerWrapper()
     : player_handle_(nullptr)
     , current_state_(PlayState::Idle)
-    , initialized_(false) {
+    , initialized_(false)
+    , raw_state_(LITEPLAYER_IDLE) {
 }
 
 LitePlayerWrapper::~LitePlayerWrapper() {
@@ -25,7 +27,19 @@ LitePlayerWrapper::~LitePlayerWrapper() {
     }
 }
 
-bool LitePlayerWrapper::initialize() {
+sink_session_handle_t LitePlayerWrapper::createSinkSession() {
+    struct sink_wrapper sink_ops = {
+        .priv_data = nullptr,
+        .name = alsa_wrapper_name,
+        .open = alsa_wrapper_open,
+        .write = alsa_wrapper_write,
+        .close = alsa_wrapper_close,
+        .xruns = alsa_wrapper_xruns,
+    };
+    return sink_session_create(&sink_ops);
+}
+
+bool LitePlayerWrapper::initialize(bool async_source, sink_session_handle_t sink_session) {
     if (initialized_) {
         return true;
     }
@@ -43,20 +57,26 @@ bool LitePlayerWrapper::initialize() {
     // 注册状态监听器
     listplayer_register_state_listener(player_handle_, stateCallbackC, this);
     
-    // 注册音频输出适配器（ALSA）
-    struct sink_wrapper sink_ops = {
-        .priv_data = nullptr,
-        .name = alsa_wrapper_name,
-        .open = alsa_wrapper_open,
-        .write = alsa_wrapper_write,
-        .close = alsa_wrapper_close,
-    };
-    listplayer_register_sink_wrapper(player_handle_, &sink_ops);
+    // 注册音频输出适配器（ALSA），切歌时设备保持打开，仅在格式变化时重新配置
+    if (sink_session != nullptr) {
+        listplayer_register_sink_session(player_handle_, sink_session);
+    } else {
+        struct sink_wrapper sink_ops = {
+            .priv_data = nullptr,
+            .name = alsa_wrapper_name,
+            .open = alsa_wrapper_open,
+            .write = alsa_wrapper_write,
+            .close = alsa_wrapper_close,
+            .xruns = alsa_wrapper_xruns,
+        };
+        listplayer_register_sink_wrapper(player_handle_, &sink_ops);
+    }
     
     // 注册文件输入适配器
+    // 异步模式下源线程提前读完文件会上报 NEARLYCOMPLETED，256KB 缓冲约为 128kbps 下 16 秒的余量
     struct source_wrapper file_ops = {
-        .async_mode = false,
-        .buffer_size = 2*1024,
+        .async_mode = async_source,
+        .buffer_size = async_source ? 256*1024 : 2*1024,
         .priv_data = nullptr,
         .url_protocol = file_wrapper_url_protocol,
         .open = file_wrapper_open,
@@ -77,6 +97,14 @@ void LitePlayerWrapper::setStateCallback(StateCallback callback) {
     state_callback_ = callback;
 }
 
+void LitePlayerWrapper::setPreparedCallback(NotifyCallback callback) {
+    prepared_callback_ = callback;
+}
+
+void LitePlayerWrapper::setNearlyCompletedCallback(NotifyCallback callback) {
+    nearly_completed_callback_ = callback;
+}
+
 bool LitePlayerWrapper::loadPlaylist(const std::string& playlist_file) {
     if (!initialized_ || !player_handle_) {
         std::cerr << "Player not initialized" << std::endl;
@@ -154,6 +182,13 @@ bool LitePlayerWrapper::reset() {
         return false;
     }
     std::cout << "[LitePlayerWrapper] reset called" << std::endl;
+    {
+        // 标记为"等待 IDLE"，避免上一次会话残留的 PREPARED 被误判为已就绪
+        std::lock_guard<std::mutex> lock(raw_state_mutex_);
+        if (raw_state_ != LITEPLAYER_IDLE) {
+            raw_state_ = LITEPLAYER_STOPPED;
+        }
+    }
     int res = listplayer_reset(player_handle_);
     std::cout << "[LitePlayerWrapper] reset result=" << res << std::endl;
     return res == 0;
@@ -191,6 +226,38 @@ bool LitePlayerWrapper::setSingleLooping(bool enable) {
     return listplayer_set_single_looping(player_handle_, enable) == 0;
 }
 
+bool LitePlayerWrapper::setIndexCacheDir(const std::string& dir) {
+    if (!player_handle_) {
+        return false;
+    }
+    
+    return listplayer_set_index_cache_dir(player_handle_, dir.empty() ? nullptr : dir.c_str()) == 0;
+}
+
+bool LitePlayerWrapper::setSinkFormat(int samplerate, int channels, int bits) {
+    if (!player_handle_) {
+        return false;
+    }
+    
+    return listplayer_set_sink_format(player_handle_, samplerate, channels, bits, LITEPLAYER_RESAMPLE_FAST) == 0;
+}
+
+bool LitePlayerWrapper::setVolume(float volume) {
+    if (!player_handle_) {
+        return false;
+    }
+    
+    return listplayer_set_volume(player_handle_, volume) == 0;
+}
+
+bool LitePlayerWrapper::setTrackGain(float gain_db) {
+    if (!player_handle_) {
+        return false;
+    }
+    
+    return listplayer_set_track_gain(player_handle_, gain_db) == 0;
+}
+
 int LitePlayerWrapper::getPosition() const {
     if (!player_handle_) {
         return -1;
@@ -217,6 +284,34 @@ int LitePlayerWrapper::getDuration() const {
     return duration;
 }
 
+bool LitePlayerWrapper::getStats(liteplayer_stats& stats) const {
+    if (!player_handle_) {
+        return false;
+    }
+    
+    return listplayer_get_stats(player_handle_, &stats) == 0;
+}
+
+bool LitePlayerWrapper::isPrepared() const {
+    std::lock_guard<std::mutex> lock(raw_state_mutex_);
+    return raw_state_ == LITEPLAYER_PREPARED;
+}
+
+bool LitePlayerWrapper::waitForIdle(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(raw_state_mutex_);
+    return raw_state_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] {
+        return raw_state_ == LITEPLAYER_IDLE;
+    });
+}
+
+bool LitePlayerWrapper::waitForPrepared(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(raw_state_mutex_);
+    raw_state_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] {
+        return raw_state_ == LITEPLAYER_PREPARED || raw_state_ == LITEPLAYER_ERROR;
+    });
+    return raw_state_ == LITEPLAYER_PREPARED;
+}
+
 // 静态回调函数
 int LitePlayerWrapper::stateCallbackC(enum liteplayer_state state, int errcode, void* priv) {
     LitePlayerWrapper* wrapper = static_cast<LitePlayerWrapper*>(priv);
@@ -224,6 +319,20 @@ int LitePlayerWrapper::stateCallbackC(enum liteplayer_state state, int errcode,
         return -1;
     }
     
+    {
+        std::lock_guard<std::mutex> lock(wrapper->raw_state_mutex_);
+        wrapper->raw_state_ = state;
+    }
+    wrapper->raw_state_cv_.notify_all();
+    
+    // NEARLYCOMPLETED 时仍在播放（解码器排空中），不改变 PlayState
+    if (state == LITEPLAYER_NEARLYCOMPLETED) {
+        if (wrapper->nearly_completed_callback_) {
+            wrapper->nearly_completed_callback_();
+        }
+        return 0;
+    }
+    
     PlayState new_state = convertState(state);
     wrapper->current_state_ = new_state;
     
@@ -232,6 +341,10 @@ int LitePlayerWrapper::stateCallbackC(enum liteplayer_state state, int errcode,
         wrapper->state_callback_(new_state, errcode);
     }
     
+    if (state == LITEPLAYER_PREPARED && wrapper->prepared_callback_) {
+        wrapper->prepared_callback_();
+    }
+    
     return 0;
 }
 
@@ -4,33 +4,169 @@
 #include "PlaybackController.h"
 #include <iostream>
 #include <filesystem>
-#include <unistd.h>
 #include <mutex>
 
 namespace music_player {
 
 PlaybackController::PlaybackController()
-    : currentState_(PlayState::Idle)
+    : sinkSession_(nullptr, sink_session_destroy)
+    , activeIndex_(0)
+    , currentState_(PlayState::Idle)
     , autoPlayNext_(true)
     , isTransitioning_(false)
     , errorRetryCount_(0)
+    , preloadEnabled_(false)
+    , preloadPending_(false)
+    , handoverPending_(false)
+    , preloadTrackIndex_(0)
+    , loudnessTarget_(DEFAULT_LOUDNESS_TARGET)
+    , volume_(1.0f)
+    , crossfadeMs_(0)
+    , crossfadeCurve_(CrossfadeCurve::EqualPower)
+    , crossfadeCapable_(false)
+    , crossfadeStarted_(false)
+    , monitorStop_(false)
 {
 }
 
-bool PlaybackController::initialize() {
-    // 初始化player
-    if (!player_.initialize()) {
-        std::cerr << "[PlaybackController] Failed to initialize player" << std::endl;
+PlaybackController::~PlaybackController() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        monitorStop_ = true;
+    }
+    monitorCv_.notify_all();
+    if (monitorThread_.joinable()) {
+        monitorThread_.join();
+    }
+}
+
+void PlaybackController::setPreloadNextTrack(bool enable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    preloadEnabled_ = enable;
+    std::cout << "[PlaybackController] Preload next track: " << (enable ? "on" : "off") << std::endl;
+}
+
+void PlaybackController::setIndexCacheDir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    indexCacheDir_ = dir;
+}
+
+void PlaybackController::setLoudnessTarget(double lufs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loudnessTarget_ = lufs;
+}
+
+bool PlaybackController::setCrossfade(int durationMs, CrossfadeCurve curve) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (durationMs < 0 || durationMs > SINK_SESSION_CROSSFADE_MAX_MS) {
+        return false;
+    }
+    // 运行期间无法再补建备用播放器和固定输出格式
+    if (sinkSession_ && !crossfadeCapable_ && durationMs > 0) {
+        std::cerr << "[PlaybackController] Crossfade was not enabled at startup" << std::endl;
+        return false;
+    }
+    crossfadeMs_ = durationMs;
+    crossfadeCurve_ = curve;
+    if (sinkSession_) {
+        sink_session_set_crossfade(sinkSession_.get(), durationMs,
+            curve == CrossfadeCurve::Linear ? SINK_SESSION_FADE_LINEAR : SINK_SESSION_FADE_EQUAL_POWER);
+    }
+    std::cout << "[PlaybackController] Crossfade: " << durationMs << "ms, "
+              << (curve == CrossfadeCurve::Linear ? "linear" : "equal power") << std::endl;
+    return true;
+}
+
+int PlaybackController::getCrossfade() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return crossfadeMs_;
+}
+
+bool PlaybackController::setVolume(float volume) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!(volume >= 0.0f && volume <= 1.0f)) {
         return false;
     }
+    volume_ = volume;
+    // 只更新播放器内的目标值，不会阻塞
+    bool ok = true;
+    for (auto& player : players_) {
+        ok = player.setVolume(volume) && ok;
+    }
+    return ok;
+}
+
+float PlaybackController::getVolume() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return volume_;
+}
+
+float PlaybackController::trackGainDbLocked(const Track& track) const {
+    if (!track.loudness_lufs) {
+        return 0.0f;
+    }
+    float gain = static_cast<float>(loudnessTarget_ - *track.loudness_lufs);
+    if (gain > MAX_TRACK_GAIN_DB) {
+        gain = MAX_TRACK_GAIN_DB;
+    } else if (gain < -MAX_TRACK_GAIN_DB) {
+        gain = -MAX_TRACK_GAIN_DB;
+    }
+    return gain;
+}
+
+bool PlaybackController::initialize() {
+    // 预加载需要两个播放器实例，并使用异步源以获得 NEARLYCOMPLETED 通知；交叉淡化同样需要两个播放器
+    crossfadeCapable_ = crossfadeMs_ > 0;
+    const size_t playerCount = (preloadEnabled_ || crossfadeCapable_) ? 2 : 1;
     
-    // 设置状态回调
-    player_.setStateCallback([this](PlayState state, int error_code) {
-        onPlayerStateChanged(state);
-        if (error_code != 0) {
-            handleError("Error code: " + std::to_string(error_code));
+    sinkSession_.reset(LitePlayerWrapper::createSinkSession());
+    if (!sinkSession_) {
+        std::cerr << "[PlaybackController] Failed to create sink session" << std::endl;
+        return false;
+    }
+    sink_session_set_crossfade(sinkSession_.get(), crossfadeMs_,
+        crossfadeCurve_ == CrossfadeCurve::Linear ? SINK_SESSION_FADE_LINEAR : SINK_SESSION_FADE_EQUAL_POWER);
+    
+    for (size_t i = 0; i < playerCount; i++) {
+        // 初始化player
+        if (!players_[i].initialize(preloadEnabled_, sinkSession_.get())) {
+            std::cerr << "[PlaybackController] Failed to initialize player " << i << std::endl;
+            return false;
         }
-    });
+        if (!indexCacheDir_.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(indexCacheDir_, ec);
+            players_[i].setIndexCacheDir(indexCacheDir_);
+        }
+        players_[i].setVolume(volume_);
+        // 会话只混合格式相同的两路 PCM，其他格式先在各自的播放器里重采样
+        if (crossfadeCapable_ &&
+            !players_[i].setSinkFormat(CROSSFADE_SAMPLERATE, CROSSFADE_CHANNELS, CROSSFADE_BITS)) {
+            std::cerr << "[PlaybackController] Failed to set sink format of player " << i << std::endl;
+        }
+        
+        // 设置状态回调
+        players_[i].setStateCallback([this, i](PlayState state, int error_code) {
+            if (i != activePlayerIndex()) {
+                onStandbyStateChanged(state);
+                return;
+            }
+            onPlayerStateChanged(state);
+            if (error_code != 0) {
+                handleError("Error code: " + std::to_string(error_code));
+            }
+        });
+        players_[i].setPreparedCallback([this, i]() {
+            onPlayerPrepared(i);
+        });
+        players_[i].setNearlyCompletedCallback([this, i]() {
+            onPlayerNearlyCompleted(i);
+        });
+    }
+    
+    if (crossfadeCapable_) {
+        monitorThread_ = std::thread(&PlaybackController::crossfadeMonitorLoop, this);
+    }
     
     std::cout << "[PlaybackController] Initialized successfully" << std::endl;
     return true;
@@ -70,6 +206,49 @@ PlayMode PlaybackController::getPlayMode() const {
     return playlist_.getPlayMode();
 }
 
+void PlaybackController::addTrack(const Track& track) {
+    bool fallback = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        playlist_.addTrack(track);
+        fallback = dropStalePreloadLocked(track.file_path);
+    }
+    
+    if (fallback && eventCallback_) {
+        eventCallback_(PlayerEvent::TrackEnded, getCurrentTrack().title);
+    }
+}
+
+bool PlaybackController::updateTrack(const Track& track) {
+    bool updated = false;
+    bool fallback = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        updated = playlist_.updateTrack(track);
+        fallback = updated && dropStalePreloadLocked(track.file_path);
+    }
+    
+    if (fallback && eventCallback_) {
+        eventCallback_(PlayerEvent::TrackEnded, getCurrentTrack().title);
+    }
+    return updated;
+}
+
+size_t PlaybackController::removeTracks(const std::string& path) {
+    size_t removed = 0;
+    bool fallback = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        removed = playlist_.removeTracks(path);
+        fallback = removed > 0 && dropStalePreloadLocked(path);
+    }
+    
+    if (fallback && eventCallback_) {
+        eventCallback_(PlayerEvent::TrackEnded, getCurrentTrack().title);
+    }
+    return removed;
+}
+
 bool PlaybackController::play() {
     std::cout << "[PlaybackController::play] ========== START ==========" << std::endl;
     
@@ -108,6 +287,7 @@ bool PlaybackController::playTrack(size_t index) {
         std::cerr << "[PlaybackController] Invalid track index: " << index << std::endl;
         return false;
     }
+    cancelPreloadLocked();
     
     std::cout << "[PlaybackController::playTrack] Seeking to index " << index << std::endl;
     
@@ -135,8 +315,12 @@ bool PlaybackController::pause() {
         std::cout << "[PlaybackController] Not playing, cannot pause" << std::endl;
         return false;
     }
+    // 淡化中暂停：放弃下一首，恢复后由调度线程重新安排
+    if (crossfadeStarted_) {
+        cancelPreloadLocked();
+    }
     
-    bool success = player_.pause();
+    bool success = activePlayer().pause();
     if (success) {
         std::cout << "[PlaybackController] Paused" << std::endl;
     }
@@ -150,7 +334,7 @@ bool PlaybackController::resume() {
         return false;
     }
     
-    bool success = player_.resume();
+    bool success = activePlayer().resume();
     if (success) {
         std::cout << "[PlaybackController] Resumed" << std::endl;
     }
@@ -162,6 +346,7 @@ bool PlaybackController::stop() {
     
     std::unique_lock<std::mutex> lock(mutex_);
     isTransitioning_ = true;
+    cancelPreloadLocked();
     
     bool result = safeStopInternal(lock);
     
@@ -187,6 +372,7 @@ bool PlaybackController::next() {
     
     std::cout << "[PlaybackController::next] Setting isTransitioning_=true" << std::endl;
     isTransitioning_ = true;
+    cancelPreloadLocked();
     
     // 安全停止当前播放
     std::cout << "[PlaybackController::next] Calling safeStopInternal..." << std::endl;
@@ -218,6 +404,7 @@ bool PlaybackController::prev() {
     
     std::cout << "[PlaybackController::prev] Setting isTransitioning_=true" << std::endl;
     isTransitioning_ = true;
+    cancelPreloadLocked();
     
     // 安全停止当前播放
     std::cout << "[PlaybackController::prev] Calling safeStopInternal..." << std::endl;
@@ -248,12 +435,13 @@ bool PlaybackController::safeStopInternal(std::unique_lock<std::mutex>& lock) {
     std::cout << "[PlaybackController] safeStopInternal: initiating stop from state=" 
               << static_cast<int>(state) << std::endl;
     
-    // 释放状态锁，获取播放器锁，调用底层停止
+    // 在状态锁内取播放器（activeIndex_ 可能被交接切换），再释放状态锁调用底层停止
+    LitePlayerWrapper& player = activePlayer();
     lock.unlock();
     {
         std::lock_guard<std::mutex> playerLock(playerOpMutex_);
-        std::cout << "[PlaybackController] safeStopInternal: calling player_.stop() with player lock" << std::endl;
-        player_.stop();
+        std::cout << "[PlaybackController] safeStopInternal: calling stop() with player lock" << std::endl;
+        player.stop();
     }
     lock.lock();
     
@@ -271,13 +459,16 @@ bool PlaybackController::safeStopInternal(std::unique_lock<std::mutex>& lock) {
         std::cout << "[PlaybackController] safeStopInternal: reached Stopped state" << std::endl;
     }
     
-    // Reset player（释放状态锁，获取播放器锁）
+    // Reset player（等待期间可能已交接，重新在状态锁内取播放器）
+    LitePlayerWrapper& resetPlayer = activePlayer();
     lock.unlock();
     {
         std::lock_guard<std::mutex> playerLock(playerOpMutex_);
-        std::cout << "[PlaybackController] safeStopInternal: calling player_.reset() with player lock" << std::endl;
-        player_.reset();
-        usleep(50000); // 50ms 缓冲
+        std::cout << "[PlaybackController] safeStopInternal: calling reset() with player lock" << std::endl;
+        resetPlayer.reset();
+        if (!resetPlayer.waitForIdle(RESET_TIMEOUT_MS)) {
+            std::cerr << "[PlaybackController] ⚠️  safeStopInternal: TIMEOUT waiting for reset" << std::endl;
+        }
     }
     lock.lock();
     
@@ -291,8 +482,11 @@ bool PlaybackController::seek(int positionMs) {
         std::cerr << "[PlaybackController] Cannot seek in current state" << std::endl;
         return false;
     }
+    if (crossfadeStarted_) {
+        cancelPreloadLocked();
+    }
     
-    return player_.seek(positionMs);
+    return activePlayer().seek(positionMs);
 }
 
 PlayState PlaybackController::getState() const {
@@ -316,11 +510,23 @@ size_t PlaybackController::getPlaylistSize() const {
 }
 
 int PlaybackController::getPosition() const {
-    return player_.getPosition();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return activePlayer().getPosition();
 }
 
 int PlaybackController::getDuration() const {
-    return player_.getDuration();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return activePlayer().getDuration();
+}
+
+bool PlaybackController::getStats(liteplayer_stats& stats) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return activePlayer().getStats(stats);
+}
+
+size_t PlaybackController::activePlayerIndex() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return activeIndex_;
 }
 
 void PlaybackController::setEventCallback(EventCallback callback) {
@@ -333,6 +539,8 @@ void PlaybackController::onPlayerStateChanged(PlayState newState) {
     
     PlayState oldState;
     bool shouldAutoNext = false;
+    bool handedOver = false;
+    Track startedTrack;
     
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -352,7 +560,17 @@ void PlaybackController::onPlayerStateChanged(PlayState newState) {
             oldState == PlayState::Playing && 
             newState == PlayState::Stopped &&
             autoPlayNext_) {
-            shouldAutoNext = true;
+            // 备用播放器已装载下一首：直接接续；尚未准备好则等 PREPARED 再接续
+            if (preloadPending_ && (crossfadeStarted_ || standbyPlayer().isPrepared())) {
+                handedOver = handoverLocked();
+                if (handedOver) {
+                    startedTrack = playlist_.getCurrentTrack();
+                }
+            } else if (preloadPending_) {
+                std::cout << "[PlaybackController] Track completed, waiting for preloaded track" << std::endl;
+                handoverPending_ = true;
+            }
+            shouldAutoNext = !handedOver && !handoverPending_;
         }
     }
     
@@ -366,6 +584,10 @@ void PlaybackController::onPlayerStateChanged(PlayState newState) {
     // 原因：next() 会触发 listplayer_set_data_source/prepare_async/reset 等，
     // 这些若在解码/looper 线程回调上下文内调用，可能与 liteplayer 内部锁形成互锁。
     // 改为仅发出 TrackEnded 事件，由上层服务（命令线程）决定是否调用 next()。
+    if (handedOver && eventCallback_) {
+        eventCallback_(PlayerEvent::TrackStarted, startedTrack.title);
+    }
+    
     if (shouldAutoNext) {
         std::cout << "[PlaybackController] Track completed (auto-next requested)" << std::endl;
         if (eventCallback_) {
@@ -380,6 +602,200 @@ void PlaybackController::onPlayerStateChanged(PlayState newState) {
     }
 }
 
+void PlaybackController::onStandbyStateChanged(PlayState newState) {
+    if (newState != PlayState::Error) {
+        return;
+    }
+    
+    // 预加载失败：放弃备用播放器；若当前曲目已结束在等待接续，退回到常规的 TrackEnded 流程
+    bool fallback = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::cerr << "[PlaybackController] Preload failed for track index " << preloadTrackIndex_ << std::endl;
+        fallback = handoverPending_;
+        cancelPreloadLocked();
+    }
+    
+    if (fallback && eventCallback_) {
+        Track track = getCurrentTrack();
+        eventCallback_(PlayerEvent::TrackEnded, track.title);
+    }
+}
+
+void PlaybackController::onPlayerNearlyCompleted(size_t playerIndex) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (playerIndex != activeIndex_ || !preloadEnabled_ || isTransitioning_ || preloadPending_) {
+        return;
+    }
+    preloadNextLocked();
+}
+
+void PlaybackController::onPlayerPrepared(size_t playerIndex) {
+    bool handedOver = false;
+    Track startedTrack;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (playerIndex == activeIndex_ || !handoverPending_) {
+            return;
+        }
+        handedOver = handoverLocked();
+        if (handedOver) {
+            startedTrack = playlist_.getCurrentTrack();
+        }
+    }
+    
+    if (eventCallback_) {
+        if (handedOver) {
+            eventCallback_(PlayerEvent::TrackStarted, startedTrack.title);
+        } else {
+            eventCallback_(PlayerEvent::TrackEnded, getCurrentTrack().title);
+        }
+    }
+}
+
+void PlaybackController::preloadNextLocked() {
+    size_t nextIndex = 0;
+    if (!playlist_.peekNext(nextIndex)) {
+        return;
+    }
+    
+    const Track& track = playlist_.getAllTracks()[nextIndex];
+    std::cout << "[PlaybackController] Preloading next track [" << nextIndex << "] \"" 
+              << track.title << "\"" << std::endl;
+    
+    // 备用播放器的 reset/load 都在其 looper 中按序执行，这里不等待
+    LitePlayerWrapper& standby = standbyPlayer();
+    standby.reset();
+    standby.setTrackGain(trackGainDbLocked(track));
+    if (!standby.loadFile(track.file_path)) {
+        std::cerr << "[PlaybackController] Failed to preload: " << track.file_path << std::endl;
+        return;
+    }
+    preloadPending_ = true;
+    preloadTrackIndex_ = nextIndex;
+    preloadTrackPath_ = track.file_path;
+}
+
+bool PlaybackController::dropStalePreloadLocked(const std::string& changedPath) {
+    if (!preloadPending_) {
+        return false;
+    }
+    
+    // 下一首变了（包括被移除），或者预加载的文件本身被改写
+    size_t nextIndex = 0;
+    bool stale = !playlist_.peekNext(nextIndex) || nextIndex != preloadTrackIndex_ ||
+                 playlist_.getAllTracks()[nextIndex].file_path != preloadTrackPath_ ||
+                 changedPath == preloadTrackPath_;
+    if (!stale) {
+        return false;
+    }
+    
+    // 当前曲目已结束在等待接续时，退回到常规的 TrackEnded 流程
+    std::cout << "[PlaybackController] Playlist changed, dropping preloaded track" << std::endl;
+    bool fallback = handoverPending_;
+    cancelPreloadLocked();
+    return fallback;
+}
+
+void PlaybackController::cancelPreloadLocked() {
+    handoverPending_ = false;
+    if (!preloadPending_) {
+        return;
+    }
+    preloadPending_ = false;
+    
+    // 先让会话丢弃下一首，否则其解码线程可能阻塞在已满的缓冲上而无法停止
+    if (crossfadeStarted_) {
+        crossfadeStarted_ = false;
+        sink_session_cancel_crossfade(sinkSession_.get());
+    }
+    
+    LitePlayerWrapper& standby = standbyPlayer();
+    standby.stop();
+    standby.reset();
+}
+
+bool PlaybackController::handoverLocked() {
+    handoverPending_ = false;
+    
+    // 播放列表在预加载之后可能被修改（切换模式、增删曲目），此时预加载的曲目已不是下一首
+    size_t nextIndex = 0;
+    if (!preloadPending_ || !playlist_.peekNext(nextIndex) || nextIndex != preloadTrackIndex_) {
+        std::cout << "[PlaybackController] Preloaded track is stale, dropping it" << std::endl;
+        cancelPreloadLocked();
+        return false;
+    }
+    
+    size_t previous = activeIndex_;
+    activeIndex_ = 1 - activeIndex_;
+    preloadPending_ = false;
+    errorRetryCount_ = 0;
+    playlist_.next();
+    
+    std::cout << "[PlaybackController] Handover to preloaded track [" << nextIndex << "] \""
+              << playlist_.getCurrentTrack().title << "\"" << std::endl;
+    
+    // 只投递消息：新播放器 start，旧播放器 stop + reset（其后续回调按备用播放器处理）；
+    // 交叉淡化时新播放器早已启动
+    if (crossfadeStarted_) {
+        crossfadeStarted_ = false;
+        currentState_ = PlayState::Playing;
+    } else {
+        if (!players_[activeIndex_].start()) {
+            std::cerr << "[PlaybackController] Failed to start preloaded track" << std::endl;
+        }
+        currentState_ = PlayState::Loading;
+    }
+    players_[previous].stop();
+    players_[previous].reset();
+    return true;
+}
+
+void PlaybackController::crossfadeMonitorLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!monitorStop_) {
+        monitorCv_.wait_for(lock, std::chrono::milliseconds(CROSSFADE_POLL_MS), [this] {
+            return monitorStop_;
+        });
+        if (!monitorStop_) {
+            scheduleCrossfadeLocked();
+        }
+    }
+}
+
+void PlaybackController::scheduleCrossfadeLocked() {
+    if (crossfadeMs_ <= 0 || currentState_ != PlayState::Playing || isTransitioning_ ||
+        handoverPending_ || crossfadeStarted_) {
+        return;
+    }
+    
+    int duration = activePlayer().getDuration();
+    int position = activePlayer().getPosition();
+    if (duration <= 0 || position < 0) {
+        return;
+    }
+    int remaining = duration - position;
+    
+    if (!preloadPending_) {
+        if (remaining <= crossfadeMs_ + CROSSFADE_PRELOAD_LEAD_MS) {
+            preloadNextLocked();
+        }
+        return;
+    }
+    
+    // 提前启动下一首：会话缓冲满预缓冲后开始淡化，此前它只在会话中排队
+    if (remaining > crossfadeMs_ + CROSSFADE_START_LEAD_MS || !standbyPlayer().isPrepared()) {
+        return;
+    }
+    std::cout << "[PlaybackController] Starting crossfade to track [" << preloadTrackIndex_
+              << "], " << remaining << "ms left" << std::endl;
+    if (!standbyPlayer().start()) {
+        std::cerr << "[PlaybackController] Failed to start next track for crossfade" << std::endl;
+        return;
+    }
+    crossfadeStarted_ = true;
+}
+
 void PlaybackController::handleError(const std::string& error) {
     std::cerr << "[PlaybackController] Error: " << error << std::endl;
     
@@ -437,19 +853,27 @@ bool PlaybackController::startCurrentTrackInternal(std::unique_lock<std::mutex>&
     std::cout << "[PlaybackController] startCurrentTrackInternal: \"" << track.title 
               << "\" (path=" << track.file_path << ")" << std::endl;
     
-    // 释放状态锁，并获取播放器操作锁（互斥保护 player_ 对象）
+    // 手动启动曲目时，之前预加载的备用播放器不再需要
+    cancelPreloadLocked();
+    const float trackGainDb = trackGainDbLocked(track);
+    // activeIndex_ 由状态锁保护，释放前取出播放器
+    LitePlayerWrapper& player = activePlayer();
+    
+    // 释放状态锁，并获取播放器操作锁（互斥保护 players_ 对象）
     std::cout << "[PlaybackController] Releasing state lock, acquiring player lock..." << std::endl;
     lock.unlock();
     std::lock_guard<std::mutex> playerLock(playerOpMutex_);
     std::cout << "[PlaybackController] ✅ Acquired player operation lock" << std::endl;
     
-    std::cout << "[PlaybackController] Calling player_.reset()..." << std::endl;
-    player_.reset();
-    std::cout << "[PlaybackController] Waiting for reset to complete (200ms)..." << std::endl;
-    usleep(200000); // 200ms - 等待异步销毁完成
+    std::cout << "[PlaybackController] Calling reset()..." << std::endl;
+    player.reset();
+    if (!player.waitForIdle(RESET_TIMEOUT_MS)) {
+        std::cerr << "[PlaybackController] ⚠️  TIMEOUT waiting for reset" << std::endl;
+    }
     
+    player.setTrackGain(trackGainDb);
     std::cout << "[PlaybackController] Loading file: " << track.file_path << std::endl;
-    bool loadResult = player_.loadFile(track.file_path);
+    bool loadResult = player.loadFile(track.file_path) && player.waitForPrepared(PREPARE_TIMEOUT_MS);
     if (!loadResult) {
         std::cerr << "[PlaybackController] ❌ Failed to load: " << track.file_path << std::endl;
         if (eventCallback_) {
@@ -460,11 +884,8 @@ bool PlaybackController::startCurrentTrackInternal(std::unique_lock<std::mutex>&
         return false;
     }
     
-    std::cout << "[PlaybackController] Waiting for async prepare (500ms)..." << std::endl;
-    usleep(500000);  // 500ms - 对 MP3 文件很重要
-    
-    std::cout << "[PlaybackController] Calling player_.start()..." << std::endl;
-    bool startResult = player_.start();
+    std::cout << "[PlaybackController] Calling start()..." << std::endl;
+    bool startResult = player.start();
     
     // 重新获取状态锁
     lock.lock();
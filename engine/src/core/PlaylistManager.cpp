@@ -17,6 +17,8 @@ PlaylistManager::PlaylistManager()
     , loopCount_(0)
     , remainingLoops_(0)
     , isShuffled_(false)
+    , hasPeekedNext_(false)
+    , peekedNextIndex_(0)
 {
     // 使用当前时间作为随机种子
     auto seed = std::chrono::system_clock::now().time_since_epoch().count();
@@ -84,20 +86,70 @@ bool PlaylistManager::loadFromFile(const std::string& filePath) {
 
 void PlaylistManager::addTrack(const Track& track) {
     tracks_.push_back(track);
+    hasPeekedNext_ = false;
     if (!isShuffled_) {
         originalTracks_ = tracks_;
     }
 }
 
+bool PlaylistManager::updateTrack(const Track& track) {
+    bool found = false;
+    for (auto* list : {&tracks_, &originalTracks_}) {
+        for (auto& t : *list) {
+            if (t.file_path == track.file_path) {
+                t = track;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+size_t PlaylistManager::removeTracks(const std::string& path) {
+    auto matches = [&path](const Track& t) {
+        return t.file_path == path ||
+               (t.file_path.size() > path.size() && t.file_path.compare(0, path.size(), path) == 0 &&
+                t.file_path[path.size()] == '/');
+    };
+    
+    // 当前曲目之前的被移除时索引前移；当前曲目被移除时停在它的前一首，next() 仍接到原来的下一首
+    size_t removed = 0;
+    size_t newIndex = currentIndex_;
+    std::vector<Track> kept;
+    kept.reserve(tracks_.size());
+    for (size_t i = 0; i < tracks_.size(); i++) {
+        if (!matches(tracks_[i])) {
+            kept.push_back(tracks_[i]);
+            continue;
+        }
+        removed++;
+        if (i <= currentIndex_ && newIndex > 0) {
+            newIndex--;
+        }
+    }
+    if (removed == 0) {
+        return 0;
+    }
+    
+    tracks_.swap(kept);
+    originalTracks_.erase(std::remove_if(originalTracks_.begin(), originalTracks_.end(), matches),
+                          originalTracks_.end());
+    currentIndex_ = tracks_.empty() ? 0 : std::min(newIndex, tracks_.size() - 1);
+    hasPeekedNext_ = false;
+    return removed;
+}
+
 void PlaylistManager::clear() {
     tracks_.clear();
     originalTracks_.clear();
     currentIndex_ = 0;
     isShuffled_ = false;
+    hasPeekedNext_ = false;
 }
 
 void PlaylistManager::setPlayMode(PlayMode mode) {
     playMode_ = mode;
+    hasPeekedNext_ = false;
     std::cout << "[PlaylistManager] Play mode set to: " 
               << static_cast<int>(mode) << std::endl;
 }
@@ -118,7 +170,8 @@ bool PlaylistManager::next() {
         return false;
     }
     
-    size_t nextIdx = calculateNextIndex();
+    size_t nextIdx = hasPeekedNext_ ? peekedNextIndex_ : calculateNextIndex();
+    hasPeekedNext_ = false;
     
     // Sequential模式下，如果到达末尾则返回false
     if (playMode_ == PlayMode::Sequential && 
@@ -153,6 +206,7 @@ bool PlaylistManager::prev() {
     }
     
     size_t prevIdx = calculatePrevIndex();
+    hasPeekedNext_ = false;
     
     // Sequential模式下，如果在开头则返回false
     if (playMode_ == PlayMode::Sequential && currentIndex_ == 0) {
@@ -168,6 +222,20 @@ bool PlaylistManager::seekTo(size_t index) {
         return false;
     }
     currentIndex_ = index;
+    hasPeekedNext_ = false;
+    return true;
+}
+
+bool PlaylistManager::peekNext(size_t& index) const {
+    if (!hasNext()) {
+        return false;
+    }
+    
+    if (!hasPeekedNext_) {
+        peekedNextIndex_ = calculateNextIndex();
+        hasPeekedNext_ = true;
+    }
+    index = peekedNextIndex_;
     return true;
 }
 
@@ -195,6 +263,7 @@ void PlaylistManager::shuffle() {
     }
     
     isShuffled_ = true;
+    hasPeekedNext_ = false;
     std::cout << "[PlaylistManager] Playlist shuffled" << std::endl;
 }
 
@@ -222,6 +291,7 @@ void PlaylistManager::unshuffle() {
     }
     
     isShuffled_ = false;
+    hasPeekedNext_ = false;
     std::cout << "[PlaylistManager] Playlist restored to original order" << std::endl;
 }
 
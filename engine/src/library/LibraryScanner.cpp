@@ -0,0 +1,322 @@
+// LibraryScanner.cpp
+// 音乐库扫描实现
+
+#include "LibraryScanner.h"
+#include "BatchWorkerPool.h"
+#include "TagReader.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sys/stat.h>
+#include "cipher/sha2.h"
+
+extern "C" {
+#include "liteplayer_analyzer.h"
+}
+
+namespace music_player {
+
+namespace {
+
+// liteplayer 解析器的数据源：从 MediaFile 读取，命中文件头时不再访问磁盘
+struct ScanSource {
+    MediaFile* file;
+    long long pos;
+};
+
+const char* scanSourceProtocol() {
+    return "file";
+}
+
+source_handle_t scanSourceOpen(const char* url, long long content_pos, void* priv_data) {
+    (void)url;
+    return new ScanSource{static_cast<MediaFile*>(priv_data), content_pos};
+}
+
+int scanSourceRead(source_handle_t handle, char* buffer, int size) {
+    ScanSource* source = static_cast<ScanSource*>(handle);
+    int n = source->file->readAt(source->pos, buffer, size);
+    source->pos += n;
+    return n;
+}
+
+long long scanSourcePos(source_handle_t handle) {
+    return static_cast<ScanSource*>(handle)->pos;
+}
+
+long long scanSourceLen(source_handle_t handle) {
+    return static_cast<ScanSource*>(handle)->file->size();
+}
+
+int scanSourceSeek(source_handle_t handle, long offset) {
+    static_cast<ScanSource*>(handle)->pos = offset;
+    return 0;
+}
+
+void scanSourceClose(source_handle_t handle) {
+    delete static_cast<ScanSource*>(handle);
+}
+
+// 内容哈希只读文件头尾各一段，和文件大小无关；文件头已由 MediaFile 读入
+constexpr int64_t HASH_CHUNK_SIZE = 64 * 1024;
+
+void readFileFingerprint(MediaFile& file, Track& track) {
+    int64_t size = file.size();
+    track.file_size = size;
+    track.file_mtime = file.mtime();
+
+    // SHA-256(大小 + 前 64KB + 后 64KB)，取前 16 字节
+    sha256_ctx ctx;
+    sha256_init(&ctx);
+    unsigned char size_bytes[8];
+    for (int i = 0; i < 8; i++) {
+        size_bytes[i] = static_cast<unsigned char>(size >> (8 * i));
+    }
+    sha256_update(&ctx, size_bytes, sizeof(size_bytes));
+
+    std::vector<char> buf(HASH_CHUNK_SIZE);
+    int64_t head_len = std::min(size, HASH_CHUNK_SIZE);
+    int n = file.readAt(0, buf.data(), static_cast<int>(head_len));
+    sha256_update(&ctx, reinterpret_cast<const unsigned char*>(buf.data()), std::max(n, 0));
+    int64_t tail_offset = std::max(head_len, size - HASH_CHUNK_SIZE);
+    if (tail_offset < size) {
+        n = file.readAt(tail_offset, buf.data(), static_cast<int>(size - tail_offset));
+        sha256_update(&ctx, reinterpret_cast<const unsigned char*>(buf.data()), std::max(n, 0));
+    }
+
+    unsigned char digest[SHA256_DIGEST_SIZE];
+    sha256_final(&ctx, digest);
+    static const char hex[] = "0123456789abcdef";
+    track.content_hash.clear();
+    for (int i = 0; i < 16; i++) {
+        track.content_hash += hex[digest[i] >> 4];
+        track.content_hash += hex[digest[i] & 0x0f];
+    }
+}
+
+// 读取标签和时长，opened 为 false 时只按文件名填充
+bool parseTrack(MediaFile& file, bool opened, const std::string& path, Track& track) {
+    namespace fs = std::filesystem;
+    track.file_path = path;
+
+    bool parsed = false;
+    if (opened) {
+        TagReader::read(file, track);
+
+        struct source_wrapper file_ops = {
+            .async_mode = false,
+            .buffer_size = 32*1024,
+            .priv_data = &file,
+            .url_protocol = scanSourceProtocol,
+            .open = scanSourceOpen,
+            .read = scanSourceRead,
+            .content_pos = scanSourcePos,
+            .content_len = scanSourceLen,
+            .seek = scanSourceSeek,
+            .close = scanSourceClose,
+        };
+        struct liteplayer_media_info info;
+        if (liteplayer_probe_media(path.c_str(), &file_ops, &info) == 0) {
+            track.duration_ms = info.duration_ms;
+            parsed = true;
+        }
+    }
+
+    if (track.title.empty()) track.title = fs::path(path).stem().string();
+    if (track.artist.empty()) track.artist = "Unknown";
+    if (track.album.empty()) track.album = "Unknown";
+    return parsed;
+}
+
+} // namespace
+
+LibraryScanner::LibraryScanner(MusicLibrary& library)
+    : library_(library)
+    , failed_(0)
+    , moved_(0)
+{
+}
+
+bool LibraryScanner::readTrack(const std::string& path, Track& track) {
+    MediaFile file;
+    bool opened = file.open(path);
+    if (opened) {
+        readFileFingerprint(file, track);
+    }
+    return parseTrack(file, opened, path, track);
+}
+
+bool LibraryScanner::readFingerprint(const std::string& path, Track& track) {
+    MediaFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    track.file_path = path;
+    readFileFingerprint(file, track);
+    return true;
+}
+
+LibraryScanner::Result LibraryScanner::scan(const std::vector<std::string>& directories,
+                                            const Options& options) {
+    auto start_time = std::chrono::steady_clock::now();
+    Result result;
+
+    known_.clear();
+    for (auto& fp : library_.getFileFingerprints()) {
+        std::string path = fp.file_path;
+        known_.emplace(std::move(path), std::move(fp));
+    }
+    tasks_.clear();
+    for (const auto& dir : directories) {
+        std::cout << "[LibraryScanner] Scanning directory: " << dir << std::endl;
+        collectFiles(dir, options);
+    }
+
+    // 没有见到且文件已不存在的曲目，新文件内容与之相同时视为移动
+    missing_.clear();
+    bool has_new = std::any_of(tasks_.begin(), tasks_.end(), [](const Task& t) { return t.track_id == 0; });
+    for (auto& item : known_) {
+        struct stat st;
+        if (has_new && !item.second.content_hash.empty() && stat(item.first.c_str(), &st) != 0) {
+            missing_.emplace(item.second.content_hash, std::move(item.second));
+        }
+    }
+    known_.clear();
+
+    result.found = static_cast<int>(tasks_.size());
+    if (tasks_.empty()) {
+        std::cout << "[LibraryScanner] No new or changed files" << std::endl;
+        return result;
+    }
+
+    BatchWorkerPool<TaskResult> pool(options.threads, options.batch_size);
+    std::cout << "[LibraryScanner] Reading " << tasks_.size() << " files with "
+              << pool.threadCount(tasks_.size()) << " threads" << std::endl;
+
+    failed_ = 0;
+    moved_ = 0;
+    pool.run(tasks_.size(),
+             [this](size_t index) { return readTask(tasks_[index]); },
+             [this, &result](std::vector<TaskResult>& batch) { result.added += commitBatch(batch); });
+    tasks_.clear();
+    missing_.clear();
+    result.failed = failed_;
+    result.moved = moved_;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "[LibraryScanner] Done: " << result.added << " added, " << result.moved << " moved, "
+              << result.failed << " unparsed, " << elapsed << "ms" << std::endl;
+    return result;
+}
+
+void LibraryScanner::collectFiles(const std::string& directory, const Options& options) {
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        std::cerr << "[LibraryScanner] Not a directory: " << directory << std::endl;
+        return;
+    }
+
+    std::string abs_dir = fs::absolute(directory, ec).string();
+    fs::recursive_directory_iterator it(abs_dir, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+
+        std::string extension = it->path().extension().string();
+        if (extension.size() < 2) continue;
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (std::find(options.formats.begin(), options.formats.end(), extension.substr(1)) ==
+            options.formats.end()) {
+            continue;
+        }
+
+        Task task;
+        task.path = it->path().string();
+        auto known = known_.find(task.path);
+        if (known != known_.end()) {
+            // 已入库：指纹一致时跳过，没有指纹的旧记录只补记指纹
+            const FileFingerprint& fp = known->second;
+            struct stat st;
+            if (stat(task.path.c_str(), &st) != 0) continue;
+            bool unchanged = fp.file_size == static_cast<int64_t>(st.st_size) &&
+                             fp.file_mtime == static_cast<int64_t>(st.st_mtime);
+            bool has_hash = !fp.content_hash.empty();
+            task.track_id = fp.track_id;
+            task.changed = has_hash && !unchanged;
+            known_.erase(known);
+            if (unchanged && has_hash) continue;
+        }
+        tasks_.push_back(std::move(task));
+    }
+    if (ec) {
+        std::cerr << "[LibraryScanner] Error scanning " << abs_dir << ": " << ec.message() << std::endl;
+    }
+}
+
+int64_t LibraryScanner::claimMovedTrack(const Track& track) {
+    std::lock_guard<std::mutex> lock(missing_mutex_);
+    auto range = missing_.equal_range(track.content_hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.file_size == track.file_size) {
+            int64_t id = it->second.track_id;
+            missing_.erase(it);
+            return id;
+        }
+    }
+    return 0;
+}
+
+LibraryScanner::TaskResult LibraryScanner::readTask(const Task& task) {
+    TaskResult result;
+    Track& track = result.track;
+    MediaFile file;
+    bool opened = file.open(task.path);
+    if (opened) {
+        readFileFingerprint(file, track);
+    }
+
+    // 内容未变的文件只改写原记录的路径和指纹，不重新解析
+    if (opened && task.track_id > 0 && !task.changed) {
+        result.relink_id = task.track_id;
+    } else if (opened && task.track_id == 0) {
+        result.relink_id = claimMovedTrack(track);
+        if (result.relink_id > 0) moved_++;
+    }
+
+    if (result.relink_id == 0 && !parseTrack(file, opened, task.path, track)) {
+        std::cerr << "[LibraryScanner] Failed to parse: " << task.path << std::endl;
+        failed_++;
+    }
+    if (result.relink_id > 0) {
+        track.file_path = task.path;
+    }
+    return result;
+}
+
+int LibraryScanner::commitBatch(std::vector<TaskResult>& batch) {
+    std::vector<Track> tracks;
+    std::vector<FileFingerprint> moves;
+    for (auto& result : batch) {
+        if (result.relink_id == 0) {
+            tracks.push_back(std::move(result.track));
+            continue;
+        }
+        FileFingerprint move;
+        move.track_id = result.relink_id;
+        move.file_path = std::move(result.track.file_path);
+        move.file_size = result.track.file_size;
+        move.file_mtime = result.track.file_mtime;
+        move.content_hash = std::move(result.track.content_hash);
+        moves.push_back(std::move(move));
+    }
+
+    if (!moves.empty()) {
+        library_.relinkTracks(moves);
+    }
+    return tracks.empty() ? 0 : library_.upsertTracks(tracks);
+}
+
+} // namespace music_player
@@ -0,0 +1,448 @@
+// LibraryWatcher.cpp
+// 音乐库监控实现
+
+#include "LibraryWatcher.h"
+#include "LibraryScanner.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+namespace music_player {
+
+namespace {
+
+#if defined(__linux__)
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                IN_DELETE_SELF | IN_ONLYDIR;
+#endif
+
+bool isUnder(const std::string& path, const std::string& dir) {
+    return path.size() > dir.size() && path.compare(0, dir.size(), dir) == 0 && path[dir.size()] == '/';
+}
+
+} // namespace
+
+LibraryWatcher::LibraryWatcher(const std::string& db_path)
+    : db_path_(db_path)
+    , running_(false)
+    , stop_pipe_{-1, -1}
+    , inotify_fd_(-1)
+{
+}
+
+LibraryWatcher::~LibraryWatcher() {
+    stop();
+}
+
+bool LibraryWatcher::start(const Options& options, ChangeCallback callback) {
+    if (running_) {
+        return false;
+    }
+    if (!library_.open(db_path_)) {
+        std::cerr << "[LibraryWatcher] Failed to open library: " << db_path_ << std::endl;
+        return false;
+    }
+    if (pipe2(stop_pipe_, O_CLOEXEC | O_NONBLOCK) != 0) {
+        library_.close();
+        return false;
+    }
+
+    options_ = options;
+    callback_ = std::move(callback);
+    for (auto& dir : options_.directories) {
+        std::error_code ec;
+        // 与 LibraryScanner 一致，只补全为绝对路径，保证数据库里的 file_path 相同
+        std::string abs_dir = std::filesystem::absolute(dir, ec).string();
+        if (!ec) dir = abs_dir;
+        while (dir.size() > 1 && dir.back() == '/') dir.pop_back();
+    }
+
+    running_ = true;
+    thread_ = std::thread(&LibraryWatcher::run, this);
+    return true;
+}
+
+void LibraryWatcher::stop() {
+    if (thread_.joinable()) {
+        running_ = false;
+        char c = 0;
+        if (write(stop_pipe_[1], &c, 1) < 0) {
+            // 管道满说明已经有待处理的唤醒
+        }
+        thread_.join();
+    }
+    for (int& fd : stop_pipe_) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    library_.close();
+}
+
+void LibraryWatcher::run() {
+    // 先建立监控再取快照，两者之间的变化会以事件的形式再报告一次
+    if (options_.use_inotify && !initInotify()) {
+        std::cerr << "[LibraryWatcher] inotify unavailable, comparing snapshots every "
+                  << rescanIntervalSeconds() << "s" << std::endl;
+    }
+    for (const auto& dir : options_.directories) {
+        walk(dir, snapshot_);
+    }
+    std::cout << "[LibraryWatcher] Watching " << options_.directories.size() << " directories, "
+              << snapshot_.size() << " files" << (isUsingInotify() ? " (inotify)" : " (snapshot)") << std::endl;
+
+    next_rescan_ = Clock::now() + std::chrono::seconds(rescanIntervalSeconds());
+
+    while (running_) {
+        auto now = Clock::now();
+        Clock::time_point deadline = Clock::time_point::max();
+        if (rescanIntervalSeconds() > 0) {
+            deadline = next_rescan_;
+        }
+        if (!pending_.empty()) {
+            deadline = std::min({deadline,
+                                 last_pending_ + std::chrono::milliseconds(options_.debounce_ms),
+                                 first_pending_ + std::chrono::milliseconds(options_.max_delay_ms)});
+        }
+        int timeout_ms = -1;
+        if (deadline != Clock::time_point::max()) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+            timeout_ms = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(left, 60000)));
+        }
+
+        struct pollfd fds[2] = {
+            { stop_pipe_[0], POLLIN, 0 },
+            { inotify_fd_, POLLIN, 0 },
+        };
+        int ret = poll(fds, isUsingInotify() ? 2 : 1, timeout_ms);
+        if (ret < 0 && errno != EINTR) {
+            std::cerr << "[LibraryWatcher] poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        if (!running_) break;
+
+        if (ret > 0 && isUsingInotify() && (fds[1].revents & POLLIN)) {
+            readInotifyEvents();
+        }
+
+        now = Clock::now();
+        if (rescanIntervalSeconds() > 0 && now >= next_rescan_) {
+            diffSnapshot();
+            next_rescan_ = now + std::chrono::seconds(rescanIntervalSeconds());
+        }
+        if (!pending_.empty() &&
+            (now >= last_pending_ + std::chrono::milliseconds(options_.debounce_ms) ||
+             now >= first_pending_ + std::chrono::milliseconds(options_.max_delay_ms))) {
+            flush();
+        }
+    }
+
+    // 退出前提交已合并的变化
+    if (!pending_.empty()) {
+        flush();
+    }
+    closeInotify();
+}
+
+bool LibraryWatcher::initInotify() {
+#if defined(__linux__)
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+        return false;
+    }
+    for (const auto& dir : options_.directories) {
+        if (!addWatchRecursive(dir, false)) {
+            closeInotify();
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LibraryWatcher::closeInotify() {
+    if (inotify_fd_ >= 0) {
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+    }
+    watches_.clear();
+}
+
+bool LibraryWatcher::addWatchRecursive(const std::string& dir, bool queue_files) {
+#if defined(__linux__)
+    namespace fs = std::filesystem;
+
+    int wd = inotify_add_watch(inotify_fd_, dir.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            std::cerr << "[LibraryWatcher] inotify watch limit reached (fs.inotify.max_user_watches)" << std::endl;
+            return false;
+        }
+        // 目录不存在或无权限，跳过
+        return true;
+    }
+    watches_[wd] = dir;
+
+    // 新出现的目录（移入或新建）里已有的文件不会再产生事件，直接入队
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        std::error_code type_ec;
+        if (it->is_directory(type_ec) && !it->is_symlink(type_ec)) {
+            if (!addWatchRecursive(it->path().string(), queue_files)) {
+                return false;
+            }
+        } else if (queue_files && it->is_regular_file(type_ec) && isSupported(it->path().string())) {
+            queueChange(it->path().string(), false);
+        }
+    }
+    return true;
+#else
+    (void)dir;
+    (void)queue_files;
+    return false;
+#endif
+}
+
+void LibraryWatcher::removeWatchesUnder(const std::string& dir) {
+#if defined(__linux__)
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        if (it->second == dir || isUnder(it->second, dir)) {
+            inotify_rm_watch(inotify_fd_, it->first);
+            it = watches_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+#else
+    (void)dir;
+#endif
+}
+
+void LibraryWatcher::readInotifyEvents() {
+#if defined(__linux__)
+    alignas(struct inotify_event) char buf[16 * 1024];
+    bool overflow = false;
+    bool limit_reached = false;
+
+    while (true) {
+        ssize_t len = read(inotify_fd_, buf, sizeof(buf));
+        if (len <= 0) break;
+
+        for (char* p = buf; p < buf + len;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches_.erase(event->wd);
+                continue;
+            }
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end() || event->len == 0) {
+                continue;
+            }
+
+            std::string path = watch->second + "/" + event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    limit_reached = limit_reached || !addWatchRecursive(path, true);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    removeWatchesUnder(path);
+                    queueChange(path, true);
+                }
+            } else if (isSupported(path)) {
+                // IN_CREATE 时文件可能还没写完，等 IN_CLOSE_WRITE
+                if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    queueChange(path, false);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    queueChange(path, true);
+                }
+            }
+        }
+    }
+
+    if (limit_reached) {
+        std::cerr << "[LibraryWatcher] Falling back to snapshots every " << rescanIntervalSeconds() << "s" << std::endl;
+        closeInotify();
+        diffSnapshot();
+        next_rescan_ = Clock::now() + std::chrono::seconds(rescanIntervalSeconds());
+    } else if (overflow) {
+        std::cerr << "[LibraryWatcher] inotify queue overflow, comparing snapshot" << std::endl;
+        diffSnapshot();
+    }
+#endif
+}
+
+int LibraryWatcher::rescanIntervalSeconds() const {
+    // 快照是没有 inotify 时唯一的变化来源，不能按 inotify 模式的补充间隔等一小时
+    if (!isUsingInotify() && options_.fallback_poll_interval_s > 0) {
+        return options_.fallback_poll_interval_s;
+    }
+    return options_.rescan_interval_s;
+}
+
+void LibraryWatcher::walk(const std::string& dir, std::map<std::string, FileStamp>& files) const {
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        std::string path = it->path().string();
+        if (!isSupported(path)) continue;
+
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            files[path] = FileStamp{static_cast<int64_t>(st.st_size), static_cast<int64_t>(st.st_mtime)};
+        }
+    }
+}
+
+void LibraryWatcher::diffSnapshot() {
+    std::map<std::string, FileStamp> current;
+    for (const auto& dir : options_.directories) {
+        walk(dir, current);
+    }
+
+    // 两个有序 map 归并比较
+    auto old_it = snapshot_.begin();
+    auto new_it = current.begin();
+    while (old_it != snapshot_.end() || new_it != current.end()) {
+        if (new_it == current.end() || (old_it != snapshot_.end() && old_it->first < new_it->first)) {
+            queueChange(old_it->first, true);
+            ++old_it;
+        } else if (old_it == snapshot_.end() || new_it->first < old_it->first) {
+            queueChange(new_it->first, false);
+            ++new_it;
+        } else {
+            if (old_it->second.size != new_it->second.size || old_it->second.mtime != new_it->second.mtime) {
+                queueChange(new_it->first, false);
+            }
+            ++old_it;
+            ++new_it;
+        }
+    }
+}
+
+void LibraryWatcher::queueChange(const std::string& path, bool removed) {
+    auto now = Clock::now();
+    if (pending_.empty()) {
+        first_pending_ = now;
+    }
+    last_pending_ = now;
+    pending_[path] = removed;
+}
+
+void LibraryWatcher::flush() {
+    Changes changes;
+    std::vector<std::string> updated_paths;
+    for (const auto& item : pending_) {
+        if (item.second) {
+            changes.removed.push_back(item.first);
+        } else {
+            updated_paths.push_back(item.first);
+        }
+    }
+    pending_.clear();
+
+    // 同一批中删除的曲目：新出现的文件内容与之相同时视为移动，保留原记录
+    std::unordered_multimap<std::string, FileFingerprint> gone;
+    if (!changes.removed.empty()) {
+        for (auto& fp : library_.getFileFingerprints(changes.removed)) {
+            if (!fp.content_hash.empty()) {
+                std::string hash = fp.content_hash;
+                gone.emplace(std::move(hash), std::move(fp));
+            }
+        }
+    }
+
+    std::vector<Track> tracks;
+    std::vector<FileFingerprint> moves;
+    for (const auto& path : updated_paths) {
+        // 入队之后又被删除或移走的按删除处理
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            changes.removed.push_back(path);
+            continue;
+        }
+        snapshot_[path] = FileStamp{static_cast<int64_t>(st.st_size), static_cast<int64_t>(st.st_mtime)};
+
+        Track track;
+        if (!gone.empty() && LibraryScanner::readFingerprint(path, track) &&
+            library_.getFileFingerprints({path}).empty()) {
+            auto range = gone.equal_range(track.content_hash);
+            auto match = std::find_if(range.first, range.second, [&](const auto& item) {
+                return item.second.file_size == track.file_size;
+            });
+            if (match != range.second) {
+                FileFingerprint move = match->second;
+                move.file_path = path;
+                move.file_mtime = track.file_mtime;
+                moves.push_back(std::move(move));
+                gone.erase(match);
+                continue;
+            }
+        }
+        LibraryScanner::readTrack(path, track);
+        tracks.push_back(std::move(track));
+    }
+
+    for (const auto& path : changes.removed) {
+        auto it = snapshot_.lower_bound(path);
+        while (it != snapshot_.end() && (it->first == path || isUnder(it->first, path))) {
+            it = snapshot_.erase(it);
+        }
+    }
+
+    // 先改写移动的曲目，随后按旧路径删除时不会带走它们；
+    // 再删后写：目录被移走后又移回时，新的曲目不会被随后的删除带走
+    int moved = moves.empty() ? 0 : library_.relinkTracks(moves);
+    int removed = changes.removed.empty() ? 0 : library_.deleteTracksByPath(changes.removed);
+    int updated = tracks.empty() ? 0 : library_.upsertTracks(tracks);
+    for (auto& track : tracks) {
+        if (track.id > 0) {
+            changes.updated.push_back(std::move(track));
+        }
+    }
+    for (const auto& move : moves) {
+        TrackInfo info;
+        if (library_.getTrack(move.track_id, info) && info.file_path == move.file_path) {
+            changes.updated.push_back(info);
+        }
+    }
+
+    std::cout << "[LibraryWatcher] Applied changes: " << updated << " updated, "
+              << moved << " moved, " << removed << " removed" << std::endl;
+    if (callback_ && (!changes.updated.empty() || !changes.removed.empty())) {
+        callback_(changes);
+    }
+}
+
+bool LibraryWatcher::isSupported(const std::string& path) const {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return false;
+    }
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return std::find(options_.formats.begin(), options_.formats.end(), ext) != options_.formats.end();
+}
+
+} // namespace music_player
@@ -0,0 +1,157 @@
+// LoudnessAnalyzer.cpp
+// 响度分析实现
+
+#include "LoudnessAnalyzer.h"
+#include "BatchWorkerPool.h"
+#include <iostream>
+#include <chrono>
+#include <sys/stat.h>
+
+extern "C" {
+#include "liteplayer_analyzer.h"
+#include "source_file_wrapper.h"
+}
+
+namespace music_player {
+
+LoudnessAnalyzer::LoudnessAnalyzer(const std::string& db_path)
+    : db_path_(db_path)
+    , running_(false)
+    , stop_requested_(false)
+    , total_(0)
+    , analyzed_(0)
+    , failed_(0)
+{
+}
+
+LoudnessAnalyzer::~LoudnessAnalyzer() {
+    stop();
+}
+
+bool LoudnessAnalyzer::start(const Options& options) {
+    if (running_) {
+        return false;
+    }
+    // 上一次运行已结束但线程未回收
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    stop_requested_ = false;
+    total_ = 0;
+    analyzed_ = 0;
+    failed_ = 0;
+    running_ = true;
+    thread_ = std::thread(&LoudnessAnalyzer::run, this, options);
+    return true;
+}
+
+void LoudnessAnalyzer::stop() {
+    stop_requested_ = true;
+    wait();
+}
+
+void LoudnessAnalyzer::wait() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+LoudnessAnalyzer::Progress LoudnessAnalyzer::getProgress() const {
+    Progress progress;
+    progress.total = total_;
+    progress.analyzed = analyzed_;
+    progress.failed = failed_;
+    progress.running = running_;
+    return progress;
+}
+
+void LoudnessAnalyzer::run(Options options) {
+    auto start_time = std::chrono::steady_clock::now();
+
+    MusicLibrary library;
+    if (!library.open(db_path_)) {
+        std::cerr << "[LoudnessAnalyzer] Failed to open library: " << db_path_ << std::endl;
+        running_ = false;
+        return;
+    }
+
+    // 只分析指纹和磁盘文件不一致的曲目，找不到的文件留给扫描处理
+    tasks_.clear();
+    for (auto& fp : library.getLoudnessFingerprints()) {
+        struct stat st;
+        if (stat(fp.file_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        if (fp.file_size == static_cast<int64_t>(st.st_size) &&
+            fp.file_mtime == static_cast<int64_t>(st.st_mtime)) {
+            continue;
+        }
+        fp.file_size = st.st_size;
+        fp.file_mtime = st.st_mtime;
+        tasks_.push_back(std::move(fp));
+    }
+    total_ = static_cast<int>(tasks_.size());
+
+    if (tasks_.empty()) {
+        std::cout << "[LoudnessAnalyzer] All tracks are up to date" << std::endl;
+        running_ = false;
+        return;
+    }
+
+    BatchWorkerPool<LoudnessResult> pool(options.threads, options.batch_size, &stop_requested_);
+    std::cout << "[LoudnessAnalyzer] Analyzing " << tasks_.size() << " tracks with "
+              << pool.threadCount(tasks_.size()) << " threads" << std::endl;
+
+    pool.run(tasks_.size(),
+             [this](size_t index) { return analyzeTrack(tasks_[index]); },
+             [&library](std::vector<LoudnessResult>& batch) {
+                 if (library.saveLoudnessResults(batch) < 0) {
+                     std::cerr << "[LoudnessAnalyzer] Failed to save " << batch.size() << " results" << std::endl;
+                 }
+             });
+    library.close();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "[LoudnessAnalyzer] " << (stop_requested_ ? "Stopped" : "Done") << ": "
+              << analyzed_ << " analyzed, " << failed_ << " failed, "
+              << (total_ - analyzed_ - failed_) << " left, " << elapsed << "ms" << std::endl;
+    running_ = false;
+}
+
+LoudnessResult LoudnessAnalyzer::analyzeTrack(const LoudnessFingerprint& task) {
+    // 同步读文件，解析器留下的数据只需要小缓冲
+    struct source_wrapper file_ops = {
+        .async_mode = false,
+        .buffer_size = 32*1024,
+        .priv_data = nullptr,
+        .url_protocol = file_wrapper_url_protocol,
+        .open = file_wrapper_open,
+        .read = file_wrapper_read,
+        .content_pos = file_wrapper_content_pos,
+        .content_len = file_wrapper_content_len,
+        .seek = file_wrapper_seek,
+        .close = file_wrapper_close,
+    };
+
+    LoudnessResult result;
+    result.track_id = task.track_id;
+    result.file_size = task.file_size;
+    result.file_mtime = task.file_mtime;
+
+    struct liteplayer_loudness_info info;
+    if (liteplayer_analyze_loudness(task.file_path.c_str(), &file_ops, &info) == 0) {
+        result.success = true;
+        result.loudness_lufs = info.integrated_lufs;
+        result.true_peak_dbtp = info.true_peak_dbtp;
+        result.duration_ms = info.duration_ms;
+        analyzed_++;
+    } else {
+        std::cerr << "[LoudnessAnalyzer] Failed to analyze: " << task.file_path << std::endl;
+        failed_++;
+    }
+    return result;
+}
+
+} // namespace music_player
@@ -7,6 +7,8 @@
 #include <sstream>
 #include <cstring>
 #include <ctime>
+#include <cmath>
+#include <algorithm>
 
 namespace music_player {
 
@@ -28,6 +30,19 @@ static bool columnExists(sqlite3* db, const std::string& table, const std::strin
     return found;
 }
 
+// 从 index 开始绑定 file_size、file_mtime、content_hash，没有指纹时绑定 NULL
+static void bindFingerprint(sqlite3_stmt* stmt, int index, const Track& track) {
+    if (track.content_hash.empty()) {
+        sqlite3_bind_null(stmt, index);
+        sqlite3_bind_null(stmt, index + 1);
+        sqlite3_bind_null(stmt, index + 2);
+        return;
+    }
+    sqlite3_bind_int64(stmt, index, track.file_size);
+    sqlite3_bind_int64(stmt, index + 1, track.file_mtime);
+    sqlite3_bind_text(stmt, index + 2, track.content_hash.c_str(), -1, SQLITE_TRANSIENT);
+}
+
 MusicLibrary::MusicLibrary()
     : db_(nullptr)
     , is_open_(false)
@@ -51,6 +66,13 @@ bool MusicLibrary::open(const std::string& db_path) {
     }
     
     is_open_ = true;
+
+    // 响度分析等后台任务使用独立连接写入，写锁冲突时等待而不是立即失败
+    sqlite3_busy_timeout(db_, 5000);
+
+    // WAL：查询线程和后台任务的读连接不阻塞写入；NORMAL 下提交不再 fsync，只在检查点同步
+    execute("PRAGMA journal_mode=WAL;");
+    execute("PRAGMA synchronous=NORMAL;");
     
     // 初始化表结构
     if (!initializeTables()) {
@@ -74,6 +96,31 @@ bool MusicLibrary::open(const std::string& db_path) {
             if (!columnExists(db_, "tracks", "bad_fail_count")) {
                 execute("ALTER TABLE tracks ADD COLUMN bad_fail_count INTEGER DEFAULT 0;");
             }
+            // 响度均衡：未测量的曲目为 NULL
+            if (!columnExists(db_, "tracks", "loudness_lufs")) {
+                execute("ALTER TABLE tracks ADD COLUMN loudness_lufs REAL;");
+            }
+            if (!columnExists(db_, "tracks", "true_peak_dbtp")) {
+                execute("ALTER TABLE tracks ADD COLUMN true_peak_dbtp REAL;");
+            }
+            // 分析时的文件大小和修改时间，变化后重新分析
+            if (!columnExists(db_, "tracks", "loudness_file_size")) {
+                execute("ALTER TABLE tracks ADD COLUMN loudness_file_size INTEGER;");
+            }
+            if (!columnExists(db_, "tracks", "loudness_file_mtime")) {
+                execute("ALTER TABLE tracks ADD COLUMN loudness_file_mtime INTEGER;");
+            }
+            // 扫描时的文件指纹，未记录为 NULL
+            if (!columnExists(db_, "tracks", "file_size")) {
+                execute("ALTER TABLE tracks ADD COLUMN file_size INTEGER;");
+            }
+            if (!columnExists(db_, "tracks", "file_mtime")) {
+                execute("ALTER TABLE tracks ADD COLUMN file_mtime INTEGER;");
+            }
+            if (!columnExists(db_, "tracks", "content_hash")) {
+                execute("ALTER TABLE tracks ADD COLUMN content_hash TEXT;");
+            }
+            execute("CREATE INDEX IF NOT EXISTS idx_tracks_content_hash ON tracks(content_hash);");
             execute("CREATE INDEX IF NOT EXISTS idx_tracks_bad_flag ON tracks(bad_flag);");
         } catch (...) {
             // 不影响服务启动
@@ -84,10 +131,28 @@ bool MusicLibrary::open(const std::string& db_path) {
     return true;
 }
 
-bool MusicLibrary::markTrackBadByPath(const std::string& file_path, const std::string& reason) {
-    if (!is_open_ || file_path.empty()) return false;
+bool MusicLibrary::openReadOnly(const std::string& db_path) {
+    if (is_open_) {
+        std::cerr << "[MusicLibrary] Database already open" << std::endl;
+        return false;
+    }
+    
+    int rc = sqlite3_open_v2(db_path.c_str(), &db_, SQLITE_OPEN_READONLY, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "[MusicLibrary] Failed to open database read-only: " << sqlite3_errmsg(db_) << std::endl;
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return false;
+    }
+    
+    is_open_ = true;
+    
+    // 主连接写入时等待而不是立即失败
+    sqlite3_busy_timeout(db_, 5000);
+    return true;
+}
 
-    const char* sql = R"(
+static const char* MARK_BAD_SQL = R"(
         UPDATE tracks
         SET bad_flag = 1,
             bad_reason = ?,
@@ -96,8 +161,11 @@ bool MusicLibrary::markTrackBadByPath(const std::string& file_path, const std::s
         WHERE file_path = ?
     )";
 
+bool MusicLibrary::markTrackBadByPath(const std::string& file_path, const std::string& reason) {
+    if (!is_open_ || file_path.empty()) return false;
+
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(MARK_BAD_SQL, &stmt) != SQLITE_OK) {
         return false;
     }
     const auto now = static_cast<sqlite3_int64>(std::time(nullptr));
@@ -106,7 +174,7 @@ bool MusicLibrary::markTrackBadByPath(const std::string& file_path, const std::s
     sqlite3_bind_text(stmt, 3, file_path.c_str(), -1, SQLITE_TRANSIENT);
 
     bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (ok) {
         std::cout << "[MusicLibrary] Marked bad track: " << file_path << " reason=" << reason << std::endl;
     }
@@ -125,12 +193,12 @@ bool MusicLibrary::unmarkTrackBadByPath(const std::string& file_path) {
     )";
 
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return false;
     }
     sqlite3_bind_text(stmt, 1, file_path.c_str(), -1, SQLITE_TRANSIENT);
     bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return ok;
 }
 
@@ -139,7 +207,7 @@ bool MusicLibrary::isTrackBadByPath(const std::string& file_path) {
 
     const char* sql = "SELECT bad_flag FROM tracks WHERE file_path = ?";
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return false;
     }
     sqlite3_bind_text(stmt, 1, file_path.c_str(), -1, SQLITE_TRANSIENT);
@@ -148,7 +216,7 @@ bool MusicLibrary::isTrackBadByPath(const std::string& file_path) {
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         bad = (sqlite3_column_int(stmt, 0) != 0);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return bad;
 }
 
@@ -192,7 +260,7 @@ bool MusicLibrary::upsertTrackEmotion(int64_t track_id,
     )";
 
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return false;
     }
     const auto now = static_cast<sqlite3_int64>(std::time(nullptr));
@@ -206,7 +274,7 @@ bool MusicLibrary::upsertTrackEmotion(int64_t track_id,
     sqlite3_bind_int64(stmt, 7, now);
 
     bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return ok;
 }
 
@@ -229,7 +297,7 @@ int64_t MusicLibrary::pickTrackIdByEmotion(const std::string& mood,
     ss << "ORDER BY e.updated_at DESC LIMIT 1";
 
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, ss.str().c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(ss.str().c_str(), &stmt) != SQLITE_OK) {
         return -1;
     }
     int idx = 1;
@@ -247,7 +315,7 @@ int64_t MusicLibrary::pickTrackIdByEmotion(const std::string& mood,
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         id = sqlite3_column_int64(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return id;
 }
 
@@ -271,7 +339,7 @@ int64_t MusicLibrary::pickRandomTrackByFilter(const std::string& artist,
     ss << " ORDER BY RANDOM() LIMIT 1";
 
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, ss.str().c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(ss.str().c_str(), &stmt) != SQLITE_OK) {
         return -1;
     }
 
@@ -293,7 +361,7 @@ int64_t MusicLibrary::pickRandomTrackByFilter(const std::string& artist,
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         id = sqlite3_column_int64(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return id;
 }
 
@@ -307,12 +375,14 @@ bool MusicLibrary::updateTrack(int64_t id, const Track& track) {
     const char* sql = R"(
         UPDATE tracks 
         SET file_path = ?, title = ?, artist = ?, album = ?, 
-            year = ?, duration_ms = ?, artist_id = ?, album_id = ?
+            year = ?, duration_ms = ?, artist_id = ?, album_id = ?,
+            file_size = COALESCE(?, file_size), file_mtime = COALESCE(?, file_mtime),
+            content_hash = COALESCE(?, content_hash)
         WHERE id = ?
     )";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return false;
     }
 
@@ -324,18 +394,124 @@ bool MusicLibrary::updateTrack(int64_t id, const Track& track) {
     sqlite3_bind_int64(stmt, 6, track.duration_ms);
     sqlite3_bind_int64(stmt, 7, artist_id);
     sqlite3_bind_int64(stmt, 8, album_id);
-    sqlite3_bind_int64(stmt, 9, id);
+    bindFingerprint(stmt, 9, track);
+    sqlite3_bind_int64(stmt, 12, id);
 
     bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     
-    if (success) {
+    if (success && !bulk_import_) {
         std::cout << "[MusicLibrary] Updated track ID: " << id << std::endl;
     }
     
     return success;
 }
 
+bool MusicLibrary::setTrackLoudness(int64_t id, double loudness_lufs) {
+    if (!is_open_) return false;
+
+    const char* sql = "UPDATE tracks SET loudness_lufs = ? WHERE id = ?";
+
+    sqlite3_stmt* stmt;
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
+        return false;
+    }
+
+    sqlite3_bind_double(stmt, 1, loudness_lufs);
+    sqlite3_bind_int64(stmt, 2, id);
+
+    bool success = (sqlite3_step(stmt) == SQLITE_DONE) && sqlite3_changes(db_) > 0;
+    releaseStatement(stmt);
+    return success;
+}
+
+std::vector<LoudnessFingerprint> MusicLibrary::getLoudnessFingerprints() {
+    std::vector<LoudnessFingerprint> fingerprints;
+    if (!is_open_) return fingerprints;
+
+    const char* sql = R"(
+        SELECT id, file_path, COALESCE(loudness_file_size, -1), COALESCE(loudness_file_mtime, -1)
+        FROM tracks
+        WHERE COALESCE(bad_flag, 0) = 0
+        ORDER BY id
+    )";
+
+    sqlite3_stmt* stmt;
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
+        return fingerprints;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        LoudnessFingerprint fp;
+        fp.track_id = sqlite3_column_int64(stmt, 0);
+        const unsigned char* path = sqlite3_column_text(stmt, 1);
+        fp.file_path = path ? reinterpret_cast<const char*>(path) : "";
+        fp.file_size = sqlite3_column_int64(stmt, 2);
+        fp.file_mtime = sqlite3_column_int64(stmt, 3);
+        fingerprints.push_back(fp);
+    }
+
+    releaseStatement(stmt);
+    return fingerprints;
+}
+
+int MusicLibrary::saveLoudnessResults(const std::vector<LoudnessResult>& results) {
+    if (!is_open_) return -1;
+    if (results.empty()) return 0;
+
+    // 失败的曲目响度写 NULL，时长为 0 时保留扫描得到的值
+    const char* sql = R"(
+        UPDATE tracks
+        SET loudness_lufs = ?, true_peak_dbtp = ?,
+            duration_ms = CASE WHEN ? > 0 THEN ? ELSE duration_ms END,
+            loudness_file_size = ?, loudness_file_mtime = ?
+        WHERE id = ?
+    )";
+
+    if (!execute("BEGIN TRANSACTION")) {
+        return -1;
+    }
+
+    sqlite3_stmt* stmt;
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
+        execute("ROLLBACK");
+        return -1;
+    }
+
+    int count = 0;
+    for (const auto& result : results) {
+        if (result.success) {
+            sqlite3_bind_double(stmt, 1, result.loudness_lufs);
+        } else {
+            sqlite3_bind_null(stmt, 1);
+        }
+        // 数字静音的真峰值为 -inf，不写入
+        if (result.success && std::isfinite(result.true_peak_dbtp)) {
+            sqlite3_bind_double(stmt, 2, result.true_peak_dbtp);
+        } else {
+            sqlite3_bind_null(stmt, 2);
+        }
+        sqlite3_bind_int(stmt, 3, result.duration_ms);
+        sqlite3_bind_int(stmt, 4, result.duration_ms);
+        sqlite3_bind_int64(stmt, 5, result.file_size);
+        sqlite3_bind_int64(stmt, 6, result.file_mtime);
+        sqlite3_bind_int64(stmt, 7, result.track_id);
+
+        if (sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(db_) > 0) {
+            count++;
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+
+    releaseStatement(stmt);
+    if (!execute("COMMIT")) {
+        execute("ROLLBACK");
+        return -1;
+    }
+    return count;
+}
+
 bool MusicLibrary::deleteTrack(int64_t id) {
     if (!is_open_) return false;
 
@@ -343,21 +519,21 @@ bool MusicLibrary::deleteTrack(int64_t id) {
     const char* delete_from_playlists = "DELETE FROM playlist_tracks WHERE track_id = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_, delete_from_playlists, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(delete_from_playlists, &stmt) == SQLITE_OK) {
         sqlite3_bind_int64(stmt, 1, id);
         sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     // 删除曲目
     const char* delete_track = "DELETE FROM tracks WHERE id = ?";
-    if (sqlite3_prepare_v2(db_, delete_track, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(delete_track, &stmt) != SQLITE_OK) {
         return false;
     }
 
     sqlite3_bind_int64(stmt, 1, id);
     bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     
     if (success) {
         std::cout << "[MusicLibrary] Deleted track ID: " << id << std::endl;
@@ -367,6 +543,11 @@ bool MusicLibrary::deleteTrack(int64_t id) {
 }
 
 void MusicLibrary::close() {
+    for (auto& item : statements_) {
+        sqlite3_finalize(item.second.stmt);
+    }
+    statements_.clear();
+    endBulkImport();
     if (db_) {
         sqlite3_close(db_);
         db_ = nullptr;
@@ -378,6 +559,23 @@ bool MusicLibrary::isOpen() const {
     return is_open_;
 }
 
+void MusicLibrary::setAutoCheckpoint(int pages) {
+    if (!is_open_) return;
+    sqlite3_wal_autocheckpoint(db_, pages);
+}
+
+bool MusicLibrary::checkpoint() {
+    if (!is_open_) return false;
+    int log_frames = 0;
+    int checkpointed = 0;
+    int rc = sqlite3_wal_checkpoint_v2(db_, nullptr, SQLITE_CHECKPOINT_PASSIVE, &log_frames, &checkpointed);
+    if (rc != SQLITE_OK && rc != SQLITE_BUSY) {
+        std::cerr << "[MusicLibrary] Checkpoint failed: " << sqlite3_errmsg(db_) << std::endl;
+        return false;
+    }
+    return true;
+}
+
 bool MusicLibrary::initializeTables() {
     // 创建艺术家表
     const char* create_artists = R"(
@@ -475,6 +673,87 @@ bool MusicLibrary::execute(const std::string& sql) {
     return true;
 }
 
+int MusicLibrary::prepareStatement(const std::string& sql, sqlite3_stmt** stmt, bool cache) {
+    auto it = cache ? statements_.find(sql) : statements_.end();
+    // 正在使用中（嵌套调用同一条 SQL）时另外编译一份，用完即释放
+    if (it != statements_.end() && !it->second.in_use) {
+        it->second.in_use = true;
+        it->second.last_used = ++statement_clock_;
+        *stmt = it->second.stmt;
+        return SQLITE_OK;
+    }
+
+    int rc = sqlite3_prepare_v3(db_, sql.c_str(), static_cast<int>(sql.size() + 1),
+                                cache ? SQLITE_PREPARE_PERSISTENT : 0, stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        *stmt = nullptr;
+        return rc;
+    }
+    if (!cache || it != statements_.end()) {
+        return rc;
+    }
+
+    if (statements_.size() >= MAX_CACHED_STATEMENTS) {
+        auto oldest = statements_.end();
+        for (auto e = statements_.begin(); e != statements_.end(); ++e) {
+            if (!e->second.in_use && (oldest == statements_.end() || e->second.last_used < oldest->second.last_used)) {
+                oldest = e;
+            }
+        }
+        if (oldest == statements_.end()) {
+            return rc;
+        }
+        sqlite3_finalize(oldest->second.stmt);
+        statements_.erase(oldest);
+    }
+    statements_.emplace(sql, CachedStatement{*stmt, true, ++statement_clock_});
+    return rc;
+}
+
+void MusicLibrary::releaseStatement(sqlite3_stmt* stmt) {
+    if (!stmt) return;
+    auto it = statements_.find(sqlite3_sql(stmt));
+    if (it != statements_.end() && it->second.stmt == stmt) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        it->second.in_use = false;
+    } else {
+        sqlite3_finalize(stmt);
+    }
+}
+
+void MusicLibrary::beginBulkImport() {
+    bulk_import_ = true;
+}
+
+void MusicLibrary::endBulkImport() {
+    bulk_import_ = false;
+    artist_ids_.clear();
+    album_ids_.clear();
+}
+
+// tracks 表插入的列，addTrack 和 addTracks 共用
+static const char* TRACK_INSERT_COLUMNS =
+    "INSERT OR IGNORE INTO tracks (file_path, title, artist, album, year, duration_ms, "
+    "artist_id, album_id, added_date, file_size, file_mtime, content_hash) VALUES ";
+static const char* TRACK_INSERT_ROW = "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+static constexpr int TRACK_INSERT_PARAMS = 12;
+
+// 从 base 开始绑定一行插入参数
+static void bindTrackRow(sqlite3_stmt* stmt, int base, const Track& track,
+                         int64_t artist_id, int64_t album_id, time_t now) {
+    sqlite3_bind_text(stmt, base, track.file_path.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, base + 1, track.title.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, base + 2, track.artist.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, base + 3, track.album.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, base + 4, track.year);
+    sqlite3_bind_int64(stmt, base + 5, track.duration_ms);
+    sqlite3_bind_int64(stmt, base + 6, artist_id);
+    sqlite3_bind_int64(stmt, base + 7, album_id);
+    sqlite3_bind_int64(stmt, base + 8, now);
+    bindFingerprint(stmt, base + 9, track);
+}
+
 int64_t MusicLibrary::addTrack(const Track& track) {
     if (!is_open_) {
         std::cerr << "[MusicLibrary] Database not open" << std::endl;
@@ -485,37 +764,24 @@ int64_t MusicLibrary::addTrack(const Track& track) {
     int64_t artist_id = getOrCreateArtist(track.artist);
     int64_t album_id = getOrCreateAlbum(track.album, track.artist, track.year);
 
-    const char* sql = R"(
-        INSERT OR IGNORE INTO tracks (file_path, title, artist, album, year, duration_ms, 
-                           artist_id, album_id, added_date)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )";
-
     sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    int rc = prepareStatement(std::string(TRACK_INSERT_COLUMNS) + TRACK_INSERT_ROW, &stmt);
     
     if (rc != SQLITE_OK) {
         std::cerr << "[MusicLibrary] Prepare failed: " << sqlite3_errmsg(db_) << std::endl;
         return -1;
     }
 
-    time_t now = std::time(nullptr);
-    sqlite3_bind_text(stmt, 1, track.file_path.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, track.title.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, track.artist.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, track.album.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 5, track.year);
-    sqlite3_bind_int64(stmt, 6, track.duration_ms);
-    sqlite3_bind_int64(stmt, 7, artist_id);
-    sqlite3_bind_int64(stmt, 8, album_id);
-    sqlite3_bind_int64(stmt, 9, now);
+    bindTrackRow(stmt, 1, track, artist_id, album_id, std::time(nullptr));
 
     rc = sqlite3_step(stmt);
     int64_t track_id = -1;
     
     if (rc == SQLITE_DONE) {
         track_id = sqlite3_last_insert_rowid(db_);
-        if (track_id > 0) {
+        if (bulk_import_) {
+            // 批量导入时不逐条打印
+        } else if (track_id > 0) {
             std::cout << "[MusicLibrary] Added track: " << track.title 
                       << " (ID: " << track_id << ")" << std::endl;
         } else {
@@ -526,40 +792,102 @@ int64_t MusicLibrary::addTrack(const Track& track) {
         std::cerr << "[MusicLibrary] Insert failed: " << sqlite3_errmsg(db_) << std::endl;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return track_id;
 }
 
 int MusicLibrary::addTracks(const std::vector<Track>& tracks) {
+    if (!is_open_) return 0;
+
+    // 多行 INSERT，每条语句 INSERT_ROWS 行（参数数不超过旧版 SQLite 的 999 上限），
+    // 整批一个事务；完整的块缓存，最后不足一块的行数每次不同，用完即释放
+    constexpr size_t INSERT_ROWS = 64;
     int count = 0;
-    
-    // 使用事务提高性能
+    time_t now = std::time(nullptr);
+
+    beginBulkImport();
     execute("BEGIN TRANSACTION");
-    
-    for (const auto& track : tracks) {
-        if (addTrack(track) >= 0) {
-            count++;
+
+    for (size_t begin = 0; begin < tracks.size(); begin += INSERT_ROWS) {
+        size_t rows = std::min(INSERT_ROWS, tracks.size() - begin);
+        std::string sql = TRACK_INSERT_COLUMNS;
+        for (size_t i = 0; i < rows; i++) {
+            if (i > 0) sql += ", ";
+            sql += TRACK_INSERT_ROW;
+        }
+        sqlite3_stmt* stmt;
+        if (prepareStatement(sql, &stmt, rows == INSERT_ROWS) != SQLITE_OK) {
+            std::cerr << "[MusicLibrary] Prepare failed: " << sqlite3_errmsg(db_) << std::endl;
+            break;
+        }
+        for (size_t i = 0; i < rows; i++) {
+            const Track& track = tracks[begin + i];
+            bindTrackRow(stmt, static_cast<int>(i) * TRACK_INSERT_PARAMS + 1, track,
+                         getOrCreateArtist(track.artist),
+                         getOrCreateAlbum(track.album, track.artist, track.year), now);
         }
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            count += sqlite3_changes(db_);
+        } else {
+            std::cerr << "[MusicLibrary] Insert failed: " << sqlite3_errmsg(db_) << std::endl;
+        }
+        releaseStatement(stmt);
     }
     
     execute("COMMIT");
+    endBulkImport();
     
     std::cout << "[MusicLibrary] Added " << count << "/" << tracks.size() 
               << " tracks" << std::endl;
     return count;
 }
 
+int MusicLibrary::upsertTracks(std::vector<Track>& tracks) {
+    if (!is_open_) return -1;
+
+    sqlite3_stmt* stmt;
+    if (prepareStatement("SELECT id FROM tracks WHERE file_path = ?", &stmt) != SQLITE_OK) {
+        return -1;
+    }
+
+    // 需要写回每条曲目的ID，逐行执行；语句都已缓存，艺术家和专辑ID在内存中查找
+    int count = 0;
+    beginBulkImport();
+    execute("BEGIN TRANSACTION");
+
+    for (auto& track : tracks) {
+        sqlite3_bind_text(stmt, 1, track.file_path.c_str(), -1, SQLITE_TRANSIENT);
+        int64_t id = (sqlite3_step(stmt) == SQLITE_ROW) ? sqlite3_column_int64(stmt, 0) : -1;
+        sqlite3_reset(stmt);
+
+        if (id > 0) {
+            if (!updateTrack(id, track)) continue;
+        } else {
+            id = addTrack(track);
+            if (id <= 0) continue;
+        }
+        track.id = id;
+        count++;
+    }
+
+    execute("COMMIT");
+    endBulkImport();
+    releaseStatement(stmt);
+    return count;
+}
+
 bool MusicLibrary::getTrack(int64_t id, TrackInfo& track) {
     if (!is_open_) return false;
 
     const char* sql = R"(
         SELECT id, file_path, title, artist, album, year, duration_ms,
-               artist_id, album_id, play_count, last_played, added_date, is_favorite
+               artist_id, album_id, play_count, last_played, added_date, is_favorite,
+               loudness_lufs
         FROM tracks WHERE id = ?
     )";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return false;
     }
 
@@ -580,10 +908,16 @@ bool MusicLibrary::getTrack(int64_t id, TrackInfo& track) {
         track.last_played = sqlite3_column_int64(stmt, 10);
         track.added_date = sqlite3_column_int64(stmt, 11);
         track.is_favorite = sqlite3_column_int(stmt, 12) != 0;
+        track.loudness_lufs.reset();
+        if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) {
+            if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) {
+            track.loudness_lufs = sqlite3_column_double(stmt, 13);
+        }
+        }
         found = true;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return found;
 }
 
@@ -593,20 +927,20 @@ std::vector<TrackInfo> MusicLibrary::getAllTracks(int limit) {
 
         std::string sql = R"(
             SELECT id, file_path, title, artist, album, year, duration_ms,
-                   artist_id, album_id, play_count, last_played, added_date, is_favorite
+                   artist_id, album_id, play_count, last_played, added_date, is_favorite,
+                   loudness_lufs
             FROM tracks
             WHERE COALESCE(bad_flag, 0) = 0
             ORDER BY title
+            LIMIT ?
         )";
-    
-    if (limit > 0) {
-        sql += " LIMIT " + std::to_string(limit);
-    }
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql.c_str(), &stmt) != SQLITE_OK) {
         return tracks;
     }
+    // 负数表示不限
+    sqlite3_bind_int(stmt, 1, limit > 0 ? limit : -1);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         TrackInfo track;
@@ -623,13 +957,129 @@ std::vector<TrackInfo> MusicLibrary::getAllTracks(int limit) {
         track.last_played = sqlite3_column_int64(stmt, 10);
         track.added_date = sqlite3_column_int64(stmt, 11);
         track.is_favorite = sqlite3_column_int(stmt, 12) != 0;
+        if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) {
+            track.loudness_lufs = sqlite3_column_double(stmt, 13);
+        }
         tracks.push_back(track);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return tracks;
 }
 
+int MusicLibrary::deleteTracksByPath(const std::vector<std::string>& paths) {
+    if (!is_open_) return -1;
+
+    // 目录匹配用前缀比较，路径中的 % 和 _ 不需要转义
+    const char* match = "file_path = ?1 OR substr(file_path, 1, length(?1) + 1) = ?1 || '/'";
+    const std::string statements[] = {
+        std::string("DELETE FROM playlist_tracks WHERE track_id IN (SELECT id FROM tracks WHERE ") + match + ")",
+        std::string("DELETE FROM track_emotions WHERE track_id IN (SELECT id FROM tracks WHERE ") + match + ")",
+        std::string("DELETE FROM tracks WHERE ") + match,
+    };
+
+    int count = 0;
+    execute("BEGIN TRANSACTION");
+
+    for (const auto& path : paths) {
+        // track_emotions 按需创建，不存在时 prepare 失败直接跳过
+        for (size_t i = 0; i < 3; i++) {
+            sqlite3_stmt* stmt;
+            if (prepareStatement(statements[i].c_str(), &stmt) != SQLITE_OK) {
+                continue;
+            }
+            sqlite3_bind_text(stmt, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) == SQLITE_DONE && i == 2) {
+                count += sqlite3_changes(db_);
+            }
+            releaseStatement(stmt);
+        }
+    }
+
+    execute("COMMIT");
+
+    if (count > 0) {
+        std::cout << "[MusicLibrary] Deleted " << count << " tracks" << std::endl;
+    }
+    return count;
+}
+
+std::vector<FileFingerprint> MusicLibrary::getFileFingerprints(const std::vector<std::string>& paths) {
+    std::vector<FileFingerprint> fingerprints;
+    if (!is_open_) return fingerprints;
+
+    std::string sql = R"(
+        SELECT id, file_path, COALESCE(file_size, -1), COALESCE(file_mtime, -1), COALESCE(content_hash, '')
+        FROM tracks
+    )";
+    if (!paths.empty()) {
+        sql += " WHERE file_path = ?1 OR substr(file_path, 1, length(?1) + 1) = ?1 || '/'";
+    }
+
+    sqlite3_stmt* stmt;
+    if (prepareStatement(sql.c_str(), &stmt) != SQLITE_OK) {
+        return fingerprints;
+    }
+
+    // 不带路径时执行一次
+    size_t rounds = paths.empty() ? 1 : paths.size();
+    for (size_t i = 0; i < rounds; i++) {
+        if (!paths.empty()) {
+            sqlite3_bind_text(stmt, 1, paths[i].c_str(), -1, SQLITE_TRANSIENT);
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            FileFingerprint fp;
+            fp.track_id = sqlite3_column_int64(stmt, 0);
+            const unsigned char* path = sqlite3_column_text(stmt, 1);
+            fp.file_path = path ? reinterpret_cast<const char*>(path) : "";
+            fp.file_size = sqlite3_column_int64(stmt, 2);
+            fp.file_mtime = sqlite3_column_int64(stmt, 3);
+            fp.content_hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+            fingerprints.push_back(std::move(fp));
+        }
+        sqlite3_reset(stmt);
+    }
+
+    releaseStatement(stmt);
+    return fingerprints;
+}
+
+int MusicLibrary::relinkTracks(const std::vector<FileFingerprint>& moves) {
+    if (!is_open_) return -1;
+    if (moves.empty()) return 0;
+
+    const char* sql = R"(
+        UPDATE tracks
+        SET file_path = ?, file_size = ?, file_mtime = ?, content_hash = ?
+        WHERE id = ?
+    )";
+
+    sqlite3_stmt* stmt;
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
+        return -1;
+    }
+
+    int count = 0;
+    execute("BEGIN TRANSACTION");
+
+    for (const auto& move : moves) {
+        sqlite3_bind_text(stmt, 1, move.file_path.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, move.file_size);
+        sqlite3_bind_int64(stmt, 3, move.file_mtime);
+        sqlite3_bind_text(stmt, 4, move.content_hash.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 5, move.track_id);
+        // 新路径已有曲目时违反 UNIQUE，跳过
+        if (sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(db_) > 0) {
+            count++;
+        }
+        sqlite3_reset(stmt);
+    }
+
+    execute("COMMIT");
+    releaseStatement(stmt);
+    return count;
+}
+
 void MusicLibrary::recordPlay(int64_t track_id) {
     if (!is_open_) return;
 
@@ -640,7 +1090,7 @@ void MusicLibrary::recordPlay(int64_t track_id) {
     )";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return;
     }
 
@@ -649,7 +1099,7 @@ void MusicLibrary::recordPlay(int64_t track_id) {
     sqlite3_bind_int64(stmt, 2, track_id);
 
     sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 bool MusicLibrary::setFavorite(int64_t track_id, bool is_favorite) {
@@ -658,7 +1108,7 @@ bool MusicLibrary::setFavorite(int64_t track_id, bool is_favorite) {
     const char* sql = "UPDATE tracks SET is_favorite = ? WHERE id = ?";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return false;
     }
 
@@ -666,10 +1116,54 @@ bool MusicLibrary::setFavorite(int64_t track_id, bool is_favorite) {
     sqlite3_bind_int64(stmt, 2, track_id);
 
     bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return success;
 }
 
+int MusicLibrary::applyStatistics(const std::vector<StatisticsUpdate>& updates) {
+    if (!is_open_) return -1;
+    if (updates.empty()) return 0;
+
+    sqlite3_stmt* play_stmt;
+    if (prepareStatement("UPDATE tracks SET play_count = play_count + 1, last_played = ? WHERE file_path = ?",
+                         &play_stmt) != SQLITE_OK) {
+        return -1;
+    }
+    sqlite3_stmt* bad_stmt;
+    if (prepareStatement(MARK_BAD_SQL, &bad_stmt) != SQLITE_OK) {
+        releaseStatement(play_stmt);
+        return -1;
+    }
+
+    int count = 0;
+    execute("BEGIN TRANSACTION");
+
+    for (const auto& update : updates) {
+        sqlite3_stmt* stmt = play_stmt;
+        if (update.kind == StatisticsUpdate::Kind::Play) {
+            sqlite3_bind_int64(stmt, 1, update.time);
+            sqlite3_bind_text(stmt, 2, update.file_path.c_str(), -1, SQLITE_TRANSIENT);
+        } else {
+            stmt = bad_stmt;
+            sqlite3_bind_text(stmt, 1, update.reason.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 2, update.time);
+            sqlite3_bind_text(stmt, 3, update.file_path.c_str(), -1, SQLITE_TRANSIENT);
+        }
+        if (sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(db_) > 0) {
+            count++;
+        }
+        sqlite3_reset(stmt);
+    }
+
+    bool committed = execute("COMMIT");
+    if (!committed) {
+        execute("ROLLBACK");
+    }
+    releaseStatement(play_stmt);
+    releaseStatement(bad_stmt);
+    return committed ? count : -1;
+}
+
 std::vector<TrackInfo> MusicLibrary::getFavorites() {
     std::vector<TrackInfo> tracks;
     if (!is_open_) return tracks;
@@ -681,7 +1175,7 @@ std::vector<TrackInfo> MusicLibrary::getFavorites() {
     )";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return tracks;
     }
 
@@ -703,7 +1197,7 @@ std::vector<TrackInfo> MusicLibrary::getFavorites() {
         tracks.push_back(track);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return tracks;
 }
 
@@ -716,12 +1210,14 @@ std::vector<TrackInfo> MusicLibrary::getRecentlyPlayed(int limit) {
                artist_id, album_id, play_count, last_played, added_date, is_favorite
         FROM tracks WHERE last_played > 0 
         ORDER BY last_played DESC
-        LIMIT )" + std::to_string(limit);
+        LIMIT ?
+    )";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql.c_str(), &stmt) != SQLITE_OK) {
         return tracks;
     }
+    sqlite3_bind_int(stmt, 1, limit);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         TrackInfo track;
@@ -741,7 +1237,7 @@ std::vector<TrackInfo> MusicLibrary::getRecentlyPlayed(int limit) {
         tracks.push_back(track);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return tracks;
 }
 
@@ -759,7 +1255,7 @@ MusicLibrary::Stats MusicLibrary::getStats() {
     )";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) != SQLITE_OK) {
         return stats;
     }
 
@@ -771,39 +1267,50 @@ MusicLibrary::Stats MusicLibrary::getStats() {
         stats.total_duration_ms = sqlite3_column_int64(stmt, 4);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return stats;
 }
 
 int64_t MusicLibrary::getOrCreateArtist(const std::string& artist_name) {
     if (artist_name.empty()) return 0;
 
+    if (bulk_import_) {
+        auto it = artist_ids_.find(artist_name);
+        if (it != artist_ids_.end()) return it->second;
+        int64_t id = resolveArtist(artist_name);
+        if (id > 0) artist_ids_.emplace(artist_name, id);
+        return id;
+    }
+    return resolveArtist(artist_name);
+}
+
+int64_t MusicLibrary::resolveArtist(const std::string& artist_name) {
     // 先查找
     const char* select_sql = "SELECT id FROM artists WHERE name = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_, select_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(select_sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, artist_name.c_str(), -1, SQLITE_TRANSIENT);
         
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             int64_t id = sqlite3_column_int64(stmt, 0);
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return id;
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     // 不存在则创建
     const char* insert_sql = "INSERT INTO artists (name) VALUES (?)";
-    if (sqlite3_prepare_v2(db_, insert_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(insert_sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, artist_name.c_str(), -1, SQLITE_TRANSIENT);
         
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             int64_t id = sqlite3_last_insert_rowid(db_);
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return id;
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return 0;
@@ -814,35 +1321,49 @@ int64_t MusicLibrary::getOrCreateAlbum(const std::string& album_name,
                                        int year) {
     if (album_name.empty()) return 0;
 
+    if (bulk_import_) {
+        std::string key = album_name + '\x1f' + artist_name;
+        auto it = album_ids_.find(key);
+        if (it != album_ids_.end()) return it->second;
+        int64_t id = resolveAlbum(album_name, artist_name, year);
+        if (id > 0) album_ids_.emplace(std::move(key), id);
+        return id;
+    }
+    return resolveAlbum(album_name, artist_name, year);
+}
+
+int64_t MusicLibrary::resolveAlbum(const std::string& album_name,
+                                   const std::string& artist_name,
+                                   int year) {
     // 先查找
     const char* select_sql = "SELECT id FROM albums WHERE name = ? AND artist = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_, select_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(select_sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, album_name.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 2, artist_name.c_str(), -1, SQLITE_TRANSIENT);
         
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             int64_t id = sqlite3_column_int64(stmt, 0);
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return id;
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     // 不存在则创建
     const char* insert_sql = "INSERT INTO albums (name, artist, year) VALUES (?, ?, ?)";
-    if (sqlite3_prepare_v2(db_, insert_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(insert_sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, album_name.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 2, artist_name.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_int(stmt, 3, year);
         
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             int64_t id = sqlite3_last_insert_rowid(db_);
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return id;
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return 0;
@@ -889,8 +1410,9 @@ std::vector<TrackInfo> MusicLibrary::searchTracks(const SearchCriteria& criteria
         sql += " LIMIT " + std::to_string(criteria.limit);
     }
 
+    // 条件值拼接在 SQL 中，不缓存
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql.c_str(), &stmt, false) == SQLITE_OK) {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             TrackInfo track;
             track.id = sqlite3_column_int64(stmt, 0);
@@ -909,7 +1431,7 @@ std::vector<TrackInfo> MusicLibrary::searchTracks(const SearchCriteria& criteria
             
             results.push_back(track);
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return results;
@@ -919,16 +1441,14 @@ std::vector<TrackInfo> MusicLibrary::getTracksByArtist(const std::string& artist
     std::vector<TrackInfo> results;
     if (!db_ || artist.empty()) return results;
 
-    std::string sql = "SELECT * FROM tracks WHERE artist LIKE ? ORDER BY year, title";
-    if (limit > 0) {
-        sql += " LIMIT " + std::to_string(limit);
-    }
+    std::string sql = "SELECT * FROM tracks WHERE artist LIKE ? ORDER BY year, title LIMIT ?";
 
     sqlite3_stmt* stmt;
     std::string search_pattern = "%" + artist + "%";
     
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql.c_str(), &stmt) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, search_pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, limit > 0 ? limit : -1);
         
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             TrackInfo track;
@@ -948,7 +1468,7 @@ std::vector<TrackInfo> MusicLibrary::getTracksByArtist(const std::string& artist
             
             results.push_back(track);
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return results;
@@ -958,16 +1478,14 @@ std::vector<TrackInfo> MusicLibrary::getTracksByAlbum(const std::string& album,
     std::vector<TrackInfo> results;
     if (!db_ || album.empty()) return results;
 
-    std::string sql = "SELECT * FROM tracks WHERE album LIKE ? ORDER BY title";
-    if (limit > 0) {
-        sql += " LIMIT " + std::to_string(limit);
-    }
+    std::string sql = "SELECT * FROM tracks WHERE album LIKE ? ORDER BY title LIMIT ?";
 
     sqlite3_stmt* stmt;
     std::string search_pattern = "%" + album + "%";
     
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql.c_str(), &stmt) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, search_pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, limit > 0 ? limit : -1);
         
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             TrackInfo track;
@@ -987,7 +1505,7 @@ std::vector<TrackInfo> MusicLibrary::getTracksByAlbum(const std::string& album,
             
             results.push_back(track);
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return results;
@@ -998,13 +1516,11 @@ std::vector<TrackInfo> MusicLibrary::getMostPlayed(int limit) {
     if (!db_) return results;
 
     std::string sql = "SELECT * FROM tracks WHERE play_count > 0 "
-                     "ORDER BY play_count DESC, last_played DESC";
-    if (limit > 0) {
-        sql += " LIMIT " + std::to_string(limit);
-    }
+                     "ORDER BY play_count DESC, last_played DESC LIMIT ?";
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql.c_str(), &stmt) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, limit > 0 ? limit : -1);
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             TrackInfo track;
             track.id = sqlite3_column_int64(stmt, 0);
@@ -1023,7 +1539,7 @@ std::vector<TrackInfo> MusicLibrary::getMostPlayed(int limit) {
             
             results.push_back(track);
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return results;
@@ -1038,18 +1554,18 @@ int64_t MusicLibrary::createPlaylist(const std::string& name, const std::string&
                      "VALUES (?, ?, ?, 0)";
     
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 2, description.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_int64(stmt, 3, std::time(nullptr));
         
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             int64_t id = sqlite3_last_insert_rowid(db_);
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             std::cout << "[MusicLibrary] Created playlist: " << name << " (ID: " << id << ")" << std::endl;
             return id;
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return -1;
@@ -1062,18 +1578,18 @@ bool MusicLibrary::deletePlaylist(int64_t playlist_id) {
     const char* delete_tracks_sql = "DELETE FROM playlist_tracks WHERE playlist_id = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_, delete_tracks_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(delete_tracks_sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_int64(stmt, 1, playlist_id);
         sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     // 删除播放列表
     const char* delete_playlist_sql = "DELETE FROM playlists WHERE id = ?";
-    if (sqlite3_prepare_v2(db_, delete_playlist_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(delete_playlist_sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_int64(stmt, 1, playlist_id);
         bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return success;
     }
 
@@ -1088,12 +1604,12 @@ bool MusicLibrary::addTrackToPlaylist(int64_t playlist_id, int64_t track_id, int
         const char* count_sql = "SELECT COUNT(*) FROM playlist_tracks WHERE playlist_id = ?";
         sqlite3_stmt* stmt;
         
-        if (sqlite3_prepare_v2(db_, count_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        if (prepareStatement(count_sql, &stmt) == SQLITE_OK) {
             sqlite3_bind_int64(stmt, 1, playlist_id);
             if (sqlite3_step(stmt) == SQLITE_ROW) {
                 position = sqlite3_column_int(stmt, 0);
             }
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
         }
     }
 
@@ -1101,22 +1617,22 @@ bool MusicLibrary::addTrackToPlaylist(int64_t playlist_id, int64_t track_id, int
                      "VALUES (?, ?, ?, ?)";
     
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_int64(stmt, 1, playlist_id);
         sqlite3_bind_int64(stmt, 2, track_id);
         sqlite3_bind_int(stmt, 3, position);
         sqlite3_bind_int64(stmt, 4, std::time(nullptr));
         
         bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
 
         if (success) {
             // 更新播放列表的曲目计数
             const char* update_sql = "UPDATE playlists SET track_count = track_count + 1 WHERE id = ?";
-            if (sqlite3_prepare_v2(db_, update_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            if (prepareStatement(update_sql, &stmt) == SQLITE_OK) {
                 sqlite3_bind_int64(stmt, 1, playlist_id);
                 sqlite3_step(stmt);
-                sqlite3_finalize(stmt);
+                releaseStatement(stmt);
             }
         }
 
@@ -1132,20 +1648,20 @@ bool MusicLibrary::removeTrackFromPlaylist(int64_t playlist_id, int64_t track_id
     const char* sql = "DELETE FROM playlist_tracks WHERE playlist_id = ? AND track_id = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_int64(stmt, 1, playlist_id);
         sqlite3_bind_int64(stmt, 2, track_id);
         
         bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
 
         if (success) {
             // 更新播放列表的曲目计数
             const char* update_sql = "UPDATE playlists SET track_count = track_count - 1 WHERE id = ?";
-            if (sqlite3_prepare_v2(db_, update_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            if (prepareStatement(update_sql, &stmt) == SQLITE_OK) {
                 sqlite3_bind_int64(stmt, 1, playlist_id);
                 sqlite3_step(stmt);
-                sqlite3_finalize(stmt);
+                releaseStatement(stmt);
             }
         }
 
@@ -1165,7 +1681,7 @@ std::vector<TrackInfo> MusicLibrary::getPlaylistTracks(int64_t playlist_id) {
                      "ORDER BY pt.position";
     
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) == SQLITE_OK) {
         sqlite3_bind_int64(stmt, 1, playlist_id);
         
         while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -1186,7 +1702,7 @@ std::vector<TrackInfo> MusicLibrary::getPlaylistTracks(int64_t playlist_id) {
             
             results.push_back(track);
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return results;
@@ -1199,7 +1715,7 @@ std::vector<PlaylistInfo> MusicLibrary::getAllPlaylists() {
     const char* sql = "SELECT * FROM playlists ORDER BY created_date DESC";
     
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (prepareStatement(sql, &stmt) == SQLITE_OK) {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             PlaylistInfo playlist;
             playlist.id = sqlite3_column_int64(stmt, 0);
@@ -1210,7 +1726,7 @@ std::vector<PlaylistInfo> MusicLibrary::getAllPlaylists() {
             
             results.push_back(playlist);
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
     }
 
     return results;
@@ -0,0 +1,125 @@
+// StatisticsWriter.cpp
+// 播放统计写入实现
+
+#include "StatisticsWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+
+namespace music_player {
+
+StatisticsWriter::StatisticsWriter(const std::string& db_path)
+    : db_path_(db_path)
+    , running_(false)
+    , stop_requested_(false)
+{
+}
+
+StatisticsWriter::~StatisticsWriter() {
+    stop();
+}
+
+bool StatisticsWriter::start(const Options& options) {
+    if (running_) {
+        return false;
+    }
+    if (!library_.open(db_path_)) {
+        std::cerr << "[StatisticsWriter] Failed to open library: " << db_path_ << std::endl;
+        return false;
+    }
+
+    options_ = options;
+    stop_requested_ = false;
+    running_ = true;
+    thread_ = std::thread(&StatisticsWriter::run, this);
+    return true;
+}
+
+void StatisticsWriter::stop() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_requested_ = true;
+        }
+        cond_.notify_one();
+        thread_.join();
+    }
+    running_ = false;
+    library_.close();
+}
+
+void StatisticsWriter::recordPlay(const std::string& file_path) {
+    StatisticsUpdate update;
+    update.kind = StatisticsUpdate::Kind::Play;
+    update.file_path = file_path;
+    enqueue(std::move(update));
+}
+
+void StatisticsWriter::markTrackBad(const std::string& file_path, const std::string& reason) {
+    StatisticsUpdate update;
+    update.kind = StatisticsUpdate::Kind::MarkBad;
+    update.file_path = file_path;
+    update.reason = reason;
+    enqueue(std::move(update));
+}
+
+void StatisticsWriter::enqueue(StatisticsUpdate update) {
+    update.time = std::time(nullptr);
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(update));
+        // 第一条唤醒开始计时，积压过多时唤醒提前提交
+        notify = pending_.size() == 1 || pending_.size() >= options_.max_pending;
+    }
+    if (notify) {
+        cond_.notify_one();
+    }
+}
+
+void StatisticsWriter::run() {
+    using Clock = std::chrono::steady_clock;
+    const auto flush_interval = std::chrono::milliseconds(std::max(options_.flush_interval_ms, 0));
+    const auto checkpoint_interval = std::chrono::seconds(options_.checkpoint_interval_s);
+    auto next_checkpoint = Clock::now() + checkpoint_interval;
+
+    std::vector<StatisticsUpdate> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // 等第一条更新；定时检查点时最多等到检查点时间
+        auto has_work = [this] { return stop_requested_ || !pending_.empty(); };
+        if (options_.checkpoint_interval_s > 0) {
+            cond_.wait_until(lock, next_checkpoint, has_work);
+        } else {
+            cond_.wait(lock, has_work);
+        }
+        // 再收集一段时间，合并成一个事务
+        if (!pending_.empty() && !stop_requested_) {
+            cond_.wait_for(lock, flush_interval, [this] {
+                return stop_requested_ || pending_.size() >= options_.max_pending;
+            });
+        }
+        batch.swap(pending_);
+        bool stopping = stop_requested_;
+        lock.unlock();
+
+        if (!batch.empty()) {
+            if (library_.applyStatistics(batch) < 0) {
+                std::cerr << "[StatisticsWriter] Failed to write " << batch.size() << " updates" << std::endl;
+            }
+            batch.clear();
+        }
+        if (stopping) {
+            break;
+        }
+        if (options_.checkpoint_interval_s > 0 && Clock::now() >= next_checkpoint) {
+            library_.checkpoint();
+            next_checkpoint = Clock::now() + checkpoint_interval;
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace music_player
@@ -0,0 +1,556 @@
+// TagReader.cpp
+// 标签读取实现
+
+#include "TagReader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace music_player {
+
+namespace {
+
+// ID3v1 标准流派（0~79），ID3v2 的 "(n)" 和 MP4 的 gnre 也使用这张表
+const char* const ID3_GENRES[] = {
+    "Blues", "Classic Rock", "Country", "Dance", "Disco", "Funk", "Grunge", "Hip-Hop",
+    "Jazz", "Metal", "New Age", "Oldies", "Other", "Pop", "R&B", "Rap",
+    "Reggae", "Rock", "Techno", "Industrial", "Alternative", "Ska", "Death Metal", "Pranks",
+    "Soundtrack", "Euro-Techno", "Ambient", "Trip-Hop", "Vocal", "Jazz+Funk", "Fusion", "Trance",
+    "Classical", "Instrumental", "Acid", "House", "Game", "Sound Clip", "Gospel", "Noise",
+    "AlternRock", "Bass", "Soul", "Punk", "Space", "Meditative", "Instrumental Pop", "Instrumental Rock",
+    "Ethnic", "Gothic", "Darkwave", "Techno-Industrial", "Electronic", "Pop-Folk", "Eurodance", "Dream",
+    "Southern Rock", "Comedy", "Cult", "Gangsta", "Top 40", "Christian Rap", "Pop/Funk", "Jungle",
+    "Native American", "Cabaret", "New Wave", "Psychadelic", "Rave", "Showtunes", "Trailer", "Lo-Fi",
+    "Tribal", "Acid Punk", "Acid Jazz", "Polka", "Retro", "Musical", "Rock & Roll", "Hard Rock",
+};
+constexpr int ID3_GENRE_COUNT = sizeof(ID3_GENRES) / sizeof(ID3_GENRES[0]);
+
+constexpr size_t RIFF_INFO_MAX = 64 * 1024;
+constexpr int RIFF_CHUNKS_MAX = 64;
+
+uint32_t readBE32(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+uint32_t readLE32(const unsigned char* p) {
+    return (uint32_t(p[3]) << 24) | (uint32_t(p[2]) << 16) | (uint32_t(p[1]) << 8) | p[0];
+}
+
+uint32_t readSyncsafe(const unsigned char* p) {
+    return (uint32_t(p[0] & 0x7f) << 21) | (uint32_t(p[1] & 0x7f) << 14) |
+           (uint32_t(p[2] & 0x7f) << 7) | (p[3] & 0x7f);
+}
+
+void appendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += char(cp);
+    } else if (cp < 0x800) {
+        out += char(0xc0 | (cp >> 6));
+        out += char(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        out += char(0xe0 | (cp >> 12));
+        out += char(0x80 | ((cp >> 6) & 0x3f));
+        out += char(0x80 | (cp & 0x3f));
+    } else {
+        out += char(0xf0 | (cp >> 18));
+        out += char(0x80 | ((cp >> 12) & 0x3f));
+        out += char(0x80 | ((cp >> 6) & 0x3f));
+        out += char(0x80 | (cp & 0x3f));
+    }
+}
+
+std::string latin1ToUtf8(const char* data, size_t len) {
+    std::string out;
+    for (size_t i = 0; i < len && data[i] != '\0'; i++) {
+        appendUtf8(out, static_cast<unsigned char>(data[i]));
+    }
+    return out;
+}
+
+// 没有 BOM 时按 big_endian 解码，遇到 U+0000 结束
+std::string utf16ToUtf8(const char* data, size_t len, bool big_endian) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    if (len >= 2) {
+        if (p[0] == 0xfe && p[1] == 0xff) {
+            big_endian = true;
+            i = 2;
+        } else if (p[0] == 0xff && p[1] == 0xfe) {
+            big_endian = false;
+            i = 2;
+        }
+    }
+
+    std::string out;
+    for (; i + 1 < len; i += 2) {
+        uint32_t unit = big_endian ? (uint32_t(p[i]) << 8 | p[i + 1]) : (uint32_t(p[i + 1]) << 8 | p[i]);
+        if (unit == 0) break;
+        if (unit >= 0xd800 && unit < 0xdc00 && i + 3 < len) {
+            uint32_t low = big_endian ? (uint32_t(p[i + 2]) << 8 | p[i + 3]) : (uint32_t(p[i + 3]) << 8 | p[i + 2]);
+            if (low >= 0xdc00 && low < 0xe000) {
+                appendUtf8(out, 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00));
+                i += 2;
+                continue;
+            }
+        }
+        appendUtf8(out, unit);
+    }
+    return out;
+}
+
+bool isValidUtf8(const std::string& s) {
+    size_t i = 0;
+    while (i < s.size()) {
+        unsigned char c = s[i];
+        int extra = c < 0x80 ? 0 : (c >> 5) == 0x06 ? 1 : (c >> 4) == 0x0e ? 2 : (c >> 3) == 0x1e ? 3 : -1;
+        if (extra < 0 || i + extra >= s.size()) return false;
+        for (int k = 1; k <= extra; k++) {
+            if ((static_cast<unsigned char>(s[i + k]) & 0xc0) != 0x80) return false;
+        }
+        i += extra + 1;
+    }
+    return true;
+}
+
+std::string trim(std::string s) {
+    size_t end = s.find('\0');
+    if (end != std::string::npos) s.resize(end);
+    s.erase(s.find_last_not_of(" \t\r\n") + 1);
+    s.erase(0, s.find_first_not_of(" \t\r\n"));
+    return s;
+}
+
+// ID3v2 文本帧：首字节为编码，多值（v2.4 以 NUL 分隔）只取第一个
+std::string decodeId3Text(const char* data, size_t len) {
+    if (len < 1) return "";
+    switch (data[0]) {
+    case 0:  return trim(latin1ToUtf8(data + 1, len - 1));
+    case 1:  return trim(utf16ToUtf8(data + 1, len - 1, false));
+    case 2:  return trim(utf16ToUtf8(data + 1, len - 1, true));
+    case 3:  return trim(std::string(data + 1, len - 1));
+    default: return "";
+    }
+}
+
+std::string genreByIndex(long index) {
+    return (index >= 0 && index < ID3_GENRE_COUNT) ? ID3_GENRES[index] : "";
+}
+
+// "Rock"、"17"、"(17)"、"(17)Rock" 都转换为流派名
+std::string normalizeGenre(const std::string& genre) {
+    if (genre.empty()) return genre;
+    if (genre[0] == '(') {
+        size_t close = genre.find(')');
+        if (close == std::string::npos) return genre;
+        std::string rest = trim(genre.substr(close + 1));
+        if (!rest.empty()) return rest;
+        std::string inner = genre.substr(1, close - 1);
+        if (inner == "RX") return "Remix";
+        if (inner == "CR") return "Cover";
+        return inner.find_first_not_of("0123456789") == std::string::npos && !inner.empty()
+            ? genreByIndex(std::strtol(inner.c_str(), nullptr, 10)) : genre;
+    }
+    if (genre.find_first_not_of("0123456789") == std::string::npos) {
+        return genreByIndex(std::strtol(genre.c_str(), nullptr, 10));
+    }
+    return genre;
+}
+
+int parseYear(const std::string& value) {
+    if (value.size() < 4 ||
+        !std::all_of(value.begin(), value.begin() + 4, [](char c) { return c >= '0' && c <= '9'; })) {
+        return 0;
+    }
+    return std::atoi(value.substr(0, 4).c_str());
+}
+
+void setIfEmpty(std::string& field, const std::string& value) {
+    if (field.empty() && !value.empty()) field = value;
+}
+
+// 去除非同步化（FF 00 -> FF）
+void removeUnsync(std::vector<char>& data) {
+    size_t out = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+        data[out++] = data[i];
+        if (static_cast<unsigned char>(data[i]) == 0xff && i + 1 < data.size() && data[i + 1] == 0) {
+            i++;
+        }
+    }
+    data.resize(out);
+}
+
+// 查找 [start, end) 内第一个指定类型的 atom，返回数据区的偏移和长度
+bool findAtom(MediaFile& file, int64_t start, int64_t end, const char* type,
+              int64_t& body_offset, int64_t& body_size) {
+    int64_t offset = start;
+    while (offset + 8 <= end) {
+        unsigned char header[16];
+        if (file.readAt(offset, reinterpret_cast<char*>(header), 8) != 8) return false;
+        int64_t size = readBE32(header);
+        int header_size = 8;
+        if (size == 1) {
+            if (file.readAt(offset + 8, reinterpret_cast<char*>(header + 8), 8) != 8) return false;
+            size = (int64_t(readBE32(header + 8)) << 32) | readBE32(header + 12);
+            header_size = 16;
+        } else if (size == 0) {
+            size = end - offset;
+        }
+        if (size < header_size || offset + size > end) return false;
+        if (memcmp(header + 4, type, 4) == 0) {
+            body_offset = offset + header_size;
+            body_size = size - header_size;
+            return true;
+        }
+        offset += size;
+    }
+    return false;
+}
+
+} // namespace
+
+// ========== MediaFile ==========
+
+MediaFile::~MediaFile() {
+    close();
+}
+
+bool MediaFile::open(const std::string& path, size_t head_size) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close();
+        return false;
+    }
+    path_ = path;
+    size_ = st.st_size;
+    mtime_ = st.st_mtime;
+
+    head_.resize(std::min<int64_t>(head_size, size_));
+    head_.resize(readFromDisk(0, head_.data(), head_.size()));
+    return true;
+}
+
+void MediaFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    path_.clear();
+    size_ = 0;
+    mtime_ = 0;
+    head_.clear();
+    region_.clear();
+    region_offset_ = 0;
+    disk_reads_ = 0;
+}
+
+int MediaFile::readAt(int64_t offset, char* buf, int len) {
+    if (fd_ < 0 || offset < 0 || len <= 0 || offset >= size_) {
+        return 0;
+    }
+    if (offset + len > size_) {
+        len = static_cast<int>(size_ - offset);
+    }
+    if (offset + len <= static_cast<int64_t>(head_.size())) {
+        memcpy(buf, head_.data() + offset, len);
+        return len;
+    }
+
+    // 文件头之外的小块读取（atom 头、ID3v1、LIST）顺带预读，后续解析多半落在同一区域
+    if (!inRegion(offset, len) && len < static_cast<int>(READ_AHEAD_SIZE)) {
+        cacheRegion(offset, READ_AHEAD_SIZE);
+    }
+    if (inRegion(offset, len)) {
+        memcpy(buf, region_.data() + (offset - region_offset_), len);
+        return len;
+    }
+    return readFromDisk(offset, buf, len);
+}
+
+bool MediaFile::cacheRegion(int64_t offset, size_t len) {
+    if (fd_ < 0 || offset < 0 || offset >= size_) {
+        return false;
+    }
+    len = std::min<int64_t>(len, size_ - offset);
+    if (len > MAX_REGION_SIZE) {
+        return false;
+    }
+    if (offset + static_cast<int64_t>(len) <= static_cast<int64_t>(head_.size()) || inRegion(offset, len)) {
+        return true;
+    }
+
+    std::vector<char> region(len);
+    if (readFromDisk(offset, region.data(), len) != static_cast<int64_t>(len)) {
+        return false;
+    }
+    region_.swap(region);
+    region_offset_ = offset;
+    return true;
+}
+
+bool MediaFile::inRegion(int64_t offset, size_t len) const {
+    return offset >= region_offset_ &&
+           offset + static_cast<int64_t>(len) <= region_offset_ + static_cast<int64_t>(region_.size());
+}
+
+int64_t MediaFile::readFromDisk(int64_t offset, char* buf, size_t len) {
+    disk_reads_++;
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pread(fd_, buf + done, len - done, offset + done);
+        if (n <= 0) break;
+        done += n;
+    }
+    return done;
+}
+
+// ========== TagReader ==========
+
+bool TagReader::read(MediaFile& file, Track& track) {
+    char magic[12] = {0};
+    int n = file.readAt(0, magic, sizeof(magic));
+
+    if (n >= 12 && memcmp(magic, "RIFF", 4) == 0 && memcmp(magic + 8, "WAVE", 4) == 0) {
+        return readRiffInfo(file, track);
+    }
+    if (n >= 8 && memcmp(magic + 4, "ftyp", 4) == 0) {
+        return readMp4(file, track);
+    }
+
+    // MP3/AAC：ID3v2 优先，缺少的字段再看 ID3v1
+    bool found = false;
+    if (n >= 3 && memcmp(magic, "ID3", 3) == 0) {
+        found = readId3v2(file, track);
+    }
+    if (track.title.empty() || track.artist.empty() || track.album.empty()) {
+        found = readId3v1(file, track) || found;
+    }
+    return found;
+}
+
+bool TagReader::readId3v2(MediaFile& file, Track& track) {
+    unsigned char header[10];
+    if (file.readAt(0, reinterpret_cast<char*>(header), 10) != 10) return false;
+    int major = header[3];
+    int flags = header[5];
+    if (major < 2 || major > 4) return false;
+
+    // 只解析文件头中的部分：文本帧通常在前，后面多是封面
+    size_t tag_size = readSyncsafe(header + 6);
+    std::vector<char> tag(std::min(tag_size, file.headSize() > 10 ? file.headSize() - 10 : 0));
+    tag.resize(file.readAt(10, tag.data(), static_cast<int>(tag.size())));
+    if (major < 4 && (flags & 0x80)) {
+        removeUnsync(tag);
+    }
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(tag.data());
+    size_t pos = 0;
+    if (flags & 0x40) {
+        if (tag.size() < 4) return false;
+        pos = (major == 4) ? readSyncsafe(p) : readBE32(p) + 4;
+    }
+
+    const size_t id_len = (major == 2) ? 3 : 4;
+    const size_t header_len = (major == 2) ? 6 : 10;
+    bool found = false;
+    while (pos + header_len <= tag.size() && p[pos] != 0) {
+        std::string id(tag.data() + pos, id_len);
+        size_t frame_size;
+        int format_flags = 0;
+        if (major == 2) {
+            frame_size = (size_t(p[pos + 3]) << 16) | (size_t(p[pos + 4]) << 8) | p[pos + 5];
+        } else if (major == 3) {
+            frame_size = readBE32(p + pos + 4);
+            format_flags = p[pos + 9];
+        } else {
+            frame_size = readSyncsafe(p + pos + 4);
+            format_flags = p[pos + 9];
+        }
+        pos += header_len;
+        if (frame_size > tag.size() - pos) break;
+
+        std::vector<char> body(tag.begin() + pos, tag.begin() + pos + frame_size);
+        pos += frame_size;
+
+        // 压缩、加密的帧跳过；分组标识和数据长度指示在帧数据前面
+        bool skip = false;
+        size_t body_start = 0;
+        if (major == 3) {
+            skip = (format_flags & 0xc0) != 0;
+            if (format_flags & 0x20) body_start += 1;
+        } else if (major == 4) {
+            skip = (format_flags & 0x0c) != 0;
+            if (format_flags & 0x40) body_start += 1;
+            if (format_flags & 0x01) body_start += 4;
+            if ((format_flags & 0x02) || (flags & 0x80)) removeUnsync(body);
+        }
+        if (skip || body_start >= body.size()) continue;
+
+        std::string value = decodeId3Text(body.data() + body_start, body.size() - body_start);
+        if (value.empty()) continue;
+
+        if (id == "TIT2" || id == "TT2") {
+            setIfEmpty(track.title, value);
+        } else if (id == "TPE1" || id == "TP1") {
+            setIfEmpty(track.artist, value);
+        } else if (id == "TALB" || id == "TAL") {
+            setIfEmpty(track.album, value);
+        } else if (id == "TCON" || id == "TCO") {
+            setIfEmpty(track.genre, normalizeGenre(value));
+        } else if (id == "TYER" || id == "TYE" || id == "TDRC" || id == "TDRL") {
+            if (track.year == 0) track.year = parseYear(value);
+        } else {
+            continue;
+        }
+        found = true;
+    }
+    return found;
+}
+
+bool TagReader::readId3v1(MediaFile& file, Track& track) {
+    if (file.size() < 128) return false;
+    char tag[128];
+    if (file.readAt(file.size() - 128, tag, 128) != 128 || memcmp(tag, "TAG", 3) != 0) {
+        return false;
+    }
+
+    setIfEmpty(track.title, trim(latin1ToUtf8(tag + 3, 30)));
+    setIfEmpty(track.artist, trim(latin1ToUtf8(tag + 33, 30)));
+    setIfEmpty(track.album, trim(latin1ToUtf8(tag + 63, 30)));
+    if (track.year == 0) track.year = parseYear(std::string(tag + 93, 4));
+    setIfEmpty(track.genre, genreByIndex(static_cast<unsigned char>(tag[127])));
+    return true;
+}
+
+bool TagReader::readMp4(MediaFile& file, Track& track) {
+    int64_t moov_offset, moov_size;
+    if (!findAtom(file, 0, file.size(), "moov", moov_offset, moov_size)) return false;
+
+    // moov 在文件尾时整体读入缓存，随后解析时长的 m4a_extractor 也从缓存读取
+    file.cacheRegion(moov_offset, moov_size);
+
+    int64_t udta_offset, udta_size, meta_offset, meta_size, ilst_offset, ilst_size;
+    if (!findAtom(file, moov_offset, moov_offset + moov_size, "udta", udta_offset, udta_size) ||
+        !findAtom(file, udta_offset, udta_offset + udta_size, "meta", meta_offset, meta_size)) {
+        return false;
+    }
+    // iTunes 的 meta 是 full box（4 字节 version/flags），QuickTime 的不是
+    char probe[8];
+    if (meta_size >= 8 && file.readAt(meta_offset, probe, 8) == 8 && memcmp(probe + 4, "hdlr", 4) != 0) {
+        meta_offset += 4;
+        meta_size -= 4;
+    }
+    if (!findAtom(file, meta_offset, meta_offset + meta_size, "ilst", ilst_offset, ilst_size)) {
+        return false;
+    }
+
+    bool found = false;
+    int64_t offset = ilst_offset;
+    const int64_t end = ilst_offset + ilst_size;
+    while (offset + 8 <= end) {
+        unsigned char header[8];
+        if (file.readAt(offset, reinterpret_cast<char*>(header), 8) != 8) break;
+        int64_t item_size = readBE32(header);
+        if (item_size < 8 || offset + item_size > end) break;
+        std::string type(reinterpret_cast<char*>(header + 4), 4);
+        int64_t item_offset = offset + 8;
+        offset += item_size;
+
+        std::string* field = nullptr;
+        bool is_year = false, is_genre = false, is_genre_index = false;
+        if (type == "\xa9" "nam") {
+            field = &track.title;
+        } else if (type == "\xa9" "ART") {
+            field = &track.artist;
+        } else if (type == "\xa9" "alb") {
+            field = &track.album;
+        } else if (type == "\xa9" "gen") {
+            field = &track.genre;
+            is_genre = true;
+        } else if (type == "gnre") {
+            is_genre_index = true;
+        } else if (type == "\xa9" "day") {
+            is_year = true;
+        } else {
+            continue;
+        }
+
+        // data atom：4 字节类型、4 字节 locale，之后是值
+        int64_t data_offset, data_size;
+        if (!findAtom(file, item_offset, item_offset + item_size - 8, "data", data_offset, data_size) ||
+            data_size <= 8 || data_size > 4096) {
+            continue;
+        }
+        std::vector<char> data(data_size - 8);
+        if (file.readAt(data_offset + 8, data.data(), static_cast<int>(data.size())) != static_cast<int>(data.size())) {
+            continue;
+        }
+
+        if (is_genre_index) {
+            if (data.size() >= 2) {
+                int index = (static_cast<unsigned char>(data[0]) << 8) | static_cast<unsigned char>(data[1]);
+                setIfEmpty(track.genre, genreByIndex(index - 1));
+            }
+        } else {
+            std::string value = trim(std::string(data.begin(), data.end()));
+            if (is_year) {
+                if (track.year == 0) track.year = parseYear(value);
+            } else {
+                setIfEmpty(*field, is_genre ? normalizeGenre(value) : value);
+            }
+        }
+        found = true;
+    }
+    return found;
+}
+
+bool TagReader::readRiffInfo(MediaFile& file, Track& track) {
+    int64_t offset = 12;
+    for (int i = 0; i < RIFF_CHUNKS_MAX && offset + 8 <= file.size(); i++) {
+        unsigned char header[12];
+        if (file.readAt(offset, reinterpret_cast<char*>(header), 12) < 8) break;
+        int64_t chunk_size = readLE32(header + 4);
+
+        if (memcmp(header, "LIST", 4) == 0 && chunk_size >= 4 && memcmp(header + 8, "INFO", 4) == 0) {
+            std::vector<char> info(std::min<int64_t>(chunk_size - 4, RIFF_INFO_MAX));
+            info.resize(std::max(0, file.readAt(offset + 12, info.data(), static_cast<int>(info.size()))));
+
+            bool found = false;
+            size_t pos = 0;
+            while (pos + 8 <= info.size()) {
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(info.data() + pos);
+                size_t size = readLE32(p + 4);
+                if (size > info.size() - pos - 8) break;
+
+                // INFO 没有规定编码，不是合法 UTF-8 时按 Latin-1 处理
+                std::string value = trim(std::string(info.data() + pos + 8, size));
+                if (!isValidUtf8(value)) value = trim(latin1ToUtf8(info.data() + pos + 8, size));
+                std::string id(info.data() + pos, 4);
+                pos += 8 + size + (size & 1);
+                if (value.empty()) continue;
+
+                if (id == "INAM") setIfEmpty(track.title, value);
+                else if (id == "IART") setIfEmpty(track.artist, value);
+                else if (id == "IPRD") setIfEmpty(track.album, value);
+                else if (id == "IGNR") setIfEmpty(track.genre, normalizeGenre(value));
+                else if (id == "ICRD") { if (track.year == 0) track.year = parseYear(value); }
+                else continue;
+                found = true;
+            }
+            return found;
+        }
+        offset += 8 + chunk_size + (chunk_size & 1);
+    }
+    return false;
+}
+
+} // namespace music_player
@@ -100,10 +100,12 @@ bool ConfigLoader::parseConfig(const std::string& content) {
     // 设置默认值
     config_.zmq.command_endpoint = "ipc:///tmp/music_player_cmd.sock";
     config_.zmq.event_endpoint = "ipc:///tmp/music_player_event.sock";
+    config_.zmq.query_workers = 2;
     
     config_.database.path = "data/music_library.db";  // 默认使用相对路径
     config_.database.test_path = "/tmp/test_music.db";
     config_.database.backup_dir = "data/backups";
+    config_.database.index_cache_dir = "data/index_cache";
     config_.database.auto_backup_enabled = true;
     config_.database.backup_interval_days = 7;
     config_.database.max_backups = 5;
@@ -113,6 +115,25 @@ bool ConfigLoader::parseConfig(const std::string& content) {
     config_.player.audio_output.buffer_size = 4096;
     config_.player.progress_update_interval = 1000;
     config_.player.preload_next_track = true;
+    config_.player.crossfade_ms = 0;
+    config_.player.crossfade_curve = "equal_power";
+
+    config_.loudness.enabled = true;
+    config_.loudness.threads = 0;
+    config_.loudness.batch_size = 32;
+    
+    config_.scanner.threads = 0;
+    config_.scanner.batch_size = 500;
+    
+    config_.auto_scan.enabled = true;
+    config_.auto_scan.interval_seconds = 3600;
+    config_.auto_scan.watch_directories = true;
+    config_.auto_scan.fallback_poll_seconds = 30;
+    config_.auto_scan.debounce_ms = 2000;
+    
+    config_.statistics.write_behind = true;
+    config_.statistics.flush_interval_ms = 2000;
+    config_.statistics.checkpoint_interval_s = 60;
     
     config_.service.name = "music-player";
     config_.service.pid_file = "/var/run/music-player.pid";
@@ -204,15 +225,56 @@ bool ConfigLoader::parseConfig(const std::string& content) {
                 in_scan_directories = false;
                 in_supported_formats = false;
                 
+                // 同级的键值对结束上一个子节（如 player.audio_output 之后的 player.progress_update_interval）
+                if (indent == 2) {
+                    current_subsection = "";
+                }
+                
                 // 特殊处理database.path
                 if (current_section == "library" && current_subsection == "database" && key == "path") {
                     config_.database.path = resolvePath(value);
                     std::cout << "[ConfigLoader] Database path: " << value << " -> " 
                               << config_.database.path << std::endl;
                 }
+                else if (current_section == "library" && current_subsection == "database" && key == "index_cache_dir") {
+                    config_.database.index_cache_dir = resolvePath(value);
+                }
+                else if (current_section == "library" && current_subsection == "loudness_analysis") {
+                    if (key == "enabled") config_.loudness.enabled = (value == "true");
+                    else if (key == "threads") config_.loudness.threads = std::atoi(value.c_str());
+                    else if (key == "batch_size") config_.loudness.batch_size = std::atoi(value.c_str());
+                }
+                else if (current_section == "library" && current_subsection == "scanner") {
+                    if (key == "threads") config_.scanner.threads = std::atoi(value.c_str());
+                    else if (key == "batch_size") config_.scanner.batch_size = std::atoi(value.c_str());
+                }
+                else if (current_section == "library" && current_subsection == "auto_scan") {
+                    if (key == "enabled") config_.auto_scan.enabled = (value == "true");
+                    else if (key == "interval_seconds") config_.auto_scan.interval_seconds = std::atoi(value.c_str());
+                    else if (key == "watch_directories") config_.auto_scan.watch_directories = (value == "true");
+                    else if (key == "fallback_poll_seconds") config_.auto_scan.fallback_poll_seconds = std::atoi(value.c_str());
+                    else if (key == "debounce_ms") config_.auto_scan.debounce_ms = std::atoi(value.c_str());
+                }
+                else if (current_section == "library" && current_subsection == "statistics") {
+                    if (key == "write_behind") config_.statistics.write_behind = (value == "true");
+                    else if (key == "flush_interval_ms") config_.statistics.flush_interval_ms = std::atoi(value.c_str());
+                    else if (key == "checkpoint_interval_s") config_.statistics.checkpoint_interval_s = std::atoi(value.c_str());
+                }
                 else if (current_section == "zmq") {
                     if (key == "command_endpoint") config_.zmq.command_endpoint = value;
                     else if (key == "event_endpoint") config_.zmq.event_endpoint = value;
+                    else if (key == "query_workers") config_.zmq.query_workers = std::atoi(value.c_str());
+                }
+                else if (current_section == "player") {
+                    if (current_subsection == "audio_output") {
+                        if (key == "device") config_.player.audio_output.device = value;
+                        else if (key == "buffer_size") config_.player.audio_output.buffer_size = std::atoi(value.c_str());
+                    }
+                    else if (key == "default_play_mode") config_.player.default_play_mode = value;
+                    else if (key == "progress_update_interval") config_.player.progress_update_interval = std::atoi(value.c_str());
+                    else if (key == "preload_next_track") config_.player.preload_next_track = (value == "true");
+                    else if (key == "crossfade_ms") config_.player.crossfade_ms = std::atoi(value.c_str());
+                    else if (key == "crossfade_curve") config_.player.crossfade_curve = value;
                 }
             }
         }
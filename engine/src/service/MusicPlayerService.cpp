@@ -9,9 +9,24 @@
 #include <ctime>
 #include <mutex>
 #include <queue>
+#include <algorithm>
 
 namespace music_player {
 
+namespace {
+
+const char* const WAKEUP_ENDPOINT = "inproc://music_player_wakeup";
+
+const char* playStateName(PlayState state) {
+    switch (state) {
+        case PlayState::Playing: return "playing";
+        case PlayState::Paused:  return "paused";
+        default:                 return "stopped";
+    }
+}
+
+} // namespace
+
 MusicPlayerService::MusicPlayerService()
     : running_(false)
     , should_stop_(false)
@@ -35,14 +50,21 @@ bool MusicPlayerService::initialize(const std::string& config_file) {
     try {
         zmq_context_ = std::make_unique<zmq::context_t>(1);
         
-        // 命令socket (REP)
-        cmd_socket_ = std::make_unique<zmq::socket_t>(*zmq_context_, zmq::socket_type::rep);
+        // 命令socket (ROUTER)：兼容 REQ 客户端，应答可以不按到达顺序发出
+        cmd_socket_ = std::make_unique<zmq::socket_t>(*zmq_context_, zmq::socket_type::router);
         cmd_socket_->bind(config_.zmq.command_endpoint);
         
         // 事件socket (PUB)
         event_socket_ = std::make_unique<zmq::socket_t>(*zmq_context_, zmq::socket_type::pub);
         event_socket_->bind(config_.zmq.event_endpoint);
         
+        // 唤醒通道：inproc 要求先 bind 再 connect
+        wake_recv_ = std::make_unique<zmq::socket_t>(*zmq_context_, zmq::socket_type::pair);
+        wake_recv_->bind(WAKEUP_ENDPOINT);
+        wake_send_ = std::make_unique<zmq::socket_t>(*zmq_context_, zmq::socket_type::pair);
+        wake_send_->set(zmq::sockopt::linger, 0);
+        wake_send_->connect(WAKEUP_ENDPOINT);
+        
         std::cout << "[MusicPlayerService] ZMQ initialized" << std::endl;
         std::cout << "  Command endpoint: " << config_.zmq.command_endpoint << std::endl;
         std::cout << "  Event endpoint: " << config_.zmq.event_endpoint << std::endl;
@@ -58,8 +80,17 @@ bool MusicPlayerService::initialize(const std::string& config_file) {
         return false;
     }
     
+    // 播放统计和坏轨标记交给后台线程按批写入，命令线程不等待 fsync
+    if (config_.statistics.write_behind) {
+        startStatisticsWriter();
+    }
+    
     // 初始化播放控制器
     controller_ = std::make_unique<PlaybackController>();
+    controller_->setPreloadNextTrack(config_.player.preload_next_track);
+    controller_->setIndexCacheDir(config_.database.index_cache_dir);
+    controller_->setCrossfade(config_.player.crossfade_ms,
+        config_.player.crossfade_curve == "linear" ? CrossfadeCurve::Linear : CrossfadeCurve::EqualPower);
     if (!controller_->initialize()) {
         std::cerr << "[MusicPlayerService] Failed to initialize playback controller" << std::endl;
         return false;
@@ -68,16 +99,22 @@ bool MusicPlayerService::initialize(const std::string& config_file) {
     // 将 PlaybackController 的事件回调桥接到服务线程：
     // 禁止在 liteplayer 的回调线程内直接执行 next()/reset/load 等重操作。
     controller_->setEventCallback([this](PlayerEvent event, const std::string& info) {
-        // 轻量级：只入队，真正处理在 commandLoop 线程里完成。
+        // 轻量级：只入队并唤醒，真正处理在 commandLoop 线程里完成。
         {
             std::lock_guard<std::mutex> lk(event_queue_mutex_);
             pending_events_.emplace(event, info);
         }
+        wakeCommandLoop();
     });
     
     // 首次启动时扫描配置目录中的音乐
     std::cout << "[MusicPlayerService] Scanning music directories..." << std::endl;
     scanMusicDirectories();
+
+    // 后台分析新增或变化曲目的响度，不阻塞服务启动
+    if (config_.loudness.enabled) {
+        startLoudnessAnalysis();
+    }
     
     // 从数据库加载曲目到播放列表（通过临时目录）
     if (!syncDatabaseTracksToPlaylist()) {
@@ -85,6 +122,11 @@ bool MusicPlayerService::initialize(const std::string& config_file) {
         // 不是致命错误，继续运行
     }
     
+    // 之后的目录变化由监控线程增量写入，不再依赖重启时的全量扫描
+    if (config_.auto_scan.enabled) {
+        startLibraryWatcher();
+    }
+    
     std::cout << "[MusicPlayerService] Service initialized successfully" << std::endl;
     return true;
 }
@@ -98,11 +140,11 @@ bool MusicPlayerService::start() {
     should_stop_ = false;
     running_ = true;
     
-    // 启动命令处理线程
-    cmd_thread_ = std::thread(&MusicPlayerService::commandLoop, this);
+    // 只读查询工作线程
+    startQueryWorkers();
     
-    // 启动事件发布线程
-    event_thread_ = std::thread(&MusicPlayerService::eventLoop, this);
+    // 启动服务主循环（命令、事件发布都在此线程）
+    cmd_thread_ = std::thread(&MusicPlayerService::commandLoop, this);
     
     std::cout << "[MusicPlayerService] Service started" << std::endl;
     return true;
@@ -121,11 +163,25 @@ void MusicPlayerService::stop() {
     running_ = false;
     
     // 等待线程结束
+    wakeCommandLoop();
     if (cmd_thread_.joinable()) {
         cmd_thread_.join();
     }
-    if (event_thread_.joinable()) {
-        event_thread_.join();
+    stopQueryWorkers();
+    
+    // 命令线程已退出，队列中剩余的播放统计在关闭前写入
+    if (statistics_writer_) {
+        statistics_writer_->stop();
+    }
+    
+    // 停止目录监控，已合并的变化在退出前写入数据库
+    if (library_watcher_) {
+        library_watcher_->stop();
+    }
+    
+    // 停止响度分析，已完成的批次已写入数据库
+    if (loudness_analyzer_) {
+        loudness_analyzer_->stop();
     }
     
     // 关闭库
@@ -139,39 +195,59 @@ void MusicPlayerService::stop() {
 void MusicPlayerService::commandLoop() {
     std::cout << "[MusicPlayerService] Command loop started" << std::endl;
     
+    using Clock = std::chrono::steady_clock;
+    const int progress_ms = config_.player.progress_update_interval;
+    const auto heartbeat_interval = std::chrono::milliseconds(HEARTBEAT_INTERVAL_MS);
+    const auto progress_interval = std::chrono::milliseconds(std::max(progress_ms, 1));
+    auto next_heartbeat = Clock::now() + heartbeat_interval;
+    auto next_progress = Clock::now() + progress_interval;
+    
+    zmq::pollitem_t items[] = {
+        { cmd_socket_->handle(), 0, ZMQ_POLLIN, 0 },
+        { wake_recv_->handle(), 0, ZMQ_POLLIN, 0 },
+    };
+    
     while (!should_stop_) {
         try {
-            // 处理从 PlaybackController 回调线程转发来的事件
-            processPendingControllerEvents();
-
-            zmq::message_t request;
-            
-            // 接收命令（带超时）
-            auto result = cmd_socket_->recv(request, zmq::recv_flags::dontwait);
+            // 空闲时阻塞到下一个定时点，命令和唤醒都会让 poll 立即返回
+            auto deadline = next_heartbeat;
+            if (progress_ms > 0) {
+                deadline = std::min(deadline, next_progress);
+            }
+            auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            zmq::poll(items, 2, std::max(timeout, std::chrono::milliseconds(0)));
             
-            if (!result) {
-                // 空闲时也处理一次事件队列，避免事件堆积
+            if (items[1].revents & ZMQ_POLLIN) {
+                // 多次唤醒合并为一次处理
+                zmq::message_t token;
+                while (wake_recv_->recv(token, zmq::recv_flags::dontwait)) {
+                }
+                sendQueryReplies();
                 processPendingControllerEvents();
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                continue;
+                applyLibraryChanges();
+                publishProgress();
             }
             
-            // 解析命令
-            std::string request_str(static_cast<char*>(request.data()), request.size());
-            CommandRequest cmd = CommandRequest::fromJson(request_str);
-            
-            std::cout << "[MusicPlayerService] Received command: " << cmd.command << std::endl;
-            
-            // 处理命令
-            CommandResponse response = handleCommand(cmd);
+            if (items[0].revents & ZMQ_POLLIN) {
+                handleCommandMessage();
+                publishProgress();
+            }
             
-            // 发送响应
-            std::string response_str = response.toJson();
-            std::cout << "[MusicPlayerService] Sending response for: " << cmd.command << std::endl;
-            zmq::message_t reply(response_str.size());
-            memcpy(reply.data(), response_str.c_str(), response_str.size());
-            cmd_socket_->send(reply, zmq::send_flags::none);
-            std::cout << "[MusicPlayerService] Response sent" << std::endl;
+            auto now = Clock::now();
+            if (progress_ms > 0 && now >= next_progress) {
+                publishProgress();
+                // 保持固定节拍，落后太多时（如处理耗时命令）从当前时间重新计时
+                next_progress += progress_interval;
+                if (next_progress <= now) {
+                    next_progress = now + progress_interval;
+                }
+            }
+            if (now >= next_heartbeat) {
+                json data;
+                data["status"] = "alive";
+                publishEvent("heartbeat", data);
+                next_heartbeat = now + heartbeat_interval;
+            }
             
         } catch (const std::exception& e) {
             std::cerr << "[MusicPlayerService] Command loop error: " << e.what() << std::endl;
@@ -183,6 +259,221 @@ void MusicPlayerService::commandLoop() {
     std::cout << "[MusicPlayerService] Command loop stopped" << std::endl;
 }
 
+void MusicPlayerService::wakeCommandLoop() {
+    std::lock_guard<std::mutex> lk(wake_mutex_);
+    if (!wake_send_) return;
+    try {
+        // 已有未读的唤醒时发送可能失败，commandLoop 反正会醒来，忽略即可
+        zmq::message_t token;
+        wake_send_->send(token, zmq::send_flags::dontwait);
+    } catch (const zmq::error_t& e) {
+        std::cerr << "[MusicPlayerService] Failed to wake command loop: " << e.what() << std::endl;
+    }
+}
+
+void MusicPlayerService::handleCommandMessage() {
+    // ROUTER 消息：[客户端标识, (REQ 的空分隔帧), 请求]，除最后一帧外原样用于应答
+    std::vector<std::string> envelope;
+    zmq::message_t frame;
+    bool more = true;
+    while (more) {
+        if (!cmd_socket_->recv(frame, zmq::recv_flags::dontwait)) {
+            return;
+        }
+        more = frame.more();
+        if (more) {
+            envelope.emplace_back(static_cast<char*>(frame.data()), frame.size());
+        }
+    }
+    if (envelope.empty()) {
+        return;
+    }
+    
+    // 解析命令
+    std::string request_str(static_cast<char*>(frame.data()), frame.size());
+    CommandRequest cmd = CommandRequest::fromJson(request_str);
+    
+    std::cout << "[MusicPlayerService] Received command: " << cmd.command << std::endl;
+    
+    // 只读查询不占用命令线程，播放控制命令不会排在慢查询之后
+    if (!query_workers_.empty() && isQueryCommand(cmd.command)) {
+        std::unique_lock<std::mutex> lk(query_mutex_);
+        if (query_jobs_.size() < MAX_PENDING_QUERIES) {
+            query_jobs_.push_back({std::move(envelope), std::move(cmd)});
+            lk.unlock();
+            query_cv_.notify_one();
+            return;
+        }
+        lk.unlock();
+        sendReply(envelope, CommandResponse::error("Too many pending queries", cmd.request_id).toJson());
+        return;
+    }
+    
+    // 处理命令
+    CommandResponse response = isQueryCommand(cmd.command) ? handleQuery(cmd, *library_) : handleCommand(cmd);
+    
+    // 发送响应
+    std::cout << "[MusicPlayerService] Sending response for: " << cmd.command << std::endl;
+    sendReply(envelope, response.toJson());
+    std::cout << "[MusicPlayerService] Response sent" << std::endl;
+}
+
+void MusicPlayerService::sendReply(const std::vector<std::string>& envelope, const std::string& response) {
+    for (const auto& part : envelope) {
+        zmq::message_t message(part.size());
+        memcpy(message.data(), part.data(), part.size());
+        cmd_socket_->send(message, zmq::send_flags::sndmore);
+    }
+    zmq::message_t reply(response.size());
+    memcpy(reply.data(), response.c_str(), response.size());
+    cmd_socket_->send(reply, zmq::send_flags::none);
+}
+
+void MusicPlayerService::startQueryWorkers() {
+    {
+        std::lock_guard<std::mutex> lk(query_mutex_);
+        query_stop_ = false;
+    }
+    for (int i = 0; i < config_.zmq.query_workers; i++) {
+        query_workers_.emplace_back(&MusicPlayerService::queryWorkerLoop, this);
+    }
+    if (!query_workers_.empty()) {
+        std::cout << "[MusicPlayerService] Query workers: " << query_workers_.size() << std::endl;
+    }
+}
+
+void MusicPlayerService::stopQueryWorkers() {
+    {
+        std::lock_guard<std::mutex> lk(query_mutex_);
+        query_stop_ = true;
+    }
+    query_cv_.notify_all();
+    for (auto& worker : query_workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    query_workers_.clear();
+    
+    // 命令线程已退出，未执行和未发送的查询直接丢弃，客户端按超时处理
+    std::lock_guard<std::mutex> lk(query_mutex_);
+    query_jobs_.clear();
+}
+
+void MusicPlayerService::queryWorkerLoop() {
+    // 每个工作线程一个只读连接，SQLite 连接不跨线程共享
+    MusicLibrary library;
+    if (!library.openReadOnly(config_.database.path)) {
+        std::cerr << "[MusicPlayerService] Query worker failed to open library" << std::endl;
+    }
+    
+    while (true) {
+        QueryJob job;
+        {
+            std::unique_lock<std::mutex> lk(query_mutex_);
+            query_cv_.wait(lk, [this] { return query_stop_ || !query_jobs_.empty(); });
+            if (query_stop_) {
+                break;
+            }
+            job = std::move(query_jobs_.front());
+            query_jobs_.pop_front();
+        }
+        
+        CommandResponse response = library.isOpen()
+            ? handleQuery(job.request, library)
+            : CommandResponse::error("Library not open", job.request.request_id);
+        
+        {
+            std::lock_guard<std::mutex> lk(query_reply_mutex_);
+            query_replies_.push({std::move(job.envelope), response.toJson()});
+        }
+        wakeCommandLoop();
+    }
+    
+    library.close();
+}
+
+void MusicPlayerService::sendQueryReplies() {
+    std::queue<QueryReply> local;
+    {
+        std::lock_guard<std::mutex> lk(query_reply_mutex_);
+        std::swap(local, query_replies_);
+    }
+    while (!local.empty()) {
+        sendReply(local.front().envelope, local.front().response);
+        local.pop();
+    }
+}
+
+void MusicPlayerService::publishProgress() {
+    if (!controller_) return;
+    
+    PlayState state = controller_->getState();
+    size_t index = controller_->getCurrentTrackIndex();
+    int position = controller_->getPosition();
+    int duration = controller_->getDuration();
+    
+    // 暂停/停止时位置不变，不重复发送；播放中每个周期都有新位置
+    if (state == last_progress_state_ && index == last_progress_index_ &&
+        position == last_progress_position_ && duration == last_progress_duration_) {
+        return;
+    }
+    last_progress_state_ = state;
+    last_progress_index_ = index;
+    last_progress_position_ = position;
+    last_progress_duration_ = duration;
+    
+    json data;
+    data["state"] = playStateName(state);
+    data["current_track_id"] = index;
+    data["position_ms"] = position;
+    data["duration_ms"] = duration;
+    publishEvent("progress", data);
+}
+
+void MusicPlayerService::applyLibraryChanges() {
+    std::vector<LibraryWatcher::Changes> local;
+    {
+        std::lock_guard<std::mutex> lk(library_changes_mutex_);
+        if (pending_library_changes_.empty()) return;
+        local.swap(pending_library_changes_);
+    }
+    if (!controller_) return;
+
+    size_t added = 0;
+    size_t updated = 0;
+    size_t removed = 0;
+    for (const auto& changes : local) {
+        for (const auto& path : changes.removed) {
+            removed += controller_->removeTracks(path);
+        }
+        for (const auto& track : changes.updated) {
+            if (controller_->updateTrack(track)) {
+                updated++;
+            } else {
+                controller_->addTrack(track);
+                added++;
+            }
+        }
+    }
+
+    std::cout << "[MusicPlayerService] Library changed: " << added << " added, " << updated
+              << " updated, " << removed << " removed from playlist" << std::endl;
+
+    json data;
+    data["added"] = added;
+    data["updated"] = updated;
+    data["removed"] = removed;
+    data["total"] = controller_->getPlaylistSize();
+    publishEvent("library_changed", data);
+
+    // 新增或重写的文件需要重新分析响度
+    if (config_.loudness.enabled && added + updated > 0 &&
+        (!loudness_analyzer_ || !loudness_analyzer_->isRunning())) {
+        startLoudnessAnalysis();
+    }
+}
+
 void MusicPlayerService::processPendingControllerEvents() {
     std::queue<std::pair<PlayerEvent, std::string>> local;
     {
@@ -210,6 +501,20 @@ void MusicPlayerService::processPendingControllerEvents() {
         };
 
         switch (ev) {
+            case PlayerEvent::TrackStarted: {
+                // 播放列表中的曲目按路径对应数据库记录
+                const std::string path = controller_->getCurrentTrack().file_path;
+                if (path.empty()) break;
+                if (statistics_writer_ && statistics_writer_->isRunning()) {
+                    statistics_writer_->recordPlay(path);
+                } else if (library_ && library_->isOpen()) {
+                    StatisticsUpdate update;
+                    update.file_path = path;
+                    update.time = std::time(nullptr);
+                    library_->applyStatistics({update});
+                }
+                break;
+            }
             case PlayerEvent::TrackEnded: {
                 std::cout << "[MusicPlayerService] Controller event: TrackEnded (" << info << ")" << std::endl;
                 // 在 commandLoop 线程中执行 next()，避免在 liteplayer 回调线程里做重操作
@@ -229,7 +534,13 @@ void MusicPlayerService::processPendingControllerEvents() {
                         std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
                         const bool looksAudio = (ext == ".wav" || ext == ".mp3" || ext == ".m4a" || ext == ".aac");
                         if (looksAudio && fs::exists(p)) {
-                            markedBad = library_->markTrackBadByPath(info, "liteplayer_load_or_start_failed");
+                            if (statistics_writer_ && statistics_writer_->isRunning()) {
+                                // 数据库稍后才写入，直接从内存播放列表移除，不从数据库重新同步
+                                statistics_writer_->markTrackBad(info, "liteplayer_load_or_start_failed");
+                                controller_->removeTracks(info);
+                            } else {
+                                markedBad = library_->markTrackBadByPath(info, "liteplayer_load_or_start_failed");
+                            }
                         } else {
                             std::cerr << "[MusicPlayerService] Skip mark bad track: info is not a valid audio path" << std::endl;
                         }
@@ -252,23 +563,6 @@ void MusicPlayerService::processPendingControllerEvents() {
     }
 }
 
-void MusicPlayerService::eventLoop() {
-    std::cout << "[MusicPlayerService] Event loop started" << std::endl;
-    
-    while (!should_stop_) {
-        // 简单的心跳事件
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-        
-        if (!should_stop_) {
-            json data;
-            data["status"] = "alive";
-            publishEvent("heartbeat", data);
-        }
-    }
-    
-    std::cout << "[MusicPlayerService] Event loop stopped" << std::endl;
-}
-
 CommandResponse MusicPlayerService::handleCommand(const CommandRequest& request) {
     try {
         if (request.command == "play") {
@@ -283,14 +577,42 @@ CommandResponse MusicPlayerService::handleCommand(const CommandRequest& request)
             return handlePrevious(request.params);
         } else if (request.command == "get_status") {
             return handleGetStatus(request.params);
-        } else if (request.command == "get_track") {
-            return handleGetTrack(request.params);
-        } else if (request.command == "search_tracks") {
-            return handleSearchTracks(request.params);
+        } else if (request.command == "get_metrics") {
+            return handleGetMetrics(request.params);
         } else if (request.command == "add_track") {
             return handleAddTrack(request.params);
-        } else if (request.command == "get_all_tracks") {
-            return handleGetAllTracks(request.params);
+        } else if (request.command == "analyze_loudness") {
+            return handleAnalyzeLoudness(request.params);
+        } else if (request.command == "set_volume") {
+            // params: {volume: 0-100}，软件音量，替代外部 amixer
+            int volume = request.params.value("volume", -1);
+            if (volume < 0 || volume > 100) {
+                return CommandResponse::error("volume must be within 0-100", request.request_id);
+            }
+            if (!controller_->setVolume(volume / 100.0f)) {
+                return CommandResponse::error("Failed to set volume", request.request_id);
+            }
+            json result;
+            result["volume"] = volume;
+            return CommandResponse::success(result, request.request_id);
+        } else if (request.command == "set_crossfade") {
+            // params: {duration_ms: 0-12000, curve: "equal_power"|"linear"}
+            int duration = request.params.value("duration_ms", -1);
+            std::string curve = request.params.value("curve", std::string("equal_power"));
+            if (duration < 0 || duration > 12000) {
+                return CommandResponse::error("duration_ms must be within 0-12000", request.request_id);
+            }
+            if (curve != "equal_power" && curve != "linear") {
+                return CommandResponse::error("curve must be equal_power or linear", request.request_id);
+            }
+            if (!controller_->setCrossfade(duration,
+                    curve == "linear" ? CrossfadeCurve::Linear : CrossfadeCurve::EqualPower)) {
+                return CommandResponse::error("Crossfade is not enabled in config", request.request_id);
+            }
+            json result;
+            result["duration_ms"] = duration;
+            result["curve"] = curve;
+            return CommandResponse::success(result, request.request_id);
         } else if (request.command == "tag_track_emotion") {
             // 最小实现：写入 track_emotions（供 Python/服务端共用）
             // params: {track_id, mood, valence, arousal, energy, tags[]}
@@ -512,6 +834,33 @@ CommandResponse MusicPlayerService::handleCommand(const CommandRequest& request)
     }
 }
 
+bool MusicPlayerService::isQueryCommand(const std::string& command) {
+    return command == "get_track" || command == "search_tracks" ||
+           command == "get_all_tracks" || command == "get_library_stats";
+}
+
+CommandResponse MusicPlayerService::handleQuery(const CommandRequest& request, MusicLibrary& library) {
+    CommandResponse response;
+    try {
+        if (request.command == "get_track") {
+            response = handleGetTrack(request.params, library);
+        } else if (request.command == "search_tracks") {
+            response = handleSearchTracks(request.params, library);
+        } else if (request.command == "get_all_tracks") {
+            response = handleGetAllTracks(request.params, library);
+        } else if (request.command == "get_library_stats") {
+            response = handleGetLibraryStats(request.params, library);
+        } else {
+            response = CommandResponse::error("Unknown command: " + request.command);
+        }
+    } catch (const std::exception& e) {
+        response = CommandResponse::error(std::string("Command execution failed: ") + e.what());
+    }
+    // 查询应答可能乱序返回，带上请求ID便于客户端对应
+    response.request_id = request.request_id;
+    return response;
+}
+
 void MusicPlayerService::publishEvent(const std::string& event_type, const json& data) {
     try {
         EventMessage event = EventMessage::create(event_type, data);
@@ -641,19 +990,13 @@ CommandResponse MusicPlayerService::handleGetStatus(const json& params) {
     json result;
     
     // 获取真实播放状态
-    PlayState state = controller_->getState();
-    std::string state_str = "stopped";
-    if (state == PlayState::Playing) {
-        state_str = "playing";
-    } else if (state == PlayState::Paused) {
-        state_str = "paused";
-    }
+    std::string state_str = playStateName(controller_->getState());
     
     result["state"] = state_str;
     result["current_track_id"] = controller_->getCurrentTrackIndex();
     result["position_ms"] = controller_->getPosition();
     result["duration_ms"] = controller_->getDuration();
-    result["volume"] = 100;  // TODO: 从实际设备获取
+    result["volume"] = static_cast<int>(controller_->getVolume() * 100.0f + 0.5f);
     
     Track current = controller_->getCurrentTrack();
     if (!current.title.empty()) {
@@ -666,7 +1009,45 @@ CommandResponse MusicPlayerService::handleGetStatus(const json& params) {
     return CommandResponse::success(result);
 }
 
-CommandResponse MusicPlayerService::handleGetTrack(const json& params) {
+CommandResponse MusicPlayerService::handleGetMetrics(const json& params) {
+    liteplayer_stats stats;
+    if (!controller_->getStats(stats)) {
+        return CommandResponse::error("Player not initialized");
+    }
+    
+    // 计数器无锁读取，客户端可按 10Hz 轮询并自行求差
+    json result;
+    result["bytes_read"] = stats.bytes_read;
+    result["bytes_decoded"] = stats.bytes_decoded;
+    result["frames_decoded"] = stats.frames_decoded;
+    result["bytes_written"] = stats.bytes_written;
+    result["input_timeouts"] = stats.input_timeouts;
+    result["ringbuf"] = {
+        {"size", stats.ringbuf_size},
+        {"fill_min", stats.ringbuf_fill_min},
+        {"fill_avg", stats.ringbuf_fill_avg},
+        {"fill_max", stats.ringbuf_fill_max}
+    };
+    
+    const int bounds[] = LITEPLAYER_STATS_LATENCY_BOUNDS_MS;
+    json buckets = json::array();
+    for (int i = 0; i < LITEPLAYER_STATS_LATENCY_BUCKETS; i++) {
+        json bucket;
+        bucket["lt_ms"] = i < LITEPLAYER_STATS_LATENCY_BUCKETS - 1 ? json(bounds[i]) : json(nullptr);
+        bucket["count"] = stats.sink_latency_hist[i];
+        buckets.push_back(bucket);
+    }
+    result["sink_writes"] = stats.sink_writes;
+    result["sink_latency_max_us"] = stats.sink_latency_max_us;
+    result["sink_latency_hist"] = buckets;
+    
+    result["xruns"] = stats.xruns;
+    result["decode_cpu_us"] = stats.decode_cpu_us;
+    result["first_audio_ms"] = stats.first_audio_ms;
+    return CommandResponse::success(result);
+}
+
+CommandResponse MusicPlayerService::handleGetTrack(const json& params, MusicLibrary& library) {
     if (!params.contains("track_id")) {
         return CommandResponse::error("Missing track_id parameter");
     }
@@ -674,7 +1055,7 @@ CommandResponse MusicPlayerService::handleGetTrack(const json& params) {
     int64_t track_id = params["track_id"];
     TrackInfo track;
     
-    if (library_->getTrack(track_id, track)) {
+    if (library.getTrack(track_id, track)) {
         json result;
         result["id"] = track.id;
         result["title"] = track.title;
@@ -690,14 +1071,14 @@ CommandResponse MusicPlayerService::handleGetTrack(const json& params) {
     }
 }
 
-CommandResponse MusicPlayerService::handleSearchTracks(const json& params) {
+CommandResponse MusicPlayerService::handleSearchTracks(const json& params, MusicLibrary& library) {
     std::string query = params.value("query", "");
     
     SearchCriteria criteria;
     criteria.title = query;
     criteria.limit = params.value("limit", 10);
     
-    auto tracks = library_->searchTracks(criteria);
+    auto tracks = library.searchTracks(criteria);
     
     json result = json::array();
     for (const auto& track : tracks) {
@@ -776,9 +1157,9 @@ CommandResponse MusicPlayerService::handleAddTrack(const json& params) {
     }
 }
 
-CommandResponse MusicPlayerService::handleGetAllTracks(const json& params) {
+CommandResponse MusicPlayerService::handleGetAllTracks(const json& params, MusicLibrary& library) {
     int limit = params.value("limit", 100);
-    auto tracks = library_->getAllTracks(limit);
+    auto tracks = library.getAllTracks(limit);
     
     json result = json::array();
     for (const auto& track : tracks) {
@@ -796,6 +1177,18 @@ CommandResponse MusicPlayerService::handleGetAllTracks(const json& params) {
     return CommandResponse::success(response);
 }
 
+CommandResponse MusicPlayerService::handleGetLibraryStats(const json& params, MusicLibrary& library) {
+    auto stats = library.getStats();
+    
+    json result;
+    result["total_tracks"] = stats.total_tracks;
+    result["total_albums"] = stats.total_albums;
+    result["total_artists"] = stats.total_artists;
+    result["total_playlists"] = stats.total_playlists;
+    result["total_duration_ms"] = stats.total_duration_ms;
+    return CommandResponse::success(result);
+}
+
 // ========== 辅助方法 ==========
 
 bool MusicPlayerService::syncDatabaseTracksToPlaylist() {
@@ -821,88 +1214,107 @@ bool MusicPlayerService::syncDatabaseTracksToPlaylist() {
     return true;
 }
 
-bool MusicPlayerService::scanMusicDirectories() {
+CommandResponse MusicPlayerService::handleAnalyzeLoudness(const json& params) {
+    // 未在运行时重新开始，只会分析新增或变化的曲目
+    bool started = false;
+    if (!loudness_analyzer_ || !loudness_analyzer_->isRunning()) {
+        started = startLoudnessAnalysis();
+        if (!started) {
+            return CommandResponse::error("Failed to start loudness analysis");
+        }
+    }
+
+    auto progress = loudness_analyzer_->getProgress();
+    json result;
+    result["started"] = started;
+    result["running"] = progress.running;
+    result["total"] = progress.total;
+    result["analyzed"] = progress.analyzed;
+    result["failed"] = progress.failed;
+    return CommandResponse::success(result);
+}
+
+bool MusicPlayerService::startLoudnessAnalysis() {
     if (!library_ || !library_->isOpen()) {
         std::cerr << "[MusicPlayerService] Library not open" << std::endl;
         return false;
     }
-    
-    namespace fs = std::filesystem;
-    int total_added = 0;
-    
-    // 扫描配置中的所有目录
-    for (const auto& dir : config_.scan_directories) {
-        std::cout << "[MusicPlayerService] Scanning directory: " << dir << std::endl;
-        
-        auto tracks = scanDirectory(dir);
-        if (!tracks.empty()) {
-            std::cout << "  Found " << tracks.size() << " tracks" << std::endl;
-            int added = library_->addTracks(tracks);
-            std::cout << "  Added " << added << " new tracks to database" << std::endl;
-            total_added += added;
+    if (!loudness_analyzer_) {
+        loudness_analyzer_ = std::make_unique<LoudnessAnalyzer>(config_.database.path);
+    }
+
+    LoudnessAnalyzer::Options options;
+    options.threads = config_.loudness.threads;
+    options.batch_size = config_.loudness.batch_size > 0 ? config_.loudness.batch_size : 1;
+    return loudness_analyzer_->start(options);
+}
+
+bool MusicPlayerService::startLibraryWatcher() {
+    if (!library_watcher_) {
+        library_watcher_ = std::make_unique<LibraryWatcher>(config_.database.path);
+    }
+
+    LibraryWatcher::Options options;
+    options.directories = config_.scan_directories;
+    for (const auto& format : config_.supported_formats) {
+        std::string ext = format;
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        options.formats.push_back(ext);
+    }
+    options.use_inotify = config_.auto_scan.watch_directories;
+    options.debounce_ms = std::max(config_.auto_scan.debounce_ms, 0);
+    options.rescan_interval_s = std::max(config_.auto_scan.interval_seconds, 0);
+    options.fallback_poll_interval_s = std::max(config_.auto_scan.fallback_poll_seconds, 0);
+
+    // 监控线程只入队并唤醒，播放列表在 commandLoop 线程更新
+    return library_watcher_->start(options, [this](const LibraryWatcher::Changes& changes) {
+        {
+            std::lock_guard<std::mutex> lk(library_changes_mutex_);
+            pending_library_changes_.push_back(changes);
         }
+        wakeCommandLoop();
+    });
+}
+
+bool MusicPlayerService::startStatisticsWriter() {
+    if (!statistics_writer_) {
+        statistics_writer_ = std::make_unique<StatisticsWriter>(config_.database.path);
+    }
+
+    StatisticsWriter::Options options;
+    options.flush_interval_ms = std::max(config_.statistics.flush_interval_ms, 0);
+    options.checkpoint_interval_s = std::max(config_.statistics.checkpoint_interval_s, 0);
+    if (!statistics_writer_->start(options)) {
+        return false;
+    }
+
+    // 定时检查点由写入线程完成，服务连接提交时不再检查点
+    if (options.checkpoint_interval_s > 0) {
+        library_->setAutoCheckpoint(0);
     }
-    
-    std::cout << "[MusicPlayerService] Scan complete: " << total_added << " tracks added" << std::endl;
     return true;
 }
 
-std::vector<Track> MusicPlayerService::scanDirectory(const std::string& directory) {
-    std::vector<Track> tracks;
-    namespace fs = std::filesystem;
-    
-    // 检查目录是否存在
-    if (!fs::exists(directory)) {
-        std::cerr << "[MusicPlayerService] Directory not found: " << directory << std::endl;
-        return tracks;
+bool MusicPlayerService::scanMusicDirectories() {
+    if (!library_ || !library_->isOpen()) {
+        std::cerr << "[MusicPlayerService] Library not open" << std::endl;
+        return false;
     }
     
-    if (!fs::is_directory(directory)) {
-        std::cerr << "[MusicPlayerService] Not a directory: " << directory << std::endl;
-        return tracks;
+    LibraryScanner::Options options;
+    options.threads = config_.scanner.threads;
+    options.batch_size = config_.scanner.batch_size > 0 ? config_.scanner.batch_size : 1;
+    for (const auto& format : config_.supported_formats) {
+        std::string ext = format;
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        options.formats.push_back(ext);
     }
     
-    // 获取绝对路径
-    std::string abs_dir = fs::absolute(directory).string();
+    LibraryScanner scanner(*library_);
+    auto result = scanner.scan(config_.scan_directories, options);
     
-    // 遍历目录中的所有文件
-    try {
-        for (const auto& entry : fs::recursive_directory_iterator(abs_dir)) {
-            if (!entry.is_regular_file()) continue;
-            
-            std::string filename = entry.path().filename().string();
-            std::string extension = entry.path().extension().string();
-            
-            // 转换为小写比较
-            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-            
-            // 检查是否是支持的音乐格式
-            bool is_supported = false;
-            for (const auto& format : config_.supported_formats) {
-                if (extension == "." + format) {
-                    is_supported = true;
-                    break;
-                }
-            }
-            
-            if (!is_supported) continue;
-            
-            // 创建Track对象
-            Track track;
-            track.file_path = entry.path().string();
-            track.title = filename.substr(0, filename.find_last_of('.'));
-            track.artist = "Unknown";
-            track.album = "Unknown";
-            track.year = 0;
-            track.duration_ms = 0;  // 实际应该用多媒体库获取
-            
-            tracks.push_back(track);
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "[MusicPlayerService] Error scanning directory: " << e.what() << std::endl;
-    }
-    
-    return tracks;
+    std::cout << "[MusicPlayerService] Scan complete: " << result.added << " tracks added" << std::endl;
+    return true;
 }
 
 } // namespace music_player
@@ -0,0 +1,122 @@
+/*
+ * MusicLibrary Benchmark
+ * 批量导入、重新导入和按ID查询的耗时，用于比较不同提交之间的数据库写入开销
+ *
+ * 用法: bench_library [曲目数=50000] [数据库路径=/tmp/bench_music_library.db]
+ */
+
+#include "../include/MusicLibrary.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace music_player;
+using Clock = std::chrono::steady_clock;
+
+// 模拟真实曲库：每个艺术家若干专辑，每张专辑若干曲目
+std::vector<Track> makeTracks(int count, const std::string& root) {
+    std::vector<Track> tracks;
+    tracks.reserve(count);
+    for (int i = 0; i < count; i++) {
+        int artist = i / 100;
+        int album = i / 12;
+        Track track;
+        track.file_path = root + "/artist" + std::to_string(artist) + "/album" + std::to_string(album) +
+                          "/" + std::to_string(i) + ".mp3";
+        track.title = "Track " + std::to_string(i);
+        track.artist = "Artist " + std::to_string(artist);
+        track.album = "Album " + std::to_string(album);
+        track.year = 1970 + album % 50;
+        track.duration_ms = 120000 + (i * 7919) % 240000;
+        track.file_size = 4000000 + i;
+        track.file_mtime = 1700000000 + i;
+        track.content_hash = std::to_string(i);
+        tracks.push_back(track);
+    }
+    return tracks;
+}
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void report(const char* name, double ms, size_t rows) {
+    std::printf("%-34s %10.1f ms  %10.0f rows/s\n", name, ms, rows * 1000.0 / (ms > 0 ? ms : 1));
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 50000;
+    std::string db_path = argc > 2 ? argv[2] : "/tmp/bench_music_library.db";
+    if (count <= 0) {
+        std::cerr << "usage: " << argv[0] << " [tracks] [db_path]" << std::endl;
+        return 1;
+    }
+
+    // 结果用 printf 输出，关闭库的 std::cout 日志，避免逐条日志计入耗时
+    std::cout.setstate(std::ios::failbit);
+
+    std::printf("MusicLibrary benchmark: %d tracks\n", count);
+
+    // 1. 一次 addTracks 导入全部曲目
+    {
+        std::remove(db_path.c_str());
+        MusicLibrary library;
+        library.open(db_path);
+        auto tracks = makeTracks(count, "/music");
+        auto start = Clock::now();
+        library.addTracks(tracks);
+        report("addTracks (one call)", elapsedMs(start), tracks.size());
+    }
+
+    // 2. 扫描器的写法：每批 500 条 upsertTracks
+    {
+        std::remove(db_path.c_str());
+        MusicLibrary library;
+        library.open(db_path);
+        auto tracks = makeTracks(count, "/music");
+        auto start = Clock::now();
+        for (size_t begin = 0; begin < tracks.size(); begin += 500) {
+            std::vector<Track> batch(tracks.begin() + begin,
+                                     tracks.begin() + std::min(tracks.size(), begin + 500));
+            library.upsertTracks(batch);
+        }
+        report("upsertTracks (new, batches of 500)", elapsedMs(start), tracks.size());
+
+        // 3. 全部已存在时重新导入（标签变化后重新扫描）
+        start = Clock::now();
+        library.upsertTracks(tracks);
+        report("upsertTracks (existing, one call)", elapsedMs(start), tracks.size());
+
+        // 4. 按ID随机查询（查询工作线程、播放记录的典型操作）
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> pick(1, count);
+        const int lookups = 20000;
+        start = Clock::now();
+        int found = 0;
+        for (int i = 0; i < lookups; i++) {
+            TrackInfo info;
+            if (library.getTrack(pick(rng), info)) found++;
+        }
+        report("getTrack (random ids)", elapsedMs(start), lookups);
+        if (found != lookups) {
+            std::fprintf(stderr, "getTrack found %d/%d\n", found, lookups);
+            return 1;
+        }
+
+        // 5. 逐条 recordPlay，每条一个隐式事务
+        const int plays = 2000;
+        start = Clock::now();
+        for (int i = 0; i < plays; i++) {
+            library.recordPlay(pick(rng));
+        }
+        report("recordPlay (autocommit)", elapsedMs(start), plays);
+    }
+
+    std::remove(db_path.c_str());
+    return 0;
+}
@@ -4,10 +4,12 @@
  */
 
 #include "../include/MusicLibrary.h"
+#include "../include/StatisticsWriter.h"
 #include <iostream>
 #include <cassert>
 #include <cstdio>
 #include <filesystem>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 using namespace music_player;
@@ -31,8 +33,10 @@ const std::string TEST_DB = "/tmp/test_music.db";
 
 // 清理测试数据库
 void cleanupTestDB() {
-    if (fs::exists(TEST_DB)) {
-        fs::remove(TEST_DB);
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        if (fs::exists(TEST_DB + suffix)) {
+            fs::remove(TEST_DB + suffix);
+        }
     }
 }
 
@@ -127,6 +131,23 @@ void test_batch_add() {
     // 验证所有曲目
     auto all_tracks = library.getAllTracks();
     TEST_ASSERT(all_tracks.size() == 5, "All tracks retrieved");
+
+    // 不同行数的批量和不同的 LIMIT 不会占满语句缓存
+    int added = 0;
+    for (int n = 1; n <= 100; n++) {
+        std::vector<Track> batch;
+        for (int i = 0; i < n; i++) {
+            batch.push_back(createTestTrack(
+                "/music/batch" + std::to_string(n) + "_" + std::to_string(i) + ".mp3",
+                "Batch " + std::to_string(n), "Artist B", "Album B"));
+        }
+        added += library.addTracks(batch);
+    }
+    TEST_ASSERT(added == 5050, "All tracks of varying batch sizes added");
+    for (int limit = 1; limit <= 100; limit++) {
+        TEST_ASSERT(static_cast<int>(library.getAllTracks(limit).size()) == limit, "getAllTracks honors limit");
+    }
+    TEST_ASSERT(library.getAllTracks().size() == 5055, "Unlimited getAllTracks returns all tracks");
     
     library.close();
 }
@@ -443,6 +464,289 @@ void test_playlist() {
     library.close();
 }
 
+// 测试12: 响度
+void test_loudness() {
+    std::cout << "\n=== Test 12: Track Loudness ===" << std::endl;
+    
+    cleanupTestDB();
+    
+    MusicLibrary library;
+    library.open(TEST_DB);
+    
+    auto id = library.addTrack(createTestTrack("/m/loud.mp3", "Loud Song"));
+    
+    // 未测量的曲目没有响度
+    TrackInfo retrieved;
+    library.getTrack(id, retrieved);
+    TEST_ASSERT(!retrieved.loudness_lufs, "Loudness unknown before measuring");
+    
+    bool set = library.setTrackLoudness(id, -9.5);
+    TEST_ASSERT(set, "Loudness written");
+    TEST_ASSERT(!library.setTrackLoudness(id + 100, -9.5), "Loudness of missing track rejected");
+    
+    library.getTrack(id, retrieved);
+    TEST_ASSERT(retrieved.loudness_lufs == -9.5, "Loudness read back by getTrack");
+    
+    auto all_tracks = library.getAllTracks();
+    TEST_ASSERT(all_tracks.size() == 1 && all_tracks[0].loudness_lufs == -9.5, "Loudness read back by getAllTracks");
+    
+    // 0 LUFS 是测量值，不能当成未测量
+    library.setTrackLoudness(id, 0.0);
+    library.getTrack(id, retrieved);
+    TEST_ASSERT(retrieved.loudness_lufs && *retrieved.loudness_lufs == 0.0, "0 LUFS read back as measured");
+    
+    library.close();
+}
+
+// 测试13: 响度分析指纹与批量写入
+void test_loudness_results() {
+    std::cout << "\n=== Test 13: Loudness Analysis Results ===" << std::endl;
+    
+    cleanupTestDB();
+    
+    MusicLibrary library;
+    library.open(TEST_DB);
+    
+    auto id1 = library.addTrack(createTestTrack("/m/a.mp3", "A"));
+    auto id2 = library.addTrack(createTestTrack("/m/b.mp3", "B"));
+    auto id3 = library.addTrack(createTestTrack("/m/c.mp3", "C"));
+    library.markTrackBadByPath("/m/c.mp3", "test");
+    
+    // 坏轨不分析，未分析的指纹为 -1
+    auto fps = library.getLoudnessFingerprints();
+    TEST_ASSERT(fps.size() == 2, "Bad track excluded from fingerprints");
+    TEST_ASSERT(fps.size() == 2 && fps[0].track_id == id1 && fps[0].file_size == -1 &&
+                fps[0].file_mtime == -1, "Fingerprint unset before analysis");
+    
+    LoudnessResult ok;
+    ok.track_id = id1;
+    ok.success = true;
+    ok.loudness_lufs = -14.2;
+    ok.true_peak_dbtp = -0.5;
+    ok.duration_ms = 123000;
+    ok.file_size = 4096;
+    ok.file_mtime = 1700000000;
+    LoudnessResult failed;
+    failed.track_id = id2;
+    failed.file_size = 100;
+    failed.file_mtime = 1700000001;
+    LoudnessResult missing = ok;
+    missing.track_id = id3 + 100;
+    
+    int saved = library.saveLoudnessResults({ok, failed, missing});
+    TEST_ASSERT(saved == 2, "Batch saved existing tracks only");
+    
+    TrackInfo retrieved;
+    library.getTrack(id1, retrieved);
+    TEST_ASSERT(retrieved.loudness_lufs == -14.2, "Analyzed loudness read back");
+    TEST_ASSERT(retrieved.duration_ms == 123000, "Decoded duration written");
+    library.getTrack(id2, retrieved);
+    TEST_ASSERT(!retrieved.loudness_lufs, "Failed track keeps loudness unknown");
+    
+    // 失败的曲目也记录指纹，文件不变就不再重试
+    fps = library.getLoudnessFingerprints();
+    TEST_ASSERT(fps.size() == 2 && fps[0].file_size == 4096 && fps[0].file_mtime == 1700000000,
+                "Fingerprint of analyzed track stored");
+    TEST_ASSERT(fps.size() == 2 && fps[1].file_size == 100 && fps[1].file_mtime == 1700000001,
+                "Fingerprint of failed track stored");
+    
+    TEST_ASSERT(library.saveLoudnessResults({}) == 0, "Empty batch is a no-op");
+    
+    library.close();
+}
+
+// 测试14: 只读连接
+void test_open_read_only() {
+    std::cout << "\n=== Test 14: Read-Only Connection ===" << std::endl;
+    
+    cleanupTestDB();
+    
+    MusicLibrary reader;
+    TEST_ASSERT(!reader.openReadOnly(TEST_DB), "Read-only open fails without database");
+    TEST_ASSERT(!reader.isOpen(), "Failed read-only open leaves library closed");
+    
+    MusicLibrary writer;
+    writer.open(TEST_DB);
+    auto id = writer.addTrack(createTestTrack("/m/ro.mp3", "Read Only"));
+    
+    TEST_ASSERT(reader.openReadOnly(TEST_DB), "Read-only open of existing database");
+    TrackInfo retrieved;
+    TEST_ASSERT(reader.getTrack(id, retrieved) && retrieved.title == "Read Only",
+                "Read-only connection sees committed track");
+    TEST_ASSERT(reader.addTrack(createTestTrack("/m/ro2.mp3", "Rejected")) < 0,
+                "Read-only connection rejects writes");
+    
+    // 主连接之后的写入对只读连接可见
+    writer.addTrack(createTestTrack("/m/ro3.mp3", "Later"));
+    TEST_ASSERT(reader.getAllTracks(10).size() == 2, "Read-only connection sees later writes");
+    
+    reader.close();
+    writer.close();
+}
+
+// 测试15: 按路径插入或更新
+void test_upsert_tracks() {
+    std::cout << "\n=== Test 15: Upsert Tracks ===" << std::endl;
+    
+    cleanupTestDB();
+    MusicLibrary library;
+    library.open(TEST_DB);
+    
+    int64_t id = library.addTrack(createTestTrack("/music/a.mp3", "Old Title"));
+    
+    std::vector<Track> tracks = {
+        createTestTrack("/music/a.mp3", "New Title", "New Artist"),
+        createTestTrack("/music/b.mp3", "Song B"),
+    };
+    TEST_ASSERT(library.upsertTracks(tracks) == 2, "Upsert writes both tracks");
+    TEST_ASSERT(tracks[0].id == id, "Existing path keeps its ID");
+    TEST_ASSERT(tracks[1].id > 0 && tracks[1].id != id, "New path gets a new ID");
+    
+    TrackInfo info;
+    TEST_ASSERT(library.getTrack(id, info) && info.title == "New Title" && info.artist == "New Artist",
+                "Existing track updated in place");
+    TEST_ASSERT(library.getAllTracks().size() == 2, "No duplicate rows");
+    
+    library.close();
+}
+
+// 测试16: 按文件或目录删除
+void test_delete_by_path() {
+    std::cout << "\n=== Test 16: Delete Tracks By Path ===" << std::endl;
+    
+    cleanupTestDB();
+    MusicLibrary library;
+    library.open(TEST_DB);
+    
+    std::vector<Track> tracks = {
+        createTestTrack("/music/album/1.mp3", "One"),
+        createTestTrack("/music/album/cd2/2.mp3", "Two"),
+        createTestTrack("/music/album2/3.mp3", "Three"),
+        createTestTrack("/music/4.mp3", "Four"),
+    };
+    library.addTracks(tracks);
+    
+    int64_t playlist_id = library.createPlaylist("Watch", "");
+    auto all = library.getAllTracks();
+    for (const auto& t : all) {
+        library.addTrackToPlaylist(playlist_id, t.id);
+    }
+    
+    TEST_ASSERT(library.deleteTracksByPath({"/music/album"}) == 2, "Directory removes its whole subtree");
+    auto remaining = library.getFileFingerprints();
+    TEST_ASSERT(std::any_of(remaining.begin(), remaining.end(),
+                            [](const FileFingerprint& fp) { return fp.file_path == "/music/album2/3.mp3"; }),
+                "Sibling with the same prefix kept");
+    TEST_ASSERT(library.deleteTracksByPath({"/music/4.mp3", "/music/missing.mp3"}) == 1, "Single file removed");
+    TEST_ASSERT(library.getPlaylistTracks(playlist_id).size() == 1, "Playlist entries removed with tracks");
+    
+    library.close();
+}
+
+// 测试17: 文件指纹和移动后改写路径
+void test_fingerprint_relink() {
+    std::cout << "\n=== Test 17: Fingerprint And Relink ===" << std::endl;
+    
+    cleanupTestDB();
+    MusicLibrary library;
+    library.open(TEST_DB);
+    
+    Track legacy = createTestTrack("/music/old/legacy.mp3", "Legacy");
+    Track hashed = createTestTrack("/music/old/hashed.mp3", "Hashed");
+    hashed.file_size = 4096;
+    hashed.file_mtime = 1700000000;
+    hashed.content_hash = "00112233445566778899aabbccddeeff";
+    int64_t legacy_id = library.addTrack(legacy);
+    int64_t hashed_id = library.addTrack(hashed);
+    library.recordPlay(hashed_id);
+    library.setFavorite(hashed_id, true);
+    
+    auto fps = library.getFileFingerprints({"/music/old"});
+    TEST_ASSERT(fps.size() == 2, "Fingerprints filtered by directory");
+    for (const auto& fp : fps) {
+        if (fp.track_id == legacy_id) {
+            TEST_ASSERT(fp.file_size == -1 && fp.content_hash.empty(), "Track without fingerprint reports -1");
+        } else {
+            TEST_ASSERT(fp.file_size == 4096 && fp.content_hash == hashed.content_hash, "Fingerprint stored");
+        }
+    }
+    
+    // 无指纹的更新不覆盖已记录的指纹
+    hashed.title = "Hashed Retitled";
+    hashed.content_hash.clear();
+    library.updateTrack(hashed_id, hashed);
+    fps = library.getFileFingerprints({"/music/old/hashed.mp3"});
+    TEST_ASSERT(fps.size() == 1 && fps[0].file_size == 4096, "Update without fingerprint keeps the old one");
+    
+    FileFingerprint move = fps[0];
+    move.file_path = "/music/new/hashed.mp3";
+    move.file_mtime = 1700000100;
+    FileFingerprint clash;
+    clash.track_id = legacy_id;
+    clash.file_path = "/music/new/hashed.mp3";
+    clash.file_size = 1;
+    clash.file_mtime = 1;
+    clash.content_hash = "ff";
+    TEST_ASSERT(library.relinkTracks({move, clash}) == 1, "Relink skips a path already in use");
+    
+    TrackInfo info;
+    TEST_ASSERT(library.getTrack(hashed_id, info), "Moved track keeps its ID");
+    TEST_ASSERT(info.file_path == "/music/new/hashed.mp3", "Path rewritten");
+    TEST_ASSERT(info.play_count == 1 && info.is_favorite, "Play count and favorite kept");
+    TEST_ASSERT(library.getFileFingerprints({"/music/old"}).size() == 1, "Only the legacy track left under the old path");
+    
+    library.close();
+}
+
+// 测试18: 延迟写入的播放统计
+void test_statistics_writer() {
+    std::cout << "\n=== Test 18: Write-behind Statistics ===" << std::endl;
+    
+    cleanupTestDB();
+    MusicLibrary library;
+    library.open(TEST_DB);
+    TEST_ASSERT(fs::exists(TEST_DB + "-wal"), "Database opened in WAL mode");
+    
+    Track played = createTestTrack("/music/played.mp3", "Played");
+    Track broken = createTestTrack("/music/broken.mp3", "Broken");
+    int64_t played_id = library.addTrack(played);
+    library.addTrack(broken);
+    
+    StatisticsUpdate play;
+    play.file_path = played.file_path;
+    play.time = 1700000000;
+    StatisticsUpdate bad;
+    bad.kind = StatisticsUpdate::Kind::MarkBad;
+    bad.file_path = broken.file_path;
+    bad.reason = "test";
+    bad.time = 1700000001;
+    StatisticsUpdate unknown = play;
+    unknown.file_path = "/music/missing.mp3";
+    TEST_ASSERT(library.applyStatistics({play, bad, unknown}) == 2, "Batch skips unknown paths");
+    
+    TrackInfo info;
+    library.getTrack(played_id, info);
+    TEST_ASSERT(info.play_count == 1 && info.last_played == 1700000000, "Play recorded with event time");
+    TEST_ASSERT(library.isTrackBadByPath(broken.file_path), "Bad track marked");
+    
+    // 后台线程用独立连接写入，stop() 提交剩余的更新
+    StatisticsWriter writer(TEST_DB);
+    StatisticsWriter::Options options;
+    options.flush_interval_ms = 50;
+    TEST_ASSERT(writer.start(options), "Writer started");
+    for (int i = 0; i < 3; i++) {
+        writer.recordPlay(played.file_path);
+    }
+    writer.stop();
+    TEST_ASSERT(!writer.isRunning(), "Writer stopped");
+    
+    library.getTrack(played_id, info);
+    TEST_ASSERT(info.play_count == 4, "Queued plays written on stop");
+    TEST_ASSERT(library.checkpoint(), "Checkpoint");
+    
+    library.close();
+}
+
 // 主函数
 int main(int argc, char* argv[]) {
     std::cout << "╔═══════════════════════════════════════════════════╗" << std::endl;
@@ -463,6 +767,13 @@ int main(int argc, char* argv[]) {
     test_search();
     test_most_played();
     test_playlist();
+    test_loudness();
+    test_loudness_results();
+    test_open_read_only();
+    test_upsert_tracks();
+    test_delete_by_path();
+    test_fingerprint_relink();
+    test_statistics_writer();
     
     // 清理测试数据库
     cleanupTestDB();
@@ -149,6 +149,43 @@ void testSeekTo(PlaylistManager& manager) {
     std::cout << "✅ Seek to test passed" << std::endl;
 }
 
+void testUpdateRemove() {
+    std::cout << "\n========== Test 7: Update/Remove By Path ==========" << std::endl;
+    
+    PlaylistManager manager;
+    const char* paths[] = {"/m/a.mp3", "/m/dir/b.mp3", "/m/dir/sub/c.mp3", "/m/dir2/d.mp3", "/m/e.mp3"};
+    for (const char* p : paths) {
+        Track track;
+        track.file_path = p;
+        track.title = p;
+        manager.addTrack(track);
+    }
+    
+    // 当前曲目之后的被移除，当前曲目不变
+    manager.seekTo(0);
+    Track updated;
+    updated.file_path = "/m/e.mp3";
+    updated.title = "E";
+    assert(manager.updateTrack(updated));
+    assert(manager.getAllTracks().back().title == "E");
+    assert(!manager.updateTrack(Track()));
+    
+    // 当前在 d：移除目录 /m/dir 下的两首，索引跟随 d
+    manager.seekTo(3);
+    assert(manager.removeTracks("/m/dir") == 2);
+    assert(manager.getTrackCount() == 3);
+    assert(manager.getCurrentTrack().file_path == "/m/dir2/d.mp3");
+    
+    // 移除当前曲目后，next() 接到原来的下一首
+    manager.setPlayMode(PlayMode::Sequential);
+    assert(manager.removeTracks("/m/dir2/d.mp3") == 1);
+    assert(manager.next());
+    assert(manager.getCurrentTrack().file_path == "/m/e.mp3");
+    printPlaylist(manager);
+    
+    std::cout << "✅ Update/remove test passed" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "=== PlaylistManager Test Suite ===" << std::endl;
     
@@ -193,6 +230,7 @@ int main(int argc, char* argv[]) {
         testRandomMode(manager);
         testShuffle(manager);
         testSeekTo(manager);
+        testUpdateRemove();
         
         std::cout << "\n" << std::string(50, '=') << std::endl;
         std::cout << "🎉 All tests passed!" << std::endl;
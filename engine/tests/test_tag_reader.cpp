@@ -0,0 +1,244 @@
+/*
+ * TagReader Test Suite
+ * 测试 ID3v1/v2、MP4 ilst、RIFF INFO 标签读取
+ */
+
+#include "../include/TagReader.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+using namespace music_player;
+
+// 测试计数器
+int tests_passed = 0;
+int tests_failed = 0;
+
+// 宏定义简化测试代码
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "❌ TEST FAILED: " << msg << " at line " << __LINE__ << std::endl; \
+        tests_failed++; \
+    } else { \
+        std::cout << "✅ PASSED: " << msg << std::endl; \
+        tests_passed++; \
+    }
+
+// 测试文件目录
+const std::string TEST_DIR = "/tmp/test_tag_reader";
+
+using Bytes = std::string;
+
+Bytes be32(uint32_t v) {
+    return Bytes{char(v >> 24), char(v >> 16), char(v >> 8), char(v)};
+}
+
+Bytes le32(uint32_t v) {
+    return Bytes{char(v), char(v >> 8), char(v >> 16), char(v >> 24)};
+}
+
+Bytes syncsafe(uint32_t v) {
+    return Bytes{char((v >> 21) & 0x7f), char((v >> 14) & 0x7f), char((v >> 7) & 0x7f), char(v & 0x7f)};
+}
+
+Bytes id3v23Frame(const std::string& id, const Bytes& body) {
+    return id + be32(body.size()) + Bytes(2, '\0') + body;
+}
+
+Bytes id3v24Frame(const std::string& id, const Bytes& body) {
+    return id + syncsafe(body.size()) + Bytes(2, '\0') + body;
+}
+
+Bytes id3v2Tag(int major, const Bytes& frames, size_t padding = 0) {
+    return Bytes("ID3") + char(major) + '\0' + '\0' + syncsafe(frames.size() + padding) +
+           frames + Bytes(padding, '\0');
+}
+
+Bytes id3v1Tag(const std::string& title, const std::string& artist, const std::string& album,
+               const std::string& year, int genre) {
+    auto field = [](const std::string& s, size_t n) { return (s + Bytes(n, '\0')).substr(0, n); };
+    return Bytes("TAG") + field(title, 30) + field(artist, 30) + field(album, 30) +
+           field(year, 4) + Bytes(30, '\0') + char(genre);
+}
+
+Bytes atom(const std::string& type, const Bytes& body) {
+    return be32(body.size() + 8) + type + body;
+}
+
+Bytes ilstItem(const std::string& type, const Bytes& value, uint32_t data_type = 1) {
+    return atom(type, atom("data", be32(data_type) + be32(0) + value));
+}
+
+// MP3 帧头（MPEG1 Layer3 128kbps 44.1kHz），让文件看起来像音频
+Bytes mp3Frames(size_t bytes) {
+    Bytes frame(417, '\0');
+    frame[0] = char(0xff);
+    frame[1] = char(0xfb);
+    frame[2] = char(0x90);
+    frame[3] = char(0x00);
+    Bytes out;
+    while (out.size() < bytes) out += frame;
+    return out;
+}
+
+std::string writeFile(const std::string& name, const Bytes& data) {
+    fs::create_directories(TEST_DIR);
+    std::string path = TEST_DIR + "/" + name;
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size());
+    return path;
+}
+
+bool readTags(const std::string& path, Track& track, int* disk_reads = nullptr) {
+    MediaFile file;
+    if (!file.open(path)) return false;
+    bool found = TagReader::read(file, track);
+    if (disk_reads) *disk_reads = file.diskReads();
+    return found;
+}
+
+// 测试1: ID3v2.3，UTF-16 文本和数字流派
+void test_id3v23_utf16() {
+    std::cout << "\n=== Test 1: ID3v2.3 UTF-16 ===" << std::endl;
+
+    // "测试" 的 UTF-16LE（带 BOM）
+    Bytes title = Bytes("\x01\xff\xfe", 3) + Bytes("\x4b\x6d\xd5\x8b", 4) + Bytes(2, '\0');
+    Bytes frames = id3v23Frame("TIT2", title) +
+                   id3v23Frame("TPE1", Bytes("\0Artist", 7)) +
+                   id3v23Frame("TALB", Bytes("\0Album", 6)) +
+                   id3v23Frame("TYER", Bytes("\0" "1999", 5)) +
+                   id3v23Frame("TCON", Bytes("\0(17)", 5));
+    std::string path = writeFile("v23.mp3", id3v2Tag(3, frames, 64) + mp3Frames(4096));
+
+    Track track;
+    int reads = 0;
+    TEST_ASSERT(readTags(path, track, &reads), "ID3v2.3 tag found");
+    TEST_ASSERT(track.title == "\xe6\xb5\x8b\xe8\xaf\x95", "UTF-16 title decoded to UTF-8");
+    TEST_ASSERT(track.artist == "Artist", "Artist read");
+    TEST_ASSERT(track.album == "Album", "Album read");
+    TEST_ASSERT(track.year == 1999, "Year read");
+    TEST_ASSERT(track.genre == "Rock", "Numeric genre mapped");
+    TEST_ASSERT(reads == 1, "Only the file head is read");
+}
+
+// 测试2: ID3v2.4 UTF-8，缺少的字段由 ID3v1 补全
+void test_id3v24_with_v1_fallback() {
+    std::cout << "\n=== Test 2: ID3v2.4 + ID3v1 Fallback ===" << std::endl;
+
+    Bytes frames = id3v24Frame("TIT2", Bytes("\x03" "Caf\xc3\xa9", 6)) +
+                   id3v24Frame("TDRC", Bytes("\x03" "2021-05-01", 11));
+    Bytes data = id3v2Tag(4, frames) + mp3Frames(200 * 1024) +
+                 id3v1Tag("V1 Title", "V1 Artist", "V1 Album", "1980", 8);
+    std::string path = writeFile("v24.mp3", data);
+
+    Track track;
+    TEST_ASSERT(readTags(path, track), "ID3v2.4 tag found");
+    TEST_ASSERT(track.title == "Caf\xc3\xa9", "ID3v2 title wins over ID3v1");
+    TEST_ASSERT(track.year == 2021, "Year parsed from TDRC timestamp");
+    TEST_ASSERT(track.artist == "V1 Artist", "Artist filled from ID3v1");
+    TEST_ASSERT(track.album == "V1 Album", "Album filled from ID3v1");
+    TEST_ASSERT(track.genre == "Jazz", "Genre filled from ID3v1");
+}
+
+// 测试3: 只有 ID3v1，Latin-1 文本
+void test_id3v1_only() {
+    std::cout << "\n=== Test 3: ID3v1 Only ===" << std::endl;
+
+    std::string path = writeFile("v1.mp3", mp3Frames(8192) + id3v1Tag("Ni\xf1o", "Band", "", "2005", 255));
+
+    Track track;
+    TEST_ASSERT(readTags(path, track), "ID3v1 tag found");
+    TEST_ASSERT(track.title == "Ni\xc3\xb1o", "Latin-1 title converted to UTF-8");
+    TEST_ASSERT(track.artist == "Band", "Artist read");
+    TEST_ASSERT(track.album.empty(), "Empty album left empty");
+    TEST_ASSERT(track.year == 2005, "Year read");
+    TEST_ASSERT(track.genre.empty(), "Unknown genre index ignored");
+
+    Track none;
+    std::string plain = writeFile("plain.mp3", mp3Frames(8192));
+    TEST_ASSERT(!readTags(plain, none), "File without tags reports nothing");
+    TEST_ASSERT(none.title.empty(), "No title invented");
+}
+
+// 测试4: MP4，moov 在文件尾
+void test_mp4_ilst() {
+    std::cout << "\n=== Test 4: MP4 ilst ===" << std::endl;
+
+    Bytes ilst = ilstItem("\xa9" "nam", "Song") +
+                 ilstItem("\xa9" "ART", "Singer") +
+                 ilstItem("\xa9" "alb", "Record") +
+                 ilstItem("\xa9" "day", "2010-01-01T00:00:00Z") +
+                 ilstItem("gnre", Bytes("\x00\x0e", 2), 0) +
+                 ilstItem("covr", Bytes(1000, 'x'), 13);
+    Bytes meta = atom("meta", be32(0) + atom("hdlr", Bytes(25, '\0')) + atom("ilst", ilst));
+    Bytes moov = atom("moov", atom("mvhd", Bytes(100, '\0')) + atom("udta", meta));
+    Bytes data = atom("ftyp", Bytes("M4A ") + be32(0)) + atom("mdat", Bytes(300 * 1024, '\0')) + moov;
+    std::string path = writeFile("tail.m4a", data);
+
+    Track track;
+    int reads = 0;
+    TEST_ASSERT(readTags(path, track, &reads), "ilst found");
+    TEST_ASSERT(track.title == "Song", "Title read");
+    TEST_ASSERT(track.artist == "Singer", "Artist read");
+    TEST_ASSERT(track.album == "Record", "Album read");
+    TEST_ASSERT(track.year == 2010, "Year read");
+    TEST_ASSERT(track.genre == "Pop", "gnre index mapped (1-based)");
+    TEST_ASSERT(reads == 2, "Head plus one read for the tail moov");
+
+    // 重复读取 moov 不再访问磁盘
+    MediaFile file;
+    file.open(path);
+    Track again;
+    TagReader::read(file, again);
+    int before = file.diskReads();
+    char buf[64];
+    file.readAt(data.size() - moov.size(), buf, sizeof(buf));
+    TEST_ASSERT(file.diskReads() == before, "Cached moov served from memory");
+}
+
+// 测试5: WAV，LIST/INFO 在 data 之后
+void test_riff_info() {
+    std::cout << "\n=== Test 5: RIFF INFO ===" << std::endl;
+
+    Bytes fmt = Bytes("fmt ") + le32(16) + Bytes("\x01\x00\x02\x00\x44\xac\x00\x00\x10\xb1\x02\x00\x04\x00\x10\x00", 16);
+    Bytes pcm = Bytes("data") + le32(100001) + Bytes(100001, '\0') + Bytes(1, '\0');
+    Bytes info = Bytes("INFO") +
+                 Bytes("INAM") + le32(5) + Bytes("Title", 5) + Bytes(1, '\0') +
+                 Bytes("IART") + le32(7) + Bytes("Artist\0", 7) + Bytes(1, '\0') +
+                 Bytes("IPRD") + le32(6) + Bytes("\xc3\xa9t\xc3\xa9", 6) +
+                 Bytes("ICRD") + le32(4) + Bytes("1975", 4) +
+                 Bytes("IGNR") + le32(4) + Bytes("Folk", 4);
+    Bytes list = Bytes("LIST") + le32(info.size()) + info;
+    Bytes body = Bytes("WAVE") + fmt + pcm + list;
+    std::string path = writeFile("info.wav", Bytes("RIFF") + le32(body.size()) + body);
+
+    Track track;
+    TEST_ASSERT(readTags(path, track), "INFO chunk found");
+    TEST_ASSERT(track.title == "Title", "Odd sized chunk padding handled");
+    TEST_ASSERT(track.artist == "Artist", "Trailing NUL trimmed");
+    TEST_ASSERT(track.album == "\xc3\xa9t\xc3\xa9", "UTF-8 text kept as is");
+    TEST_ASSERT(track.year == 1975, "Year read");
+    TEST_ASSERT(track.genre == "Folk", "Genre read");
+}
+
+// 主函数
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    std::cout << "╔═══════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║   TagReader Test Suite                           ║" << std::endl;
+    std::cout << "╚═══════════════════════════════════════════════════╝" << std::endl;
+
+    test_id3v23_utf16();
+    test_id3v24_with_v1_fallback();
+    test_id3v1_only();
+    test_mp4_ilst();
+    test_riff_info();
+
+    fs::remove_all(TEST_DIR);
+
+    std::cout << "\n✅ Passed: " << tests_passed << std::endl;
+    std::cout << "❌ Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,461 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "osal/os_thread.h"
+#include "cutils/log_helper.h"
+#include "liteplayer_main.h"
+#include "source_file_wrapper.h"
+
+#define TAG "liteplayer_bench"
+
+#define BENCH_RUNS_DEFAULT  3
+#define BENCH_RUNS_MAX      32
+#define BENCH_TIMEOUT_SEC   600
+
+struct bench_player {
+    os_mutex                lock;
+    os_cond                 cond;
+    enum liteplayer_state   state;
+    long long               bytes;
+    int                     samplerate;
+    int                     channels;
+    int                     bits;
+};
+
+struct bench_result {
+    const char *label;
+    const char *url;
+    bool        ok;
+    int         samplerate;
+    int         channels;
+    int         bits;
+    double      audio_sec;
+    double      wall_sec;           // median of runs
+    double      cpu_sec;            // median of runs, all threads
+    long        peak_rss_kb;        // max of runs
+    long long   allocs;             // first run
+    long long   alloc_bytes;        // first run
+};
+
+// Heap allocations of the whole process, glibc only, C++ new ends up here too
+#if defined(__GLIBC__)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static long long g_allocs;
+static long long g_alloc_bytes;
+
+void *malloc(size_t size)
+{
+    __atomic_add_fetch(&g_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_alloc_bytes, (long long)size, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    __atomic_add_fetch(&g_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_alloc_bytes, (long long)(n * size), __ATOMIC_RELAXED);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&g_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_alloc_bytes, (long long)size, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+static void bench_alloc_stats(long long *allocs, long long *bytes)
+{
+    *allocs = __atomic_load_n(&g_allocs, __ATOMIC_RELAXED);
+    *bytes = __atomic_load_n(&g_alloc_bytes, __ATOMIC_RELAXED);
+}
+#else
+static void bench_alloc_stats(long long *allocs, long long *bytes)
+{
+    *allocs = -1;
+    *bytes = -1;
+}
+#endif
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double bench_cpu_time(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// Linux resets VmHWM to the current rss, so the peak is per run instead of per process
+static void bench_reset_peak_rss(void)
+{
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp != NULL) {
+        fputs("5", fp);
+        fclose(fp);
+    }
+}
+
+static long bench_peak_rss_kb(void)
+{
+    long kb = -1;
+    char line[128];
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (fp != NULL) {
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                kb = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(fp);
+    }
+    if (kb < 0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        kb = usage.ru_maxrss / 1024;
+#else
+        kb = usage.ru_maxrss;
+#endif
+    }
+    return kb;
+}
+
+// Null sink never blocks, so the pipeline runs as fast as source and decoder allow
+static const char *null_sink_name(void)
+{
+    return "null";
+}
+
+static sink_handle_t null_sink_open(int samplerate, int channels, int bits, void *priv_data)
+{
+    struct bench_player *player = (struct bench_player *)priv_data;
+    player->samplerate = samplerate;
+    player->channels = channels;
+    player->bits = bits;
+    return (sink_handle_t)player;
+}
+
+static int null_sink_write(sink_handle_t handle, char *buffer, int size)
+{
+    struct bench_player *player = (struct bench_player *)handle;
+    player->bytes += size;
+    return size;
+}
+
+static void null_sink_close(sink_handle_t handle)
+{
+}
+
+static int bench_state_listener(enum liteplayer_state state, int errcode, void *priv)
+{
+    struct bench_player *player = (struct bench_player *)priv;
+    if (state == LITEPLAYER_NEARLYCOMPLETED)
+        return 0;
+    if (state == LITEPLAYER_ERROR)
+        OS_LOGE(TAG, "Player error: %d", errcode);
+    os_mutex_lock(player->lock);
+    player->state = state;
+    os_cond_signal(player->cond);
+    os_mutex_unlock(player->lock);
+    return 0;
+}
+
+static bool bench_wait_state(struct bench_player *player, enum liteplayer_state state)
+{
+    bool reached;
+    double deadline = bench_now() + BENCH_TIMEOUT_SEC;
+    os_mutex_lock(player->lock);
+    while (player->state != state && player->state != LITEPLAYER_ERROR && bench_now() < deadline)
+        os_cond_timedwait(player->cond, player->lock, 100*1000);
+    reached = (player->state == state);
+    os_mutex_unlock(player->lock);
+    return reached;
+}
+
+// One pass over url: prepare, decode to the end, measured from prepare to completion
+static int bench_run_once(const char *url, enum liteplayer_cpu_budget budget,
+                          struct bench_player *player, double *wall_sec, double *cpu_sec)
+{
+    int ret = -1;
+    liteplayer_handle_t handle = liteplayer_create();
+    if (handle == NULL)
+        return ret;
+
+    player->state = LITEPLAYER_IDLE;
+    player->bytes = 0;
+    liteplayer_register_state_listener(handle, bench_state_listener, player);
+
+    struct sink_wrapper sink_ops = {
+        .priv_data = player,
+        .name = null_sink_name,
+        .open = null_sink_open,
+        .write = null_sink_write,
+        .close = null_sink_close,
+    };
+    liteplayer_register_sink_wrapper(handle, &sink_ops);
+
+    struct source_wrapper file_ops = {
+        .async_mode = false,
+        .buffer_size = 2*1024,
+        .priv_data = NULL,
+        .url_protocol = file_wrapper_url_protocol,
+        .open = file_wrapper_open,
+        .read = file_wrapper_read,
+        .content_pos = file_wrapper_content_pos,
+        .content_len = file_wrapper_content_len,
+        .seek = file_wrapper_seek,
+        .close = file_wrapper_close,
+    };
+    liteplayer_register_source_wrapper(handle, &file_ops);
+    liteplayer_set_cpu_budget(handle, budget);
+
+    if (liteplayer_set_data_source(handle, url) != 0)
+        goto run_out;
+
+    double wall_start = bench_now();
+    double cpu_start = bench_cpu_time();
+    if (liteplayer_prepare_async(handle) != 0 || !bench_wait_state(player, LITEPLAYER_PREPARED))
+        goto run_out;
+    if (liteplayer_start(handle) != 0 || !bench_wait_state(player, LITEPLAYER_COMPLETED))
+        goto run_out;
+    *wall_sec = bench_now() - wall_start;
+    *cpu_sec = bench_cpu_time() - cpu_start;
+    ret = 0;
+
+    liteplayer_stop(handle);
+    bench_wait_state(player, LITEPLAYER_STOPPED);
+
+run_out:
+    liteplayer_reset(handle);
+    liteplayer_destroy(handle);
+    return ret;
+}
+
+static int bench_compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double bench_median(double *values, int count)
+{
+    qsort(values, count, sizeof(double), bench_compare_double);
+    return (count % 2) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
+}
+
+static void bench_file(struct bench_result *result, int runs, enum liteplayer_cpu_budget budget)
+{
+    double wall[BENCH_RUNS_MAX], cpu[BENCH_RUNS_MAX];
+    struct bench_player player;
+    memset(&player, 0, sizeof(player));
+    player.lock = os_mutex_create();
+    player.cond = os_cond_create();
+
+    result->ok = false;
+    for (int i = 0; i < runs; i++) {
+        long long allocs_start, bytes_start, allocs_end, bytes_end;
+        bench_reset_peak_rss();
+        bench_alloc_stats(&allocs_start, &bytes_start);
+        if (bench_run_once(result->url, budget, &player, &wall[i], &cpu[i]) != 0) {
+            OS_LOGE(TAG, "Failed to decode %s", result->url);
+            goto file_out;
+        }
+        bench_alloc_stats(&allocs_end, &bytes_end);
+
+        long rss = bench_peak_rss_kb();
+        if (rss > result->peak_rss_kb)
+            result->peak_rss_kb = rss;
+        if (i == 0) {
+            result->allocs = allocs_end < 0 ? -1 : allocs_end - allocs_start;
+            result->alloc_bytes = bytes_end < 0 ? -1 : bytes_end - bytes_start;
+        }
+    }
+
+    int frame_size = player.channels * player.bits / 8;
+    if (player.samplerate <= 0 || frame_size <= 0) {
+        OS_LOGE(TAG, "No pcm decoded from %s", result->url);
+        goto file_out;
+    }
+    result->samplerate = player.samplerate;
+    result->channels = player.channels;
+    result->bits = player.bits;
+    result->audio_sec = (double)(player.bytes / frame_size) / player.samplerate;
+    result->wall_sec = bench_median(wall, runs);
+    result->cpu_sec = bench_median(cpu, runs);
+    result->ok = result->audio_sec > 0 && result->wall_sec > 0;
+
+file_out:
+    os_cond_destroy(player.cond);
+    os_mutex_destroy(player.lock);
+}
+
+static void bench_print_json_string(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+    for (; *str != '\0'; str++) {
+        if (*str == '"' || *str == '\\')
+            fprintf(fp, "\\%c", *str);
+        else if ((unsigned char)*str < 0x20)
+            fprintf(fp, "\\u%04x", (unsigned char)*str);
+        else
+            fputc(*str, fp);
+    }
+    fputc('"', fp);
+}
+
+static int bench_write_json(const char *path, struct bench_result *results, int count,
+                            int runs, const char *budget)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        OS_LOGE(TAG, "Failed to open %s", path);
+        return -1;
+    }
+
+    fprintf(fp, "{\n  \"tool\": \"liteplayer_bench\",\n  \"format_version\": 1,\n");
+    fprintf(fp, "  \"timestamp\": %ld,\n  \"runs\": %d,\n  \"cpu_budget\": \"%s\",\n",
+            (long)time(NULL), runs, budget);
+    fprintf(fp, "  \"results\": [");
+    for (int i = 0; i < count; i++) {
+        struct bench_result *r = &results[i];
+        fprintf(fp, "%s\n    {\"label\": ", i == 0 ? "" : ",");
+        bench_print_json_string(fp, r->label);
+        fprintf(fp, ", \"url\": ");
+        bench_print_json_string(fp, r->url);
+        fprintf(fp, ", \"ok\": %s", r->ok ? "true" : "false");
+        if (r->ok) {
+            fprintf(fp, ", \"samplerate\": %d, \"channels\": %d, \"bits\": %d",
+                    r->samplerate, r->channels, r->bits);
+            fprintf(fp, ", \"audio_sec\": %.3f, \"wall_sec\": %.4f, \"cpu_sec\": %.4f",
+                    r->audio_sec, r->wall_sec, r->cpu_sec);
+            fprintf(fp, ", \"x_realtime\": %.2f, \"cpu_ms_per_audio_sec\": %.3f",
+                    r->audio_sec / r->wall_sec, r->cpu_sec * 1000 / r->audio_sec);
+            fprintf(fp, ", \"peak_rss_kb\": %ld, \"allocs\": %lld, \"alloc_bytes\": %lld",
+                    r->peak_rss_kb, r->allocs, r->alloc_bytes);
+        }
+        fprintf(fp, "}");
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    fclose(fp);
+    return 0;
+}
+
+static void bench_print_table(struct bench_result *results, int count)
+{
+    fprintf(stderr, "\n%-16s %9s %8s %10s %12s %10s %10s %12s\n",
+            "label", "format", "audio_s", "x_realtime", "cpu_ms/aud_s", "rss_kb", "allocs", "alloc_kb");
+    for (int i = 0; i < count; i++) {
+        struct bench_result *r = &results[i];
+        if (!r->ok) {
+            fprintf(stderr, "%-16s %9s\n", r->label, "FAILED");
+            continue;
+        }
+        char format[32];
+        snprintf(format, sizeof(format), "%d/%d", r->samplerate, r->channels);
+        fprintf(stderr, "%-16s %9s %8.2f %10.2f %12.3f %10ld %10lld %12lld\n",
+                r->label, format, r->audio_sec, r->audio_sec / r->wall_sec,
+                r->cpu_sec * 1000 / r->audio_sec, r->peak_rss_kb, r->allocs,
+                r->alloc_bytes < 0 ? -1 : r->alloc_bytes / 1024);
+    }
+}
+
+static void bench_usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-r runs] [-c high|medium|low] [-o result.json] [label=]file ...\n"
+            "  Decodes each file through source, parser and decoder into a null sink.\n"
+            "  Label names the case in the report, e.g. mp3_cbr=music.mp3, default is the path.\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    int runs = BENCH_RUNS_DEFAULT;
+    const char *json_path = NULL;
+    const char *budget_name = "high";
+    enum liteplayer_cpu_budget budget = LITEPLAYER_CPU_BUDGET_HIGH;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            budget_name = argv[++i];
+            if (strcmp(budget_name, "high") == 0)
+                budget = LITEPLAYER_CPU_BUDGET_HIGH;
+            else if (strcmp(budget_name, "medium") == 0)
+                budget = LITEPLAYER_CPU_BUDGET_MEDIUM;
+            else if (strcmp(budget_name, "low") == 0)
+                budget = LITEPLAYER_CPU_BUDGET_LOW;
+            else
+                break;
+        } else {
+            break;
+        }
+    }
+    if (i >= argc || argv[i][0] == '-' || runs < 1 || runs > BENCH_RUNS_MAX) {
+        bench_usage(argv[0]);
+        return -1;
+    }
+
+    int count = argc - i;
+    struct bench_result *results = calloc(count, sizeof(struct bench_result));
+    if (results == NULL)
+        return -1;
+
+    int failed = 0;
+    for (int n = 0; n < count; n++) {
+        char *arg = argv[i + n];
+        char *sep = strchr(arg, '=');
+        if (sep != NULL) {
+            *sep = '\0';
+            results[n].label = arg;
+            results[n].url = sep + 1;
+        } else {
+            results[n].label = arg;
+            results[n].url = arg;
+        }
+        bench_file(&results[n], runs, budget);
+        if (!results[n].ok)
+            failed++;
+    }
+
+    bench_print_table(results, count);
+    if (json_path != NULL && bench_write_json(json_path, results, count, runs, budget_name) != 0)
+        failed++;
+
+    free(results);
+    return failed == 0 ? 0 : -1;
+}
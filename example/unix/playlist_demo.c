@@ -154,6 +154,7 @@ static void *playlist_demo_thread(void *arg)
         .open = alsa_wrapper_open,
         .write = alsa_wrapper_write,
         .close = alsa_wrapper_close,
+        .xruns = alsa_wrapper_xruns,
     };
 #elif defined(HAVE_PORT_AUDIO_ENABLED)
     struct sink_wrapper sink_ops = {
@@ -162,6 +163,7 @@ static void *playlist_demo_thread(void *arg)
         .open = portaudio_wrapper_open,
         .write = portaudio_wrapper_write,
         .close = portaudio_wrapper_close,
+        .xruns = portaudio_wrapper_xruns,
     };
 #else
     struct sink_wrapper sink_ops = {
@@ -43,6 +43,7 @@ struct sink_wrapper {
     sink_handle_t   (*open)(int samplerate, int channels, int bits, void *priv_data);
     int             (*write)(sink_handle_t handle, char *buffer, int size);//return actual written size
     void            (*close)(sink_handle_t handle);
+    int             (*xruns)(sink_handle_t handle); // optional, underruns since open
 };
 
 #ifdef __cplusplus
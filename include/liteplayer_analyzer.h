@@ -0,0 +1,62 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _LITEPLAYER_ANALYZER_H_
+#define _LITEPLAYER_ANALYZER_H_
+
+#include "liteplayer_adapter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct liteplayer_loudness_info {
+    double integrated_lufs;     // EBU R128 integrated loudness, -70 for silence
+    double true_peak_dbtp;      // max true peak, -HUGE_VAL for digital silence
+    int    duration_ms;         // decoded duration
+};
+
+/*
+ * Decode url as fast as possible without sink and measure its loudness.
+ *
+ * It runs the same parser and decoder as liteplayer, in the calling thread
+ * plus one decoder thread at low priority, and blocks until the whole
+ * stream is decoded. Calls don't share state, so files can be analyzed
+ * concurrently from several threads. source_ops is always read synchronously.
+ */
+int liteplayer_analyze_loudness(const char *url, struct source_wrapper *source_ops,
+                                struct liteplayer_loudness_info *info);
+
+struct liteplayer_media_info {
+    int    samplerate;
+    int    channels;
+    int    bits;
+    int    duration_ms;         // 0 if the container doesn't tell it without a full scan (adts)
+};
+
+/*
+ * Parse url with the same extractors as liteplayer, without decoding.
+ *
+ * Only the headers the extractor asks for are read, so it's cheap enough
+ * to run on every file of a library scan. Like liteplayer_analyze_loudness,
+ * calls don't share state and source_ops is read synchronously.
+ */
+int liteplayer_probe_media(const char *url, struct source_wrapper *source_ops,
+                           struct liteplayer_media_info *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LITEPLAYER_ANALYZER_H_
@@ -17,6 +17,7 @@
 
 #include "liteplayer_adapter.h"
 #include "liteplayer_main.h"
+#include "liteplayer_sinksession.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,6 +44,21 @@ int listplayer_register_source_wrapper(listplayer_handle_t handle, struct source
 
 int listplayer_register_sink_wrapper(listplayer_handle_t handle, struct sink_wrapper *wrapper);
 
+// Share one opened sink between players, the session is not owned by listplayer
+int listplayer_register_sink_session(listplayer_handle_t handle, sink_session_handle_t session);
+
+// Cache parsed codec info and seek index of local files under dir, NULL to disable
+int listplayer_set_index_cache_dir(listplayer_handle_t handle, const char *dir);
+
+// Fixed sink format for all tracks, see liteplayer_set_sink_format()
+int listplayer_set_sink_format(listplayer_handle_t handle, int samplerate, int channels, int bits,
+                               enum liteplayer_resample_quality quality);
+
+// Software volume and track gain in any state, see liteplayer_set_volume()
+int listplayer_set_volume(listplayer_handle_t handle, float volume);
+
+int listplayer_set_track_gain(listplayer_handle_t handle, float gain_db);
+
 int listplayer_register_state_listener(listplayer_handle_t handle, liteplayer_state_cb listener, void *listener_priv);
 
 int listplayer_set_data_source(listplayer_handle_t handle, const char *url);
@@ -71,6 +87,9 @@ int listplayer_get_position(listplayer_handle_t handle, int *msec);
 
 int listplayer_get_duration(listplayer_handle_t handle, int *msec);
 
+// Counters of the current track, see liteplayer_get_stats()
+int listplayer_get_stats(listplayer_handle_t handle, struct liteplayer_stats *stats);
+
 void listplayer_destroy(listplayer_handle_t handle);
 
 #ifdef __cplusplus
@@ -34,6 +34,42 @@ enum liteplayer_state {
     LITEPLAYER_ERROR           = 0xFF,
 };
 
+enum liteplayer_resample_quality {
+    LITEPLAYER_RESAMPLE_FAST   = 0x00, // fixed-point polyphase filter
+    LITEPLAYER_RESAMPLE_HIGH   = 0x01, // float polyphase filter, longer and interpolated
+};
+
+enum liteplayer_cpu_budget {
+    LITEPLAYER_CPU_BUDGET_HIGH    = 0x00, // full HE-AAC decoding, SBR and PS
+    LITEPLAYER_CPU_BUDGET_MEDIUM  = 0x01, // downsampled SBR, half the bandwidth, HE-AACv2 as mono
+    LITEPLAYER_CPU_BUDGET_LOW     = 0x02, // HE-AAC decoded as plain AAC, no SBR nor PS
+};
+
+// Upper bounds in ms of the sink write latency histogram, the last bucket is open
+#define LITEPLAYER_STATS_LATENCY_BOUNDS_MS  { 1, 2, 5, 10, 20, 50, 100 }
+#define LITEPLAYER_STATS_LATENCY_BUCKETS    8
+
+// Counters of the current track, cleared when the pipeline is created. They are
+// written by the decoder thread only and read without locking, so sampling them
+// often is cheap, but fields of one snapshot may be a period apart
+struct liteplayer_stats {
+    long long   bytes_read;         // encoded bytes consumed by the decoder
+    long long   bytes_decoded;      // pcm bytes out of the decoder, before resampling
+    long long   frames_decoded;
+    long long   bytes_written;      // pcm bytes taken by the sink
+    int         input_timeouts;     // decoder waited too long for input
+    int         ringbuf_size;       // source ringbuf, fill is sampled once per period
+    int         ringbuf_fill_min;
+    int         ringbuf_fill_avg;
+    int         ringbuf_fill_max;
+    int         sink_writes;
+    int         sink_latency_max_us;
+    int         sink_latency_hist[LITEPLAYER_STATS_LATENCY_BUCKETS];
+    int         xruns;              // underruns since the sink was opened, -1 if not reported
+    long long   decode_cpu_us;      // decoder thread cpu spent decoding, -1 if unsupported
+    int         first_audio_ms;     // liteplayer_start() to the first pcm written, -1 before that
+};
+
 typedef int (*liteplayer_state_cb)(enum liteplayer_state state, int errcode, void *priv);
 
 typedef struct liteplayer *liteplayer_handle_t;
@@ -46,6 +82,26 @@ int liteplayer_register_sink_wrapper(liteplayer_handle_t handle, struct sink_wra
 
 int liteplayer_register_state_listener(liteplayer_handle_t handle, liteplayer_state_cb listener, void *listener_priv);
 
+// Cache parsed codec info and seek index of local files under dir, NULL to disable
+int liteplayer_set_index_cache_dir(liteplayer_handle_t handle, const char *dir);
+
+// Open sink with a fixed pcm format, decoded pcm is resampled and up/down-mixed to it,
+// so the sink isn't reconfigured when tracks differ. Zero keeps the decoder's value
+int liteplayer_set_sink_format(liteplayer_handle_t handle, int samplerate, int channels, int bits,
+                               enum liteplayer_resample_quality quality);
+
+// Trade decoding quality for cpu, only HE-AAC streams are affected for now.
+// Per frame on x86, MEDIUM saves 3-25% of HIGH and LOW needs 4-8x less cpu
+int liteplayer_set_cpu_budget(liteplayer_handle_t handle, enum liteplayer_cpu_budget budget);
+
+// Software volume in [0.0, 1.0], can be set in any state, a change is ramped in
+// from the next period written to sink
+int liteplayer_set_volume(liteplayer_handle_t handle, float volume);
+
+// Gain of the current track in dB within +/-18, e.g. from ReplayGain or loudness
+// normalization, applied on top of volume like liteplayer_set_volume()
+int liteplayer_set_track_gain(liteplayer_handle_t handle, float gain_db);
+
 int liteplayer_set_data_source(liteplayer_handle_t handle, const char *url);
 
 int liteplayer_prepare(liteplayer_handle_t handle);
@@ -68,6 +124,8 @@ int liteplayer_get_position(liteplayer_handle_t handle, int *msec);
 
 int liteplayer_get_duration(liteplayer_handle_t handle, int *msec);
 
+int liteplayer_get_stats(liteplayer_handle_t handle, struct liteplayer_stats *stats);
+
 void liteplayer_destroy(liteplayer_handle_t handle);
 
 #ifdef __cplusplus
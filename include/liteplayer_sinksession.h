@@ -0,0 +1,74 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _LITEPLAYER_SINKSESSION_H_
+#define _LITEPLAYER_SINKSESSION_H_
+
+#include "liteplayer_adapter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sink session keeps the output device open across consecutive tracks.
+ *
+ * It wraps a real sink_wrapper and exposes another sink_wrapper that can be
+ * registered to one or more players. Closing from the player side only drops
+ * a reference, the device is closed and reopened only when a track with a
+ * different samplerate/channels/bits is opened, or when the session is
+ * explicitly closed/destroyed. Set a fixed sink format on the players
+ * (liteplayer_set_sink_format) to avoid reopening at all.
+ *
+ * With crossfade enabled, a player that opens the session while another
+ * one is playing is the next track: its pcm is buffered until
+ * DEFAULT_CROSSFADE_PREBUFFER_MS is ready, then mixed into what the
+ * playing one writes until the fade is over. The outgoing player is
+ * dropped (its writes are discarded) and the incoming one takes over the
+ * device. Both must use the same format, a next track in another format
+ * waits for the playing one to close, i.e. a hard transition. A next track
+ * opened before the previous crossfade has fully faded in waits for it.
+ */
+typedef struct sink_session *sink_session_handle_t;
+
+#define SINK_SESSION_CROSSFADE_MAX_MS   ( 12000 )
+
+enum sink_session_fade_curve {
+    SINK_SESSION_FADE_LINEAR = 0,
+    SINK_SESSION_FADE_EQUAL_POWER,
+};
+
+sink_session_handle_t sink_session_create(struct sink_wrapper *wrapper);
+
+// Fill a sink_wrapper whose priv_data points to the session, register it to players
+int sink_session_get_wrapper(sink_session_handle_t session, struct sink_wrapper *wrapper);
+
+// Crossfade tracks that overlap for duration_ms, clamped to [0, SINK_SESSION_CROSSFADE_MAX_MS],
+// 0 disables it. Takes effect from the next track opened
+int sink_session_set_crossfade(sink_session_handle_t session, int duration_ms, enum sink_session_fade_curve curve);
+
+// Drop the next track of a pending or running crossfade, the playing track goes on at full gain.
+// The next player blocks while its buffer is full, so call it before stopping that player
+void sink_session_cancel_crossfade(sink_session_handle_t session);
+
+// Close the underlying sink now (e.g. long idle), it will be reopened on next write
+void sink_session_close(sink_session_handle_t session);
+
+void sink_session_destroy(sink_session_handle_t session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LITEPLAYER_SINKSESSION_H_
@@ -39,10 +39,15 @@ ttsplayer_handle_t ttsplayer_create(struct ttsplayer_cfg *cfg);
 
 int ttsplayer_register_sink_wrapper(ttsplayer_handle_t handle, struct sink_wrapper *wrapper);
 
+// Fixed sink format, e.g. match the music player sharing the same sink session
+int ttsplayer_set_sink_format(ttsplayer_handle_t handle, int samplerate, int channels, int bits,
+                              enum liteplayer_resample_quality quality);
+
 int ttsplayer_register_state_listener(ttsplayer_handle_t handle, liteplayer_state_cb listener, void *listener_priv);
 
 int ttsplayer_prepare_async(ttsplayer_handle_t handle);
 
+// Stream can be mp3, aac (adts) or ogg opus, codec is detected from the first bytes
 int ttsplayer_write(ttsplayer_handle_t handle, char *buffer, int size, bool final);
 
 int ttsplayer_start(ttsplayer_handle_t handle);
@@ -0,0 +1,224 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "audio_crossfade/crossfade.h"
+
+#if !defined(CROSSFADE_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64)
+#define CROSSFADE_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define CROSSFADE_USE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#define TAG "[liteplayer]crossfade"
+
+// Frames mixed with the same pair of gains
+#define CROSSFADE_BLOCK_FRAMES  32
+
+// S16 gains are Q14, so a*ga + b*gb fits in int32 with headroom
+#define CROSSFADE_S16_SHIFT     14
+
+#define CROSSFADE_CHANNELS_MAX  8
+
+struct crossfade {
+    struct crossfade_cfg cfg;
+    int         sample_size;
+    long long   fade_frames;
+    long long   position;       // frames mixed so far
+};
+
+// Stands in for a missing input, one block of the widest format
+static const int32_t crossfade_silence[CROSSFADE_BLOCK_FRAMES * CROSSFADE_CHANNELS_MAX];
+
+static inline int16_t crossfade_to_s16(float gain)
+{
+    return (int16_t)lrintf(gain * (1 << CROSSFADE_S16_SHIFT));
+}
+
+static void crossfade_mix_s16(const int16_t *a, const int16_t *b, int16_t *out, int count,
+                              int16_t ga, int16_t gb)
+{
+    int i = 0;
+#if defined(CROSSFADE_USE_SSE2)
+    // Interleave a and b so that madd gives a*ga + b*gb in one instruction
+    const __m128i vg = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)gb << 16) | (uint16_t)ga));
+    const __m128i round = _mm_set1_epi32(1 << (CROSSFADE_S16_SHIFT - 1));
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i p0 = _mm_madd_epi16(_mm_unpacklo_epi16(x, y), vg);
+        __m128i p1 = _mm_madd_epi16(_mm_unpackhi_epi16(x, y), vg);
+        p0 = _mm_srai_epi32(_mm_add_epi32(p0, round), CROSSFADE_S16_SHIFT);
+        p1 = _mm_srai_epi32(_mm_add_epi32(p1, round), CROSSFADE_S16_SHIFT);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(p0, p1));
+    }
+#elif defined(CROSSFADE_USE_NEON)
+    const int16x4_t vga = vdup_n_s16(ga);
+    const int16x4_t vgb = vdup_n_s16(gb);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(a + i);
+        int16x8_t y = vld1q_s16(b + i);
+        int32x4_t p0 = vmlal_s16(vmull_s16(vget_low_s16(x), vga), vget_low_s16(y), vgb);
+        int32x4_t p1 = vmlal_s16(vmull_s16(vget_high_s16(x), vga), vget_high_s16(y), vgb);
+        p0 = vrshrq_n_s32(p0, CROSSFADE_S16_SHIFT);
+        p1 = vrshrq_n_s32(p1, CROSSFADE_S16_SHIFT);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1)));
+    }
+#endif
+    for (; i < count; i++) {
+        int32_t v = ((int32_t)a[i] * ga + (int32_t)b[i] * gb + (1 << (CROSSFADE_S16_SHIFT - 1)))
+                    >> CROSSFADE_S16_SHIFT;
+        if (v > INT16_MAX)
+            v = INT16_MAX;
+        else if (v < INT16_MIN)
+            v = INT16_MIN;
+        out[i] = (int16_t)v;
+    }
+}
+
+// Float multiply-add rounded to nearest, the same in C, SSE2 and NEON
+static void crossfade_mix_s32(const int32_t *a, const int32_t *b, int32_t *out, int count,
+                              float ga, float gb)
+{
+    int i = 0;
+#if defined(CROSSFADE_USE_SSE2)
+    const __m128 vga = _mm_set1_ps(ga);
+    const __m128 vgb = _mm_set1_ps(gb);
+    const __m128 limit = _mm_set1_ps(2147483648.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(a + i))), vga);
+        __m128 y = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(b + i))), vgb);
+        __m128 v = _mm_add_ps(x, y);
+        // Out of range converts to INT32_MIN, flip it to INT32_MAX when positive
+        __m128i r = _mm_xor_si128(_mm_cvtps_epi32(v), _mm_castps_si128(_mm_cmpge_ps(v, limit)));
+        _mm_storeu_si128((__m128i *)(out + i), r);
+    }
+#elif defined(CROSSFADE_USE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(a + i)), ga);
+        float32x4_t y = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(b + i)), gb);
+        vst1q_s32(out + i, vcvtnq_s32_f32(vaddq_f32(x, y)));
+    }
+#endif
+    for (; i < count; i++) {
+        float x = (float)a[i] * ga;
+        float y = (float)b[i] * gb;
+        float v = x + y;
+        if (v >= 2147483648.0f)
+            out[i] = INT32_MAX;
+        else if (v <= -2147483648.0f)
+            out[i] = INT32_MIN;
+        else
+            out[i] = (int32_t)lrintf(v);
+    }
+}
+
+static void crossfade_gains(crossfade_handle_t xf, float *gout, float *gin)
+{
+    float t = (float)((double)xf->position / xf->fade_frames);
+    if (xf->cfg.curve == CROSSFADE_CURVE_EQUAL_POWER) {
+        *gout = cosf(t * (float)M_PI_2);
+        *gin = sinf(t * (float)M_PI_2);
+    } else {
+        *gout = 1.0f - t;
+        *gin = t;
+    }
+}
+
+crossfade_handle_t crossfade_create(struct crossfade_cfg *cfg)
+{
+    if (cfg == NULL || cfg->samplerate <= 0 || cfg->channels <= 0 || cfg->channels > CROSSFADE_CHANNELS_MAX ||
+        (cfg->bits != 16 && cfg->bits != 32) || cfg->duration_ms < 0) {
+        OS_LOGE(TAG, "Invalid crossfade config");
+        return NULL;
+    }
+
+    crossfade_handle_t xf = audio_calloc(1, sizeof(struct crossfade));
+    AUDIO_MEM_CHECK(TAG, xf, return NULL);
+
+    memcpy(&xf->cfg, cfg, sizeof(struct crossfade_cfg));
+    xf->sample_size = cfg->bits / 8;
+    xf->fade_frames = (long long)cfg->samplerate * cfg->duration_ms / 1000;
+    return xf;
+}
+
+void crossfade_process(crossfade_handle_t handle, const char *outgoing, const char *incoming,
+                       char *out, int bytes)
+{
+    if (handle == NULL || out == NULL || bytes <= 0)
+        return;
+
+    crossfade_handle_t xf = handle;
+    int channels = xf->cfg.channels;
+    int frames = bytes / (xf->sample_size * channels);
+
+    while (frames > 0 && xf->position < xf->fade_frames) {
+        int n = CROSSFADE_BLOCK_FRAMES;
+        if (n > xf->fade_frames - xf->position)
+            n = (int)(xf->fade_frames - xf->position);
+        if (n > frames)
+            n = frames;
+
+        float gout, gin;
+        crossfade_gains(xf, &gout, &gin);
+        const char *a = outgoing != NULL ? outgoing : (const char *)crossfade_silence;
+        const char *b = incoming != NULL ? incoming : (const char *)crossfade_silence;
+        if (xf->cfg.bits == 16)
+            crossfade_mix_s16((const int16_t *)a, (const int16_t *)b, (int16_t *)out, n * channels,
+                              crossfade_to_s16(gout), crossfade_to_s16(gin));
+        else
+            crossfade_mix_s32((const int32_t *)a, (const int32_t *)b, (int32_t *)out, n * channels,
+                              gout, gin);
+
+        int step = n * channels * xf->sample_size;
+        if (outgoing != NULL)
+            outgoing += step;
+        if (incoming != NULL)
+            incoming += step;
+        out += step;
+        frames -= n;
+        xf->position += n;
+    }
+
+    if (frames > 0) {
+        int remain = frames * channels * xf->sample_size;
+        if (incoming == NULL)
+            memset(out, 0, remain);
+        else if (incoming != out)
+            memmove(out, incoming, remain);
+    }
+}
+
+bool crossfade_is_done(crossfade_handle_t handle)
+{
+    return handle == NULL || handle->position >= handle->fade_frames;
+}
+
+void crossfade_destroy(crossfade_handle_t handle)
+{
+    if (handle == NULL)
+        return;
+    audio_free(handle);
+}
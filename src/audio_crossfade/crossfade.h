@@ -0,0 +1,61 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _CROSSFADE_H_
+#define _CROSSFADE_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum crossfade_curve {
+    CROSSFADE_CURVE_LINEAR = 0,         // gains sum to 1, dips ~3dB midway on uncorrelated tracks
+    CROSSFADE_CURVE_EQUAL_POWER,        // cos/sin, powers sum to 1
+};
+
+struct crossfade_cfg {
+    int samplerate;
+    int channels;
+    int bits;                           // 16 or 32, interleaved s16le/s32le
+    int duration_ms;
+    enum crossfade_curve curve;
+};
+
+/*
+ * Crossfade mixes a fading out and a fading in stream of the same format
+ * with saturation. The gains follow the curve per block of a few frames,
+ * so the multiply-add runs on SSE2/NEON with one gain pair per block.
+ */
+typedef struct crossfade *crossfade_handle_t;
+
+crossfade_handle_t crossfade_create(struct crossfade_cfg *cfg);
+
+// Mix bytes of outgoing and incoming pcm into out, either input may be NULL for
+// silence and out may be the same buffer as an input. Once the fade is done,
+// outgoing is dropped and incoming is copied unchanged
+void crossfade_process(crossfade_handle_t handle, const char *outgoing, const char *incoming,
+                       char *out, int bytes);
+
+// True when the incoming stream has reached full gain
+bool crossfade_is_done(crossfade_handle_t handle);
+
+void crossfade_destroy(crossfade_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -159,6 +159,8 @@ audio_element_handle_t aac_decoder_init(struct aac_decoder_cfg *config)
     audio_element_handle_t el = audio_element_init(&cfg);
     AUDIO_MEM_CHECK(TAG, el, goto aac_init_error);
     decoder->aac_info = config->aac_info;
+    decoder->decode_mode = config->decode_mode;
+    decoder->ps_to_mono = config->ps_to_mono;
     decoder->el = el;
     audio_element_setdata(el, decoder);
 
@@ -42,6 +42,15 @@ extern "C" {
  */
 #define AAC_DECODER_OUTPUT_BUFFER_SIZE   (4096 * AAC_MAX_NCHANS * sizeof(short))
 
+/**
+ * @brief      HE-AAC decoding modes, from the most to the least expensive
+ */
+enum aac_decode_mode {
+    AAC_DECODE_FULL            = 0x00, /*!< SBR at twice the core rate, full bandwidth */
+    AAC_DECODE_DOWNSAMPLED_SBR = 0x01, /*!< SBR synthesized at the core rate, half the bandwidth */
+    AAC_DECODE_CORE_ONLY       = 0x02, /*!< SBR and PS skipped, core AAC at its own rate */
+};
+
 /**
  * @brief      AAC Decoder configurations
  */
@@ -49,6 +58,8 @@ struct aac_decoder_cfg {
     int   task_stack;     /*!< Task stack size */
     int   task_prio;      /*!< Task priority (based on freeRTOS priority) */
     struct aac_info *aac_info;
+    enum aac_decode_mode decode_mode; /*!< No effect on plain AAC-LC streams */
+    bool  ps_to_mono;     /*!< Ignore parametric stereo, HE-AACv2 is played as mono */
 };
 
 #define AAC_DECODER_TASK_STACK          (4 * 1024)
@@ -57,6 +68,8 @@ struct aac_decoder_cfg {
 #define DEFAULT_AAC_DECODER_CONFIG() {\
     .task_stack     = AAC_DECODER_TASK_STACK,\
     .task_prio      = AAC_DECODER_TASK_PRIO,\
+    .decode_mode    = AAC_DECODE_FULL,\
+    .ps_to_mono     = false,\
 }
 
 struct aac_buf_in {
@@ -78,6 +91,8 @@ struct aac_decoder {
     struct aac_buf_in       buf_in;
     struct aac_buf_out      buf_out;
     struct aac_info        *aac_info;
+    enum aac_decode_mode    decode_mode;
+    bool                    ps_to_mono;
     bool                    parsed_header;
     bool                    seek_mode;
 };
@@ -30,6 +30,24 @@ struct pvaac_wrapper {
     void *pvaac_buffer;
 };
 
+static void pvaac_wrapper_setup(struct pvaac_wrapper *wrap, enum aac_decode_mode mode, bool ps_to_mono)
+{
+    wrap->pvaac_config.outputFormat = OUTPUTFORMAT_16PCM_INTERLEAVED;
+#if defined(LITEPLAYER_CONFIG_AAC_PLUS)
+    // Core only: SBR/PS elements are parsed but skipped, output at the core rate.
+    // Downsampled SBR: 32 bands QMF synthesis, output at the core rate too.
+    wrap->pvaac_config.aacPlusEnabled = mode != AAC_DECODE_CORE_ONLY;
+    wrap->pvaac_config.aacPlusDownSampledSbr = mode == AAC_DECODE_DOWNSAMPLED_SBR;
+    wrap->pvaac_config.aacPlusDisablePS = ps_to_mono;
+#else
+    (void)mode;
+    (void)ps_to_mono;
+#endif
+    // The software decoder doesn't properly support mono output on
+    // AACplus files. Always output stereo.
+    wrap->pvaac_config.desiredChannels = 2;
+}
+
 static int aac_adts_read(aac_decoder_handle_t decoder)
 {
     char *data = decoder->buf_in.data;
@@ -94,7 +112,8 @@ fill_data:
 
     decoder->buf_in.bytes_read -= wrap->pvaac_config.inputBufferUsedLength;
     decoder->buf_out.bytes_remain =
-        wrap->pvaac_config.frameLength * sizeof(short) * wrap->pvaac_config.desiredChannels;
+        wrap->pvaac_config.frameLength * sizeof(short) * wrap->pvaac_config.desiredChannels *
+        wrap->pvaac_config.aacPlusUpsamplingFactor;
 
     if (!decoder->parsed_header) {
         audio_element_info_t info = {0};
@@ -118,13 +137,7 @@ int aac_wrapper_init(aac_decoder_handle_t decoder)
         return -1;
     }
 
-    wrap->pvaac_config.outputFormat = OUTPUTFORMAT_16PCM_INTERLEAVED;
-#if defined(LITEPLAYER_CONFIG_AAC_PLUS)
-    wrap->pvaac_config.aacPlusEnabled = 1;
-#endif
-    // The software decoder doesn't properly support mono output on
-    // AACplus files. Always output stereo.
-    wrap->pvaac_config.desiredChannels = 2;
+    pvaac_wrapper_setup(wrap, decoder->decode_mode, decoder->ps_to_mono);
 
     uint32_t memRequirements = PVMP4AudioDecoderGetMemRequirements();
     wrap->pvaac_buffer = audio_malloc(memRequirements);
@@ -217,7 +230,8 @@ int m4a_wrapper_run(m4a_decoder_handle_t decoder)
     }
 
     decoder->buf_out.bytes_remain =
-        wrap->pvaac_config.frameLength * sizeof(short) * wrap->pvaac_config.desiredChannels;
+        wrap->pvaac_config.frameLength * sizeof(short) * wrap->pvaac_config.desiredChannels *
+        wrap->pvaac_config.aacPlusUpsamplingFactor;
 
     if (!decoder->parsed_header) {
         audio_element_info_t info = {0};
@@ -241,13 +255,7 @@ int m4a_wrapper_init(m4a_decoder_handle_t decoder)
         return -1;
     }
 
-    wrap->pvaac_config.outputFormat = OUTPUTFORMAT_16PCM_INTERLEAVED;
-#if defined(LITEPLAYER_CONFIG_AAC_PLUS)
-    wrap->pvaac_config.aacPlusEnabled = 1;
-#endif
-    // The software decoder doesn't properly support mono output on
-    // AACplus files. Always output stereo.
-    wrap->pvaac_config.desiredChannels = 2;
+    pvaac_wrapper_setup(wrap, decoder->decode_mode, decoder->ps_to_mono);
 
     uint32_t memRequirements = PVMP4AudioDecoderGetMemRequirements();
     wrap->pvaac_buffer = audio_malloc(memRequirements);
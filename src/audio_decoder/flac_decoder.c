@@ -0,0 +1,445 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_element.h"
+#include "esp_adf/audio_common.h"
+#include "audio_extractor/flac_extractor.h"
+#include "audio_decoder/flac_decoder.h"
+
+#define DR_FLAC_IMPLEMENTATION
+#define DR_FLAC_NO_STDIO
+#define DR_FLAC_NO_OGG
+#include "dr_libs/dr_flac.h"
+
+#define TAG "[liteplayer]flac_decoder"
+
+#define FLAC_DECODER_INPUT_TIMEOUT_MAX  200 // ms
+#define FLAC_DECODER_PREFERED_PEROID_MS 20 // ms
+#define FLAC_DECODER_READ_RETRY_MAX     10
+// Upper bound of the input buffer, frames bigger than it are read in blocking mode
+#define FLAC_DECODER_FRAME_BUFFER_MAX   (64 * 1024)
+#define FLAC_DECODER_FRAME_HEADER_MAX   (64)
+
+struct flac_buf_in {
+    char *data;
+    int  size;
+    int  threshold;      // bytes buffered before decoding a frame, so drflac never waits mid-frame
+    int  bytes_read;     // bytes that have read
+    int  offset;         // offset of the bytes not yet fed to drflac
+    bool eof;            // if end of stream
+};
+
+struct flac_buf_out {
+    char *data;
+    int  size;
+    int  bytes_remain;   // bytes that remained to write
+    int  bytes_written;  // bytes that have written
+};
+
+struct flac_decoder {
+    audio_element_handle_t  el;
+    drflac                 *drflac;
+    struct flac_buf_in      buf_in;
+    struct flac_buf_out     buf_out;
+    bool                    parsed_header;
+    bool                    filled_header;
+    bool                    seek_pending;
+    drflac_uint64           seek_sample;
+    struct flac_info       *flac_info;
+    int                     sink_bits;
+    drflac_uint64           prefered_frames;
+    drflac_uint64           min_frames;     // samples read at the start of a FLAC frame, never past its end
+};
+typedef struct flac_decoder *flac_decoder_handle_t;
+
+static void *drflac_on_malloc(size_t sz, void* pUserData)
+{
+    return audio_malloc(sz);
+}
+
+static void *drflac_on_realloc(void *p, size_t sz, void *pUserData)
+{
+    return audio_realloc(p, sz);
+}
+
+static void drflac_on_free(void *p, void *pUserData)
+{
+    audio_free(p);
+}
+
+static drflac_allocation_callbacks drflac_allocation = {
+    .pUserData = NULL,
+    .onMalloc = drflac_on_malloc,
+    .onRealloc = drflac_on_realloc,
+    .onFree = drflac_on_free,
+};
+
+static int flac_fill_input(flac_decoder_handle_t decoder, int wanted)
+{
+    struct flac_buf_in *in = &decoder->buf_in;
+
+    if (in->bytes_read >= wanted || in->eof)
+        return AEL_IO_OK;
+
+    if (in->offset > 0) {
+        memmove(in->data, in->data+in->offset, in->bytes_read);
+        in->offset = 0;
+    }
+
+    while (in->bytes_read < wanted) {
+        int ret = audio_element_input(decoder->el, in->data+in->bytes_read, in->size-in->bytes_read);
+        if (ret > 0) {
+            in->bytes_read += ret;
+        } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
+            in->eof = true;
+            break;
+        } else {
+            return ret;
+        }
+    }
+    return AEL_IO_OK;
+}
+
+static size_t drflac_on_read(void *pUserData, void *pBufferOut, size_t bytesToRead)
+{
+    flac_decoder_handle_t decoder = (flac_decoder_handle_t)pUserData;
+    struct flac_buf_in *in = &decoder->buf_in;
+
+    // drflac takes a short read as the end of stream, so wait for the bytes here.
+    // Rarely happens, frames are buffered up to threshold before decoding
+    if (bytesToRead > in->bytes_read && !in->eof) {
+        int retry = 0;
+        while (flac_fill_input(decoder, bytesToRead) == AEL_IO_TIMEOUT) {
+            if (++retry >= FLAC_DECODER_READ_RETRY_MAX) {
+                OS_LOGE(TAG, "Insufficient data: %d/%d", (int)bytesToRead, in->bytes_read);
+                break;
+            }
+        }
+    }
+
+    if (bytesToRead > in->bytes_read)
+        bytesToRead = in->bytes_read;
+    if (bytesToRead > 0) {
+        memcpy(pBufferOut, &in->data[in->offset], bytesToRead);
+        in->offset += bytesToRead;
+        in->bytes_read -= bytesToRead;
+    }
+    return bytesToRead;
+}
+
+static drflac_bool32 drflac_on_seek(void *pUserData, int offset, drflac_seek_origin origin)
+{
+    // Stream is fed sequentially, seeking is done by reopening source at seek point
+    return DRFLAC_FALSE;
+}
+
+static int drflac_open_stream(flac_decoder_handle_t decoder)
+{
+    struct flac_buf_in *in = &decoder->buf_in;
+
+    if (!decoder->filled_header) {
+        memcpy(in->data, decoder->flac_info->header_buff, FLAC_HEADER_SIZE);
+        in->bytes_read = FLAC_HEADER_SIZE;
+        in->offset = 0;
+        decoder->filled_header = true;
+    }
+
+    int ret = flac_fill_input(decoder, in->threshold);
+    if (ret != AEL_IO_OK)
+        return ret;
+    if (in->eof && in->bytes_read <= FLAC_HEADER_SIZE) {
+        OS_LOGV(TAG, "FLAC stream is empty");
+        return AEL_IO_DONE;
+    }
+
+    decoder->drflac = drflac_open(drflac_on_read, drflac_on_seek, (void *)decoder, &drflac_allocation);
+    if (decoder->drflac == NULL) {
+        OS_LOGE(TAG, "Failed to open drflac decoder");
+        return AEL_PROCESS_FAIL;
+    }
+
+    if (!decoder->parsed_header) {
+        audio_element_info_t info = {0};
+        info.samplerate = decoder->drflac->sampleRate;
+        info.channels   = decoder->drflac->channels;
+        info.bits       = decoder->sink_bits;
+        OS_LOGV(TAG,"Found flac header: SR=%d, CH=%d, BITS=%d", info.samplerate, info.channels, info.bits);
+        audio_element_setinfo(decoder->el, &info);
+        audio_element_report_info(decoder->el);
+        decoder->parsed_header = true;
+    }
+    return AEL_IO_OK;
+}
+
+// First sample of the current FLAC frame, from its header
+static drflac_uint64 drflac_frame_first_sample(drflac *pFlac)
+{
+    drflac_uint64 first = pFlac->currentFLACFrame.header.pcmFrameNumber;
+    if (first == 0)
+        first = (drflac_uint64)pFlac->currentFLACFrame.header.flacFrameNumber * pFlac->maxBlockSizeInPCMFrames;
+    return first;
+}
+
+static drflac_uint64 drflac_read_frames(flac_decoder_handle_t decoder, drflac_uint64 frames)
+{
+    drflac *pFlac = decoder->drflac;
+#if defined(LITEPLAYER_CONFIG_SINK_FIXED_S16LE)
+    return drflac_read_pcm_frames_s16(pFlac, frames, (drflac_int16 *)(decoder->buf_out.data));
+#else
+    if (decoder->sink_bits == 16)
+        return drflac_read_pcm_frames_s16(pFlac, frames, (drflac_int16 *)(decoder->buf_out.data));
+    return drflac_read_pcm_frames_s32(pFlac, frames, (drflac_int32 *)(decoder->buf_out.data));
+#endif
+}
+
+static int drflac_run(flac_decoder_handle_t decoder)
+{
+    int ret = AEL_IO_OK;
+
+    if (decoder->drflac == NULL) {
+        ret = drflac_open_stream(decoder);
+        if (ret != AEL_IO_OK)
+            return ret;
+    }
+
+#if !defined(LITEPLAYER_CONFIG_SINK_FIXED_S16LE)
+    if (decoder->sink_bits != 16 && decoder->sink_bits != 32) {
+        OS_LOGE(TAG, "Unsupported sample bits: %d", decoder->sink_bits);
+        return AEL_PROCESS_FAIL;
+    }
+#endif
+
+    drflac *pFlac = decoder->drflac;
+    int frame_bytes = pFlac->channels * (decoder->sink_bits/8);
+    drflac_uint64 out_frames;
+    do {
+        // drflac decodes the next FLAC frame when the current one is used up. Buffer it
+        // first, and read no more than the smallest block so the read stays in that frame
+        drflac_uint64 in_frames = pFlac->currentFLACFrame.pcmFramesRemaining;
+        if (in_frames == 0) {
+            ret = flac_fill_input(decoder, decoder->buf_in.threshold);
+            if (ret != AEL_IO_OK)
+                return ret;
+            in_frames = decoder->min_frames;
+        }
+        if (in_frames > decoder->prefered_frames)
+            in_frames = decoder->prefered_frames;
+
+        out_frames = drflac_read_frames(decoder, in_frames);
+        if (out_frames == 0) {
+            OS_LOGV(TAG, "FLAC frame end");
+            return AEL_IO_DONE;
+        }
+
+        if (decoder->seek_pending) {
+            // Seek point is at or before the target, drop the samples in between
+            drflac_uint64 end = drflac_frame_first_sample(pFlac) +
+                                pFlac->currentFLACFrame.header.blockSizeInPCMFrames -
+                                pFlac->currentFLACFrame.pcmFramesRemaining;
+            drflac_uint64 first = end - out_frames;
+            if (end <= decoder->seek_sample) {
+                out_frames = 0;
+            } else {
+                if (first < decoder->seek_sample) {
+                    drflac_uint64 skip_frames = decoder->seek_sample - first;
+                    out_frames -= skip_frames;
+                    memmove(decoder->buf_out.data, decoder->buf_out.data + skip_frames*frame_bytes,
+                            out_frames*frame_bytes);
+                }
+                OS_LOGV(TAG, "Seek done, target sample=%llu, first sample=%llu",
+                        (unsigned long long)decoder->seek_sample, (unsigned long long)first);
+                decoder->seek_pending = false;
+            }
+        }
+    } while (out_frames == 0);
+
+    decoder->buf_out.bytes_remain = out_frames * frame_bytes;
+    return 0;
+}
+
+static void flac_decoder_reset(flac_decoder_handle_t decoder)
+{
+    if (decoder->drflac != NULL) {
+        drflac_close(decoder->drflac);
+        decoder->drflac = NULL;
+    }
+    decoder->filled_header = false;
+    decoder->buf_in.bytes_read = 0;
+    decoder->buf_in.offset = 0;
+    decoder->buf_in.eof = false;
+    decoder->buf_out.bytes_remain = 0;
+    decoder->buf_out.bytes_written = 0;
+}
+
+static esp_err_t flac_decoder_destroy(audio_element_handle_t self)
+{
+    flac_decoder_handle_t decoder = (flac_decoder_handle_t)audio_element_getdata(self);
+    OS_LOGV(TAG, "Destroy flac decoder");
+    if (decoder->drflac != NULL)
+        drflac_close(decoder->drflac);
+    audio_free(decoder->buf_in.data);
+    audio_free(decoder->buf_out.data);
+    audio_free(decoder);
+    return ESP_OK;
+}
+
+static esp_err_t flac_decoder_open(audio_element_handle_t self)
+{
+    OS_LOGV(TAG, "Open flac decoder");
+    return ESP_OK;
+}
+
+static esp_err_t flac_decoder_close(audio_element_handle_t self)
+{
+    flac_decoder_handle_t decoder = (flac_decoder_handle_t)audio_element_getdata(self);
+
+    if (AEL_STATE_PAUSED != audio_element_get_state(self)) {
+        OS_LOGV(TAG, "Close drflac decoder");
+        flac_decoder_reset(decoder);
+        decoder->parsed_header = false;
+        decoder->seek_pending = false;
+
+        audio_element_info_t info = {0};
+        audio_element_getinfo(self, &info);
+        info.byte_pos = 0;
+        info.total_bytes = 0;
+        audio_element_setinfo(self, &info);
+    }
+    return ESP_OK;
+}
+
+static int flac_decoder_process(audio_element_handle_t self, char *in_buffer, int in_len)
+{
+    int byte_write = 0;
+    int ret = AEL_IO_FAIL;
+    flac_decoder_handle_t decoder = (flac_decoder_handle_t)audio_element_getdata(self);
+
+    if (decoder->buf_out.bytes_remain > 0) {
+        /* Output buffer have remain data */
+        byte_write = audio_element_output(self,
+                        decoder->buf_out.data+decoder->buf_out.bytes_written,
+                        decoder->buf_out.bytes_remain);
+    } else {
+        /* More data need to be wrote */
+        ret = drflac_run(decoder);
+        if (ret < 0) {
+            if (ret == AEL_IO_TIMEOUT) {
+                OS_LOGW(TAG, "drflac_run AEL_IO_TIMEOUT");
+            } else if (ret != AEL_IO_DONE) {
+                OS_LOGE(TAG, "drflac_run failed:%d", ret);
+            }
+            return ret;
+        }
+
+        decoder->buf_out.bytes_written = 0;
+        byte_write = audio_element_output(self,
+                        decoder->buf_out.data,
+                        decoder->buf_out.bytes_remain);
+    }
+
+    if (byte_write > 0) {
+        decoder->buf_out.bytes_remain -= byte_write;
+        decoder->buf_out.bytes_written += byte_write;
+
+        audio_element_info_t audio_info = {0};
+        audio_element_getinfo(self, &audio_info);
+        audio_info.byte_pos += byte_write;
+        audio_element_setinfo(self, &audio_info);
+    }
+
+    return byte_write;
+}
+
+static esp_err_t flac_decoder_seek(audio_element_handle_t self, long long offset)
+{
+    flac_decoder_handle_t decoder = (flac_decoder_handle_t)audio_element_getdata(self);
+    // Source restarts at a frame boundary (or anywhere without SEEKTABLE), reopen
+    // drflac with the saved STREAMINFO and let it resync on the next frame header
+    flac_decoder_reset(decoder);
+    decoder->seek_sample = decoder->flac_info->seek_sample;
+    decoder->seek_pending = true;
+    return ESP_OK;
+}
+
+audio_element_handle_t flac_decoder_init(struct flac_decoder_cfg *config)
+{
+    OS_LOGV(TAG, "Init flac decoder");
+
+    audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+    cfg.destroy     = flac_decoder_destroy;
+    cfg.open        = flac_decoder_open;
+    cfg.close       = flac_decoder_close;
+    cfg.process     = flac_decoder_process;
+    cfg.seek        = flac_decoder_seek;
+    cfg.buffer_len  = 0;
+    cfg.task_stack  = config->task_stack;
+    cfg.task_prio   = config->task_prio;
+    if (cfg.task_stack == 0)
+        cfg.task_stack = FLAC_DECODER_TASK_STACK;
+    cfg.tag = "flac_decoder";
+
+    flac_decoder_handle_t decoder = audio_calloc(1, sizeof(struct flac_decoder));
+    if (decoder == NULL)
+        return NULL;
+
+    struct flac_info *flac_info = config->flac_info;
+#if defined(LITEPLAYER_CONFIG_SINK_FIXED_S16LE)
+    decoder->sink_bits = 16;
+#else
+    decoder->sink_bits = (flac_info->bits > 16) ? 32 : 16;
+#endif
+
+    // Worst case of a frame is the verbatim encoding when max_framesize is unknown
+    int frame_size = flac_info->max_framesize;
+    if (frame_size <= 0)
+        frame_size = flac_info->max_blocksize*flac_info->channels*flac_info->bits/8 + FLAC_DECODER_FRAME_HEADER_MAX;
+    if (frame_size > FLAC_DECODER_FRAME_BUFFER_MAX)
+        frame_size = FLAC_DECODER_FRAME_BUFFER_MAX;
+    decoder->buf_in.threshold = frame_size + DR_FLAC_BUFFER_SIZE;
+    decoder->buf_in.size = decoder->buf_in.threshold + DR_FLAC_BUFFER_SIZE;
+
+    decoder->prefered_frames = flac_info->sample_rate*FLAC_DECODER_PREFERED_PEROID_MS/1000;
+    decoder->min_frames = flac_info->min_blocksize > 0 ? flac_info->min_blocksize : 1;
+    decoder->buf_out.size = decoder->prefered_frames * flac_info->channels * (decoder->sink_bits/8);
+    decoder->buf_in.data = audio_malloc(decoder->buf_in.size);
+    decoder->buf_out.data = audio_malloc(decoder->buf_out.size);
+    AUDIO_MEM_CHECK(TAG, decoder->buf_in.data && decoder->buf_out.data, goto flac_init_error);
+
+    audio_element_handle_t el = audio_element_init(&cfg);
+    AUDIO_MEM_CHECK(TAG, el, goto flac_init_error);
+    decoder->el = el;
+    decoder->flac_info = flac_info;
+    audio_element_setdata(el, decoder);
+
+    audio_element_info_t info = { 0 };
+    memset(&info, 0x0, sizeof(info));
+    audio_element_setinfo(el, &info);
+
+    audio_element_set_input_timeout(el, FLAC_DECODER_INPUT_TIMEOUT_MAX);
+    return el;
+
+flac_init_error:
+    if (decoder->buf_in.data)
+        audio_free(decoder->buf_in.data);
+    if (decoder->buf_out.data)
+        audio_free(decoder->buf_out.data);
+    audio_free(decoder);
+    return NULL;
+}
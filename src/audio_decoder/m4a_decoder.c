@@ -157,6 +157,8 @@ audio_element_handle_t m4a_decoder_init(struct m4a_decoder_cfg *config)
     audio_element_handle_t el = audio_element_init(&cfg);
     AUDIO_MEM_CHECK(TAG, el, goto m4a_init_error);
     decoder->m4a_info = config->m4a_info;
+    decoder->decode_mode = config->decode_mode;
+    decoder->ps_to_mono = config->ps_to_mono;
     decoder->el = el;
     audio_element_setdata(el, decoder);
 
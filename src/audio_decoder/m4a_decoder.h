@@ -29,11 +29,15 @@ struct m4a_decoder_cfg {
     int   task_stack;     /*!< Task stack size */
     int   task_prio;      /*!< Task priority (based on freeRTOS priority) */
     struct m4a_info *m4a_info;
+    enum aac_decode_mode decode_mode; /*!< No effect on plain AAC-LC streams */
+    bool  ps_to_mono;     /*!< Ignore parametric stereo, HE-AACv2 is played as mono */
 };
 
 #define DEFAULT_M4A_DECODER_CONFIG() {\
     .task_stack     = AAC_DECODER_TASK_STACK,\
     .task_prio      = AAC_DECODER_TASK_PRIO,\
+    .decode_mode    = AAC_DECODE_FULL,\
+    .ps_to_mono     = false,\
 }
 
 struct m4a_decoder {
@@ -42,6 +46,8 @@ struct m4a_decoder {
     struct aac_buf_in       buf_in;
     struct aac_buf_out      buf_out;
     struct m4a_info        *m4a_info;
+    enum aac_decode_mode    decode_mode;
+    bool                    ps_to_mono;
     bool                    parsed_header;
 };
 
@@ -28,6 +28,8 @@ extern "C" {
 // MAX_NSAMP refer to http://wiki.hydrogenaud.io/index.php?title=MP3#Polyphase_Filterbank_Formula
 #define MP3_DECODER_OUTPUT_BUFFER_SIZE  (1152 * MP3_MAX_NCHANS * sizeof(short))
 #define MP3_DECODER_INPUT_BUFFER_SIZE   (1940)  // MAINBUF_SIZE
+// Demux window, input is read in big chunks and frames are located in place
+#define MP3_DECODER_BATCH_BUFFER_SIZE   (16 * 1024)
 
 /**
  * @brief      Mp3 Decoder configurations
@@ -47,9 +49,7 @@ struct mp3_decoder_cfg {
 }
 
 struct mp3_buf_in {
-    char data[MP3_DECODER_INPUT_BUFFER_SIZE];
-    int  bytes_want;     // bytes that want to read
-    int  bytes_read;     // bytes that have read
+    int  bytes_read;     // bytes of current frame
     bool eof;            // if end of stream
 };
 
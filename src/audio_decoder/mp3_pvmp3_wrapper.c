@@ -25,13 +25,19 @@
 
 #define TAG "[liteplayer]mp3_decoder"
 
+// Decoder may peek a little beyond the frame end, keep the in-place frame away from span end
+#define MP3_SPAN_PADDING 8
+#define MP3_SPAN_FALLBACK 1
+
 struct pvmp3_wrapper {
     tPVMP3DecoderExternal pvmp3_config;
     void *pvmp3_buffer;
-    bool new_frame;    // if reading new frame
+    char *frame_data;  // current frame, points into batch_buffer or input ringbuf
     int  frame_size;
-    char seek_buffer[MP3_DECODER_INPUT_BUFFER_SIZE];
-    int  bytes_seek;
+    bool span_held;    // frame_data is borrowed from input ringbuf
+    char *batch_buffer; // demux window, frames are decoded in place
+    int  batch_pos;    // start of the next frame
+    int  batch_len;    // valid bytes in window
 };
 
 static int mp3_frame_size(char *buf)
@@ -144,6 +150,103 @@ finish:
     return found ? 0 : -1;
 }
 
+// Make sure at least 'needed' bytes are available from batch_pos, reading as much as
+// possible in one go so most frames are located without touching the input at all
+static int mp3_batch_fill(mp3_decoder_handle_t decoder, int needed)
+{
+    struct pvmp3_wrapper *wrap = (struct pvmp3_wrapper *)(decoder->handle);
+    struct mp3_buf_in *in = &decoder->buf_in;
+    int avail = wrap->batch_len - wrap->batch_pos;
+
+    if (avail >= needed)
+        return AEL_IO_OK;
+
+    if (wrap->batch_pos > 0) {
+        if (avail > 0)
+            memmove(wrap->batch_buffer, &wrap->batch_buffer[wrap->batch_pos], avail);
+        wrap->batch_pos = 0;
+        wrap->batch_len = avail;
+    }
+
+    int wanted = MP3_DECODER_BATCH_BUFFER_SIZE - wrap->batch_len;
+    if (audio_element_get_input_ringbuf(decoder->el) != NULL) {
+        // Frames are decoded in place from ringbuf, window only bridges the wrap-around,
+        // so copy no more than the frame needs
+        wanted = needed - wrap->batch_len;
+    }
+
+    int ret = audio_element_input(decoder->el, &wrap->batch_buffer[wrap->batch_len], wanted);
+    if (ret > 0) {
+        wrap->batch_len += ret;
+        return (wrap->batch_len >= needed) ? AEL_IO_OK : AEL_IO_TIMEOUT;
+    } else if (ret == AEL_IO_TIMEOUT) {
+        return AEL_IO_TIMEOUT;
+    } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
+        in->eof = true;
+        return AEL_IO_DONE;
+    } else {
+        return AEL_IO_FAIL;
+    }
+}
+
+// Borrow the next frame straight from input ringbuf, returns MP3_SPAN_FALLBACK to copy it
+// through the window if the frame is not contiguous
+static int mp3_span_read(mp3_decoder_handle_t decoder)
+{
+    struct pvmp3_wrapper *wrap = (struct pvmp3_wrapper *)(decoder->handle);
+    struct mp3_buf_in *in = &decoder->buf_in;
+    char *span = NULL;
+    int frame_size = 0;
+    int ret = 0;
+
+    ret = audio_element_input_acquire(decoder->el, &span, 4);
+    if (ret < 4)
+        goto span_fallback;
+
+    frame_size = mp3_frame_size(span);
+    if (frame_size <= 0 || frame_size > MP3_DECODER_INPUT_BUFFER_SIZE) {
+        audio_element_input_release(decoder->el, 0);
+        OS_LOGW(TAG, "MP3 demux dummy data, AEL_IO_DONE");
+        return AEL_IO_DONE;
+    }
+
+    if (ret < frame_size + MP3_SPAN_PADDING) {
+        audio_element_input_release(decoder->el, 0);
+        ret = audio_element_input_acquire(decoder->el, &span, frame_size + MP3_SPAN_PADDING);
+        if (ret < frame_size + MP3_SPAN_PADDING)
+            goto span_fallback;
+    }
+
+    wrap->frame_data = span;
+    wrap->frame_size = frame_size;
+    wrap->span_held = true;
+    in->bytes_read = frame_size;
+    return AEL_IO_OK;
+
+span_fallback:
+    if (ret > 0) {
+        // wrap-around or stream tail, let the window copy it
+        audio_element_input_release(decoder->el, 0);
+        return MP3_SPAN_FALLBACK;
+    } else if (ret == AEL_IO_TIMEOUT) {
+        return AEL_IO_TIMEOUT;
+    } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
+        in->eof = true;
+        return AEL_IO_DONE;
+    } else {
+        return AEL_IO_FAIL;
+    }
+}
+
+static void mp3_span_release(mp3_decoder_handle_t decoder)
+{
+    struct pvmp3_wrapper *wrap = (struct pvmp3_wrapper *)(decoder->handle);
+    if (wrap->span_held) {
+        audio_element_input_release(decoder->el, wrap->frame_size);
+        wrap->span_held = false;
+    }
+}
+
 static int mp3_data_read(mp3_decoder_handle_t decoder)
 {
     struct pvmp3_wrapper *wrap = (struct pvmp3_wrapper *)(decoder->handle);
@@ -154,152 +257,49 @@ static int mp3_data_read(mp3_decoder_handle_t decoder)
         return AEL_IO_DONE;
 
     if (decoder->seek_mode) {
-        wrap->bytes_seek = sizeof(wrap->seek_buffer);
-        ret = audio_element_input_chunk(decoder->el, wrap->seek_buffer, wrap->bytes_seek);
-        if (ret == wrap->bytes_seek) {
-            OS_LOGV(TAG, "SEEK_MODE: Read chunk succeed: %d/%d", ret, wrap->bytes_seek);
-        } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
-            in->eof = true;
-            return AEL_IO_DONE;
-        } else if (ret < 0) {
-            OS_LOGW(TAG, "SEEK_MODE: Read chunk error: %d/%d", ret, wrap->bytes_seek);
+        ret = mp3_batch_fill(decoder, MP3_DECODER_INPUT_BUFFER_SIZE);
+        if (ret != AEL_IO_OK)
             return ret;
-        } else {
-            OS_LOGW(TAG, "SEEK_MODE: Read chunk insufficient: %d/%d", ret, wrap->bytes_seek);
-            in->eof = true;
-            return AEL_IO_DONE;
-        }
 
         struct mp3_info *info = decoder->mp3_info;
-        ret = mp3_find_sync_offset(wrap->seek_buffer, wrap->bytes_seek, info);
+        ret = mp3_find_sync_offset(&wrap->batch_buffer[wrap->batch_pos],
+                                   wrap->batch_len - wrap->batch_pos, info);
         if (ret != 0) {
             OS_LOGE(TAG, "SEEK_MODE: Failed to find sync word after seeking");
             return AEL_IO_FAIL;
         }
 
         OS_LOGV(TAG, "SEEK_MODE: Found sync offset: %d/%d, frame_size=%d",
-                info->frame_start_offset, wrap->bytes_seek, info->frame_size);
-
-        wrap->bytes_seek -= info->frame_start_offset;
-        if (wrap->bytes_seek > 0)
-            memmove(wrap->seek_buffer, &wrap->seek_buffer[info->frame_start_offset], wrap->bytes_seek);
-        in->bytes_want = 0;
-        in->bytes_read = 0;
-        wrap->frame_size = info->frame_size;
-        decoder->seek_mode = false;
-    }
-
-    if (wrap->bytes_seek > 0) {
-        if (wrap->bytes_seek < wrap->frame_size) {
-            int remain = wrap->frame_size - wrap->bytes_seek;
-            OS_LOGD(TAG, "SEEK_MODE: Insufficient data, request more for whole frame, remain/frame: %d/%d",
-                    remain, wrap->frame_size);
-            ret = audio_element_input_chunk(decoder->el,
-                        wrap->seek_buffer+wrap->bytes_seek,
-                        remain);
-            if (ret == remain) {
-                OS_LOGV(TAG, "SEEK_MODE: Read chunk succeed: %d/%d", ret, remain);
-                wrap->bytes_seek = wrap->frame_size;
-            } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
-                in->eof = true;
-                return AEL_IO_DONE;
-            } else if (ret < 0) {
-                OS_LOGW(TAG, "SEEK_MODE: Read chunk error: %d/%d", ret, remain);
-                return ret;
-            } else {
-                OS_LOGW(TAG, "SEEK_MODE: Read chunk insufficient: %d/%d", ret, remain);
-                in->eof = true;
-                return AEL_IO_DONE;
-            }
-        }
-
-        wrap->frame_size = mp3_frame_size(wrap->seek_buffer);
-        if (wrap->frame_size <= 0 || wrap->frame_size > wrap->bytes_seek) {
-            OS_LOGW(TAG, "SEEK_MODE: MP3 demux dummy data, AEL_IO_DONE");
-            //in->eof = true;
-            wrap->bytes_seek = 0;
-            return AEL_IO_DONE;
-        }
+                info->frame_start_offset, wrap->batch_len - wrap->batch_pos, info->frame_size);
 
-        memcpy(in->data, wrap->seek_buffer, wrap->frame_size);
-        in->bytes_read = wrap->frame_size;
-        in->bytes_want = 0;
-
-        wrap->bytes_seek -= wrap->frame_size;
-        if (wrap->bytes_seek > 0)
-            memmove(wrap->seek_buffer, wrap->seek_buffer+wrap->frame_size, wrap->bytes_seek);
-
-        if (wrap->bytes_seek >= 4) {
-            wrap->frame_size = mp3_frame_size(wrap->seek_buffer);
-            if (wrap->frame_size <= 0 || wrap->frame_size > MP3_DECODER_INPUT_BUFFER_SIZE) {
-                OS_LOGW(TAG, "SEEK_MODE: MP3 demux dummy data, AEL_IO_DONE");
-                //in->eof = true;
-                wrap->bytes_seek = 0;
-                return AEL_IO_DONE;
-            }
-        }
-        return AEL_IO_OK;
+        wrap->batch_pos += info->frame_start_offset;
+        decoder->seek_mode = false;
     }
 
-    if (in->bytes_want > 0) {
-        if (wrap->new_frame) {
-            OS_LOGD(TAG, "Remain %d/4 bytes header needed to read", in->bytes_want);
-            goto fill_header;
-        } else {
-            OS_LOGD(TAG, "Remain %d/%d bytes frame needed to read", in->bytes_want, wrap->frame_size);
-            goto fill_frame;
-        }
+    if (wrap->batch_pos >= wrap->batch_len && audio_element_get_input_ringbuf(decoder->el) != NULL) {
+        ret = mp3_span_read(decoder);
+        if (ret != MP3_SPAN_FALLBACK)
+            return ret;
     }
 
-    in->bytes_want = 4;
-    in->bytes_read = 0;
-    wrap->new_frame = true;
-fill_header:
-    ret = audio_element_input(decoder->el, in->data+in->bytes_read, in->bytes_want);
-    if (ret < in->bytes_want) {
-        if (ret > 0) {
-            in->bytes_read += ret;
-            in->bytes_want -= ret;
-            return AEL_IO_TIMEOUT;
-        } else if (ret == AEL_IO_TIMEOUT) {
-            return AEL_IO_TIMEOUT;
-        } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
-            in->eof = true;
-            return AEL_IO_DONE;
-        } else {
-            return AEL_IO_FAIL;
-        }
-    }
+    ret = mp3_batch_fill(decoder, 4);
+    if (ret != AEL_IO_OK)
+        return ret;
 
-    wrap->frame_size = mp3_frame_size(in->data);
+    wrap->frame_size = mp3_frame_size(&wrap->batch_buffer[wrap->batch_pos]);
     if (wrap->frame_size <= 0 || wrap->frame_size > MP3_DECODER_INPUT_BUFFER_SIZE) {
         OS_LOGW(TAG, "MP3 demux dummy data, AEL_IO_DONE");
         //in->eof = true;
         return AEL_IO_DONE;
     }
 
-    in->bytes_read = 4;
-    in->bytes_want = wrap->frame_size - in->bytes_read;
-    wrap->new_frame = false;
-fill_frame:
-    ret = audio_element_input(decoder->el, in->data+in->bytes_read, in->bytes_want);
-    if (ret < in->bytes_want) {
-        if (ret > 0) {
-            in->bytes_read += ret;
-            in->bytes_want -= ret;
-            return AEL_IO_TIMEOUT;
-        } else if (ret == AEL_IO_TIMEOUT) {
-            return AEL_IO_TIMEOUT;
-        } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
-            in->eof = true;
-            return AEL_IO_DONE;
-        } else {
-            return AEL_IO_FAIL;
-        }
-    }
+    ret = mp3_batch_fill(decoder, wrap->frame_size);
+    if (ret != AEL_IO_OK)
+        return ret;
 
+    wrap->frame_data = &wrap->batch_buffer[wrap->batch_pos];
+    wrap->batch_pos += wrap->frame_size;
     in->bytes_read = wrap->frame_size;
-    in->bytes_want = 0;
     return AEL_IO_OK;
 }
 
@@ -320,11 +320,12 @@ int mp3_wrapper_run(mp3_decoder_handle_t decoder)
     wrap->pvmp3_config.inputBufferCurrentLength = decoder->buf_in.bytes_read;
     wrap->pvmp3_config.inputBufferMaxLength = MP3_DECODER_INPUT_BUFFER_SIZE;
     wrap->pvmp3_config.inputBufferUsedLength = 0;
-    wrap->pvmp3_config.pInputBuffer = (uint8 *)decoder->buf_in.data;
+    wrap->pvmp3_config.pInputBuffer = (uint8 *)wrap->frame_data;
     wrap->pvmp3_config.pOutputBuffer = (int16 *)decoder->buf_out.data;
     wrap->pvmp3_config.outputFrameSize = MP3_DECODER_OUTPUT_BUFFER_SIZE / sizeof(int16_t);
     wrap->pvmp3_config.crcEnabled = false;
     ERROR_CODE decoderErr = pvmp3_framedecoder(&wrap->pvmp3_config, wrap->pvmp3_buffer);
+    mp3_span_release(decoder);
     if (decoderErr != NO_DECODING_ERROR) {
         OS_LOGE(TAG, "PVMP3Decoder encountered error: %d", decoderErr);
         return AEL_PROCESS_FAIL;
@@ -358,10 +359,19 @@ int mp3_wrapper_init(mp3_decoder_handle_t decoder)
         return -1;
     }
 
+    // some spare bytes after window, decoder may peek a little beyond the frame end
+    wrap->batch_buffer = audio_malloc(MP3_DECODER_BATCH_BUFFER_SIZE + 8);
+    if (wrap->batch_buffer == NULL) {
+        OS_LOGE(TAG, "Failed to allocate memory for mp3 demux window");
+        audio_free(wrap);
+        return -1;
+    }
+
     uint32_t memRequirements = pvmp3_decoderMemRequirements();
     wrap->pvmp3_buffer = audio_malloc(memRequirements);
     if (wrap->pvmp3_buffer == NULL) {
         OS_LOGE(TAG, "Failed to allocate memory for pvmp3 decoder");
+        audio_free(wrap->batch_buffer);
         audio_free(wrap);
         return -1;
     }
@@ -376,6 +386,8 @@ void mp3_wrapper_deinit(mp3_decoder_handle_t decoder)
     struct pvmp3_wrapper *wrap = (struct pvmp3_wrapper *)decoder->handle;
     if (wrap == NULL) return;
 
+    mp3_span_release(decoder);
     audio_free(wrap->pvmp3_buffer);
+    audio_free(wrap->batch_buffer);
     audio_free(wrap);
 }
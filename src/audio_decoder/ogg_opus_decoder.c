@@ -0,0 +1,520 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_element.h"
+#include "esp_adf/audio_common.h"
+#include "audio_extractor/ogg_extractor.h"
+#include "audio_decoder/ogg_opus_decoder.h"
+#include "opus.h"
+
+#define TAG "[liteplayer]opus_decoder"
+
+#define OGG_OPUS_DECODER_INPUT_TIMEOUT_MAX  200 // ms
+#define OGG_OPUS_DECODER_INPUT_SIZE         (4 * 1024)
+// The longest opus packet is 120ms
+#define OGG_OPUS_PACKET_DURATION_MAX        (OPUS_GRANULE_RATE*120/1000)
+
+struct ogg_buf_in {
+    char *data;
+    int  size;           // grows up to OGG_PAGE_SIZE_MAX
+    int  bytes_read;     // bytes that have read
+    int  offset;         // offset of the current page
+    bool eof;            // if end of stream
+};
+
+struct ogg_buf_out {
+    char *data;
+    int  size;
+    int  bytes_remain;   // bytes that remained to write
+    int  bytes_written;  // bytes that have written
+};
+
+struct ogg_packet {
+    char *data;          // packet across pages is joined here
+    int  size;
+    int  len;
+    bool drop;           // head of packet is lost, drop it when it finishes
+};
+
+struct ogg_opus_decoder {
+    audio_element_handle_t  el;
+    OpusDecoder            *opus;
+    struct ogg_buf_in       buf_in;
+    struct ogg_buf_out      buf_out;
+    struct ogg_packet       packet;
+    struct ogg_page_header  page;
+    bool                    page_loaded;
+    int                     segment_index;  // next lacing value to read
+    int                     body_pos;       // data of next packet in buf_in
+    int                     last_segment;   // lacing value that finishes the last packet of page
+    bool                    granule_known;
+    int64_t                 granule;        // position of the next decoded sample
+    int64_t                 skip_granule;   // samples before it are discarded, for pre-skip and seek
+    bool                    parsed_header;
+    struct opus_info       *opus_info;
+};
+typedef struct ogg_opus_decoder *ogg_opus_decoder_handle_t;
+
+static int ogg_fill_input(ogg_opus_decoder_handle_t decoder, int wanted)
+{
+    struct ogg_buf_in *in = &decoder->buf_in;
+
+    if (in->bytes_read >= wanted || in->eof)
+        return AEL_IO_OK;
+
+    if (in->offset > 0) {
+        memmove(in->data, in->data+in->offset, in->bytes_read);
+        in->offset = 0;
+    }
+    if (wanted > in->size) {
+        char *data = audio_realloc(in->data, wanted);
+        if (data == NULL)
+            return AEL_PROCESS_FAIL;
+        in->data = data;
+        in->size = wanted;
+    }
+
+    while (in->bytes_read < wanted) {
+        int ret = audio_element_input(decoder->el, in->data+in->bytes_read, in->size-in->bytes_read);
+        if (ret > 0) {
+            in->bytes_read += ret;
+        } else if (ret == AEL_IO_OK || ret == AEL_IO_DONE || ret == AEL_IO_ABORT) {
+            in->eof = true;
+            break;
+        } else {
+            return ret;
+        }
+    }
+    return AEL_IO_OK;
+}
+
+static void ogg_drop_input(ogg_opus_decoder_handle_t decoder, int size)
+{
+    decoder->buf_in.offset += size;
+    decoder->buf_in.bytes_read -= size;
+}
+
+static int ogg_packet_append(struct ogg_packet *packet, const char *data, int len)
+{
+    if (packet->len + len > packet->size) {
+        if (packet->len + len > OGG_PAGE_SIZE_MAX)
+            return -1;
+        char *buf = audio_realloc(packet->data, packet->len + len);
+        if (buf == NULL)
+            return -1;
+        packet->data = buf;
+        packet->size = packet->len + len;
+    }
+    memcpy(&packet->data[packet->len], data, len);
+    packet->len += len;
+    return 0;
+}
+
+// Granule of the page is the end of its last finished packet, count back to get
+// the position of the first packet that will be decoded
+static void ogg_update_granule(ogg_opus_decoder_handle_t decoder)
+{
+    const unsigned char *lacing = (const unsigned char *)&decoder->buf_in.data[decoder->buf_in.offset + OGG_PAGE_HEADER_SIZE];
+    const unsigned char *body = (const unsigned char *)&decoder->buf_in.data[decoder->body_pos];
+    bool drop = decoder->packet.drop;
+    int packet_start = 0, packet_len = 0, pos = 0;
+    int64_t samples = 0;
+
+    for (int i = 0; i < decoder->page.segment_count; i++) {
+        packet_len += lacing[i];
+        pos += lacing[i];
+        if (lacing[i] == 255)
+            continue;
+        if (drop) {
+            drop = false;
+        } else if (packet_start == 0 && decoder->packet.len > 0) {
+            // toc byte and frame count are enough to get the duration
+            unsigned char toc[2];
+            toc[0] = decoder->packet.data[0];
+            toc[1] = (decoder->packet.len > 1) ? decoder->packet.data[1] : body[0];
+            int ret = opus_packet_get_nb_samples(toc, 2, OPUS_GRANULE_RATE);
+            samples += (ret > 0) ? ret : 0;
+        } else if (packet_len > 0) {
+            int ret = opus_packet_get_nb_samples(&body[packet_start], packet_len, OPUS_GRANULE_RATE);
+            samples += (ret > 0) ? ret : 0;
+        }
+        packet_start = pos;
+        packet_len = 0;
+    }
+
+    decoder->granule = decoder->page.granule_position - samples;
+    if (decoder->granule < 0)
+        decoder->granule = 0; // stream is shorter than its packets, trimmed at end
+    decoder->granule_known = true;
+    OS_LOGV(TAG, "Resume at granule %lld, skip to %lld",
+            (long long)decoder->granule, (long long)decoder->skip_granule);
+}
+
+static int ogg_load_page(ogg_opus_decoder_handle_t decoder)
+{
+    struct ogg_buf_in *in = &decoder->buf_in;
+    struct ogg_page_header *page = &decoder->page;
+
+    if (decoder->page_loaded) {
+        ogg_drop_input(decoder, page->header_size + page->body_size);
+        decoder->page_loaded = false;
+    }
+
+    while (!decoder->page_loaded) {
+        int ret = ogg_fill_input(decoder, OGG_PAGE_HEADER_SIZE);
+        if (ret != AEL_IO_OK)
+            return ret;
+        if (in->bytes_read < OGG_PAGE_HEADER_SIZE)
+            return AEL_IO_DONE;
+
+        ret = ogg_parse_page_header(&in->data[in->offset], in->bytes_read, page);
+        if (ret < 0) {
+            // Lost sync, drop bytes until the next capture pattern
+            int skip = 1;
+            while (skip <= in->bytes_read - 4 && memcmp(&in->data[in->offset + skip], "OggS", 4) != 0)
+                skip++;
+            OS_LOGW(TAG, "Invalid page, skip %d bytes", skip);
+            ogg_drop_input(decoder, skip);
+            continue;
+        }
+        if (ret == 0) {
+            ret = ogg_fill_input(decoder, OGG_PAGE_HEADER_SIZE + (in->data[in->offset + 26] & 0xFF));
+            if (ret != AEL_IO_OK)
+                return ret;
+            if (ogg_parse_page_header(&in->data[in->offset], in->bytes_read, page) <= 0)
+                return AEL_IO_DONE;
+        }
+
+        ret = ogg_fill_input(decoder, page->header_size + page->body_size);
+        if (ret != AEL_IO_OK)
+            return ret;
+        if (in->bytes_read < page->header_size + page->body_size) {
+            OS_LOGW(TAG, "Truncated page at end of stream");
+            return AEL_IO_DONE;
+        }
+
+        if (page->serial_number != decoder->opus_info->serial_number) {
+            ogg_drop_input(decoder, page->header_size + page->body_size);
+            continue;
+        }
+        decoder->page_loaded = true;
+    }
+
+    decoder->segment_index = 0;
+    decoder->body_pos = in->offset + page->header_size;
+    decoder->last_segment = -1;
+    for (int i = 0; i < page->segment_count; i++) {
+        if ((in->data[in->offset + OGG_PAGE_HEADER_SIZE + i] & 0xFF) < 255)
+            decoder->last_segment = i;
+    }
+
+    if (page->header_type & OGG_HEADER_TYPE_CONTINUED) {
+        if (decoder->packet.len == 0)
+            decoder->packet.drop = true;
+    } else if (decoder->packet.len > 0) {
+        OS_LOGW(TAG, "Missing continued page, drop %d bytes", decoder->packet.len);
+        decoder->packet.len = 0;
+    }
+
+    if (!decoder->granule_known && page->granule_position != -1)
+        ogg_update_granule(decoder);
+    return AEL_IO_OK;
+}
+
+// Return the next finished packet in page, or NULL if more pages are needed
+static const char *ogg_next_packet(ogg_opus_decoder_handle_t decoder, int *len, bool *last)
+{
+    const unsigned char *lacing = (const unsigned char *)&decoder->buf_in.data[decoder->buf_in.offset + OGG_PAGE_HEADER_SIZE];
+    struct ogg_packet *packet = &decoder->packet;
+
+    while (decoder->segment_index < decoder->page.segment_count) {
+        int start = decoder->body_pos;
+        int size = 0;
+        bool finished = false;
+        while (decoder->segment_index < decoder->page.segment_count) {
+            int value = lacing[decoder->segment_index++];
+            size += value;
+            if (value < 255) {
+                finished = true;
+                break;
+            }
+        }
+        decoder->body_pos += size;
+
+        if (packet->drop) {
+            if (finished)
+                packet->drop = false;
+            continue;
+        }
+        if (!finished) {
+            if (ogg_packet_append(packet, &decoder->buf_in.data[start], size) != 0) {
+                OS_LOGW(TAG, "Packet too large, drop it");
+                packet->len = 0;
+                packet->drop = true;
+            }
+            return NULL;
+        }
+
+        *last = (decoder->segment_index - 1 == decoder->last_segment);
+        if (packet->len == 0) {
+            *len = size;
+            return &decoder->buf_in.data[start];
+        }
+        if (ogg_packet_append(packet, &decoder->buf_in.data[start], size) != 0) {
+            packet->len = 0;
+            continue;
+        }
+        *len = packet->len;
+        packet->len = 0; // data is valid until next append
+        return packet->data;
+    }
+    return NULL;
+}
+
+static int ogg_opus_run(ogg_opus_decoder_handle_t decoder)
+{
+    struct opus_info *info = decoder->opus_info;
+    int ratio = OPUS_GRANULE_RATE / info->sample_rate;
+    int frame_bytes = info->channels * sizeof(opus_int16);
+
+    if (decoder->opus == NULL) {
+        int err = OPUS_OK;
+        decoder->opus = opus_decoder_create(info->sample_rate, info->channels, &err);
+        if (decoder->opus == NULL) {
+            OS_LOGE(TAG, "Failed to create opus decoder: %s", opus_strerror(err));
+            return AEL_PROCESS_FAIL;
+        }
+        if (info->output_gain != 0)
+            opus_decoder_ctl(decoder->opus, OPUS_SET_GAIN(info->output_gain));
+
+        if (!decoder->parsed_header) {
+            audio_element_info_t el_info = {0};
+            el_info.samplerate = info->sample_rate;
+            el_info.channels   = info->channels;
+            el_info.bits       = 16;
+            OS_LOGV(TAG,"Found opus header: SR=%d, CH=%d, BITS=%d", el_info.samplerate, el_info.channels, el_info.bits);
+            audio_element_setinfo(decoder->el, &el_info);
+            audio_element_report_info(decoder->el);
+            decoder->parsed_header = true;
+        }
+    }
+
+    while (true) {
+        const char *data = NULL;
+        int len = 0;
+        bool last = false;
+
+        if (decoder->page_loaded)
+            data = ogg_next_packet(decoder, &len, &last);
+        if (data == NULL) {
+            int ret = ogg_load_page(decoder);
+            if (ret != AEL_IO_OK)
+                return ret;
+            continue;
+        }
+        if (!decoder->granule_known)
+            continue; // position is unknown until a page finishes a packet
+
+        int frames = opus_decode(decoder->opus, (const unsigned char *)data, len,
+                                 (opus_int16 *)decoder->buf_out.data,
+                                 decoder->buf_out.size / frame_bytes, 0);
+        if (frames < 0) {
+            OS_LOGW(TAG, "Failed to decode packet(%d bytes): %s", len, opus_strerror(frames));
+            continue;
+        }
+
+        int64_t start = decoder->granule;
+        decoder->granule += (int64_t)frames * ratio;
+
+        int begin = 0, end = frames;
+        if (start < decoder->skip_granule) {
+            int64_t skip = (decoder->skip_granule - start) / ratio;
+            begin = (skip < frames) ? (int)skip : frames;
+        }
+        if (last && (decoder->page.header_type & OGG_HEADER_TYPE_EOS) &&
+            decoder->granule > decoder->page.granule_position) {
+            // Last page trims the padding of final packet
+            int64_t trim = (decoder->granule - decoder->page.granule_position) / ratio;
+            end = (trim < frames) ? frames - (int)trim : 0;
+        }
+        if (end <= begin)
+            continue;
+
+        decoder->buf_out.bytes_written = begin * frame_bytes;
+        decoder->buf_out.bytes_remain = (end - begin) * frame_bytes;
+        return 0;
+    }
+}
+
+static void ogg_opus_decoder_reset(ogg_opus_decoder_handle_t decoder)
+{
+    decoder->buf_in.bytes_read = 0;
+    decoder->buf_in.offset = 0;
+    decoder->buf_in.eof = false;
+    decoder->buf_out.bytes_remain = 0;
+    decoder->buf_out.bytes_written = 0;
+    decoder->packet.len = 0;
+    decoder->packet.drop = false;
+    decoder->page_loaded = false;
+    decoder->granule_known = false;
+    decoder->granule = 0;
+}
+
+static esp_err_t ogg_opus_decoder_destroy(audio_element_handle_t self)
+{
+    ogg_opus_decoder_handle_t decoder = (ogg_opus_decoder_handle_t)audio_element_getdata(self);
+    OS_LOGV(TAG, "Destroy opus decoder");
+    if (decoder->opus != NULL)
+        opus_decoder_destroy(decoder->opus);
+    audio_free(decoder->buf_in.data);
+    audio_free(decoder->buf_out.data);
+    if (decoder->packet.data != NULL)
+        audio_free(decoder->packet.data);
+    audio_free(decoder);
+    return ESP_OK;
+}
+
+static esp_err_t ogg_opus_decoder_open(audio_element_handle_t self)
+{
+    OS_LOGV(TAG, "Open opus decoder");
+    return ESP_OK;
+}
+
+static esp_err_t ogg_opus_decoder_close(audio_element_handle_t self)
+{
+    ogg_opus_decoder_handle_t decoder = (ogg_opus_decoder_handle_t)audio_element_getdata(self);
+
+    if (AEL_STATE_PAUSED != audio_element_get_state(self)) {
+        if (decoder->opus != NULL) {
+            OS_LOGV(TAG, "Close opus decoder");
+            opus_decoder_destroy(decoder->opus);
+            decoder->opus = NULL;
+        }
+        ogg_opus_decoder_reset(decoder);
+        decoder->skip_granule = decoder->opus_info->pre_skip;
+        decoder->parsed_header = false;
+
+        audio_element_info_t info = {0};
+        audio_element_getinfo(self, &info);
+        info.byte_pos = 0;
+        info.total_bytes = 0;
+        audio_element_setinfo(self, &info);
+    }
+    return ESP_OK;
+}
+
+static int ogg_opus_decoder_process(audio_element_handle_t self, char *in_buffer, int in_len)
+{
+    int byte_write = 0;
+    int ret = AEL_IO_FAIL;
+    ogg_opus_decoder_handle_t decoder = (ogg_opus_decoder_handle_t)audio_element_getdata(self);
+
+    if (decoder->buf_out.bytes_remain <= 0) {
+        /* More data need to be wrote */
+        ret = ogg_opus_run(decoder);
+        if (ret < 0) {
+            if (ret == AEL_IO_TIMEOUT) {
+                OS_LOGW(TAG, "ogg_opus_run AEL_IO_TIMEOUT");
+            } else if (ret != AEL_IO_DONE) {
+                OS_LOGE(TAG, "ogg_opus_run failed:%d", ret);
+            }
+            return ret;
+        }
+    }
+
+    byte_write = audio_element_output(self,
+                    decoder->buf_out.data+decoder->buf_out.bytes_written,
+                    decoder->buf_out.bytes_remain);
+
+    if (byte_write > 0) {
+        decoder->buf_out.bytes_remain -= byte_write;
+        decoder->buf_out.bytes_written += byte_write;
+
+        audio_element_info_t audio_info = {0};
+        audio_element_getinfo(self, &audio_info);
+        audio_info.byte_pos += byte_write;
+        audio_element_setinfo(self, &audio_info);
+    }
+
+    return byte_write;
+}
+
+static esp_err_t ogg_opus_decoder_seek(audio_element_handle_t self, long long offset)
+{
+    ogg_opus_decoder_handle_t decoder = (ogg_opus_decoder_handle_t)audio_element_getdata(self);
+    // Source restarts at a page boundary, position is recovered from the next granule
+    ogg_opus_decoder_reset(decoder);
+    decoder->skip_granule = decoder->opus_info->seek_granule;
+    if (decoder->opus != NULL)
+        opus_decoder_ctl(decoder->opus, OPUS_RESET_STATE);
+    return ESP_OK;
+}
+
+audio_element_handle_t ogg_opus_decoder_init(struct ogg_opus_decoder_cfg *config)
+{
+    OS_LOGV(TAG, "Init opus decoder");
+
+    audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+    cfg.destroy     = ogg_opus_decoder_destroy;
+    cfg.open        = ogg_opus_decoder_open;
+    cfg.close       = ogg_opus_decoder_close;
+    cfg.process     = ogg_opus_decoder_process;
+    cfg.seek        = ogg_opus_decoder_seek;
+    cfg.buffer_len  = 0;
+    cfg.task_stack  = config->task_stack;
+    cfg.task_prio   = config->task_prio;
+    if (cfg.task_stack == 0)
+        cfg.task_stack = OGG_OPUS_DECODER_TASK_STACK;
+    cfg.tag = "opus_decoder";
+
+    ogg_opus_decoder_handle_t decoder = audio_calloc(1, sizeof(struct ogg_opus_decoder));
+    if (decoder == NULL)
+        return NULL;
+
+    struct opus_info *opus_info = config->opus_info;
+    decoder->buf_in.size = OGG_OPUS_DECODER_INPUT_SIZE;
+    decoder->buf_out.size = OGG_OPUS_PACKET_DURATION_MAX / (OPUS_GRANULE_RATE / opus_info->sample_rate) *
+                            opus_info->channels * sizeof(opus_int16);
+    decoder->buf_in.data = audio_malloc(decoder->buf_in.size);
+    decoder->buf_out.data = audio_malloc(decoder->buf_out.size);
+    AUDIO_MEM_CHECK(TAG, decoder->buf_in.data && decoder->buf_out.data, goto opus_init_error);
+
+    audio_element_handle_t el = audio_element_init(&cfg);
+    AUDIO_MEM_CHECK(TAG, el, goto opus_init_error);
+    decoder->el = el;
+    decoder->opus_info = opus_info;
+    decoder->skip_granule = opus_info->pre_skip;
+    audio_element_setdata(el, decoder);
+
+    audio_element_info_t info = { 0 };
+    memset(&info, 0x0, sizeof(info));
+    audio_element_setinfo(el, &info);
+
+    audio_element_set_input_timeout(el, OGG_OPUS_DECODER_INPUT_TIMEOUT_MAX);
+    return el;
+
+opus_init_error:
+    if (decoder->buf_in.data)
+        audio_free(decoder->buf_in.data);
+    if (decoder->buf_out.data)
+        audio_free(decoder->buf_out.data);
+    audio_free(decoder);
+    return NULL;
+}
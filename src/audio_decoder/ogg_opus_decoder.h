@@ -0,0 +1,59 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _OGG_OPUS_DECODER_H_
+#define _OGG_OPUS_DECODER_H_
+
+#include "osal/os_thread.h"
+#include "esp_adf/audio_element.h"
+#include "audio_extractor/ogg_extractor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * brief      Ogg Opus Decoder configurations
+ *
+ * Names are prefixed with ogg_ to not clash with libopus, which owns opus_decoder_*
+ */
+struct ogg_opus_decoder_cfg {
+    int task_stack;     /*!< Task stack size */
+    int task_prio;      /*!< Task priority (based on freeRTOS priority) */
+    struct opus_info *opus_info;
+};
+
+#define OGG_OPUS_DECODER_TASK_PRIO      (OS_THREAD_PRIO_NORMAL)
+#define OGG_OPUS_DECODER_TASK_STACK     (16 * 1024)
+
+#define DEFAULT_OGG_OPUS_DECODER_CONFIG() {\
+    .task_prio          = OGG_OPUS_DECODER_TASK_PRIO,\
+    .task_stack         = OGG_OPUS_DECODER_TASK_STACK,\
+}
+
+/**
+ * @brief      Create an Audio Element handle to decode incoming Ogg Opus data
+ *
+ * @param      config  The configuration
+ *
+ * @return     The audio element handle
+ */
+audio_element_handle_t ogg_opus_decoder_init(struct ogg_opus_decoder_cfg *config);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
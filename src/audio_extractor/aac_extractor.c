@@ -369,3 +369,79 @@ finish:
     }
     return found ? 0 : -1;
 }
+
+#define AAC_INDEX_ENTRIES_MAX 2048
+
+int aac_scan_frames(aac_fetch_cb fetch_cb, void *fetch_priv, long content_len, struct aac_info *info)
+{
+    char buf[DEFAULT_AAC_PARSER_BUFFER_SIZE];
+    long buf_offset = 0;
+    int buf_size = 0;
+    long offset = info->frame_start_offset;
+    int frames = 0;
+    int stride = 1;
+    int count = 0;
+
+    // Offsets of every stride-th frame, stride doubles when the index is full
+    uint32_t *index = audio_malloc(sizeof(uint32_t) * AAC_INDEX_ENTRIES_MAX);
+    if (index == NULL)
+        return -1;
+
+    while (content_len <= 0 || offset + 7 <= content_len) {
+        if (offset < buf_offset || offset + 7 > buf_offset + buf_size) {
+            buf_size = fetch_cb(buf, sizeof(buf), offset, fetch_priv);
+            if (buf_size < 7)
+                break;
+            buf_offset = offset;
+        }
+        unsigned char *hdr = (unsigned char *)&buf[offset - buf_offset];
+        if (hdr[0] != 0xFF || (hdr[1] & 0xF6) != 0xF0)
+            break;
+        int frame_size = ((hdr[3] & 0x03) << 11) | (hdr[4] << 3) | (hdr[5] >> 5);
+        if (frame_size < 7)
+            break;
+
+        if (frames % stride == 0) {
+            if (count == AAC_INDEX_ENTRIES_MAX) {
+                for (int i = 0; i < AAC_INDEX_ENTRIES_MAX/2; i++)
+                    index[i] = index[2*i];
+                count = AAC_INDEX_ENTRIES_MAX/2;
+                stride *= 2;
+            }
+            if (frames % stride == 0)
+                index[count++] = (uint32_t)(offset - info->frame_start_offset);
+        }
+        frames++;
+        offset += frame_size;
+    }
+
+    if (frames == 0) {
+        audio_free(index);
+        return -1;
+    }
+
+    uint32_t *shrunk = audio_realloc(index, sizeof(uint32_t) * count);
+    if (shrunk != NULL)
+        index = shrunk;
+
+    info->total_frames = frames;
+    info->total_bytes = offset - info->frame_start_offset;
+    info->index_stride = stride;
+    info->index_entries = count;
+    info->index = index;
+    OS_LOGD(TAG, "Scanned %d frames, %ld bytes, index stride %d", frames, info->total_bytes, stride);
+    return 0;
+}
+
+int aac_get_seek_offset(int seek_ms, struct aac_info *info, long *offset)
+{
+    if (info->index == NULL || info->index_entries == 0 || info->sample_rate <= 0)
+        return -1;
+
+    long long frame = (long long)seek_ms * info->sample_rate / AAC_SAMPLES_PER_FRAME / 1000;
+    long long entry = frame / info->index_stride;
+    if (entry >= info->index_entries)
+        entry = info->index_entries - 1;
+    *offset = (long)info->index[entry];
+    return 0;
+}
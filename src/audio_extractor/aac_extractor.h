@@ -15,6 +15,8 @@
 #ifndef _AAC_EXTRACTOR_H_
 #define _AAC_EXTRACTOR_H_
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -22,17 +24,31 @@ extern "C" {
 // Return the data size obtained
 typedef int (*aac_fetch_cb)(char *buf, int wanted_size, long offset, void *fetch_priv);
 
+#define AAC_SAMPLES_PER_FRAME 1024
+
 struct aac_info {
     int channels;
     int sample_rate;
     int frame_size;
     int frame_start_offset;
+
+    // ADTS frame index built by aac_scan_frames, index is NULL if not built
+    int total_frames;
+    long total_bytes;
+    int index_stride;   // frames between two index entries
+    int index_entries;
+    uint32_t *index;    // need to free when resetting player
 };
 
 int aac_parse_adts_frame(char *buf, int buf_size, struct aac_info *info);
 
 int aac_extractor(aac_fetch_cb fetch_cb, void *fetch_priv, struct aac_info *info);
 
+// Walk all ADTS frames to count frames and build the seek index
+int aac_scan_frames(aac_fetch_cb fetch_cb, void *fetch_priv, long content_len, struct aac_info *info);
+
+int aac_get_seek_offset(int seek_ms, struct aac_info *info, long *offset);
+
 #ifdef __cplusplus
 }
 #endif
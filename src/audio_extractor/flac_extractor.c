@@ -0,0 +1,231 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "audio_extractor/flac_extractor.h"
+
+#define TAG "[liteplayer]flac_extractor"
+
+#define FLAC_METADATA_STREAMINFO    0
+#define FLAC_METADATA_SEEKTABLE     3
+#define FLAC_METADATA_INVALID       127
+#define FLAC_SEEKPOINT_SIZE         18
+#define FLAC_SEEKPOINT_PLACEHOLDER  0xFFFFFFFFFFFFFFFFULL
+
+// Seek points are fetched in batches, keep it under the parser buffer
+#define DEFAULT_FLAC_PARSER_BUFFER_SIZE (FLAC_SEEKPOINT_SIZE * 100)
+
+static uint32_t flac_read_be24(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[2];
+}
+
+static uint32_t flac_read_be32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint64_t flac_read_be64(const unsigned char *p)
+{
+    return ((uint64_t)flac_read_be32(p) << 32) | (uint64_t)flac_read_be32(&p[4]);
+}
+
+static int flac_parse_streaminfo(const unsigned char *buf, struct flac_info *info)
+{
+    info->min_blocksize = (buf[0] << 8) | buf[1];
+    info->max_blocksize = (buf[2] << 8) | buf[3];
+    info->min_framesize = flac_read_be24(&buf[4]);
+    info->max_framesize = flac_read_be24(&buf[7]);
+    info->sample_rate   = (buf[10] << 12) | (buf[11] << 4) | (buf[12] >> 4);
+    info->channels      = ((buf[12] >> 1) & 0x07) + 1;
+    info->bits          = (((buf[12] & 0x01) << 4) | (buf[13] >> 4)) + 1;
+    info->total_samples = ((uint64_t)(buf[13] & 0x0F) << 32) | flac_read_be32(&buf[14]);
+
+    if (info->sample_rate == 0 || info->max_blocksize < 16 || info->min_blocksize > info->max_blocksize) {
+        OS_LOGE(TAG, "Invalid STREAMINFO: samplerate=%d, blocksize=%d-%d",
+                info->sample_rate, info->min_blocksize, info->max_blocksize);
+        return -1;
+    }
+
+    OS_LOGV(TAG, "STREAMINFO: samplerate=%d, channels=%d, bits=%d, blocksize=%d-%d, framesize=%d-%d, samples=%llu",
+            info->sample_rate, info->channels, info->bits, info->min_blocksize, info->max_blocksize,
+            info->min_framesize, info->max_framesize, (unsigned long long)info->total_samples);
+    return 0;
+}
+
+static int flac_parse_seektable(flac_fetch_cb fetch_cb, void *fetch_priv,
+                                long offset, int length, struct flac_info *info)
+{
+    char buf[DEFAULT_FLAC_PARSER_BUFFER_SIZE];
+    int total = length / FLAC_SEEKPOINT_SIZE;
+    int stride = (total + FLAC_SEEKPOINT_MAX - 1) / FLAC_SEEKPOINT_MAX;
+    if (total <= 0)
+        return 0;
+
+    info->seektable = audio_calloc((total + stride - 1) / stride, sizeof(struct flac_seekpoint));
+    if (info->seektable == NULL)
+        return -1;
+
+    int index = 0;
+    while (index < total) {
+        int count = total - index;
+        if (count > sizeof(buf) / FLAC_SEEKPOINT_SIZE)
+            count = sizeof(buf) / FLAC_SEEKPOINT_SIZE;
+        int wanted = count * FLAC_SEEKPOINT_SIZE;
+        if (fetch_cb(buf, wanted, offset + index * FLAC_SEEKPOINT_SIZE, fetch_priv) != wanted) {
+            OS_LOGW(TAG, "Failed to read SEEKTABLE, ignore it");
+            break;
+        }
+
+        for (int i = 0; i < count; i++, index++) {
+            if (index % stride != 0)
+                continue;
+            const unsigned char *point = (const unsigned char *)&buf[i * FLAC_SEEKPOINT_SIZE];
+            uint64_t sample_number = flac_read_be64(point);
+            // placeholders are sorted to the end, points must be ascending
+            if (sample_number == FLAC_SEEKPOINT_PLACEHOLDER)
+                goto finish;
+            if (info->seekpoint_count > 0 &&
+                sample_number <= info->seektable[info->seekpoint_count - 1].sample_number)
+                continue;
+            info->seektable[info->seekpoint_count].sample_number = sample_number;
+            info->seektable[info->seekpoint_count].offset = flac_read_be64(&point[8]);
+            info->seekpoint_count++;
+        }
+    }
+
+finish:
+    OS_LOGV(TAG, "SEEKTABLE: %d points, %d kept", total, info->seekpoint_count);
+    if (info->seekpoint_count == 0) {
+        audio_free(info->seektable);
+        info->seektable = NULL;
+    }
+    return 0;
+}
+
+int flac_extractor(flac_fetch_cb fetch_cb, void *fetch_priv, struct flac_info *info)
+{
+    unsigned char buf[FLAC_STREAMINFO_SIZE];
+    long offset = 0;
+    bool last_block = false;
+    bool found_streaminfo = false;
+
+    info->seekpoint_count = 0;
+    info->seektable = NULL;
+
+    if (fetch_cb((char *)buf, 10, 0, fetch_priv) != 10) {
+        OS_LOGE(TAG, "Not enough data to parse");
+        goto fail;
+    }
+    if (memcmp(buf, "ID3", 3) == 0) {
+        int id3v2_len =
+                (((int)(buf[6]) & 0x7F) << 21) +
+                (((int)(buf[7]) & 0x7F) << 14) +
+                (((int)(buf[8]) & 0x7F) <<  7) +
+                 ((int)(buf[9]) & 0x7F);
+        offset = id3v2_len + 10;
+        OS_LOGV(TAG, "ID3 tag find with length[%d]", id3v2_len);
+        if (fetch_cb((char *)buf, 4, offset, fetch_priv) != 4)
+            goto fail;
+    }
+    if (memcmp(buf, "fLaC", 4) != 0) {
+        OS_LOGE(TAG, "Invalid flac stream marker");
+        goto fail;
+    }
+    offset += 4;
+
+    while (!last_block) {
+        if (fetch_cb((char *)buf, 4, offset, fetch_priv) != 4) {
+            OS_LOGE(TAG, "Failed to read metadata block header");
+            goto fail;
+        }
+        last_block = (buf[0] & 0x80) != 0;
+        int type = buf[0] & 0x7F;
+        int length = flac_read_be24(&buf[1]);
+        offset += 4;
+
+        if (type == FLAC_METADATA_STREAMINFO) {
+            if (length < FLAC_STREAMINFO_SIZE ||
+                fetch_cb((char *)buf, FLAC_STREAMINFO_SIZE, offset, fetch_priv) != FLAC_STREAMINFO_SIZE ||
+                flac_parse_streaminfo(buf, info) != 0)
+                goto fail;
+            memcpy(&info->header_buff[8], buf, FLAC_STREAMINFO_SIZE);
+            found_streaminfo = true;
+        } else if (type == FLAC_METADATA_SEEKTABLE && info->seektable == NULL) {
+            if (flac_parse_seektable(fetch_cb, fetch_priv, offset, length, info) != 0)
+                goto fail;
+        } else if (type == FLAC_METADATA_INVALID) {
+            OS_LOGE(TAG, "Invalid metadata block type");
+            goto fail;
+        }
+        offset += length;
+    }
+
+    if (!found_streaminfo) {
+        OS_LOGE(TAG, "Missing STREAMINFO block");
+        goto fail;
+    }
+
+    // Only STREAMINFO is kept for decoder, marked as the last metadata block
+    memcpy(info->header_buff, "fLaC", 4);
+    info->header_buff[4] = 0x80 | FLAC_METADATA_STREAMINFO;
+    info->header_buff[5] = 0;
+    info->header_buff[6] = 0;
+    info->header_buff[7] = FLAC_STREAMINFO_SIZE;
+    info->frame_start_offset = (int)offset;
+
+    OS_LOGV(TAG, "Found flac frame start offset: %d", info->frame_start_offset);
+    return 0;
+
+fail:
+    if (info->seektable != NULL) {
+        audio_free(info->seektable);
+        info->seektable = NULL;
+    }
+    info->seekpoint_count = 0;
+    return -1;
+}
+
+int flac_get_seek_offset(int seek_ms, struct flac_info *info, long *offset)
+{
+    if (info->sample_rate <= 0)
+        return -1;
+
+    // Decoder skips the samples between seek point and target
+    info->seek_sample = (uint64_t)seek_ms * info->sample_rate / 1000;
+    if (info->seekpoint_count <= 0 || info->seektable == NULL)
+        return -1;
+
+    int low = 0, high = info->seekpoint_count - 1;
+    int found = -1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (info->seektable[mid].sample_number <= info->seek_sample) {
+            found = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    *offset = (found >= 0) ? (long)info->seektable[found].offset : 0;
+    OS_LOGV(TAG, "Seek %dms, sample=%llu, offset=%ld", seek_ms,
+            (unsigned long long)info->seek_sample, *offset);
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _FLAC_EXTRACTOR_H_
+#define _FLAC_EXTRACTOR_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Return the data size obtained
+typedef int (*flac_fetch_cb)(char *buf, int wanted_size, long offset, void *fetch_priv);
+
+// "fLaC" + metadata block header + STREAMINFO
+#define FLAC_STREAMINFO_SIZE    34
+#define FLAC_HEADER_SIZE        (4 + 4 + FLAC_STREAMINFO_SIZE)
+// SEEKTABLE is decimated to keep memory bounded for huge tables
+#define FLAC_SEEKPOINT_MAX      1024
+
+struct flac_seekpoint {
+    uint64_t sample_number;
+    uint64_t offset;            // offset from the first frame header
+};
+
+struct flac_info {
+    int sample_rate;
+    int channels;
+    int bits;
+    int min_blocksize;
+    int max_blocksize;
+    int min_framesize;          // zero if unknown
+    int max_framesize;          // zero if unknown
+    uint64_t total_samples;     // zero if unknown
+    int frame_start_offset;
+
+    // Decoder starts with this header, so it can resume at any frame after seeking
+    uint8_t header_buff[FLAC_HEADER_SIZE];
+
+    int seekpoint_count;
+    struct flac_seekpoint *seektable; // need to free when resetting player
+
+    uint64_t seek_sample;       // target of the last seek, set by flac_get_seek_offset
+};
+
+int flac_extractor(flac_fetch_cb fetch_cb, void *fetch_priv, struct flac_info *info);
+
+// Offset of the last seek point before seek_ms, fails if there is no SEEKTABLE.
+// seek_sample is updated either way, so decoder can skip to the exact sample
+int flac_get_seek_offset(int seek_ms, struct flac_info *info, long *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
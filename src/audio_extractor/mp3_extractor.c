@@ -36,20 +36,13 @@ int mp3_find_syncword(char *buf, int size)
     return -1;
 }
 
-int mp3_parse_header(char *buf, int buf_size, struct mp3_info *info)
+static int mp3_decode_header(const char *buf, struct mp3_info *info)
 {
     unsigned char ver, layer, brIdx, srIdx, sMode, padding;
-    int sample_rate, bit_rate, frame_size;
-    bool double_check = false;
-
-    if (buf_size < 4)
-        return -1;
+    int sample_rate, bit_rate, frame_size, samples_per_frame;
 
-check_next_frame:
-    if ((buf[0] & 0xFF) != 0xFF || (buf[1] & 0xE0) != 0xE0) {
-        OS_LOGE(TAG, "Invalid sync word");
+    if ((buf[0] & 0xFF) != 0xFF || (buf[1] & 0xE0) != 0xE0)
         return -1;
-    }
 
     // read header fields - use bitmasks instead of GetBits() for speed, since format never varies
     ver     = (buf[1] >> 3) & 0x03;
@@ -60,15 +53,8 @@ check_next_frame:
     sMode   = (buf[3] >> 6) & 0x03;
 
     // check parameters to avoid indexing tables with bad values
-    if (ver == 1 ||  srIdx >= 3 || layer == 0 || brIdx == 15 || brIdx == 0) {
-        OS_LOGE(TAG, "Invalid mp3 header");
+    if (ver == 1 ||  srIdx >= 3 || layer == 0 || brIdx == 15 || brIdx == 0)
         return -1;
-    }
-
-    if (double_check)
-        goto success;
-
-    OS_LOGV(TAG, "srIdx=%d, ver=%d, layer=%d, brIdx=%d", srIdx, ver, layer, brIdx);
 
     static const int kSamplingRateV1[] = {44100, 48000, 32000};
     sample_rate = kSamplingRateV1[srIdx];
@@ -88,6 +74,7 @@ check_next_frame:
         };
         bit_rate = (ver == 3) ? kBitrateV1[brIdx - 1] : kBitrateV2[brIdx - 1];
         frame_size = (12000 * bit_rate / sample_rate + padding) * 4;
+        samples_per_frame = 384;
     } else {
         // layer II or III
         static const int kBitrateV1L2[] = {
@@ -108,10 +95,12 @@ check_next_frame:
 
         if (ver == 3 /* V1 */) {
             frame_size = 144000 * bit_rate / sample_rate + padding;
+            samples_per_frame = 1152;
         } else {
             // V2 or V2.5
             int tmp = (layer == 1 /* L3 */) ? 72000 : 144000;
             frame_size = tmp * bit_rate / sample_rate + padding;
+            samples_per_frame = (layer == 1 /* L3 */) ? 576 : 1152;
         }
     }
 
@@ -119,19 +108,142 @@ check_next_frame:
     info->sample_rate = sample_rate;
     info->bit_rate = bit_rate;
     info->frame_size = frame_size;
+    info->samples_per_frame = samples_per_frame;
+    return 0;
+}
+
+int mp3_parse_header(char *buf, int buf_size, struct mp3_info *info)
+{
+    struct mp3_info next;
+
+    if (buf_size < 4)
+        return -1;
+
+    if (mp3_decode_header(buf, info) != 0) {
+        OS_LOGE(TAG, "Invalid mp3 header");
+        return -1;
+    }
 
     OS_LOGD(TAG, "channels=%d, sample_rate=%d, bit_rate=%d, frame_size=%d",
              info->channels, info->sample_rate, info->bit_rate, info->frame_size);
 
-    if (frame_size + 4 > buf_size) {
+    if (info->frame_size + 4 > buf_size) {
         OS_LOGD(TAG, "Not enough data to double check, but go on");
         return 0;
     }
-    buf += frame_size;
-    double_check = true;
-    goto check_next_frame;
 
-success:
+    if (mp3_decode_header(buf + info->frame_size, &next) != 0) {
+        OS_LOGE(TAG, "Invalid mp3 header");
+        return -1;
+    }
+    return 0;
+}
+
+static unsigned int mp3_read_be32(const unsigned char *p)
+{
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) |
+           ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+}
+
+static unsigned int mp3_read_be16(const unsigned char *p)
+{
+    return ((unsigned int)p[0] << 8) | (unsigned int)p[1];
+}
+
+static int mp3_parse_xing(const unsigned char *frame, int size, struct mp3_info *info)
+{
+    unsigned char ver = (frame[1] >> 3) & 0x03;
+    unsigned char sMode = (frame[3] >> 6) & 0x03;
+    int side_info_size;
+    if (ver == 3 /* V1 */)
+        side_info_size = (sMode == 0x03) ? 17 : 32;
+    else
+        side_info_size = (sMode == 0x03) ? 9 : 17;
+
+    const unsigned char *p = frame + 4 + side_info_size;
+    const unsigned char *end = frame + size;
+    if (p + 8 > end)
+        return -1;
+    if (memcmp(p, "Xing", 4) != 0 && memcmp(p, "Info", 4) != 0)
+        return -1;
+
+    unsigned int flags = mp3_read_be32(p + 4);
+    p += 8;
+    if (flags & 0x1) {
+        if (p + 4 > end)
+            return -1;
+        info->total_frames = (int)mp3_read_be32(p);
+        p += 4;
+    }
+    if (flags & 0x2) {
+        if (p + 4 > end)
+            return -1;
+        info->total_bytes = (long)mp3_read_be32(p);
+        p += 4;
+    }
+    if (flags & 0x4) {
+        if (p + MP3_TOC_ENTRIES > end)
+            return -1;
+        memcpy(info->toc, p, MP3_TOC_ENTRIES);
+        info->has_toc = true;
+    }
+
+    OS_LOGD(TAG, "Found %.4s header: frames=%d, bytes=%ld, toc=%d",
+            frame + 4 + side_info_size, info->total_frames, info->total_bytes, info->has_toc);
+    return 0;
+}
+
+static int mp3_parse_vbri(const unsigned char *frame, int size, struct mp3_info *info)
+{
+    // VBRI header is always located 32 bytes after the end of the frame header
+    const unsigned char *p = frame + 4 + 32;
+    const unsigned char *end = frame + size;
+    if (p + 26 > end || memcmp(p, "VBRI", 4) != 0)
+        return -1;
+
+    unsigned int bytes = mp3_read_be32(p + 10);
+    unsigned int frames = mp3_read_be32(p + 14);
+    unsigned int entries = mp3_read_be16(p + 18);
+    unsigned int scale = mp3_read_be16(p + 20);
+    unsigned int entry_size = mp3_read_be16(p + 22);
+    unsigned int frames_per_entry = mp3_read_be16(p + 24);
+    const unsigned char *table = p + 26;
+
+    info->total_frames = (int)frames;
+    info->total_bytes = (long)bytes;
+
+    if (bytes == 0 || frames == 0 || entries == 0 || frames_per_entry == 0 ||
+        entry_size == 0 || entry_size > 4 || table + entries * entry_size > end)
+        goto out;
+
+    // Convert the per-entry byte sizes into the Xing style percent TOC
+    long long entry_start = 0;
+    unsigned int entry = 0;
+    for (int i = 0; i < MP3_TOC_ENTRIES; i++) {
+        unsigned int target = (unsigned int)((unsigned long long)frames * i / MP3_TOC_ENTRIES);
+        unsigned int entry_len = 0;
+        for (;;) {
+            entry_len = 0;
+            for (unsigned int b = 0; b < entry_size; b++)
+                entry_len = (entry_len << 8) | table[entry * entry_size + b];
+            entry_len *= scale;
+            if (entry + 1 >= entries || target < (entry + 1) * frames_per_entry)
+                break;
+            entry_start += entry_len;
+            entry++;
+        }
+        unsigned int in_entry = target - entry * frames_per_entry;
+        if (in_entry > frames_per_entry)
+            in_entry = frames_per_entry;
+        long long pos = entry_start + (long long)entry_len * in_entry / frames_per_entry;
+        long long value = pos * 256 / bytes;
+        info->toc[i] = (unsigned char)(value > 255 ? 255 : value);
+    }
+    info->has_toc = true;
+
+out:
+    OS_LOGD(TAG, "Found VBRI header: frames=%d, bytes=%ld, toc=%d",
+            info->total_frames, info->total_bytes, info->has_toc);
     return 0;
 }
 
@@ -143,6 +255,10 @@ static void mp3_dump_info(struct mp3_info *info)
     OS_LOGD(TAG, "  >bit_rate          : %d", info->bit_rate);
     OS_LOGD(TAG, "  >frame_size        : %d", info->frame_size);
     OS_LOGD(TAG, "  >frame_start_offset: %d", info->frame_start_offset);
+    OS_LOGD(TAG, "  >samples_per_frame : %d", info->samples_per_frame);
+    OS_LOGD(TAG, "  >total_frames      : %d", info->total_frames);
+    OS_LOGD(TAG, "  >total_bytes       : %ld", info->total_bytes);
+    OS_LOGD(TAG, "  >has_toc           : %d", info->has_toc);
 }
 
 int mp3_extractor(mp3_fetch_cb fetch_cb, void *fetch_priv, struct mp3_info *info)
@@ -217,7 +333,108 @@ find_syncword:
 finish:
     if (found) {
         info->frame_start_offset = frame_start_offset + last_position;
+        info->total_frames = 0;
+        info->total_bytes = 0;
+        info->has_toc = false;
+
+        // The first frame may carry a Xing/Info or VBRI header instead of audio data
+        buf_size = fetch_cb(buf, sizeof(buf), info->frame_start_offset, fetch_priv);
+        if (buf_size >= 4) {
+            int size = info->frame_size < buf_size ? info->frame_size : buf_size;
+            if (mp3_parse_xing((const unsigned char *)buf, size, info) != 0)
+                mp3_parse_vbri((const unsigned char *)buf, size, info);
+        }
         mp3_dump_info(info);
     }
     return found ? 0 : -1;
 }
+
+#define MP3_SCAN_CHECKPOINTS 1024
+
+int mp3_scan_frames(mp3_fetch_cb fetch_cb, void *fetch_priv, long content_len, struct mp3_info *info)
+{
+    char buf[DEFAULT_MP3_PARSER_BUFFER_SIZE];
+    long buf_offset = 0;
+    int buf_size = 0;
+    long offset = info->frame_start_offset;
+    int frames = 0;
+    int stride = 1;
+    int count = 0;
+    struct mp3_info frame;
+
+    // Offsets of every stride-th frame, stride doubles when the table is full
+    long *checkpoints = audio_malloc(sizeof(long) * MP3_SCAN_CHECKPOINTS);
+    if (checkpoints == NULL)
+        return -1;
+
+    while (content_len <= 0 || offset + 4 <= content_len) {
+        if (offset < buf_offset || offset + 4 > buf_offset + buf_size) {
+            buf_size = fetch_cb(buf, sizeof(buf), offset, fetch_priv);
+            if (buf_size < 4)
+                break;
+            buf_offset = offset;
+        }
+        if (mp3_decode_header(&buf[offset - buf_offset], &frame) != 0)
+            break;
+
+        if (frames % stride == 0) {
+            if (count == MP3_SCAN_CHECKPOINTS) {
+                for (int i = 0; i < MP3_SCAN_CHECKPOINTS/2; i++)
+                    checkpoints[i] = checkpoints[2*i];
+                count = MP3_SCAN_CHECKPOINTS/2;
+                stride *= 2;
+            }
+            if (frames % stride == 0)
+                checkpoints[count++] = offset;
+        }
+        frames++;
+        offset += frame.frame_size;
+    }
+
+    long stream_bytes = offset - info->frame_start_offset;
+    if (frames == 0 || stream_bytes <= 0) {
+        audio_free(checkpoints);
+        return -1;
+    }
+
+    for (int i = 0; i < MP3_TOC_ENTRIES; i++) {
+        int target = (int)((long long)frames * i / MP3_TOC_ENTRIES);
+        int idx = target / stride;
+        long pos = checkpoints[idx];
+        if (idx + 1 < count)
+            pos += (checkpoints[idx + 1] - checkpoints[idx]) * (target % stride) / stride;
+        long long value = (long long)(pos - info->frame_start_offset) * 256 / stream_bytes;
+        info->toc[i] = (unsigned char)(value > 255 ? 255 : value);
+    }
+    info->total_frames = frames;
+    info->total_bytes = stream_bytes;
+    info->has_toc = true;
+    audio_free(checkpoints);
+
+    OS_LOGD(TAG, "Scanned %d frames, %ld bytes", frames, stream_bytes);
+    return 0;
+}
+
+int mp3_get_seek_offset(int seek_ms, int duration_ms, struct mp3_info *info, long *offset)
+{
+    if (!info->has_toc || info->total_bytes <= 0 || duration_ms <= 0)
+        return -1;
+
+    // percent of duration in 1/1000 units, interpolated between TOC entries
+    long long permille = (long long)seek_ms * MP3_TOC_ENTRIES * 1000 / duration_ms;
+    if (permille < 0)
+        permille = 0;
+    if (permille > MP3_TOC_ENTRIES * 1000)
+        permille = MP3_TOC_ENTRIES * 1000;
+
+    int a = (int)(permille / 1000);
+    if (a > MP3_TOC_ENTRIES - 1)
+        a = MP3_TOC_ENTRIES - 1;
+    long long fa = info->toc[a];
+    long long fb = (a < MP3_TOC_ENTRIES - 1) ? info->toc[a + 1] : 256;
+    long long fx = fa * 1000 + (fb - fa) * (permille - (long long)a * 1000);
+
+    *offset = (long)(fx * info->total_bytes / (256 * 1000));
+    OS_LOGD(TAG, "TOC seek: seek_ms=%d, offset=%ld", seek_ms, *offset);
+    return 0;
+}
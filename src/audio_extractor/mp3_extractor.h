@@ -15,6 +15,8 @@
 #ifndef _MP3_EXTRACTOR_H_
 #define _MP3_EXTRACTOR_H_
 
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -22,12 +24,23 @@ extern "C" {
 // Return the data size obtained
 typedef int (*mp3_fetch_cb)(char *buf, int wanted_size, long offset, void *fetch_priv);
 
+#define MP3_TOC_ENTRIES 100
+
 struct mp3_info {
     int channels;
     int sample_rate;
     int bit_rate;
     int frame_size;
     int frame_start_offset;
+    int samples_per_frame;
+
+    // from Xing/Info/VBRI header (or frame scan), 0 if unknown
+    int total_frames;
+    long total_bytes;
+
+    // Xing style TOC: toc[i]*total_bytes/256 is the byte offset at i% of duration
+    bool has_toc;
+    unsigned char toc[MP3_TOC_ENTRIES];
 };
 
 int mp3_find_syncword(char *buf, int size);
@@ -36,6 +49,11 @@ int mp3_parse_header(char *buf, int buf_size, struct mp3_info *info);
 
 int mp3_extractor(mp3_fetch_cb fetch_cb, void *fetch_priv, struct mp3_info *info);
 
+// Walk all frame headers to count frames and build TOC, for the files without Xing/VBRI header
+int mp3_scan_frames(mp3_fetch_cb fetch_cb, void *fetch_priv, long content_len, struct mp3_info *info);
+
+int mp3_get_seek_offset(int seek_ms, int duration_ms, struct mp3_info *info, long *offset);
+
 #ifdef __cplusplus
 }
 #endif
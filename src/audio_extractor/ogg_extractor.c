@@ -0,0 +1,276 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "audio_extractor/ogg_extractor.h"
+
+#define TAG "[liteplayer]ogg_extractor"
+
+#define OPUS_HEAD_SIZE              19
+// Keep fetch size under the parser buffer
+#define DEFAULT_OGG_PARSER_BUFFER_SIZE 2048
+// Last page is within the tail of stream
+#define OGG_TAIL_SCAN_MAX           (OGG_PAGE_SIZE_MAX + DEFAULT_OGG_PARSER_BUFFER_SIZE)
+
+static uint32_t ogg_read_le32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int ogg_parse_page_header(const char *buf, int size, struct ogg_page_header *header)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+
+    if (size < 4)
+        return 0;
+    if (memcmp(buf, "OggS", 4) != 0)
+        return -1;
+    if (size < OGG_PAGE_HEADER_SIZE)
+        return 0;
+    if (p[4] != 0 || (p[5] & ~0x07) != 0)
+        return -1;
+
+    header->header_type = p[5];
+    header->granule_position = (int64_t)(((uint64_t)ogg_read_le32(&p[10]) << 32) | ogg_read_le32(&p[6]));
+    header->serial_number = ogg_read_le32(&p[14]);
+    header->sequence_number = ogg_read_le32(&p[18]);
+    header->segment_count = p[26];
+    header->header_size = OGG_PAGE_HEADER_SIZE + header->segment_count;
+    if (size < header->header_size)
+        return 0;
+
+    header->body_size = 0;
+    for (int i = 0; i < header->segment_count; i++)
+        header->body_size += p[OGG_PAGE_HEADER_SIZE + i];
+    return header->header_size;
+}
+
+static int ogg_fetch_page_header(ogg_fetch_cb fetch_cb, void *fetch_priv, long offset,
+                                 char *buf, struct ogg_page_header *header)
+{
+    if (fetch_cb(buf, OGG_PAGE_HEADER_SIZE, offset, fetch_priv) != OGG_PAGE_HEADER_SIZE)
+        return -1;
+    int segments = buf[26] & 0xFF;
+    if (segments > 0 &&
+        fetch_cb(&buf[OGG_PAGE_HEADER_SIZE], segments, offset + OGG_PAGE_HEADER_SIZE, fetch_priv) != segments)
+        return -1;
+    if (ogg_parse_page_header(buf, OGG_PAGE_HEADER_SIZE + segments, header) <= 0)
+        return -1;
+    return 0;
+}
+
+// Find the first page of stream in [start, end), pages without granule are skipped
+static int ogg_find_next_granule(ogg_fetch_cb fetch_cb, void *fetch_priv, long start, long end,
+                                 struct opus_info *info, long *page_offset, struct ogg_page_header *page)
+{
+    char buf[DEFAULT_OGG_PARSER_BUFFER_SIZE];
+    char header[OGG_PAGE_HEADER_SIZE + OGG_PAGE_SEGMENTS_MAX];
+    long offset = start;
+
+    while (offset < end) {
+        int size = fetch_cb(buf, sizeof(buf), offset, fetch_priv);
+        if (size < OGG_PAGE_HEADER_SIZE)
+            return -1;
+
+        int i;
+        for (i = 0; i <= size - OGG_PAGE_HEADER_SIZE && offset + i < end; i++) {
+            if (buf[i] != 'O' || memcmp(&buf[i], "OggS", 4) != 0)
+                continue;
+            if (ogg_fetch_page_header(fetch_cb, fetch_priv, offset + i, header, page) != 0 ||
+                page->serial_number != info->serial_number)
+                continue;
+            // Walk pages from here, much cheaper than scanning bytes
+            long next = offset + i;
+            while (next < end) {
+                if (page->granule_position != -1) {
+                    *page_offset = next;
+                    return 0;
+                }
+                next += page->header_size + page->body_size;
+                if (ogg_fetch_page_header(fetch_cb, fetch_priv, next, header, page) != 0)
+                    return -1;
+            }
+            return -1;
+        }
+        offset += i;
+    }
+    return -1;
+}
+
+static int64_t ogg_find_last_granule(ogg_fetch_cb fetch_cb, void *fetch_priv, long content_len,
+                                     struct opus_info *info)
+{
+    char buf[DEFAULT_OGG_PARSER_BUFFER_SIZE];
+    struct ogg_page_header page;
+    long start = content_len;
+    long lowest = content_len - OGG_TAIL_SCAN_MAX;
+
+    if (lowest < info->frame_start_offset)
+        lowest = info->frame_start_offset;
+
+    while (start > lowest) {
+        // Overlap the chunks, so header across the boundary can be found
+        long end = start;
+        start = end - sizeof(buf);
+        if (start < lowest)
+            start = lowest;
+        int size = fetch_cb(buf, (int)(end - start), start, fetch_priv);
+        if (size < OGG_PAGE_HEADER_SIZE)
+            break;
+        for (int i = size - OGG_PAGE_HEADER_SIZE; i >= 0; i--) {
+            if (buf[i] != 'O' || ogg_parse_page_header(&buf[i], size - i, &page) == -1)
+                continue;
+            if (page.serial_number == info->serial_number && page.granule_position > 0)
+                return page.granule_position;
+        }
+        if (start > lowest)
+            start += OGG_PAGE_HEADER_SIZE - 1;
+    }
+    return 0;
+}
+
+static int opus_parse_head(const unsigned char *buf, int size, struct opus_info *info)
+{
+    if (size < OPUS_HEAD_SIZE || memcmp(buf, "OpusHead", 8) != 0) {
+        OS_LOGE(TAG, "Missing OpusHead packet");
+        return -1;
+    }
+    if ((buf[8] & 0xF0) != 0) {
+        OS_LOGE(TAG, "Unsupported OpusHead version: %d", buf[8]);
+        return -1;
+    }
+
+    info->channels          = buf[9];
+    info->pre_skip          = buf[10] | (buf[11] << 8);
+    info->input_sample_rate = (int)ogg_read_le32(&buf[12]);
+    info->output_gain       = (int16_t)(buf[16] | (buf[17] << 8));
+    info->mapping_family    = buf[18];
+
+    // Only mono and stereo are supported, which need no channel mapping table
+    if (info->channels < 1 || info->channels > 2 || (info->mapping_family != 0 && info->mapping_family != 1)) {
+        OS_LOGE(TAG, "Unsupported channels=%d, mapping family=%d", info->channels, info->mapping_family);
+        return -1;
+    }
+
+    // Decode at input rate if possible, it saves resampling in sink
+    switch (info->input_sample_rate) {
+    case 8000:
+    case 12000:
+    case 16000:
+    case 24000:
+    case 48000:
+        info->sample_rate = info->input_sample_rate;
+        break;
+    default:
+        info->sample_rate = OPUS_GRANULE_RATE;
+        break;
+    }
+
+    OS_LOGV(TAG, "OpusHead: channels=%d, pre_skip=%d, input_rate=%d, gain=%d, mapping=%d",
+            info->channels, info->pre_skip, info->input_sample_rate, info->output_gain, info->mapping_family);
+    return 0;
+}
+
+int ogg_opus_extractor(ogg_fetch_cb fetch_cb, void *fetch_priv, long content_len, struct opus_info *info)
+{
+    char header[OGG_PAGE_HEADER_SIZE + OGG_PAGE_SEGMENTS_MAX];
+    unsigned char head[OPUS_HEAD_SIZE];
+    struct ogg_page_header page;
+    long offset = 0;
+
+    if (ogg_fetch_page_header(fetch_cb, fetch_priv, offset, header, &page) != 0 ||
+        (page.header_type & OGG_HEADER_TYPE_BOS) == 0) {
+        OS_LOGE(TAG, "Invalid ogg stream, missing BOS page");
+        return -1;
+    }
+    if (page.body_size < OPUS_HEAD_SIZE ||
+        fetch_cb((char *)head, OPUS_HEAD_SIZE, offset + page.header_size, fetch_priv) != OPUS_HEAD_SIZE ||
+        opus_parse_head(head, OPUS_HEAD_SIZE, info) != 0)
+        return -1;
+    info->serial_number = page.serial_number;
+    offset += page.header_size + page.body_size;
+
+    // OpusTags may span several pages, and it must finish its last page
+    bool tags_done = false;
+    while (!tags_done) {
+        if (ogg_fetch_page_header(fetch_cb, fetch_priv, offset, header, &page) != 0) {
+            OS_LOGE(TAG, "Failed to read OpusTags page at %ld", offset);
+            return -1;
+        }
+        if (page.serial_number == info->serial_number) {
+            for (int i = 0; i < page.segment_count; i++) {
+                if ((header[OGG_PAGE_HEADER_SIZE + i] & 0xFF) < 255)
+                    tags_done = true;
+            }
+        }
+        offset += page.header_size + page.body_size;
+    }
+    info->frame_start_offset = (int)offset;
+
+    info->total_granule = 0;
+    if (content_len > offset)
+        info->total_granule = ogg_find_last_granule(fetch_cb, fetch_priv, content_len, info);
+
+    OS_LOGV(TAG, "Found opus frame start offset: %d, total granule: %lld",
+            info->frame_start_offset, (long long)info->total_granule);
+    return 0;
+}
+
+int ogg_opus_get_seek_offset(ogg_fetch_cb fetch_cb, void *fetch_priv, long content_len,
+                             int seek_ms, struct opus_info *info, long *offset)
+{
+    struct ogg_page_header page;
+    long page_offset = 0;
+
+    int64_t target = (int64_t)seek_ms*(OPUS_GRANULE_RATE/1000) + info->pre_skip;
+    int64_t search = target - OPUS_SEEK_PREROLL;
+    if (search <= 0) {
+        *offset = 0;
+        info->seek_granule = target;
+        return 0;
+    }
+    if (content_len <= info->frame_start_offset)
+        return -1;
+
+    // Decoding resumes at the page after the last page that ends before search point,
+    // the first packet it finishes starts exactly at that granule
+    long low = info->frame_start_offset;
+    long high = content_len;
+    long found = info->frame_start_offset;
+    while (high - low > DEFAULT_OGG_PARSER_BUFFER_SIZE) {
+        long middle = low + (high - low)/2;
+        if (ogg_find_next_granule(fetch_cb, fetch_priv, middle, high, info, &page_offset, &page) != 0 ||
+            page.granule_position >= search) {
+            high = middle;
+        } else {
+            found = low = page_offset + page.header_size + page.body_size;
+        }
+    }
+
+    // Walk the remaining pages one by one
+    while (ogg_find_next_granule(fetch_cb, fetch_priv, low, content_len, info, &page_offset, &page) == 0 &&
+           page.granule_position < search) {
+        found = low = page_offset + page.header_size + page.body_size;
+    }
+
+    *offset = found - info->frame_start_offset;
+    info->seek_granule = target;
+    OS_LOGV(TAG, "Seek %dms, granule=%lld, offset=%ld", seek_ms, (long long)target, *offset);
+    return 0;
+}
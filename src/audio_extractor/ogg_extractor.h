@@ -0,0 +1,79 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _OGG_EXTRACTOR_H_
+#define _OGG_EXTRACTOR_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Return the data size obtained
+typedef int (*ogg_fetch_cb)(char *buf, int wanted_size, long offset, void *fetch_priv);
+
+#define OGG_PAGE_HEADER_SIZE        27
+#define OGG_PAGE_SEGMENTS_MAX       255
+#define OGG_PAGE_SIZE_MAX           (OGG_PAGE_HEADER_SIZE + OGG_PAGE_SEGMENTS_MAX*256)
+
+#define OGG_HEADER_TYPE_CONTINUED   0x01
+#define OGG_HEADER_TYPE_BOS         0x02
+#define OGG_HEADER_TYPE_EOS         0x04
+
+// Opus granule position is always counted at 48kHz
+#define OPUS_GRANULE_RATE           48000
+// Decoder needs 80ms to converge after seeking
+#define OPUS_SEEK_PREROLL           (OPUS_GRANULE_RATE*80/1000)
+
+struct ogg_page_header {
+    uint8_t  header_type;
+    int64_t  granule_position;  // -1 if no packet finishes on this page
+    uint32_t serial_number;
+    uint32_t sequence_number;
+    int      segment_count;     // lacing values follow the fixed header
+    int      header_size;
+    int      body_size;
+};
+
+struct opus_info {
+    int channels;
+    int sample_rate;            // decoder output rate, input rate if opus supports it, or 48kHz
+    int input_sample_rate;      // rate of the original input, informational only
+    int pre_skip;               // samples at 48kHz to discard at the beginning
+    int output_gain;            // Q7.8 in dB, applied by decoder
+    int mapping_family;
+    uint32_t serial_number;
+    int frame_start_offset;     // the first audio page, after OpusHead and OpusTags
+    int64_t total_granule;      // granule position of the last page, zero if unknown
+
+    int64_t seek_granule;       // target of the last seek, set by ogg_opus_get_seek_offset
+};
+
+// Parse page header, lacing values are at &buf[OGG_PAGE_HEADER_SIZE].
+// Return header size, 0 if more bytes are needed, -1 if it's not a page
+int ogg_parse_page_header(const char *buf, int size, struct ogg_page_header *header);
+
+int ogg_opus_extractor(ogg_fetch_cb fetch_cb, void *fetch_priv, long content_len, struct opus_info *info);
+
+// Bisect pages by granule position, offset is the page to resume decoding
+// (relative to frame_start_offset). seek_granule is updated on success
+int ogg_opus_get_seek_offset(ogg_fetch_cb fetch_cb, void *fetch_priv, long content_len,
+                             int seek_ms, struct opus_info *info, long *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
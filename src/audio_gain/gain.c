@@ -0,0 +1,225 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "audio_gain/gain.h"
+
+#if !defined(GAIN_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64)
+#define GAIN_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GAIN_USE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#define TAG "[liteplayer]gain"
+
+// Frames processed with the same gain while ramping
+#define GAIN_BLOCK_FRAMES   32
+
+// S16 gain is Q12, so s16 * gain fits in int32 up to GAIN_LINEAR_MAX
+#define GAIN_S16_SHIFT      12
+
+#define GAIN_CHANNELS_MAX   8
+
+struct gain {
+    struct gain_cfg cfg;
+    int         sample_size;
+    int         ramp_samples;   // samples of a full ramp, all channels
+    float       current;
+    float       target;
+    float       step;           // gain change per sample while ramping
+    int         ramp_remain;
+};
+
+static inline int16_t gain_to_s16(float gain)
+{
+    return (int16_t)lrintf(gain * (1 << GAIN_S16_SHIFT));
+}
+
+static void gain_apply_s16(const int16_t *in, int16_t *out, int count, int16_t g)
+{
+    int i = 0;
+#if defined(GAIN_USE_SSE2)
+    const __m128i vg = _mm_set1_epi16(g);
+    const __m128i round = _mm_set1_epi32(1 << (GAIN_S16_SHIFT - 1));
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i lo = _mm_mullo_epi16(x, vg);
+        __m128i hi = _mm_mulhi_epi16(x, vg);
+        __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), GAIN_S16_SHIFT);
+        __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), GAIN_S16_SHIFT);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(p0, p1));
+    }
+#elif defined(GAIN_USE_NEON)
+    const int16x4_t vg = vdup_n_s16(g);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        int32x4_t p0 = vrshrq_n_s32(vmull_s16(vget_low_s16(x), vg), GAIN_S16_SHIFT);
+        int32x4_t p1 = vrshrq_n_s32(vmull_s16(vget_high_s16(x), vg), GAIN_S16_SHIFT);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1)));
+    }
+#endif
+    for (; i < count; i++) {
+        int32_t v = ((int32_t)in[i] * g + (1 << (GAIN_S16_SHIFT - 1))) >> GAIN_S16_SHIFT;
+        if (v > INT16_MAX)
+            v = INT16_MAX;
+        else if (v < INT16_MIN)
+            v = INT16_MIN;
+        out[i] = (int16_t)v;
+    }
+}
+
+// Float multiply rounded to nearest, the same in C, SSE2 and NEON
+static void gain_apply_s32(const int32_t *in, int32_t *out, int count, float g)
+{
+    int i = 0;
+#if defined(GAIN_USE_SSE2)
+    const __m128 vg = _mm_set1_ps(g);
+    const __m128 limit = _mm_set1_ps(2147483648.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(in + i))), vg);
+        // Out of range converts to INT32_MIN, flip it to INT32_MAX when positive
+        __m128i r = _mm_xor_si128(_mm_cvtps_epi32(v), _mm_castps_si128(_mm_cmpge_ps(v, limit)));
+        _mm_storeu_si128((__m128i *)(out + i), r);
+    }
+#elif defined(GAIN_USE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(in + i)), g);
+        vst1q_s32(out + i, vcvtnq_s32_f32(v));
+    }
+#endif
+    for (; i < count; i++) {
+        float v = (float)in[i] * g;
+        if (v >= 2147483648.0f)
+            out[i] = INT32_MAX;
+        else if (v <= -2147483648.0f)
+            out[i] = INT32_MIN;
+        else
+            out[i] = (int32_t)lrintf(v);
+    }
+}
+
+static void gain_apply(gain_handle_t g, const char *in, char *out, int count, float gain)
+{
+    if (gain == 1.0f) {
+        if (in != out)
+            memcpy(out, in, count * g->sample_size);
+        return;
+    }
+    if (g->cfg.bits == 16)
+        gain_apply_s16((const int16_t *)in, (int16_t *)out, count, gain_to_s16(gain));
+    else
+        gain_apply_s32((const int32_t *)in, (int32_t *)out, count, gain);
+}
+
+gain_handle_t gain_create(struct gain_cfg *cfg, float initial)
+{
+    if (cfg == NULL || cfg->samplerate <= 0 || cfg->channels <= 0 || cfg->channels > GAIN_CHANNELS_MAX ||
+        (cfg->bits != 16 && cfg->bits != 32) || cfg->ramp_ms < 0) {
+        OS_LOGE(TAG, "Invalid gain config");
+        return NULL;
+    }
+
+    gain_handle_t g = audio_calloc(1, sizeof(struct gain));
+    AUDIO_MEM_CHECK(TAG, g, return NULL);
+
+    memcpy(&g->cfg, cfg, sizeof(struct gain_cfg));
+    g->sample_size = cfg->bits / 8;
+    g->ramp_samples = (int)((long long)cfg->samplerate * cfg->ramp_ms / 1000) * cfg->channels;
+    gain_set_target(g, initial);
+    gain_reset(g);
+    return g;
+}
+
+void gain_set_target(gain_handle_t handle, float gain)
+{
+    if (handle == NULL)
+        return;
+    if (!(gain > 0.0f))
+        gain = 0.0f;
+    else if (gain > GAIN_LINEAR_MAX)
+        gain = GAIN_LINEAR_MAX;
+    if (gain == handle->target)
+        return;
+
+    handle->target = gain;
+    if (handle->ramp_samples == 0) {
+        gain_reset(handle);
+        return;
+    }
+    handle->ramp_remain = handle->ramp_samples;
+    handle->step = (handle->target - handle->current) / handle->ramp_samples;
+}
+
+bool gain_is_unity(gain_handle_t handle)
+{
+    return handle == NULL || (handle->ramp_remain == 0 && handle->current == 1.0f);
+}
+
+void gain_process(gain_handle_t handle, const char *in, char *out, int bytes)
+{
+    if (handle == NULL || in == NULL || out == NULL || bytes <= 0)
+        return;
+
+    gain_handle_t g = handle;
+    int count = bytes / g->sample_size;
+    int block = GAIN_BLOCK_FRAMES * g->cfg.channels;
+
+    while (count > 0 && g->ramp_remain > 0) {
+        int n = block;
+        if (n > g->ramp_remain)
+            n = g->ramp_remain;
+        if (n > count)
+            n = count;
+        gain_apply(g, in, out, n, g->current);
+        in += n * g->sample_size;
+        out += n * g->sample_size;
+        count -= n;
+
+        g->ramp_remain -= n;
+        if (g->ramp_remain == 0)
+            g->current = g->target;
+        else
+            g->current += g->step * n;
+    }
+
+    if (count > 0)
+        gain_apply(g, in, out, count, g->current);
+}
+
+void gain_reset(gain_handle_t handle)
+{
+    if (handle == NULL)
+        return;
+    handle->current = handle->target;
+    handle->ramp_remain = 0;
+    handle->step = 0.0f;
+}
+
+void gain_destroy(gain_handle_t handle)
+{
+    if (handle == NULL)
+        return;
+    audio_free(handle);
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _GAIN_H_
+#define _GAIN_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Max linear gain, about +18dB, keeps the s16 gain in Q12
+#define GAIN_LINEAR_MAX     7.9f
+
+struct gain_cfg {
+    int samplerate;
+    int channels;
+    int bits;                   // 16 or 32, interleaved s16le/s32le
+    int ramp_ms;                // duration of a gain change, 0 to jump
+};
+
+/*
+ * Gain applies a linear gain to pcm with saturation. A new target is
+ * reached with a linear ramp, the gain is held per block of a few frames,
+ * so the multiply runs on SSE2/NEON with one gain per block.
+ */
+typedef struct gain *gain_handle_t;
+
+gain_handle_t gain_create(struct gain_cfg *cfg, float initial);
+
+// Ramp to gain from the next processed frame, clamped to [0, GAIN_LINEAR_MAX]
+void gain_set_target(gain_handle_t handle, float gain);
+
+// True when processing would copy pcm unchanged
+bool gain_is_unity(gain_handle_t handle);
+
+// Process bytes of pcm from in to out, in and out may be the same buffer
+void gain_process(gain_handle_t handle, const char *in, char *out, int bytes);
+
+// Finish a pending ramp, call it after seeking
+void gain_reset(gain_handle_t handle);
+
+void gain_destroy(gain_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,302 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "audio_loudness/loudness.h"
+
+#define TAG "[liteplayer]loudness"
+
+#define LOUDNESS_CHANNELS_MAX   8
+
+// Gating blocks are 400ms, made of 4 steps of 100ms
+#define LOUDNESS_BLOCK_STEPS    4
+#define LOUDNESS_STEP_MS        100
+
+#define LOUDNESS_ABSOLUTE_GATE  (-70.0)
+#define LOUDNESS_RELATIVE_GATE  (-10.0)
+
+// Taps of each polyphase branch of the true peak interpolator
+#define TRUE_PEAK_TAPS          12
+#define TRUE_PEAK_PHASES_MAX    4
+
+// Filter states below this are flushed, so silence never runs on denormals
+#define LOUDNESS_STATE_MIN      1e-30
+
+struct biquad {
+    double b0, b1, b2, a1, a2;
+};
+
+struct loudness {
+    struct loudness_cfg cfg;
+    int         sample_size;
+    double      weight[LOUDNESS_CHANNELS_MAX];
+
+    struct biquad shelf;
+    struct biquad highpass;
+    double      state[LOUDNESS_CHANNELS_MAX][4];
+    double      sumsq[LOUDNESS_CHANNELS_MAX];
+
+    int         step_frames;
+    int         step_count;
+    double      steps[LOUDNESS_BLOCK_STEPS];
+    long long   step_total;
+
+    double     *blocks;         // mean square of every gating block
+    int         block_count;
+    int         block_size;
+
+    int         phases;
+    float       fir[TRUE_PEAK_PHASES_MAX][TRUE_PEAK_TAPS];
+    float       history[LOUDNESS_CHANNELS_MAX][2 * TRUE_PEAK_TAPS];
+    int         history_pos;
+    double      peak;
+};
+
+// K-weighting of BS.1770 computed for any samplerate, it matches the
+// coefficients tabled in the recommendation at 48k
+static void loudness_init_k_weighting(loudness_handle_t l)
+{
+    double fs = l->cfg.samplerate;
+
+    // Stage 1, high shelf of about +4dB modelling the head
+    double f0 = 1681.974450955533;
+    double G = 3.999843853973347;
+    double Q = 0.7071752369554196;
+    double K = tan(M_PI * f0 / fs);
+    double Vh = pow(10.0, G / 20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+    l->shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+    l->shelf.b1 = 2.0 * (K * K - Vh) / a0;
+    l->shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+    l->shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+    l->shelf.a2 = (1.0 - K / Q + K * K) / a0;
+
+    // Stage 2, RLB high pass
+    f0 = 38.13547087602444;
+    Q = 0.5003270373238773;
+    K = tan(M_PI * f0 / fs);
+    a0 = 1.0 + K / Q + K * K;
+    l->highpass.b0 = 1.0;
+    l->highpass.b1 = -2.0;
+    l->highpass.b2 = 1.0;
+    l->highpass.a1 = 2.0 * (K * K - 1.0) / a0;
+    l->highpass.a2 = (1.0 - K / Q + K * K) / a0;
+}
+
+// Windowed sinc interpolator split in polyphase branches, branch taps are
+// reversed to run over the history in time order
+static void loudness_init_true_peak(loudness_handle_t l)
+{
+    if (l->cfg.samplerate < 96000)
+        l->phases = 4;
+    else if (l->cfg.samplerate < 192000)
+        l->phases = 2;
+    else
+        l->phases = 1;
+    if (l->phases == 1)
+        return;
+
+    int length = l->phases * TRUE_PEAK_TAPS;
+    double center = (length - 1) / 2.0;
+    for (int n = 0; n < length; n++) {
+        double x = (n - center) / l->phases;
+        double sinc = x == 0.0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double window = 0.5 - 0.5 * cos(2.0 * M_PI * (n + 0.5) / length);
+        int phase = n % l->phases;
+        int tap = n / l->phases;
+        l->fir[phase][TRUE_PEAK_TAPS - 1 - tap] = (float)(sinc * window);
+    }
+}
+
+static inline double biquad_run(const struct biquad *f, double *z, double x)
+{
+    double y = f->b0 * x + z[0];
+    z[0] = f->b1 * x - f->a1 * y + z[1];
+    z[1] = f->b2 * x - f->a2 * y;
+    return y;
+}
+
+static void loudness_add_block(loudness_handle_t l, double mean_square)
+{
+    if (l->block_count == l->block_size) {
+        int size = l->block_size > 0 ? l->block_size * 2 : 1024;
+        double *blocks = audio_realloc(l->blocks, size * sizeof(double));
+        AUDIO_MEM_CHECK(TAG, blocks, return);
+        l->blocks = blocks;
+        l->block_size = size;
+    }
+    l->blocks[l->block_count++] = mean_square;
+}
+
+static void loudness_end_step(loudness_handle_t l)
+{
+    double energy = 0.0;
+    for (int ch = 0; ch < l->cfg.channels; ch++) {
+        energy += l->weight[ch] * l->sumsq[ch];
+        l->sumsq[ch] = 0.0;
+        for (int i = 0; i < 4; i++) {
+            if (fabs(l->state[ch][i]) < LOUDNESS_STATE_MIN)
+                l->state[ch][i] = 0.0;
+        }
+    }
+
+    l->steps[l->step_total % LOUDNESS_BLOCK_STEPS] = energy;
+    l->step_total++;
+    l->step_count = 0;
+    if (l->step_total < LOUDNESS_BLOCK_STEPS)
+        return;
+
+    double sum = 0.0;
+    for (int i = 0; i < LOUDNESS_BLOCK_STEPS; i++)
+        sum += l->steps[i];
+    loudness_add_block(l, sum / ((double)l->step_frames * LOUDNESS_BLOCK_STEPS));
+}
+
+static void loudness_true_peak(loudness_handle_t l, int ch, float x)
+{
+    float *history = l->history[ch];
+    history[l->history_pos] = x;
+    history[l->history_pos + TRUE_PEAK_TAPS] = x;
+
+    const float *window = &history[l->history_pos + 1];
+    for (int p = 0; p < l->phases; p++) {
+        float y = 0.0f;
+        for (int i = 0; i < TRUE_PEAK_TAPS; i++)
+            y += l->fir[p][i] * window[i];
+        if (fabsf(y) > l->peak)
+            l->peak = fabsf(y);
+    }
+}
+
+loudness_handle_t loudness_create(struct loudness_cfg *cfg)
+{
+    if (cfg == NULL || cfg->samplerate < 8000 || cfg->channels <= 0 ||
+        cfg->channels > LOUDNESS_CHANNELS_MAX || (cfg->bits != 16 && cfg->bits != 32)) {
+        OS_LOGE(TAG, "Invalid loudness config");
+        return NULL;
+    }
+
+    loudness_handle_t l = audio_calloc(1, sizeof(struct loudness));
+    AUDIO_MEM_CHECK(TAG, l, return NULL);
+
+    memcpy(&l->cfg, cfg, sizeof(struct loudness_cfg));
+    l->sample_size = cfg->bits / 8;
+    l->step_frames = cfg->samplerate * LOUDNESS_STEP_MS / 1000;
+
+    for (int ch = 0; ch < cfg->channels; ch++)
+        l->weight[ch] = 1.0;
+    if (cfg->channels == 5) {
+        l->weight[3] = l->weight[4] = 1.41;
+    } else if (cfg->channels == 6) {
+        l->weight[3] = 0.0;
+        l->weight[4] = l->weight[5] = 1.41;
+    }
+
+    loudness_init_k_weighting(l);
+    loudness_init_true_peak(l);
+    return l;
+}
+
+void loudness_process(loudness_handle_t handle, const char *in, int bytes)
+{
+    if (handle == NULL || in == NULL || bytes <= 0)
+        return;
+
+    loudness_handle_t l = handle;
+    int channels = l->cfg.channels;
+    int frames = bytes / (l->sample_size * channels);
+    const int16_t *in16 = (const int16_t *)in;
+    const int32_t *in32 = (const int32_t *)in;
+
+    for (int f = 0; f < frames; f++) {
+        for (int ch = 0; ch < channels; ch++) {
+            double x;
+            if (l->cfg.bits == 16)
+                x = *in16++ / 32768.0;
+            else
+                x = *in32++ / 2147483648.0;
+
+            double y = biquad_run(&l->shelf, &l->state[ch][0], x);
+            y = biquad_run(&l->highpass, &l->state[ch][2], y);
+            l->sumsq[ch] += y * y;
+
+            if (fabs(x) > l->peak)
+                l->peak = fabs(x);
+            if (l->phases > 1)
+                loudness_true_peak(l, ch, (float)x);
+        }
+        if (++l->history_pos == TRUE_PEAK_TAPS)
+            l->history_pos = 0;
+        if (++l->step_count == l->step_frames)
+            loudness_end_step(l);
+    }
+}
+
+double loudness_get_integrated(loudness_handle_t handle)
+{
+    if (handle == NULL)
+        return LOUDNESS_SILENCE_LUFS;
+
+    loudness_handle_t l = handle;
+    double absolute = pow(10.0, (LOUDNESS_ABSOLUTE_GATE + 0.691) / 10.0);
+    double sum = 0.0;
+    int count = 0;
+    for (int i = 0; i < l->block_count; i++) {
+        if (l->blocks[i] > absolute) {
+            sum += l->blocks[i];
+            count++;
+        }
+    }
+    if (count == 0)
+        return LOUDNESS_SILENCE_LUFS;
+
+    double relative = sum / count * pow(10.0, LOUDNESS_RELATIVE_GATE / 10.0);
+    double gate = relative > absolute ? relative : absolute;
+    sum = 0.0;
+    count = 0;
+    for (int i = 0; i < l->block_count; i++) {
+        if (l->blocks[i] > gate) {
+            sum += l->blocks[i];
+            count++;
+        }
+    }
+    if (count == 0)
+        return LOUDNESS_SILENCE_LUFS;
+
+    double lufs = -0.691 + 10.0 * log10(sum / count);
+    return lufs > LOUDNESS_SILENCE_LUFS ? lufs : LOUDNESS_SILENCE_LUFS;
+}
+
+double loudness_get_true_peak(loudness_handle_t handle)
+{
+    if (handle == NULL || handle->peak <= 0.0)
+        return -HUGE_VAL;
+    return 20.0 * log10(handle->peak);
+}
+
+void loudness_destroy(loudness_handle_t handle)
+{
+    if (handle == NULL)
+        return;
+    audio_free(handle->blocks);
+    audio_free(handle);
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _LOUDNESS_H_
+#define _LOUDNESS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Integrated loudness of a stream with no block above the absolute gate
+#define LOUDNESS_SILENCE_LUFS       (-70.0)
+
+struct loudness_cfg {
+    int samplerate;
+    int channels;               // 5 and 6 channels are weighted as 5.0/5.1 (L R C [LFE] Ls Rs)
+    int bits;                   // 16 or 32, interleaved s16le/s32le as decoders output
+};
+
+/*
+ * Loudness meter of EBU R128 / ITU-R BS.1770-4: K-weighted mean square
+ * over 400ms blocks with 75% overlap, gated at -70 LUFS and then 10 LU
+ * below the ungated mean. True peak is measured on a 4x oversampled
+ * signal (2x from 96k, none from 192k).
+ */
+typedef struct loudness *loudness_handle_t;
+
+loudness_handle_t loudness_create(struct loudness_cfg *cfg);
+
+// Measure bytes of pcm, partial frames are dropped
+void loudness_process(loudness_handle_t handle, const char *in, int bytes);
+
+// Integrated loudness in LUFS of all pcm processed so far
+double loudness_get_integrated(loudness_handle_t handle);
+
+// Max true peak in dBTP of all pcm processed so far, -HUGE_VAL if all zero
+double loudness_get_true_peak(loudness_handle_t handle);
+
+void loudness_destroy(loudness_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,385 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "audio_resampler/resampler.h"
+
+#define TAG "[liteplayer]resampler"
+
+// Input frames filtered per pass, bounds the work buffer
+#define RESAMPLER_BLOCK_FRAMES      256
+
+// Kaiser windowed sinc, cutoff is relative to the lower nyquist
+#define RESAMPLER_FAST_TAPS         16
+#define RESAMPLER_FAST_PHASES       256
+#define RESAMPLER_FAST_BETA         6.0
+#define RESAMPLER_FAST_CUTOFF       0.85
+#define RESAMPLER_HIGH_TAPS         32
+#define RESAMPLER_HIGH_PHASES       128
+#define RESAMPLER_HIGH_BETA         9.0
+#define RESAMPLER_HIGH_CUTOFF       0.92
+
+#define RESAMPLER_CHANNELS_MAX      8
+
+struct resampler {
+    struct resampler_cfg cfg;
+    int         in_frame_size;
+    int         out_frame_size;
+    int         work_channels;  // channels that go through the filter
+    bool        convert_rate;
+
+    uint32_t    step;           // input samplerate / gcd
+    uint32_t    den;            // output samplerate / gcd
+    uint32_t    frac;           // position between input frames, in 1/den
+
+    int         taps;
+    int         phases;
+    int16_t    *coef_fixed;     // [phases][taps], Q15
+    float      *coef_float;     // [phases + 1][taps], last row is the next frame
+
+    // Planar work buffer, int16_t in fast mode, float in high mode
+    void       *frames;
+    int         frames_cap;
+    int         frames_filled;
+    int         frame_pos;      // first tap of the next output frame
+};
+
+static uint32_t resampler_gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static double resampler_bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0, half = x / 2.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+static double resampler_kaiser_sinc(double t, double half, double fc, double beta)
+{
+    double x = t / half;
+    if (x <= -1.0 || x >= 1.0)
+        return 0.0;
+    double window = resampler_bessel_i0(beta * sqrt(1.0 - x * x)) / resampler_bessel_i0(beta);
+    double s = fc * t;
+    double sinc = (fabs(s) < 1e-9) ? 1.0 : sin(M_PI * s) / (M_PI * s);
+    return fc * sinc * window;
+}
+
+static int resampler_design_filter(resampler_handle_t r)
+{
+    bool fixed = r->cfg.quality == RESAMPLER_QUALITY_FAST;
+    double beta = fixed ? RESAMPLER_FAST_BETA : RESAMPLER_HIGH_BETA;
+    double fc = fixed ? RESAMPLER_FAST_CUTOFF : RESAMPLER_HIGH_CUTOFF;
+    if (r->cfg.out_samplerate < r->cfg.in_samplerate)
+        fc = fc * r->cfg.out_samplerate / r->cfg.in_samplerate;
+    int rows = fixed ? r->phases : r->phases + 1;
+    double half = r->taps / 2;
+
+    if (fixed)
+        r->coef_fixed = audio_malloc(rows * r->taps * sizeof(int16_t));
+    else
+        r->coef_float = audio_malloc(rows * r->taps * sizeof(float));
+    if (r->coef_fixed == NULL && r->coef_float == NULL)
+        return -1;
+
+    for (int p = 0; p < rows; p++) {
+        double mu = (double)p / r->phases;
+        double sum = 0.0;
+        // Tap k is at input frame (frame_pos + k), the output is between tap half-1 and half
+        for (int k = 0; k < r->taps; k++)
+            sum += resampler_kaiser_sinc(k - (half - 1) - mu, half, fc, beta);
+        for (int k = 0; k < r->taps; k++) {
+            // Normalize every phase to unity dc gain
+            double h = resampler_kaiser_sinc(k - (half - 1) - mu, half, fc, beta) / sum;
+            if (fixed) {
+                long q = lrint(h * 32768.0);
+                r->coef_fixed[p * r->taps + k] = (int16_t)(q > 32767 ? 32767 : (q < -32768 ? -32768 : q));
+            } else {
+                r->coef_float[p * r->taps + k] = (float)h;
+            }
+        }
+    }
+    return 0;
+}
+
+static inline int32_t resampler_read_sample(const char *in, int bits, int index)
+{
+    if (bits == 16)
+        return (int32_t)((uint32_t)((const int16_t *)in)[index] << 16);
+    return ((const int32_t *)in)[index];
+}
+
+// Returns the full scale s32 sample of work channel ch
+static inline int32_t resampler_mix_sample(resampler_handle_t r, const char *frame, int ch)
+{
+    int in_channels = r->cfg.in_channels;
+    int bits = r->cfg.in_bits;
+    if (r->work_channels == 1 && in_channels > 1) {
+        int64_t sum = 0;
+        for (int i = 0; i < in_channels; i++)
+            sum += resampler_read_sample(frame, bits, i);
+        return (int32_t)(sum / in_channels);
+    }
+    // Same layout, or front pair of a multichannel stream
+    return resampler_read_sample(frame, bits, ch);
+}
+
+static inline void resampler_write_frame(resampler_handle_t r, char *out, const int32_t *work)
+{
+    for (int c = 0; c < r->cfg.out_channels; c++) {
+        int32_t v = work[c % r->work_channels];
+        if (r->cfg.out_bits == 16)
+            ((int16_t *)out)[c] = (int16_t)(v >> 16);
+        else
+            ((int32_t *)out)[c] = v;
+    }
+}
+
+static void resampler_load_frames(resampler_handle_t r, const char *in, int count)
+{
+    for (int ch = 0; ch < r->work_channels; ch++) {
+        const char *frame = in;
+        if (r->cfg.quality == RESAMPLER_QUALITY_FAST) {
+            int16_t *dst = (int16_t *)r->frames + ch * r->frames_cap + r->frames_filled;
+            for (int i = 0; i < count; i++, frame += r->in_frame_size) {
+                int32_t v = resampler_mix_sample(r, frame, ch);
+                // Round to s16, avoid wrapping at positive full scale
+                dst[i] = (int16_t)((v >= 0x7FFF8000) ? 0x7FFF : ((v + 0x8000) >> 16));
+            }
+        } else {
+            float *dst = (float *)r->frames + ch * r->frames_cap + r->frames_filled;
+            for (int i = 0; i < count; i++, frame += r->in_frame_size)
+                dst[i] = (float)resampler_mix_sample(r, frame, ch) * (1.0f / 2147483648.0f);
+        }
+    }
+    r->frames_filled += count;
+}
+
+static inline int32_t resampler_filter_fixed(resampler_handle_t r, int ch)
+{
+    const int16_t *x = (const int16_t *)r->frames + ch * r->frames_cap + r->frame_pos;
+    const int16_t *h = r->coef_fixed + (uint32_t)((uint64_t)r->frac * r->phases / r->den) * r->taps;
+    // Phases have unity gain and sum|h| stays well below 2, so Q15 x Q15 fits in int32
+    int32_t acc = 0;
+    for (int k = 0; k < r->taps; k++)
+        acc += (int32_t)x[k] * h[k];
+    acc = (acc + (1 << 14)) >> 15;
+    if (acc > 32767)
+        acc = 32767;
+    else if (acc < -32768)
+        acc = -32768;
+    return (int32_t)((uint32_t)acc << 16);
+}
+
+static inline int32_t resampler_filter_float(resampler_handle_t r, int ch)
+{
+    const float *x = (const float *)r->frames + ch * r->frames_cap + r->frame_pos;
+    uint64_t pos = (uint64_t)r->frac * r->phases;
+    const float *h0 = r->coef_float + (uint32_t)(pos / r->den) * r->taps;
+    const float *h1 = h0 + r->taps;
+    float w = (float)(pos % r->den) / r->den;
+    float acc0 = 0.0f, acc1 = 0.0f;
+    for (int k = 0; k < r->taps; k++) {
+        acc0 += x[k] * h0[k];
+        acc1 += x[k] * h1[k];
+    }
+    double y = (double)(acc0 + (acc1 - acc0) * w) * 2147483648.0;
+    if (y >= 2147483647.0)
+        return INT32_MAX;
+    if (y <= -2147483648.0)
+        return INT32_MIN;
+    return (int32_t)lrint(y);
+}
+
+static void resampler_shift_frames(resampler_handle_t r)
+{
+    if (r->frame_pos >= r->frames_filled) {
+        // Downsampling may step over the whole buffer
+        r->frame_pos -= r->frames_filled;
+        r->frames_filled = 0;
+        return;
+    }
+    int remain = r->frames_filled - r->frame_pos;
+    int sample_size = (r->cfg.quality == RESAMPLER_QUALITY_FAST) ? sizeof(int16_t) : sizeof(float);
+    for (int ch = 0; ch < r->work_channels; ch++) {
+        char *base = (char *)r->frames + ch * r->frames_cap * sample_size;
+        memmove(base, base + r->frame_pos * sample_size, remain * sample_size);
+    }
+    r->frames_filled = remain;
+    r->frame_pos = 0;
+}
+
+resampler_handle_t resampler_create(struct resampler_cfg *cfg)
+{
+    if (cfg == NULL || cfg->in_samplerate <= 0 || cfg->out_samplerate <= 0 ||
+        cfg->in_channels <= 0 || cfg->in_channels > RESAMPLER_CHANNELS_MAX ||
+        cfg->out_channels <= 0 || cfg->out_channels > RESAMPLER_CHANNELS_MAX ||
+        (cfg->in_bits != 16 && cfg->in_bits != 32) || (cfg->out_bits != 16 && cfg->out_bits != 32)) {
+        OS_LOGE(TAG, "Invalid resampler config");
+        return NULL;
+    }
+
+    resampler_handle_t r = audio_calloc(1, sizeof(struct resampler));
+    AUDIO_MEM_CHECK(TAG, r, return NULL);
+
+    memcpy(&r->cfg, cfg, sizeof(struct resampler_cfg));
+    r->in_frame_size = cfg->in_channels * cfg->in_bits / 8;
+    r->out_frame_size = cfg->out_channels * cfg->out_bits / 8;
+    r->work_channels = (cfg->in_channels < cfg->out_channels) ? cfg->in_channels : cfg->out_channels;
+    r->convert_rate = cfg->in_samplerate != cfg->out_samplerate;
+    if (!r->convert_rate)
+        return r;
+
+    uint32_t g = resampler_gcd(cfg->in_samplerate, cfg->out_samplerate);
+    r->step = cfg->in_samplerate / g;
+    r->den = cfg->out_samplerate / g;
+
+    bool fixed = cfg->quality == RESAMPLER_QUALITY_FAST;
+    // Downsampling needs a filter longer by the ratio, while the band left is narrower
+    // by the same ratio and needs fewer phases, so the table size stays the same
+    int ratio = (cfg->in_samplerate + cfg->out_samplerate - 1) / cfg->out_samplerate;
+    r->taps = (fixed ? RESAMPLER_FAST_TAPS : RESAMPLER_HIGH_TAPS) * ratio;
+    r->phases = (fixed ? RESAMPLER_FAST_PHASES : RESAMPLER_HIGH_PHASES) / ratio;
+    if (r->phases < 16)
+        r->phases = 16;
+    if (resampler_design_filter(r) != 0)
+        goto create_fail;
+
+    r->frames_cap = r->taps + RESAMPLER_BLOCK_FRAMES;
+    r->frames = audio_malloc(r->work_channels * r->frames_cap * (fixed ? sizeof(int16_t) : sizeof(float)));
+    if (r->frames == NULL)
+        goto create_fail;
+
+    OS_LOGD(TAG, "Resampler: %d->%d, taps:%d, phases:%d, %s",
+            cfg->in_samplerate, cfg->out_samplerate, r->taps, r->phases, fixed ? "fixed" : "float");
+    resampler_reset(r);
+    return r;
+
+create_fail:
+    OS_LOGE(TAG, "Failed to allocate resampler");
+    resampler_destroy(r);
+    return NULL;
+}
+
+int resampler_get_output_size(resampler_handle_t handle, int in_bytes)
+{
+    if (handle == NULL || in_bytes <= 0)
+        return 0;
+    long long in_frames = in_bytes / handle->in_frame_size;
+    if (!handle->convert_rate)
+        return (int)(in_frames * handle->out_frame_size);
+    long long out_frames = (in_frames + handle->taps) * handle->den / handle->step + 1;
+    return (int)(out_frames * handle->out_frame_size);
+}
+
+int resampler_process(resampler_handle_t handle, const char *in, int in_bytes, char *out, int out_size)
+{
+    if (handle == NULL || in == NULL || out == NULL)
+        return -1;
+
+    resampler_handle_t r = handle;
+    int in_frames = in_bytes / r->in_frame_size;
+    int out_frames_max = out_size / r->out_frame_size;
+    int out_frames = 0;
+    int32_t work[RESAMPLER_CHANNELS_MAX];
+
+    if (!r->convert_rate) {
+        if (in_frames > out_frames_max)
+            goto process_fail;
+        for (int i = 0; i < in_frames; i++, in += r->in_frame_size) {
+            for (int ch = 0; ch < r->work_channels; ch++)
+                work[ch] = resampler_mix_sample(r, in, ch);
+            resampler_write_frame(r, out + i * r->out_frame_size, work);
+        }
+        return in_frames * r->out_frame_size;
+    }
+
+    while (in_frames > 0) {
+        int count = r->frames_cap - r->frames_filled;
+        if (count > in_frames)
+            count = in_frames;
+        resampler_load_frames(r, in, count);
+        in += count * r->in_frame_size;
+        in_frames -= count;
+
+        while (r->frame_pos + r->taps <= r->frames_filled) {
+            if (out_frames >= out_frames_max)
+                goto process_fail;
+            for (int ch = 0; ch < r->work_channels; ch++) {
+                if (r->cfg.quality == RESAMPLER_QUALITY_FAST)
+                    work[ch] = resampler_filter_fixed(r, ch);
+                else
+                    work[ch] = resampler_filter_float(r, ch);
+            }
+            resampler_write_frame(r, out + out_frames * r->out_frame_size, work);
+            out_frames++;
+
+            r->frac += r->step;
+            r->frame_pos += r->frac / r->den;
+            r->frac %= r->den;
+        }
+        resampler_shift_frames(r);
+    }
+
+    return out_frames * r->out_frame_size;
+
+process_fail:
+    OS_LOGE(TAG, "Output buffer too small: %d", out_size);
+    return -1;
+}
+
+void resampler_reset(resampler_handle_t handle)
+{
+    if (handle == NULL || !handle->convert_rate)
+        return;
+    int sample_size = (handle->cfg.quality == RESAMPLER_QUALITY_FAST) ? sizeof(int16_t) : sizeof(float);
+    memset(handle->frames, 0x0, handle->work_channels * handle->frames_cap * sample_size);
+    // Zero history before the first frame keeps the output aligned with the input
+    handle->frames_filled = handle->taps / 2 - 1;
+    handle->frame_pos = 0;
+    handle->frac = 0;
+}
+
+void resampler_destroy(resampler_handle_t handle)
+{
+    if (handle == NULL)
+        return;
+    if (handle->coef_fixed != NULL)
+        audio_free(handle->coef_fixed);
+    if (handle->coef_float != NULL)
+        audio_free(handle->coef_float);
+    if (handle->frames != NULL)
+        audio_free(handle->frames);
+    audio_free(handle);
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef _RESAMPLER_H_
+#define _RESAMPLER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum resampler_quality {
+    RESAMPLER_QUALITY_FAST = 0, // fixed-point polyphase, nearest phase of 256
+    RESAMPLER_QUALITY_HIGH = 1, // float polyphase, longer filter, interpolated phases
+};
+
+struct resampler_cfg {
+    int in_samplerate;
+    int in_channels;
+    int in_bits;                // 16 or 32, interleaved s16le/s32le as decoders output
+    int out_samplerate;
+    int out_channels;
+    int out_bits;               // 16 or 32
+    enum resampler_quality quality;
+};
+
+/*
+ * Resampler converts decoded pcm to the sink format: samplerate conversion,
+ * channel up/down-mixing and sample width conversion. Downmixing is done
+ * before the filter and upmixing after it, so only min(in, out) channels
+ * are filtered.
+ */
+typedef struct resampler *resampler_handle_t;
+
+resampler_handle_t resampler_create(struct resampler_cfg *cfg);
+
+// Max output bytes of resampler_process() for in_bytes input
+int resampler_get_output_size(resampler_handle_t handle, int in_bytes);
+
+// Consume all input, return the output bytes written, or -1 if out_size is too small
+int resampler_process(resampler_handle_t handle, const char *in, int in_bytes, char *out, int out_size);
+
+// Drop filter history, call it after seeking
+void resampler_reset(resampler_handle_t handle);
+
+void resampler_destroy(resampler_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -66,6 +66,8 @@
 #define audio_element_input                         ADF_NAMESPACE(audio_element_input)
 #define audio_element_output                        ADF_NAMESPACE(audio_element_output)
 #define audio_element_input_chunk                   ADF_NAMESPACE(audio_element_input_chunk)
+#define audio_element_input_acquire                 ADF_NAMESPACE(audio_element_input_acquire)
+#define audio_element_input_release                 ADF_NAMESPACE(audio_element_input_release)
 #define audio_element_output_chunk                  ADF_NAMESPACE(audio_element_output_chunk)
 #define audio_element_set_read_cb                   ADF_NAMESPACE(audio_element_set_read_cb)
 #define audio_element_set_write_cb                  ADF_NAMESPACE(audio_element_set_write_cb)
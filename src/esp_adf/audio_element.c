@@ -115,6 +115,7 @@ struct audio_element {
     bool                        stopping;
     long long                   offset;
 #define SEEK_COMPLETED          (-1)
+    long long                   input_bytes;
 };
 
 const static int TASK_CREATED_BIT       = (1 << 0);
@@ -353,6 +354,13 @@ static esp_err_t audio_element_on_cmd(audio_event_iface_msg_t *msg, void *contex
     return ESP_OK;
 }
 
+// Only the element task counts, readers on other threads just need untorn values
+static inline void audio_element_count_input(audio_element_handle_t el, int bytes)
+{
+    __atomic_store_n(&el->input_bytes, __atomic_load_n(&el->input_bytes, __ATOMIC_RELAXED) + bytes,
+                     __ATOMIC_RELAXED);
+}
+
 static esp_err_t audio_element_process_running(audio_element_handle_t el)
 {
     int process_len = -1;
@@ -418,6 +426,8 @@ int audio_element_input(audio_element_handle_t el, char *buffer, int wanted_size
         OS_LOGE(TAG, "[%s] Invalid read IO type", el->tag);
         return ESP_FAIL;
     }
+    if (in_len > 0)
+        audio_element_count_input(el, in_len);
     if (in_len <= 0) {
         switch (in_len) {
             case AEL_IO_ABORT:
@@ -513,6 +523,8 @@ int audio_element_input_chunk(audio_element_handle_t el, char *buffer, int wante
         OS_LOGE(TAG, "[%s] Invalid read IO type", el->tag);
         return ESP_FAIL;
     }
+    if (in_len > 0)
+        audio_element_count_input(el, in_len);
     if (in_len <= 0) {
         switch (in_len) {
             case AEL_IO_ABORT:
@@ -542,6 +554,51 @@ int audio_element_input_chunk(audio_element_handle_t el, char *buffer, int wante
     return in_len;
 }
 
+int audio_element_input_acquire(audio_element_handle_t el, char **buffer, int wanted_size)
+{
+    int in_len = 0;
+    if (el->read_type != IO_TYPE_RB || el->in.input_rb == NULL) {
+        OS_LOGE(TAG, "[%s] Acquire input only works with ringbuf", el->tag);
+        return ESP_FAIL;
+    }
+    in_len = rb_acquire_read(el->in.input_rb, buffer, wanted_size, el->input_timeout_ms);
+    if (in_len <= 0) {
+        switch (in_len) {
+            case AEL_IO_ABORT:
+                OS_LOGW(TAG, "IN-[%s] AEL_IO_ABORT", el->tag);
+                audio_element_set_ringbuf_done(el);
+                audio_element_stop(el);
+                break;
+            case AEL_IO_DONE:
+            case AEL_IO_OK:
+                OS_LOGD(TAG, "IN-[%s] AEL_IO_DONE,%d", el->tag, in_len);
+                break;
+            case AEL_IO_FAIL:
+                OS_LOGE(TAG, "IN-[%s] AEL_STATUS_ERROR_INPUT", el->tag);
+                audio_element_report_status(el, AEL_STATUS_ERROR_INPUT);
+                audio_element_cmd_send(el, AEL_MSG_CMD_ERROR);
+                break;
+            case AEL_IO_TIMEOUT:
+                OS_LOGV(TAG, "IN-[%s] AEL_IO_TIMEOUT", el->tag);
+                break;
+            default:
+                OS_LOGE(TAG, "IN-[%s] Input return not support,ret:%d", el->tag, in_len);
+                audio_element_cmd_send(el, AEL_MSG_CMD_PAUSE);
+                break;
+        }
+    }
+    return in_len;
+}
+
+int audio_element_input_release(audio_element_handle_t el, int consumed_size)
+{
+    if (el->read_type != IO_TYPE_RB || el->in.input_rb == NULL)
+        return ESP_FAIL;
+    if (consumed_size > 0)
+        audio_element_count_input(el, consumed_size);
+    return rb_release_read(el->in.input_rb, consumed_size);
+}
+
 int audio_element_output_chunk(audio_element_handle_t el, char *buffer, int write_size)
 {
     int output_len = 0;
@@ -928,6 +985,14 @@ esp_err_t audio_element_set_output_timeout(audio_element_handle_t el, int timeou
     return ESP_FAIL;
 }
 
+long long audio_element_get_input_bytes(audio_element_handle_t el)
+{
+    if (el) {
+        return __atomic_load_n(&el->input_bytes, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
 int audio_element_get_output_ringbuf_size(audio_element_handle_t el)
 {
     if (el) {
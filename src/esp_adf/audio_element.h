@@ -664,6 +664,33 @@ int audio_element_output(audio_element_handle_t el, char *buffer, int write_size
  */
 int audio_element_input_chunk(audio_element_handle_t el, char *buffer, int wanted_size);
 
+/**
+ * @brief      Call this function to borrow Element input data in place, without copying it out.
+ *             Only works with input ringbuffer, the span may be shorter than wanted size when it
+ *             wraps around. Must be followed by audio_element_input_release.
+ *
+ * @param[in]  el            The audio element handle
+ * @param[out] buffer        Start of the span
+ * @param[in]  wanted_size   The wanted size
+ *
+ * @return
+ *        - > 0 number of bytes in the span
+ *        - <=0 audio_element_err_t
+ */
+int audio_element_input_acquire(audio_element_handle_t el, char **buffer, int wanted_size);
+
+/**
+ * @brief      Give back the span of audio_element_input_acquire, consuming `consumed_size` bytes.
+ *
+ * @param[in]  el              The audio element handle
+ * @param[in]  consumed_size   The consumed size, zero to keep all data in ringbuffer
+ *
+ * @return
+ *        - >=0 number of bytes consumed
+ *        - < 0 audio_element_err_t
+ */
+int audio_element_input_release(audio_element_handle_t el, int consumed_size);
+
 /**
  * @brief      Call this function to sendout Element output the whole chunk
  *             Depending on setup using ringbuffer or function callback, Element will invoke write to ringbuffer, or call write callback funtion.
@@ -744,6 +771,16 @@ esp_err_t audio_element_set_ringbuf_done(audio_element_handle_t el);
  */
 esp_err_t audio_element_reset_state(audio_element_handle_t el);
 
+/**
+ * @brief      Get bytes the element has consumed from its input since it was created.
+ *             Safe to call from any thread.
+ *
+ * @param[in]  el    The audio element handle
+ *
+ * @return     Consumed bytes, 0 if el is NULL
+ */
+long long audio_element_get_input_bytes(audio_element_handle_t el);
+
 /**
  * @brief      Get Element output ringbuffer size.
  *
@@ -0,0 +1,292 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "osal/os_thread.h"
+#include "cutils/ringbuf.h"
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_element.h"
+#include "esp_adf/audio_common.h"
+#include "audio_loudness/loudness.h"
+
+#include "liteplayer_config.h"
+#include "liteplayer_source.h"
+#include "liteplayer_parser.h"
+#include "liteplayer_decoder.h"
+#include "liteplayer_analyzer.h"
+
+#define TAG "[liteplayer]analyzer"
+
+struct loudness_analyzer {
+    struct media_source_info source;
+    struct media_codec_info  codec;
+    audio_element_handle_t   decoder;
+
+    loudness_handle_t        meter;
+    int                      samplerate;
+    int                      frame_size;
+    long long                frames;
+
+    os_mutex                 lock;
+    os_cond                  cond;
+    bool                     done;
+    bool                     failed;
+};
+
+static int analyzer_source_open(audio_element_handle_t self, void *ctx)
+{
+    struct loudness_analyzer *analyzer = (struct loudness_analyzer *)ctx;
+    if (analyzer->source.source_handle == NULL) {
+        analyzer->source.source_handle = analyzer->source.source_ops->open(analyzer->source.url,
+            analyzer->codec.content_pos, analyzer->source.source_ops->priv_data);
+        if (analyzer->source.source_handle == NULL) {
+            OS_LOGE(TAG, "Failed to open source: %s", analyzer->source.url);
+            return AEL_IO_FAIL;
+        }
+        rb_reset(analyzer->source.out_ringbuf);
+    }
+    return AEL_IO_OK;
+}
+
+// Bytes left in ringbuf by parser come first, then the source is read directly.
+// Decoders take a short read as end of stream, so len is always filled until eof
+static int analyzer_source_read(audio_element_handle_t self, char *buffer, int len, int timeout_ms, void *ctx)
+{
+    struct loudness_analyzer *analyzer = (struct loudness_analyzer *)ctx;
+    int bytes_remain = rb_bytes_filled(analyzer->source.out_ringbuf);
+    if (bytes_remain > len)
+        bytes_remain = len;
+    if (bytes_remain > 0)
+        rb_read_chunk(analyzer->source.out_ringbuf, buffer, bytes_remain, 0);
+    if (bytes_remain == len)
+        return len;
+
+    int bytes_want = len - bytes_remain;
+    int bytes_read = analyzer->source.source_ops->read(analyzer->source.source_handle,
+                                                       buffer + bytes_remain, bytes_want);
+    if (bytes_read < 0 || bytes_read > bytes_want) {
+        OS_LOGE(TAG, "Failed to read source, ret:%d", bytes_read);
+        return AEL_IO_FAIL;
+    }
+    if (bytes_read + bytes_remain == 0)
+        return AEL_IO_DONE;
+    return bytes_read + bytes_remain;
+}
+
+static void analyzer_source_close(audio_element_handle_t self, void *ctx)
+{
+    struct loudness_analyzer *analyzer = (struct loudness_analyzer *)ctx;
+    if (analyzer->source.source_handle != NULL) {
+        analyzer->source.source_ops->close(analyzer->source.source_handle);
+        analyzer->source.source_handle = NULL;
+    }
+}
+
+// No sink, pcm is measured and dropped as fast as decoder produces it
+static int analyzer_sink_write(audio_element_handle_t self, char *buffer, int len, int timeout_ms, void *ctx)
+{
+    struct loudness_analyzer *analyzer = (struct loudness_analyzer *)ctx;
+    if (analyzer->meter == NULL) {
+        audio_element_info_t info = {0};
+        audio_element_getinfo(self, &info);
+        struct loudness_cfg cfg = {
+            .samplerate = info.samplerate,
+            .channels = info.channels,
+            .bits = info.bits,
+        };
+        analyzer->meter = loudness_create(&cfg);
+        if (analyzer->meter == NULL) {
+            OS_LOGE(TAG, "Unsupported pcm format: samplerate=%d, ch=%d, bits=%d",
+                    info.samplerate, info.channels, info.bits);
+            return AEL_IO_FAIL;
+        }
+        analyzer->samplerate = info.samplerate;
+        analyzer->frame_size = info.channels * info.bits / 8;
+    }
+
+    loudness_process(analyzer->meter, buffer, len);
+    analyzer->frames += len / analyzer->frame_size;
+    return len;
+}
+
+static int analyzer_event_callback(audio_element_handle_t el, audio_event_iface_msg_t *msg, void *ctx)
+{
+    struct loudness_analyzer *analyzer = (struct loudness_analyzer *)ctx;
+    if (msg->source_type != AUDIO_ELEMENT_TYPE_ELEMENT || msg->cmd != AEL_MSG_CMD_REPORT_STATUS)
+        return ESP_OK;
+
+    audio_element_status_t el_status = (audio_element_status_t)msg->data;
+    switch (el_status) {
+    case AEL_STATUS_ERROR_OPEN:
+    case AEL_STATUS_ERROR_INPUT:
+    case AEL_STATUS_ERROR_PROCESS:
+    case AEL_STATUS_ERROR_OUTPUT:
+    case AEL_STATUS_ERROR_CLOSE:
+    case AEL_STATUS_ERROR_UNKNOWN:
+        OS_LOGE(TAG, "[ %s ] Receive error[%d]", audio_element_get_tag(el), el_status);
+        os_mutex_lock(analyzer->lock);
+        analyzer->failed = true;
+        analyzer->done = true;
+        os_cond_signal(analyzer->cond);
+        os_mutex_unlock(analyzer->lock);
+        break;
+    case AEL_STATUS_STATE_FINISHED:
+        os_mutex_lock(analyzer->lock);
+        analyzer->done = true;
+        os_cond_signal(analyzer->cond);
+        os_mutex_unlock(analyzer->lock);
+        break;
+    default:
+        break;
+    }
+    return ESP_OK;
+}
+
+static int analyzer_decode(struct loudness_analyzer *analyzer)
+{
+    struct media_decoder_cfg decoder_cfg = {
+        .task_prio = DEFAULT_ANALYZER_DECODER_TASK_PRIO,
+        .task_stack = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE,
+        .aac_decode_mode = AAC_DECODE_FULL,
+        .aac_ps_to_mono = false,
+    };
+    analyzer->decoder = media_decoder_init(&analyzer->codec, &decoder_cfg);
+    AUDIO_MEM_CHECK(TAG, analyzer->decoder, return ESP_FAIL);
+
+    stream_callback_t sink = {
+        .write = analyzer_sink_write,
+        .ctx = analyzer,
+    };
+    stream_callback_t source = {
+        .open = analyzer_source_open,
+        .read = analyzer_source_read,
+        .close = analyzer_source_close,
+        .ctx = analyzer,
+    };
+    audio_element_set_write_cb(analyzer->decoder, &sink);
+    audio_element_set_read_cb(analyzer->decoder, &source);
+    audio_element_set_event_callback(analyzer->decoder, analyzer_event_callback, analyzer);
+
+    if (audio_element_run(analyzer->decoder) != 0 ||
+        audio_element_resume(analyzer->decoder, 0, 0) != 0)
+        return ESP_FAIL;
+
+    os_mutex_lock(analyzer->lock);
+    while (!analyzer->done)
+        os_cond_wait(analyzer->cond, analyzer->lock);
+    os_mutex_unlock(analyzer->lock);
+
+    return analyzer->failed ? ESP_FAIL : ESP_OK;
+}
+
+int liteplayer_analyze_loudness(const char *url, struct source_wrapper *source_ops,
+                                struct liteplayer_loudness_info *info)
+{
+    if (url == NULL || source_ops == NULL || info == NULL)
+        return ESP_FAIL;
+
+    int ret = ESP_FAIL;
+    struct loudness_analyzer analyzer;
+    memset(&analyzer, 0, sizeof(analyzer));
+    analyzer.source.url = url;
+    analyzer.source.source_ops = source_ops;
+
+    analyzer.lock = os_mutex_create();
+    analyzer.cond = os_cond_create();
+    analyzer.source.out_ringbuf = rb_create_spsc(source_ops->buffer_size);
+    if (analyzer.lock == NULL || analyzer.cond == NULL || analyzer.source.out_ringbuf == NULL)
+        goto analyze_out;
+
+    // No index cache, every file is parsed only once
+    if (media_parser_get_codec_info(&analyzer.source, NULL, &analyzer.codec) != ESP_OK) {
+        OS_LOGE(TAG, "Failed to parse codec info: %s", url);
+        goto analyze_out;
+    }
+
+    ret = analyzer_decode(&analyzer);
+    if (ret == ESP_OK && analyzer.meter == NULL) {
+        OS_LOGE(TAG, "No pcm decoded: %s", url);
+        ret = ESP_FAIL;
+    }
+    if (ret == ESP_OK) {
+        info->integrated_lufs = loudness_get_integrated(analyzer.meter);
+        info->true_peak_dbtp = loudness_get_true_peak(analyzer.meter);
+        info->duration_ms = (int)(analyzer.frames * 1000 / analyzer.samplerate);
+        OS_LOGD(TAG, "Analyzed %s: %.2f LUFS, %.2f dBTP, %d ms", url,
+                info->integrated_lufs, info->true_peak_dbtp, info->duration_ms);
+    }
+
+analyze_out:
+    if (analyzer.decoder != NULL)
+        audio_element_deinit(analyzer.decoder);
+    if (analyzer.source.source_handle != NULL)
+        source_ops->close(analyzer.source.source_handle);
+    media_parser_release_codec_info(&analyzer.codec);
+    if (analyzer.meter != NULL)
+        loudness_destroy(analyzer.meter);
+    if (analyzer.source.out_ringbuf != NULL)
+        rb_destroy(analyzer.source.out_ringbuf);
+    if (analyzer.cond != NULL)
+        os_cond_destroy(analyzer.cond);
+    if (analyzer.lock != NULL)
+        os_mutex_destroy(analyzer.lock);
+    return ret;
+}
+
+int liteplayer_probe_media(const char *url, struct source_wrapper *source_ops,
+                           struct liteplayer_media_info *info)
+{
+    if (url == NULL || source_ops == NULL || info == NULL)
+        return ESP_FAIL;
+
+    int ret = ESP_FAIL;
+    struct media_source_info source;
+    struct media_codec_info codec;
+    memset(&source, 0, sizeof(source));
+    memset(&codec, 0, sizeof(codec));
+    source.url = url;
+    source.source_ops = source_ops;
+    source.out_ringbuf = rb_create_spsc(source_ops->buffer_size);
+    if (source.out_ringbuf == NULL)
+        return ESP_FAIL;
+
+    if (media_parser_get_codec_info(&source, NULL, &codec) != ESP_OK) {
+        OS_LOGE(TAG, "Failed to parse codec info: %s", url);
+        goto probe_out;
+    }
+
+    info->samplerate = codec.codec_samplerate;
+    info->channels = codec.codec_channels;
+    info->bits = codec.codec_bits;
+    info->duration_ms = codec.duration_ms;
+    // Parser rounds these down to whole seconds, which is fine for seeking but not for a library
+    if (codec.codec_type == AUDIO_CODEC_M4A && codec.detail.m4a_info.time_scale > 0) {
+        info->duration_ms = (int)((long long)codec.detail.m4a_info.duration*1000/codec.detail.m4a_info.time_scale);
+    } else if (codec.codec_type == AUDIO_CODEC_WAV && codec.detail.wav_info.byteRate > 0) {
+        info->duration_ms = (int)((long long)codec.detail.wav_info.dataSize*1000/codec.detail.wav_info.byteRate);
+    }
+    ret = ESP_OK;
+
+probe_out:
+    // Parser keeps the handle open when it can be reused for decoding
+    if (source.source_handle != NULL)
+        source_ops->close(source.source_handle);
+    media_parser_release_codec_info(&codec);
+    rb_destroy(source.out_ringbuf);
+    return ret;
+}
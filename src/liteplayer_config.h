@@ -37,6 +37,16 @@ extern "C" {
 #define DEFAULT_LISTPLAYER_TASK_PRIO             ( OS_THREAD_PRIO_HIGH )
 #define DEFAULT_LISTPLAYER_TASK_STACKSIZE        ( 1024*4 )
 
+// software gain definations, volume and track gain
+#define DEFAULT_GAIN_RAMP_MS                     ( 20 )
+#define DEFAULT_TRACK_GAIN_MAX_DB                ( 18.0f )
+
+// loudness analyzer definations, offline decoding must not starve playback
+#define DEFAULT_ANALYZER_DECODER_TASK_PRIO       ( OS_THREAD_PRIO_LOW )
+
+// crossfade definations, next track is buffered this long before the fade starts
+#define DEFAULT_CROSSFADE_PREBUFFER_MS           ( 300 )
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,99 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cutils/log_helper.h"
+#include "audio_decoder/mp3_decoder.h"
+#include "audio_decoder/aac_decoder.h"
+#include "audio_decoder/m4a_decoder.h"
+#include "audio_decoder/wav_decoder.h"
+#include "audio_decoder/flac_decoder.h"
+#if defined(LITEPLAYER_CONFIG_OPUS_DECODER)
+#include "audio_decoder/ogg_opus_decoder.h"
+#endif
+
+#include "liteplayer_decoder.h"
+
+#define TAG "[liteplayer]decoder"
+
+audio_element_handle_t media_decoder_init(struct media_codec_info *codec, struct media_decoder_cfg *cfg)
+{
+    audio_element_handle_t decoder = NULL;
+
+    switch (codec->codec_type) {
+    case AUDIO_CODEC_MP3: {
+        struct mp3_decoder_cfg mp3_cfg = DEFAULT_MP3_DECODER_CONFIG();
+        mp3_cfg.task_prio            = cfg->task_prio;
+        mp3_cfg.task_stack           = cfg->task_stack;
+        mp3_cfg.mp3_info             = &(codec->detail.mp3_info);
+        decoder = mp3_decoder_init(&mp3_cfg);
+        break;
+    }
+    case AUDIO_CODEC_AAC: {
+        struct aac_decoder_cfg aac_cfg = DEFAULT_AAC_DECODER_CONFIG();
+        aac_cfg.task_prio            = cfg->task_prio;
+        aac_cfg.task_stack           = cfg->task_stack;
+        aac_cfg.aac_info             = &(codec->detail.aac_info);
+        aac_cfg.decode_mode          = cfg->aac_decode_mode;
+        aac_cfg.ps_to_mono           = cfg->aac_ps_to_mono;
+        decoder = aac_decoder_init(&aac_cfg);
+        break;
+    }
+    case AUDIO_CODEC_M4A: {
+        struct m4a_decoder_cfg m4a_cfg = DEFAULT_M4A_DECODER_CONFIG();
+        m4a_cfg.task_prio            = cfg->task_prio;
+        m4a_cfg.task_stack           = cfg->task_stack;
+        m4a_cfg.m4a_info             = &(codec->detail.m4a_info);
+        m4a_cfg.decode_mode          = cfg->aac_decode_mode;
+        m4a_cfg.ps_to_mono           = cfg->aac_ps_to_mono;
+        decoder = m4a_decoder_init(&m4a_cfg);
+        break;
+    }
+    case AUDIO_CODEC_WAV: {
+        struct wav_decoder_cfg wav_cfg = DEFAULT_WAV_DECODER_CONFIG();
+        wav_cfg.task_prio            = cfg->task_prio;
+        wav_cfg.task_stack           = cfg->task_stack;
+        wav_cfg.wav_info             = &(codec->detail.wav_info);
+        decoder = wav_decoder_init(&wav_cfg);
+        break;
+    }
+    case AUDIO_CODEC_OPUS: {
+#if defined(LITEPLAYER_CONFIG_OPUS_DECODER)
+        struct ogg_opus_decoder_cfg opus_cfg = DEFAULT_OGG_OPUS_DECODER_CONFIG();
+        opus_cfg.task_prio            = cfg->task_prio;
+        opus_cfg.task_stack           = cfg->task_stack;
+        opus_cfg.opus_info            = &(codec->detail.opus_info);
+        decoder = ogg_opus_decoder_init(&opus_cfg);
+#else
+        OS_LOGE(TAG, "Opus decoder is disabled, build with LITEPLAYER_CONFIG_OPUS_DECODER");
+#endif
+        break;
+    }
+    case AUDIO_CODEC_FLAC: {
+        struct flac_decoder_cfg flac_cfg = DEFAULT_FLAC_DECODER_CONFIG();
+        flac_cfg.task_prio            = cfg->task_prio;
+        flac_cfg.task_stack           = cfg->task_stack;
+        flac_cfg.flac_info            = &(codec->detail.flac_info);
+        decoder = flac_decoder_init(&flac_cfg);
+        break;
+    }
+    default:
+        OS_LOGE(TAG, "Unsupported codec type: %d", codec->codec_type);
+        break;
+    }
+
+    return decoder;
+}
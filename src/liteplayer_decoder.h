@@ -0,0 +1,41 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _LITEPLAYER_DECODER_H_
+#define _LITEPLAYER_DECODER_H_
+
+#include "esp_adf/audio_element.h"
+#include "audio_decoder/aac_decoder.h"
+#include "liteplayer_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct media_decoder_cfg {
+    int                  task_prio;
+    int                  task_stack;
+    enum aac_decode_mode aac_decode_mode; // aac and m4a only
+    bool                 aac_ps_to_mono;  // aac and m4a only
+};
+
+// Create the decoder element of codec->codec_type, NULL if not supported.
+// codec must outlive the element, decoders keep pointers to its tables.
+audio_element_handle_t media_decoder_init(struct media_codec_info *codec, struct media_decoder_cfg *cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LITEPLAYER_DECODER_H_
@@ -0,0 +1,242 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "liteplayer_indexcache.h"
+
+#define TAG "[liteplayer]indexcache"
+
+#define MEDIA_INDEX_MAGIC   "LPIX"
+#define MEDIA_INDEX_VERSION 1
+
+struct media_index_header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t info_size; // sizeof(struct media_codec_info), invalidates cache if layout changes
+    uint32_t url_len;
+    int64_t  file_size;
+    int64_t  file_mtime;
+};
+
+static int media_index_path(const char *cache_dir, const char *url, char *path, int size)
+{
+    // FNV-1a hash of url as cache file name, url is stored in file to detect collision
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char *p = url; *p != '\0'; p++) {
+        hash ^= (unsigned char)*p;
+        hash *= 0x100000001b3ULL;
+    }
+    int ret = snprintf(path, size, "%s/%016llx.idx", cache_dir, (unsigned long long)hash);
+    return (ret > 0 && ret < size) ? 0 : -1;
+}
+
+static int media_index_stat(const char *url, int64_t *file_size, int64_t *file_mtime)
+{
+    struct stat st;
+    if (strstr(url, "://") != NULL && strncmp(url, "file://", 7) != 0)
+        return -1;
+    if (strncmp(url, "file://", 7) == 0)
+        url += 7;
+    if (stat(url, &st) != 0 || !S_ISREG(st.st_mode))
+        return -1;
+    *file_size = (int64_t)st.st_size;
+    *file_mtime = (int64_t)st.st_mtime;
+    return 0;
+}
+
+bool media_index_cacheable_url(const char *url)
+{
+    int64_t file_size, file_mtime;
+    return url != NULL && media_index_stat(url, &file_size, &file_mtime) == 0;
+}
+
+static bool media_index_cacheable(audio_codec_t codec_type)
+{
+    return codec_type == AUDIO_CODEC_MP3 ||
+           codec_type == AUDIO_CODEC_AAC ||
+           codec_type == AUDIO_CODEC_M4A;
+}
+
+static void *media_index_read_table(FILE *fp, uint32_t entries, size_t entry_size, bool *failed)
+{
+    if (*failed || entries == 0)
+        return NULL;
+    void *table = audio_malloc(entries * entry_size);
+    if (table == NULL || fread(table, entry_size, entries, fp) != entries) {
+        if (table != NULL)
+            audio_free(table);
+        *failed = true;
+        return NULL;
+    }
+    return table;
+}
+
+static bool media_index_write_table(FILE *fp, const void *table, uint32_t entries, size_t entry_size)
+{
+    if (entries == 0)
+        return true;
+    if (table == NULL)
+        return false;
+    return fwrite(table, entry_size, entries, fp) == entries;
+}
+
+int media_index_cache_load(const char *cache_dir, const char *url, struct media_codec_info *codec)
+{
+    char path[256];
+    char cached_url[256];
+    struct media_index_header header;
+    struct media_codec_info info;
+    int64_t file_size, file_mtime;
+    bool failed = false;
+    FILE *fp = NULL;
+
+    if (cache_dir == NULL || url == NULL || codec == NULL)
+        return -1;
+    if (media_index_stat(url, &file_size, &file_mtime) != 0)
+        return -1;
+    if (media_index_path(cache_dir, url, path, sizeof(path)) != 0)
+        return -1;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+        return -1;
+
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, MEDIA_INDEX_MAGIC, 4) != 0 ||
+        header.version != MEDIA_INDEX_VERSION ||
+        header.info_size != sizeof(struct media_codec_info) ||
+        header.file_size != file_size ||
+        header.file_mtime != file_mtime ||
+        header.url_len != strlen(url) ||
+        header.url_len >= sizeof(cached_url))
+        goto load_fail;
+
+    if (fread(cached_url, 1, header.url_len, fp) != header.url_len ||
+        memcmp(cached_url, url, header.url_len) != 0)
+        goto load_fail;
+
+    if (fread(&info, sizeof(info), 1, fp) != 1 || !media_index_cacheable(info.codec_type))
+        goto load_fail;
+
+    switch (info.codec_type) {
+    case AUDIO_CODEC_AAC: {
+        struct aac_info *aac = &info.detail.aac_info;
+        aac->index = media_index_read_table(fp, aac->index_entries, sizeof(uint32_t), &failed);
+        break;
+    }
+    case AUDIO_CODEC_M4A: {
+        struct m4a_info *m4a = &info.detail.m4a_info;
+        m4a->stsz_samplesize = media_index_read_table(fp,
+                m4a->stsz_samplesize_entries, sizeof(uint16_t), &failed);
+        m4a->stts_time2sample = media_index_read_table(fp,
+                m4a->stts_time2sample_entries, sizeof(struct time2sample), &failed);
+        m4a->stsc_sample2chunk = media_index_read_table(fp,
+                m4a->stsc_sample2chunk_entries, sizeof(struct sample2chunk), &failed);
+        m4a->stco_chunk2offset = media_index_read_table(fp,
+                m4a->stco_chunk2offset_entries, sizeof(struct chunk2offset), &failed);
+        break;
+    }
+    default:
+        break;
+    }
+    if (failed) {
+        media_parser_release_codec_info(&info);
+        goto load_fail;
+    }
+
+    fclose(fp);
+    memcpy(codec, &info, sizeof(info));
+    OS_LOGD(TAG, "Index cache hit: %s", url);
+    return 0;
+
+load_fail:
+    fclose(fp);
+    OS_LOGV(TAG, "Index cache miss: %s", url);
+    return -1;
+}
+
+int media_index_cache_save(const char *cache_dir, const char *url, struct media_codec_info *codec)
+{
+    char path[256];
+    char temp_path[260];
+    struct media_index_header header;
+    struct media_codec_info info;
+    int64_t file_size, file_mtime;
+    bool ok = true;
+    FILE *fp = NULL;
+
+    if (cache_dir == NULL || url == NULL || codec == NULL || !media_index_cacheable(codec->codec_type))
+        return -1;
+    if (media_index_stat(url, &file_size, &file_mtime) != 0)
+        return -1;
+    if (media_index_path(cache_dir, url, path, sizeof(path)) != 0)
+        return -1;
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    mkdir(cache_dir, 0755);
+    fp = fopen(temp_path, "wb");
+    if (fp == NULL) {
+        OS_LOGW(TAG, "Failed to create index cache: %s", temp_path);
+        return -1;
+    }
+
+    memset(&header, 0x0, sizeof(header));
+    memcpy(header.magic, MEDIA_INDEX_MAGIC, 4);
+    header.version = MEDIA_INDEX_VERSION;
+    header.info_size = sizeof(struct media_codec_info);
+    header.url_len = strlen(url);
+    header.file_size = file_size;
+    header.file_mtime = file_mtime;
+
+    // pointers are written along with the struct but never read back
+    memcpy(&info, codec, sizeof(info));
+
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         fwrite(url, 1, header.url_len, fp) == header.url_len &&
+         fwrite(&info, sizeof(info), 1, fp) == 1;
+
+    if (ok && info.codec_type == AUDIO_CODEC_AAC) {
+        struct aac_info *aac = &info.detail.aac_info;
+        ok = media_index_write_table(fp, aac->index, aac->index_entries, sizeof(uint32_t));
+    } else if (ok && info.codec_type == AUDIO_CODEC_M4A) {
+        struct m4a_info *m4a = &info.detail.m4a_info;
+        ok = media_index_write_table(fp, m4a->stsz_samplesize,
+                    m4a->stsz_samplesize_entries, sizeof(uint16_t)) &&
+             media_index_write_table(fp, m4a->stts_time2sample,
+                    m4a->stts_time2sample_entries, sizeof(struct time2sample)) &&
+             media_index_write_table(fp, m4a->stsc_sample2chunk,
+                    m4a->stsc_sample2chunk_entries, sizeof(struct sample2chunk)) &&
+             media_index_write_table(fp, m4a->stco_chunk2offset,
+                    m4a->stco_chunk2offset_entries, sizeof(struct chunk2offset));
+    }
+
+    if (fclose(fp) != 0)
+        ok = false;
+    if (!ok || rename(temp_path, path) != 0) {
+        OS_LOGW(TAG, "Failed to write index cache: %s", path);
+        remove(temp_path);
+        return -1;
+    }
+
+    OS_LOGD(TAG, "Index cache saved: %s", url);
+    return 0;
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _LITEPLAYER_INDEXCACHE_H_
+#define _LITEPLAYER_INDEXCACHE_H_
+
+#include "liteplayer_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cache of parsed codec info and seek tables for local files, one file per
+// media url under cache_dir, keyed by url, file size and mtime.
+
+// Return true if url is a local file whose index can be cached
+bool media_index_cacheable_url(const char *url);
+
+// Return 0 if hit, tables in codec->detail are allocated and owned by caller
+int media_index_cache_load(const char *cache_dir, const char *url, struct media_codec_info *codec);
+
+// Return 0 if saved, codec is not modified
+int media_index_cache_save(const char *cache_dir, const char *url, struct media_codec_info *codec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LITEPLAYER_INDEXCACHE_H_
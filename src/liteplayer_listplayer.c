@@ -25,6 +25,7 @@
 #include "liteplayer_adapter.h"
 #include "liteplayer_config.h"
 #include "liteplayer_main.h"
+#include "liteplayer_sinksession.h"
 #include "liteplayer_listplayer.h"
 
 #define TAG "[liteplayer]listplayer"
@@ -41,6 +42,8 @@ struct listplayer {
     liteplayer_state_cb         listener;
     void                       *listener_priv;
     struct source_wrapper      *file_ops;
+    sink_session_handle_t       sink_session;
+    bool                        sink_session_owned;
 
     struct listnode      url_list;
     struct listnode     *url_curr;
@@ -485,6 +488,23 @@ int listplayer_register_source_wrapper(listplayer_handle_t handle, struct source
     return liteplayer_register_source_wrapper(handle->player, wrapper);
 }
 
+static int listplayer_attach_sink_session(listplayer_handle_t handle, sink_session_handle_t session, bool owned)
+{
+    struct sink_wrapper session_ops;
+    if (sink_session_get_wrapper(session, &session_ops) != 0)
+        return -1;
+
+    handle->adapter->add_sink_wrapper(handle->adapter, &session_ops);
+    if (liteplayer_register_sink_wrapper(handle->player, &session_ops) != 0)
+        return -1;
+
+    if (handle->sink_session_owned)
+        sink_session_destroy(handle->sink_session);
+    handle->sink_session = session;
+    handle->sink_session_owned = owned;
+    return 0;
+}
+
 int listplayer_register_sink_wrapper(listplayer_handle_t handle, struct sink_wrapper *wrapper)
 {
     if (handle == NULL || wrapper == NULL)
@@ -498,8 +518,80 @@ int listplayer_register_sink_wrapper(listplayer_handle_t handle, struct sink_wra
     }
     os_mutex_unlock(handle->lock);
 
-    handle->adapter->add_sink_wrapper(handle->adapter, wrapper);
-    return liteplayer_register_sink_wrapper(handle->player, wrapper);
+    // Keep the sink opened across the tracks of the playlist
+    sink_session_handle_t session = sink_session_create(wrapper);
+    if (session == NULL) {
+        OS_LOGE(TAG, "Failed to create sink session");
+        return -1;
+    }
+    if (listplayer_attach_sink_session(handle, session, true) != 0) {
+        sink_session_destroy(session);
+        return -1;
+    }
+    return 0;
+}
+
+int listplayer_register_sink_session(listplayer_handle_t handle, sink_session_handle_t session)
+{
+    if (handle == NULL || session == NULL)
+        return -1;
+
+    os_mutex_lock(handle->lock);
+    if (handle->state != LITEPLAYER_IDLE) {
+        OS_LOGE(TAG, "Can't register sink session in state=[%d]", handle->state);
+        os_mutex_unlock(handle->lock);
+        return -1;
+    }
+    os_mutex_unlock(handle->lock);
+
+    return listplayer_attach_sink_session(handle, session, false);
+}
+
+int listplayer_set_index_cache_dir(listplayer_handle_t handle, const char *dir)
+{
+    if (handle == NULL)
+        return -1;
+
+    os_mutex_lock(handle->lock);
+    if (handle->state != LITEPLAYER_IDLE) {
+        OS_LOGE(TAG, "Can't set index cache dir in state=[%d]", handle->state);
+        os_mutex_unlock(handle->lock);
+        return -1;
+    }
+    os_mutex_unlock(handle->lock);
+
+    return liteplayer_set_index_cache_dir(handle->player, dir);
+}
+
+int listplayer_set_sink_format(listplayer_handle_t handle, int samplerate, int channels, int bits,
+                               enum liteplayer_resample_quality quality)
+{
+    if (handle == NULL)
+        return -1;
+
+    os_mutex_lock(handle->lock);
+    if (handle->state != LITEPLAYER_IDLE) {
+        OS_LOGE(TAG, "Can't set sink format in state=[%d]", handle->state);
+        os_mutex_unlock(handle->lock);
+        return -1;
+    }
+    os_mutex_unlock(handle->lock);
+
+    return liteplayer_set_sink_format(handle->player, samplerate, channels, bits, quality);
+}
+
+int listplayer_set_volume(listplayer_handle_t handle, float volume)
+{
+    if (handle == NULL)
+        return -1;
+    return liteplayer_set_volume(handle->player, volume);
+}
+
+int listplayer_set_track_gain(listplayer_handle_t handle, float gain_db)
+{
+    if (handle == NULL)
+        return -1;
+    return liteplayer_set_track_gain(handle->player, gain_db);
 }
 
 int listplayer_register_state_listener(listplayer_handle_t handle, liteplayer_state_cb listener, void *listener_priv)
@@ -742,6 +834,13 @@ int listplayer_get_duration(listplayer_handle_t handle, int *msec)
     return liteplayer_get_duration(handle->player, msec);
 }
 
+int listplayer_get_stats(listplayer_handle_t handle, struct liteplayer_stats *stats)
+{
+    if (handle == NULL || stats == NULL)
+        return -1;
+    return liteplayer_get_stats(handle->player, stats);
+}
+
 void listplayer_destroy(listplayer_handle_t handle)
 {
     if (handle == NULL)
@@ -752,6 +851,8 @@ void listplayer_destroy(listplayer_handle_t handle)
         liteplayer_destroy(handle->player);
     if (handle->adapter != NULL)
         handle->adapter->destory(handle->adapter);
+    if (handle->sink_session_owned)
+        sink_session_destroy(handle->sink_session);
     if (handle->lock != NULL)
         os_mutex_destroy(handle->lock);
     if (handle->cfg.playlist_url_suffix != NULL)
@@ -15,23 +15,26 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <math.h>
+#include <time.h>
 
 #include "osal/os_thread.h"
+#include "osal/os_time.h"
 #include "cutils/ringbuf.h"
 #include "cutils/log_helper.h"
 #include "esp_adf/audio_element.h"
 #include "esp_adf/audio_event_iface.h"
 #include "esp_adf/audio_common.h"
-#include "audio_decoder/mp3_decoder.h"
 #include "audio_decoder/aac_decoder.h"
-#include "audio_decoder/m4a_decoder.h"
-#include "audio_decoder/wav_decoder.h"
+#include "audio_resampler/resampler.h"
+#include "audio_gain/gain.h"
 
 #include "liteplayer_adapter_internal.h"
 #include "liteplayer_adapter.h"
 #include "liteplayer_config.h"
 #include "liteplayer_source.h"
 #include "liteplayer_parser.h"
+#include "liteplayer_decoder.h"
 #include "liteplayer_main.h"
 
 #define TAG "[liteplayer]core"
@@ -54,6 +57,7 @@ struct liteplayer {
 
     media_parser_handle_t   media_parser_handle;
     struct media_codec_info media_codec_info;
+    char                   *index_cache_dir;
 
     audio_element_handle_t  ael_decoder;
 
@@ -69,10 +73,131 @@ struct liteplayer {
     long long               sink_position;
     bool                    sink_inited;
 
+    int                     pcm_samplerate; // decoder output, differs from sink when resampling
+    int                     pcm_channels;
+    int                     pcm_bits;
+    int                     fixed_samplerate; // fixed sink format, 0 to follow decoder
+    int                     fixed_channels;
+    int                     fixed_bits;
+    enum resampler_quality  resample_quality;
+    resampler_handle_t      resampler;
+    char                   *convert_buffer; // resampled or gained pcm, written out entirely
+    int                     convert_buffer_size;
+
+    gain_handle_t           gain;
+    os_mutex                gain_lock;
+    float                   volume;     // linear, liteplayer_set_volume()
+    float                   track_gain; // linear, liteplayer_set_track_gain()
+
+    enum liteplayer_cpu_budget cpu_budget;
+
     int                     seek_time;
     long long               seek_offset;
+
+    struct liteplayer_stats stats;      // see STATS_STORE()
+    long long               stats_fill_sum;
+    int                     stats_fill_samples;
+    int                     stats_xrun_base;
+    long long               stats_cpu_mark_us; // decoder thread cpu when the last sink write returned
+    unsigned long long      stats_start_usec;
 };
 
+// Stats have a single writer, the decoder thread, and are read by liteplayer_get_stats()
+// without locking. Relaxed atomics only keep 64-bit counters from tearing on 32-bit cpus
+#define STATS_STORE(field, value)   __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+#define STATS_LOAD(field)           __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define STATS_ADD(field, value)     STATS_STORE(field, STATS_LOAD(field) + (value))
+
+static const int stats_latency_bounds_ms[] = LITEPLAYER_STATS_LATENCY_BOUNDS_MS;
+
+static long long stats_thread_cpu_us(void)
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+    return -1;
+}
+
+static void stats_reset(liteplayer_handle_t handle)
+{
+    memset(&handle->stats, 0, sizeof(handle->stats));
+    handle->stats.xruns = -1;
+    handle->stats.first_audio_ms = -1;
+    handle->stats_fill_sum = 0;
+    handle->stats_fill_samples = 0;
+    handle->stats_xrun_base = 0;
+    // Decoder thread is created along with the pipeline, its cpu clock starts from zero
+    handle->stats_cpu_mark_us = 0;
+    handle->stats_start_usec = 0;
+}
+
+// Once per period on the decoder thread, before the pcm goes to sink
+static void stats_period_begin(liteplayer_handle_t handle)
+{
+    long long cpu_us = stats_thread_cpu_us();
+    if (cpu_us < 0)
+        STATS_STORE(handle->stats.decode_cpu_us, -1);
+    else if (cpu_us >= handle->stats_cpu_mark_us)
+        STATS_ADD(handle->stats.decode_cpu_us, cpu_us - handle->stats_cpu_mark_us);
+
+    ringbuf_handle rb = handle->media_source_info.out_ringbuf;
+    if (rb == NULL)
+        return;
+    int fill = rb_bytes_filled(rb);
+    handle->stats_fill_sum += fill;
+    handle->stats_fill_samples++;
+    if (handle->stats_fill_samples == 1 || fill < handle->stats.ringbuf_fill_min)
+        STATS_STORE(handle->stats.ringbuf_fill_min, fill);
+    if (fill > handle->stats.ringbuf_fill_max)
+        STATS_STORE(handle->stats.ringbuf_fill_max, fill);
+    STATS_STORE(handle->stats.ringbuf_fill_avg, (int)(handle->stats_fill_sum / handle->stats_fill_samples));
+    STATS_STORE(handle->stats.ringbuf_size, rb_get_size(rb));
+}
+
+static void stats_period_end(liteplayer_handle_t handle, int consumed)
+{
+    if (consumed > 0) {
+        int frame_size = handle->pcm_channels * handle->pcm_bits / 8;
+        STATS_ADD(handle->stats.bytes_decoded, consumed);
+        if (frame_size > 0)
+            STATS_STORE(handle->stats.frames_decoded, handle->stats.bytes_decoded / frame_size);
+    }
+    STATS_STORE(handle->stats.bytes_read, audio_element_get_input_bytes(handle->ael_decoder));
+    handle->stats_cpu_mark_us = stats_thread_cpu_us();
+}
+
+// Wraps every write to sink, pcm goes out in one or more writes per period
+static int stats_sink_write(liteplayer_handle_t handle, char *buffer, int size)
+{
+    unsigned long long begin = os_monotonic_usec();
+    int bytes_written = handle->sink_ops->write(handle->sink_handle, buffer, size);
+    unsigned long long end = os_monotonic_usec();
+
+    int latency_us = (int)(end - begin);
+    int bucket = 0;
+    while (bucket < LITEPLAYER_STATS_LATENCY_BUCKETS - 1 &&
+           latency_us >= stats_latency_bounds_ms[bucket] * 1000)
+        bucket++;
+    STATS_ADD(handle->stats.sink_latency_hist[bucket], 1);
+    STATS_ADD(handle->stats.sink_writes, 1);
+    if (latency_us > handle->stats.sink_latency_max_us)
+        STATS_STORE(handle->stats.sink_latency_max_us, latency_us);
+
+    if (bytes_written > 0) {
+        STATS_ADD(handle->stats.bytes_written, bytes_written);
+        if (handle->stats.first_audio_ms < 0 && handle->stats_start_usec > 0)
+            STATS_STORE(handle->stats.first_audio_ms, (int)((end - handle->stats_start_usec) / 1000));
+    }
+    if (handle->sink_ops->xruns != NULL) {
+        int xruns = handle->sink_ops->xruns(handle->sink_handle);
+        if (xruns >= 0)
+            STATS_STORE(handle->stats.xruns, xruns - handle->stats_xrun_base);
+    }
+    return bytes_written;
+}
+
 static int audio_source_open(audio_element_handle_t self, void *ctx)
 {
     liteplayer_handle_t handle = (liteplayer_handle_t)ctx;
@@ -148,6 +273,66 @@ static void audio_source_close(audio_element_handle_t self, void *ctx)
     }
 }
 
+static void audio_sink_set_format(liteplayer_handle_t handle, int samplerate, int channels, int bits)
+{
+    handle->pcm_samplerate = samplerate;
+    handle->pcm_channels = channels;
+    handle->pcm_bits = bits;
+    handle->sink_samplerate = handle->fixed_samplerate > 0 ? handle->fixed_samplerate : samplerate;
+    handle->sink_channels = handle->fixed_channels > 0 ? handle->fixed_channels : channels;
+    handle->sink_bits = handle->fixed_bits > 0 ? handle->fixed_bits : bits;
+}
+
+static int audio_sink_open_resampler(liteplayer_handle_t handle)
+{
+    if (handle->pcm_samplerate == handle->sink_samplerate &&
+        handle->pcm_channels == handle->sink_channels &&
+        handle->pcm_bits == handle->sink_bits)
+        return AEL_IO_OK;
+
+    OS_LOGI(TAG, "Resampling pcm: rate:%d->%d, channels:%d->%d, bits:%d->%d",
+            handle->pcm_samplerate, handle->sink_samplerate,
+            handle->pcm_channels, handle->sink_channels,
+            handle->pcm_bits, handle->sink_bits);
+    struct resampler_cfg cfg = {
+        .in_samplerate = handle->pcm_samplerate,
+        .in_channels = handle->pcm_channels,
+        .in_bits = handle->pcm_bits,
+        .out_samplerate = handle->sink_samplerate,
+        .out_channels = handle->sink_channels,
+        .out_bits = handle->sink_bits,
+        .quality = handle->resample_quality,
+    };
+    handle->resampler = resampler_create(&cfg);
+    if (handle->resampler == NULL) {
+        OS_LOGE(TAG, "Failed to create resampler");
+        return AEL_IO_FAIL;
+    }
+    return AEL_IO_OK;
+}
+
+static float audio_sink_target_gain(liteplayer_handle_t handle)
+{
+    os_mutex_lock(handle->gain_lock);
+    float gain = handle->volume * handle->track_gain;
+    os_mutex_unlock(handle->gain_lock);
+    return gain;
+}
+
+static void audio_sink_open_gain(liteplayer_handle_t handle)
+{
+    struct gain_cfg cfg = {
+        .samplerate = handle->sink_samplerate,
+        .channels = handle->sink_channels,
+        .bits = handle->sink_bits,
+        .ramp_ms = DEFAULT_GAIN_RAMP_MS,
+    };
+    // Without gain the pcm is still played, only at unity
+    handle->gain = gain_create(&cfg, audio_sink_target_gain(handle));
+    if (handle->gain == NULL)
+        OS_LOGW(TAG, "Failed to create gain, volume is disabled");
+}
+
 static int audio_sink_open(audio_element_handle_t self, void *ctx)
 {
     liteplayer_handle_t handle = (liteplayer_handle_t)ctx;
@@ -155,6 +340,10 @@ static int audio_sink_open(audio_element_handle_t self, void *ctx)
         OS_LOGV(TAG, "Sink not inited, abort opening");
         return AEL_IO_OK;
     }
+    if (handle->resampler == NULL && audio_sink_open_resampler(handle) != AEL_IO_OK)
+        return AEL_IO_FAIL;
+    if (handle->gain == NULL)
+        audio_sink_open_gain(handle);
     OS_LOGI(TAG, "Opening sink: rate:%d, channels:%d, bits:%d",
             handle->sink_samplerate, handle->sink_channels, handle->sink_bits);
     if (handle->sink_handle == NULL) {
@@ -166,20 +355,92 @@ static int audio_sink_open(audio_element_handle_t self, void *ctx)
             OS_LOGE(TAG, "Failed to open sink");
             return AEL_IO_FAIL;
         }
+        // A shared sink may have counted underruns before this track
+        if (handle->sink_ops->xruns != NULL) {
+            int xruns = handle->sink_ops->xruns(handle->sink_handle);
+            handle->stats_xrun_base = xruns > 0 ? xruns : 0;
+            if (xruns >= 0 && handle->stats.xruns < 0)
+                STATS_STORE(handle->stats.xruns, 0);
+        }
     }
     return AEL_IO_OK;
 }
 
-static int audio_sink_write(audio_element_handle_t self, char *buffer, int len, int timeout_ms, void *ctx)
+static int audio_sink_reserve_convert_buffer(liteplayer_handle_t handle, int size)
 {
-    liteplayer_handle_t handle = (liteplayer_handle_t)ctx;
-    if (!handle->sink_inited) {
-        handle->sink_inited = true;
-        if (audio_sink_open(self, ctx) != 0)
+    if (size > handle->convert_buffer_size) {
+        char *out = audio_realloc(handle->convert_buffer, size);
+        AUDIO_MEM_CHECK(TAG, out, return AEL_IO_FAIL);
+        handle->convert_buffer = out;
+        handle->convert_buffer_size = size;
+    }
+    return AEL_IO_OK;
+}
+
+// Input is consumed by resampler and gain, so the converted pcm must be written out entirely
+static int audio_sink_write_converted(liteplayer_handle_t handle, int out_len)
+{
+    int offset = 0;
+    while (offset < out_len) {
+        int bytes_written = stats_sink_write(handle, handle->convert_buffer + offset, out_len - offset);
+        if (bytes_written <= 0 || bytes_written > out_len - offset) {
+            OS_LOGE(TAG, "Failed to write pcm, ret:%d", bytes_written);
             return AEL_IO_FAIL;
+        }
+        offset += bytes_written;
+        handle->sink_position += bytes_written;
     }
+    return AEL_IO_OK;
+}
 
-    int bytes_written = handle->sink_ops->write(handle->sink_handle, buffer, len);
+static int audio_sink_write_resampled(liteplayer_handle_t handle, char *buffer, int len, bool apply_gain)
+{
+    int out_size = resampler_get_output_size(handle->resampler, len);
+    if (audio_sink_reserve_convert_buffer(handle, out_size) != AEL_IO_OK)
+        return AEL_IO_FAIL;
+
+    int out_len = resampler_process(handle->resampler, buffer, len,
+                                    handle->convert_buffer, handle->convert_buffer_size);
+    if (out_len < 0) {
+        OS_LOGE(TAG, "Failed to resample pcm, ret:%d", out_len);
+        return AEL_IO_FAIL;
+    }
+    if (apply_gain)
+        gain_process(handle->gain, handle->convert_buffer, handle->convert_buffer, out_len);
+
+    if (audio_sink_write_converted(handle, out_len) != AEL_IO_OK)
+        return AEL_IO_FAIL;
+    return len;
+}
+
+static int audio_sink_write_gained(liteplayer_handle_t handle, char *buffer, int len)
+{
+    // Decoder may resubmit what the sink didn't take, so gain is never applied in place
+    if (audio_sink_reserve_convert_buffer(handle, len) != AEL_IO_OK)
+        return AEL_IO_FAIL;
+
+    gain_process(handle->gain, buffer, handle->convert_buffer, len);
+
+    if (audio_sink_write_converted(handle, len) != AEL_IO_OK)
+        return AEL_IO_FAIL;
+    return len;
+}
+
+static int audio_sink_write_period(liteplayer_handle_t handle, char *buffer, int len)
+{
+    // Volume changes are picked up once per period, the ramp starts with this one
+    bool apply_gain = false;
+    if (handle->gain != NULL) {
+        gain_set_target(handle->gain, audio_sink_target_gain(handle));
+        apply_gain = !gain_is_unity(handle->gain);
+    }
+
+    if (handle->resampler != NULL)
+        return audio_sink_write_resampled(handle, buffer, len, apply_gain);
+    if (apply_gain)
+        return audio_sink_write_gained(handle, buffer, len);
+
+    int bytes_written = stats_sink_write(handle, buffer, len);
     if (bytes_written >= 0 && bytes_written <= len) {
         handle->sink_position += bytes_written;
     } else {
@@ -189,6 +450,21 @@ static int audio_sink_write(audio_element_handle_t self, char *buffer, int len,
     return bytes_written;
 }
 
+static int audio_sink_write(audio_element_handle_t self, char *buffer, int len, int timeout_ms, void *ctx)
+{
+    liteplayer_handle_t handle = (liteplayer_handle_t)ctx;
+    if (!handle->sink_inited) {
+        handle->sink_inited = true;
+        if (audio_sink_open(self, ctx) != 0)
+            return AEL_IO_FAIL;
+    }
+
+    stats_period_begin(handle);
+    int ret = audio_sink_write_period(handle, buffer, len);
+    stats_period_end(handle, ret);
+    return ret;
+}
+
 static void audio_sink_close(audio_element_handle_t self, void *ctx)
 {
     liteplayer_handle_t handle = (liteplayer_handle_t)ctx;
@@ -200,6 +476,14 @@ static void audio_sink_close(audio_element_handle_t self, void *ctx)
     if (audio_element_get_state(self) != AEL_STATE_PAUSED) {
         handle->sink_position = 0;
         handle->sink_inited = false;
+        if (handle->resampler != NULL) {
+            resampler_destroy(handle->resampler);
+            handle->resampler = NULL;
+        }
+        if (handle->gain != NULL) {
+            gain_destroy(handle->gain);
+            handle->gain = NULL;
+        }
     }
 }
 
@@ -242,6 +526,7 @@ static int audio_element_state_callback(audio_element_handle_t el, audio_event_i
 
             case AEL_STATUS_ERROR_TIMEOUT:
                 if (msg->source == (void *)handle->ael_decoder) {
+                    STATS_ADD(handle->stats.input_timeouts, 1);
                     OS_LOGW(TAG, "[ %s-%s ] Receive inputtimeout event, filled/total: %d/%d",
                             handle->source_ops->url_protocol(), audio_element_get_tag(el),
                             rb_bytes_filled(handle->media_source_info.out_ringbuf),
@@ -301,9 +586,7 @@ static int audio_element_state_callback(audio_element_handle_t el, audio_event_i
                 OS_LOGI(TAG, "[ %s-%s ] Receive codec info: samplerate=%d, ch=%d, bits=%d",
                         handle->source_ops->url_protocol(), audio_element_get_tag(el),
                         info.samplerate, info.channels, info.bits);
-                handle->sink_samplerate = info.samplerate;
-                handle->sink_channels = info.channels;
-                handle->sink_bits = info.bits;
+                audio_sink_set_format(handle, info.samplerate, info.channels, info.bits);
             }
         }
     }
@@ -391,73 +674,58 @@ static void main_pipeline_deinit(liteplayer_handle_t handle)
         audio_free(handle->source_buffer_addr);
         handle->source_buffer_addr = NULL;
     }
+
+    if (handle->resampler != NULL) {
+        resampler_destroy(handle->resampler);
+        handle->resampler = NULL;
+    }
+
+    if (handle->gain != NULL) {
+        gain_destroy(handle->gain);
+        handle->gain = NULL;
+    }
+
+    if (handle->convert_buffer != NULL) {
+        audio_free(handle->convert_buffer);
+        handle->convert_buffer = NULL;
+        handle->convert_buffer_size = 0;
+    }
+}
+
+static enum aac_decode_mode aac_decode_mode_from_budget(enum liteplayer_cpu_budget budget)
+{
+    switch (budget) {
+    case LITEPLAYER_CPU_BUDGET_MEDIUM:
+        return AAC_DECODE_DOWNSAMPLED_SBR;
+    case LITEPLAYER_CPU_BUDGET_LOW:
+        return AAC_DECODE_CORE_ONLY;
+    default:
+        return AAC_DECODE_FULL;
+    }
 }
 
 static int main_pipeline_init(liteplayer_handle_t handle)
 {
     {
         OS_LOGD(TAG, "[1.0] Create decoder element");
-        switch (handle->media_codec_info.codec_type) {
-        case AUDIO_CODEC_MP3: {
-            struct mp3_decoder_cfg mp3_cfg = DEFAULT_MP3_DECODER_CONFIG();
-            mp3_cfg.task_prio            = DEFAULT_MEDIA_DECODER_TASK_PRIO;
-            mp3_cfg.task_stack           = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE;
-            mp3_cfg.mp3_info             = &(handle->media_codec_info.detail.mp3_info);
-            handle->ael_decoder = mp3_decoder_init(&mp3_cfg);
-            break;
-        }
-        case AUDIO_CODEC_AAC: {
-            struct aac_decoder_cfg aac_cfg = DEFAULT_AAC_DECODER_CONFIG();
-            aac_cfg.task_prio            = DEFAULT_MEDIA_DECODER_TASK_PRIO;
-            aac_cfg.task_stack           = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE;
-            aac_cfg.aac_info             = &(handle->media_codec_info.detail.aac_info);
-            handle->ael_decoder = aac_decoder_init(&aac_cfg);
-            break;
-        }
-        case AUDIO_CODEC_M4A: {
-            struct m4a_decoder_cfg m4a_cfg = DEFAULT_M4A_DECODER_CONFIG();
-            m4a_cfg.task_prio            = DEFAULT_MEDIA_DECODER_TASK_PRIO;
-            m4a_cfg.task_stack           = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE;
-            m4a_cfg.m4a_info             = &(handle->media_codec_info.detail.m4a_info);
-            handle->ael_decoder = m4a_decoder_init(&m4a_cfg);
-            break;
-        }
-        case AUDIO_CODEC_WAV: {
-            struct wav_decoder_cfg wav_cfg = DEFAULT_WAV_DECODER_CONFIG();
-            wav_cfg.task_prio            = DEFAULT_MEDIA_DECODER_TASK_PRIO;
-            wav_cfg.task_stack           = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE;
-            wav_cfg.wav_info             = &(handle->media_codec_info.detail.wav_info);
-            handle->ael_decoder = wav_decoder_init(&wav_cfg);
-            break;
-        }
-        case AUDIO_CODEC_OPUS: {
-            //struct opus_decoder_cfg opus_cfg = DEFAULT_OPUS_DECODER_CONFIG();
-            //opus_cfg.task_prio            = DEFAULT_MEDIA_DECODER_TASK_PRIO;
-            //opus_cfg.task_stack           = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE;
-            //opus_cfg.opus_info            = &(handle->media_codec_info.detail.opus_info);
-            //handle->ael_decoder = opus_decoder_init(&opus_cfg);
-            break;
-        }
-        case AUDIO_CODEC_FLAC: {
-            //struct flac_decoder_cfg flac_cfg = DEFAULT_FLAC_DECODER_CONFIG();
-            //flac_cfg.task_prio            = DEFAULT_MEDIA_DECODER_TASK_PRIO;
-            //flac_cfg.task_stack           = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE;
-            //flac_cfg.flac_info            = &(handle->media_codec_info.detail.flac_info);
-            //handle->ael_decoder = flac_decoder_init(&flac_cfg);
-            break;
-        }
-        default:
-            break;
-        }
+        stats_reset(handle);
+        struct media_decoder_cfg decoder_cfg = {
+            .task_prio = DEFAULT_MEDIA_DECODER_TASK_PRIO,
+            .task_stack = DEFAULT_MEDIA_DECODER_TASK_STACKSIZE,
+            .aac_decode_mode = aac_decode_mode_from_budget(handle->cpu_budget),
+            .aac_ps_to_mono = handle->cpu_budget >= LITEPLAYER_CPU_BUDGET_MEDIUM,
+        };
+        handle->ael_decoder = media_decoder_init(&handle->media_codec_info, &decoder_cfg);
         AUDIO_MEM_CHECK(TAG, handle->ael_decoder, return ESP_FAIL);
     }
 
     {
         OS_LOGD(TAG, "[1.1] Create sink element");
         handle->sink_position = 0;
-        handle->sink_samplerate = handle->media_codec_info.codec_samplerate;
-        handle->sink_channels = handle->media_codec_info.codec_channels;
-        handle->sink_bits = handle->media_codec_info.codec_bits;
+        audio_sink_set_format(handle,
+                              handle->media_codec_info.codec_samplerate,
+                              handle->media_codec_info.codec_channels,
+                              handle->media_codec_info.codec_bits);
         stream_callback_t audio_sink = {
             .open = audio_sink_open,
             .write = audio_sink_write,
@@ -507,10 +775,15 @@ liteplayer_handle_t liteplayer_create()
     liteplayer_handle_t handle = audio_calloc(1, sizeof(struct liteplayer));
     if (handle != NULL) {
         handle->state = LITEPLAYER_IDLE;
+        handle->volume = 1.0f;
+        handle->track_gain = 1.0f;
+        stats_reset(handle);
         handle->io_lock = os_mutex_create();
         handle->state_lock = os_mutex_create();
+        handle->gain_lock = os_mutex_create();
         handle->adapter_handle = liteplayer_adapter_init();
-        if (handle->io_lock == NULL || handle->state_lock == NULL || handle->adapter_handle == NULL) {
+        if (handle->io_lock == NULL || handle->state_lock == NULL || handle->gain_lock == NULL ||
+            handle->adapter_handle == NULL) {
             goto create_fail;
         }
     }
@@ -521,6 +794,8 @@ create_fail:
         os_mutex_destroy(handle->io_lock);
     if (handle->state_lock != NULL)
         os_mutex_destroy(handle->state_lock);
+    if (handle->gain_lock != NULL)
+        os_mutex_destroy(handle->gain_lock);
     if (handle->adapter_handle != NULL)
         handle->adapter_handle->destory(handle->adapter_handle);
     audio_free(handle);
@@ -559,6 +834,110 @@ int liteplayer_register_sink_wrapper(liteplayer_handle_t handle, struct sink_wra
     return ret;
 }
 
+int liteplayer_set_index_cache_dir(liteplayer_handle_t handle, const char *dir)
+{
+    if (handle == NULL)
+        return ESP_FAIL;
+
+    os_mutex_lock(handle->io_lock);
+    if (handle->state != LITEPLAYER_IDLE) {
+        OS_LOGE(TAG, "Can't set index cache dir in state=[%d]", handle->state);
+        os_mutex_unlock(handle->io_lock);
+        return ESP_FAIL;
+    }
+    if (handle->index_cache_dir != NULL) {
+        audio_free(handle->index_cache_dir);
+        handle->index_cache_dir = NULL;
+    }
+    int ret = ESP_OK;
+    if (dir != NULL) {
+        handle->index_cache_dir = audio_strdup(dir);
+        if (handle->index_cache_dir == NULL)
+            ret = ESP_FAIL;
+    }
+    os_mutex_unlock(handle->io_lock);
+    return ret;
+}
+
+int liteplayer_set_sink_format(liteplayer_handle_t handle, int samplerate, int channels, int bits,
+                               enum liteplayer_resample_quality quality)
+{
+    if (handle == NULL)
+        return ESP_FAIL;
+
+    if (samplerate < 0 || channels < 0 || channels > 8 || (bits != 0 && bits != 16 && bits != 32)) {
+        OS_LOGE(TAG, "Invalid sink format: rate:%d, channels:%d, bits:%d", samplerate, channels, bits);
+        return ESP_FAIL;
+    }
+
+    os_mutex_lock(handle->io_lock);
+    if (handle->state != LITEPLAYER_IDLE) {
+        OS_LOGE(TAG, "Can't set sink format in state=[%d]", handle->state);
+        os_mutex_unlock(handle->io_lock);
+        return ESP_FAIL;
+    }
+    handle->fixed_samplerate = samplerate;
+    handle->fixed_channels = channels;
+    handle->fixed_bits = bits;
+    handle->resample_quality = (quality == LITEPLAYER_RESAMPLE_HIGH) ?
+                               RESAMPLER_QUALITY_HIGH : RESAMPLER_QUALITY_FAST;
+    os_mutex_unlock(handle->io_lock);
+    return ESP_OK;
+}
+
+int liteplayer_set_cpu_budget(liteplayer_handle_t handle, enum liteplayer_cpu_budget budget)
+{
+    if (handle == NULL)
+        return ESP_FAIL;
+
+    if (budget < LITEPLAYER_CPU_BUDGET_HIGH || budget > LITEPLAYER_CPU_BUDGET_LOW) {
+        OS_LOGE(TAG, "Invalid cpu budget: %d", budget);
+        return ESP_FAIL;
+    }
+
+    os_mutex_lock(handle->io_lock);
+    if (handle->state != LITEPLAYER_IDLE) {
+        OS_LOGE(TAG, "Can't set cpu budget in state=[%d]", handle->state);
+        os_mutex_unlock(handle->io_lock);
+        return ESP_FAIL;
+    }
+    handle->cpu_budget = budget;
+    os_mutex_unlock(handle->io_lock);
+    return ESP_OK;
+}
+
+int liteplayer_set_volume(liteplayer_handle_t handle, float volume)
+{
+    if (handle == NULL)
+        return ESP_FAIL;
+
+    if (!(volume >= 0.0f && volume <= 1.0f)) {
+        OS_LOGE(TAG, "Invalid volume: %f", volume);
+        return ESP_FAIL;
+    }
+
+    os_mutex_lock(handle->gain_lock);
+    handle->volume = volume;
+    os_mutex_unlock(handle->gain_lock);
+    return ESP_OK;
+}
+
+int liteplayer_set_track_gain(liteplayer_handle_t handle, float gain_db)
+{
+    if (handle == NULL)
+        return ESP_FAIL;
+
+    if (!(gain_db >= -DEFAULT_TRACK_GAIN_MAX_DB && gain_db <= DEFAULT_TRACK_GAIN_MAX_DB)) {
+        OS_LOGE(TAG, "Invalid track gain: %fdB", gain_db);
+        return ESP_FAIL;
+    }
+
+    os_mutex_lock(handle->gain_lock);
+    handle->track_gain = powf(10.0f, gain_db / 20.0f);
+    os_mutex_unlock(handle->gain_lock);
+    return ESP_OK;
+}
+
 int liteplayer_register_state_listener(liteplayer_handle_t handle, liteplayer_state_cb listener, void *listener_priv)
 {
     if (handle == NULL || listener == NULL)
@@ -612,7 +991,8 @@ int liteplayer_set_data_source(liteplayer_handle_t handle, const char *url)
 
     handle->media_source_info.url = handle->url;
     handle->media_source_info.source_ops = handle->source_ops;
-    handle->media_source_info.out_ringbuf = rb_create(handle->source_ops->buffer_size);
+    // source thread is the only writer and decoder the only reader
+    handle->media_source_info.out_ringbuf = rb_create_spsc(handle->source_ops->buffer_size);
     AUDIO_MEM_CHECK(TAG, handle->media_source_info.out_ringbuf, goto set_fail);
 
     {
@@ -653,7 +1033,8 @@ int liteplayer_prepare(liteplayer_handle_t handle)
         return ESP_FAIL;
     }
 
-    int ret = media_parser_get_codec_info(&handle->media_source_info, &handle->media_codec_info);
+    int ret = media_parser_get_codec_info(&handle->media_source_info, handle->index_cache_dir,
+                                          &handle->media_codec_info);
     if (ret == ESP_OK)
         ret = main_pipeline_init(handle);
 
@@ -686,6 +1067,7 @@ int liteplayer_prepare_async(liteplayer_handle_t handle)
     int ret = ESP_OK;
     if (handle->source_ops->async_mode) {
         handle->media_parser_handle = media_parser_start_async(&handle->media_source_info,
+                                                               handle->index_cache_dir,
                                                                media_parser_state_callback,
                                                                handle);
         if (handle->media_parser_handle == NULL) {
@@ -696,7 +1078,8 @@ int liteplayer_prepare_async(liteplayer_handle_t handle)
             os_mutex_unlock(handle->state_lock);
         }
     } else {
-        ret = media_parser_get_codec_info(&handle->media_source_info, &handle->media_codec_info);
+        ret = media_parser_get_codec_info(&handle->media_source_info, handle->index_cache_dir,
+                                          &handle->media_codec_info);
         if (ret == ESP_OK)
             ret = main_pipeline_init(handle);
         os_mutex_lock(handle->state_lock);
@@ -736,6 +1119,7 @@ int liteplayer_start(liteplayer_handle_t handle)
     if (handle->state == LITEPLAYER_PREPARED) {
         if (handle->ael_decoder == NULL)
             ret = main_pipeline_init(handle);
+        handle->stats_start_usec = os_monotonic_usec();
     } else {
         if (handle->ael_decoder == NULL)
             ret = ESP_FAIL;
@@ -834,7 +1218,7 @@ int liteplayer_seek(liteplayer_handle_t handle, int msec)
         goto seek_out;
     }
 
-    long long offset = media_parser_get_seek_offset(&handle->media_codec_info, msec);
+    long long offset = media_parser_get_seek_offset(&handle->media_source_info, &handle->media_codec_info, msec);
     if (offset < 0) {
         ret = ESP_OK;
         goto seek_out;
@@ -860,6 +1244,11 @@ int liteplayer_seek(liteplayer_handle_t handle, int msec)
         if (ret != ESP_OK)
             goto seek_out;
 
+        if (handle->resampler != NULL)
+            resampler_reset(handle->resampler);
+        if (handle->gain != NULL)
+            gain_reset(handle->gain);
+
         if (handle->media_source_handle != NULL) {
             media_source_stop(handle->media_source_handle);
             handle->media_source_handle = NULL;
@@ -963,19 +1352,7 @@ int liteplayer_reset(liteplayer_handle_t handle)
         handle->url = NULL;
     }
 
-    if (handle->media_codec_info.codec_type == AUDIO_CODEC_M4A) {
-        if (handle->media_codec_info.detail.m4a_info.stsz_samplesize != NULL)
-            audio_free(handle->media_codec_info.detail.m4a_info.stsz_samplesize);
-        if (handle->media_codec_info.detail.m4a_info.stts_time2sample != NULL)
-            audio_free(handle->media_codec_info.detail.m4a_info.stts_time2sample);
-        if (handle->media_codec_info.detail.m4a_info.stsc_sample2chunk != NULL)
-            audio_free(handle->media_codec_info.detail.m4a_info.stsc_sample2chunk);
-        if (handle->media_codec_info.detail.m4a_info.stco_chunk2offset != NULL)
-            audio_free(handle->media_codec_info.detail.m4a_info.stco_chunk2offset);
-    } else if (handle->media_codec_info.codec_type == AUDIO_CODEC_WAV) {
-        if (handle->media_codec_info.detail.wav_info.header_buff != NULL)
-            audio_free(handle->media_codec_info.detail.wav_info.header_buff);
-    }
+    media_parser_release_codec_info(&handle->media_codec_info);
 
     memset(&handle->media_source_info, 0x0, sizeof(handle->media_source_info));
     memset(&handle->media_codec_info, 0x0, sizeof(handle->media_codec_info));
@@ -988,6 +1365,9 @@ int liteplayer_reset(liteplayer_handle_t handle)
     handle->sink_bits = 0;
     handle->sink_position = 0;
     handle->sink_inited = false;
+    handle->pcm_samplerate = 0;
+    handle->pcm_channels = 0;
+    handle->pcm_bits = 0;
     handle->seek_time = 0;
     handle->seek_offset = 0;
 
@@ -1043,6 +1423,31 @@ int liteplayer_get_duration(liteplayer_handle_t handle, int *msec)
     return ESP_OK;
 }
 
+int liteplayer_get_stats(liteplayer_handle_t handle, struct liteplayer_stats *stats)
+{
+    if (handle == NULL || stats == NULL)
+        return ESP_FAIL;
+
+    struct liteplayer_stats *cur = &handle->stats;
+    stats->bytes_read = STATS_LOAD(cur->bytes_read);
+    stats->bytes_decoded = STATS_LOAD(cur->bytes_decoded);
+    stats->frames_decoded = STATS_LOAD(cur->frames_decoded);
+    stats->bytes_written = STATS_LOAD(cur->bytes_written);
+    stats->input_timeouts = STATS_LOAD(cur->input_timeouts);
+    stats->ringbuf_size = STATS_LOAD(cur->ringbuf_size);
+    stats->ringbuf_fill_min = STATS_LOAD(cur->ringbuf_fill_min);
+    stats->ringbuf_fill_avg = STATS_LOAD(cur->ringbuf_fill_avg);
+    stats->ringbuf_fill_max = STATS_LOAD(cur->ringbuf_fill_max);
+    stats->sink_writes = STATS_LOAD(cur->sink_writes);
+    stats->sink_latency_max_us = STATS_LOAD(cur->sink_latency_max_us);
+    for (int i = 0; i < LITEPLAYER_STATS_LATENCY_BUCKETS; i++)
+        stats->sink_latency_hist[i] = STATS_LOAD(cur->sink_latency_hist[i]);
+    stats->xruns = STATS_LOAD(cur->xruns);
+    stats->decode_cpu_us = STATS_LOAD(cur->decode_cpu_us);
+    stats->first_audio_ms = STATS_LOAD(cur->first_audio_ms);
+    return ESP_OK;
+}
+
 void liteplayer_destroy(liteplayer_handle_t handle)
 {
     if (handle == NULL)
@@ -1052,6 +1457,9 @@ void liteplayer_destroy(liteplayer_handle_t handle)
         liteplayer_reset(handle);
 
     handle->adapter_handle->destory(handle->adapter_handle);
+    if (handle->index_cache_dir != NULL)
+        audio_free(handle->index_cache_dir);
+    os_mutex_destroy(handle->gain_lock);
     os_mutex_destroy(handle->state_lock);
     os_mutex_destroy(handle->io_lock);
     audio_free(handle);
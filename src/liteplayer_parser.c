@@ -21,9 +21,12 @@
 #include "audio_extractor/aac_extractor.h"
 #include "audio_extractor/m4a_extractor.h"
 #include "audio_extractor/wav_extractor.h"
+#include "audio_extractor/flac_extractor.h"
+#include "audio_extractor/ogg_extractor.h"
 
 #include "liteplayer_config.h"
 #include "liteplayer_parser.h"
+#include "liteplayer_indexcache.h"
 
 #define TAG "[liteplayer]parser"
 
@@ -33,6 +36,7 @@
 
 struct media_parser_priv {
     struct media_source_info source;
+    char *cache_dir;
     struct media_codec_info codec;
     char header_buffer[DEFAULT_MEDIA_PARSER_BUFFER_SIZE];
     int header_size;
@@ -62,6 +66,9 @@ static audio_codec_t get_codec_type(const char *url, char *buf)
         } else if (strstr(url, "aac") != NULL) {
             OS_LOGV(TAG, "Found AAC media with ID3 tag");
             codec = AUDIO_CODEC_AAC;
+        } else if (strstr(url, "flac") != NULL) {
+            OS_LOGV(TAG, "Found FLAC media with ID3 tag");
+            codec = AUDIO_CODEC_FLAC;
         } else {
             OS_LOGV(TAG, "Unknown type with ID3, assume codec is MP3");
             codec = AUDIO_CODEC_MP3;
@@ -78,8 +85,14 @@ static audio_codec_t get_codec_type(const char *url, char *buf)
     } else if (memcmp(&buf[0], "RIFF", 4) == 0) {
         OS_LOGV(TAG, "Found wav media");
         codec = AUDIO_CODEC_WAV;
+    } else if (memcmp(&buf[0], "fLaC", 4) == 0) {
+        OS_LOGV(TAG, "Found flac media");
+        codec = AUDIO_CODEC_FLAC;
+    } else if (memcmp(&buf[0], "OggS", 4) == 0 &&
+               memcmp(&buf[OGG_PAGE_HEADER_SIZE + (buf[26] & 0xFF)], "OpusHead", 8) == 0) {
+        OS_LOGV(TAG, "Found ogg opus media");
+        codec = AUDIO_CODEC_OPUS;
     }
-    // todo: support flac/opus
     return codec;
 }
 
@@ -232,8 +245,27 @@ static int media_parser_extract(struct media_parser_priv *priv)
             codec->codec_bits = 16;
             codec->content_pos = codec->detail.mp3_info.frame_start_offset;
             codec->content_len = priv->source.source_ops->content_len(priv->source.source_handle);
-            codec->bytes_per_sec = codec->detail.mp3_info.bit_rate*1000/8;
-            codec->duration_ms = (codec->content_len - codec->content_pos)*8/codec->detail.mp3_info.bit_rate;
+            struct mp3_info *info = &(codec->detail.mp3_info);
+#if defined(LITEPLAYER_CONFIG_MP3_FRAME_SCAN)
+            if (info->total_frames == 0 && codec->content_len > 0)
+                mp3_scan_frames(media_parser_fetch, priv, codec->content_len, info);
+#endif
+            long stream_bytes = info->total_bytes;
+            if (stream_bytes <= 0 && codec->content_len > 0) {
+                stream_bytes = codec->content_len - codec->content_pos;
+                info->total_bytes = stream_bytes;
+            }
+            if (info->total_frames > 0 && info->sample_rate > 0) {
+                // VBR stream: duration from frame count, bytes_per_sec is the average
+                codec->duration_ms = (int)((long long)info->total_frames*info->samples_per_frame*1000/info->sample_rate);
+                if (codec->duration_ms > 0 && stream_bytes > 0)
+                    codec->bytes_per_sec = (int)((long long)stream_bytes*1000/codec->duration_ms);
+                else
+                    codec->bytes_per_sec = info->bit_rate*1000/8;
+            } else {
+                codec->bytes_per_sec = info->bit_rate*1000/8;
+                codec->duration_ms = (codec->content_len - codec->content_pos)*8/info->bit_rate;
+            }
             ret = ESP_OK;
         }
         break;
@@ -246,8 +278,15 @@ static int media_parser_extract(struct media_parser_priv *priv)
             codec->codec_bits = 16;
             codec->content_pos = codec->detail.aac_info.frame_start_offset;
             codec->content_len = priv->source.source_ops->content_len(priv->source.source_handle);
-            //codec->bytes_per_sec = codec->detail.aac_info.bit_rate*1000/8;
-            //codec->duration_ms = (codec->content_len - codec->content_pos)*8/codec->detail.aac_info.bit_rate;
+            struct aac_info *info = &(codec->detail.aac_info);
+            // Scanning reads the whole stream, only worth it when the index can be cached
+            if (priv->cache_dir != NULL && codec->content_len > 0 &&
+                media_index_cacheable_url(priv->source.url) &&
+                aac_scan_frames(media_parser_fetch, priv, codec->content_len, info) == 0) {
+                codec->duration_ms = (int)((long long)info->total_frames*AAC_SAMPLES_PER_FRAME*1000/info->sample_rate);
+                if (codec->duration_ms > 0)
+                    codec->bytes_per_sec = (int)((long long)info->total_bytes*1000/codec->duration_ms);
+            }
             ret = ESP_OK;
         }
         break;
@@ -285,6 +324,40 @@ static int media_parser_extract(struct media_parser_priv *priv)
         break;
     }
 
+    case AUDIO_CODEC_FLAC: {
+        if (flac_extractor(media_parser_fetch, priv, &(codec->detail.flac_info)) == 0) {
+            struct flac_info *info = &(codec->detail.flac_info);
+            codec->codec_samplerate = info->sample_rate;
+            codec->codec_channels = info->channels;
+            codec->codec_bits = info->bits;
+            codec->content_pos = info->frame_start_offset;
+            codec->content_len = priv->source.source_ops->content_len(priv->source.source_handle);
+            if (info->total_samples > 0)
+                codec->duration_ms = (int)(info->total_samples*1000/info->sample_rate);
+            if (codec->duration_ms > 0 && codec->content_len > codec->content_pos)
+                codec->bytes_per_sec = (int)((long long)(codec->content_len - codec->content_pos)*1000/codec->duration_ms);
+            ret = ESP_OK;
+        }
+        break;
+    }
+
+    case AUDIO_CODEC_OPUS: {
+        codec->content_len = priv->source.source_ops->content_len(priv->source.source_handle);
+        if (ogg_opus_extractor(media_parser_fetch, priv, codec->content_len, &(codec->detail.opus_info)) == 0) {
+            struct opus_info *info = &(codec->detail.opus_info);
+            codec->codec_samplerate = info->sample_rate;
+            codec->codec_channels = info->channels;
+            codec->codec_bits = 16;
+            codec->content_pos = info->frame_start_offset;
+            if (info->total_granule > info->pre_skip)
+                codec->duration_ms = (int)((info->total_granule - info->pre_skip)*1000/OPUS_GRANULE_RATE);
+            if (codec->duration_ms > 0 && codec->content_len > codec->content_pos)
+                codec->bytes_per_sec = (int)((long long)(codec->content_len - codec->content_pos)*1000/codec->duration_ms);
+            ret = ESP_OK;
+        }
+        break;
+    }
+
     default:
         break;
     }
@@ -292,8 +365,44 @@ static int media_parser_extract(struct media_parser_priv *priv)
     return ret;
 }
 
+static int media_parser_open_cached(struct media_parser_priv *priv)
+{
+    // Cached info is valid, open source at frame_start_offset directly
+    priv->source.source_handle =
+        priv->source.source_ops->open(priv->source.url, priv->codec.content_pos,
+                                      priv->source.source_ops->priv_data);
+    if (priv->source.source_handle == NULL) {
+        media_parser_release_codec_info(&priv->codec);
+        return ESP_FAIL;
+    }
+
+    OS_LOGI(TAG, "MediaInfo(cached): codec_type[%d], samplerate[%d], channels[%d], bits[%d], pos[%ld], len[%ld], duration[%dms]",
+            priv->codec.codec_type, priv->codec.codec_samplerate, priv->codec.codec_channels, priv->codec.codec_bits,
+            priv->codec.content_pos, priv->codec.content_len, priv->codec.duration_ms);
+
+    bool reuse_handle = false;
+    if (priv->lock != NULL)
+        os_mutex_lock(priv->lock);
+    if (!priv->stop) {
+        rb_reset(priv->source.out_ringbuf);
+        reuse_handle = true;
+    }
+    if (priv->lock != NULL)
+        os_mutex_unlock(priv->lock);
+
+    if (!reuse_handle) {
+        priv->source.source_ops->close(priv->source.source_handle);
+        priv->source.source_handle = NULL;
+    }
+    return ESP_OK;
+}
+
 static int media_parser_main(struct media_parser_priv *priv)
 {
+    if (priv->cache_dir != NULL &&
+        media_index_cache_load(priv->cache_dir, priv->source.url, &priv->codec) == 0)
+        return media_parser_open_cached(priv);
+
     priv->source.source_handle =
         priv->source.source_ops->open(priv->source.url, 0, priv->source.source_ops->priv_data);
     if (priv->source.source_handle == NULL)
@@ -305,6 +414,8 @@ static int media_parser_main(struct media_parser_priv *priv)
         OS_LOGI(TAG, "MediaInfo: codec_type[%d], samplerate[%d], channels[%d], bits[%d], pos[%ld], len[%ld], duration[%dms]",
                 priv->codec.codec_type, priv->codec.codec_samplerate, priv->codec.codec_channels, priv->codec.codec_bits,
                 priv->codec.content_pos, priv->codec.content_len, priv->codec.duration_ms);
+        if (priv->cache_dir != NULL)
+            media_index_cache_save(priv->cache_dir, priv->source.url, &priv->codec);
     } else {
         OS_LOGE(TAG, "Failed to parse url:[%s]", priv->source.url);
     }
@@ -369,7 +480,8 @@ reuse_out:
     return ret;
 }
 
-int media_parser_get_codec_info(struct media_source_info *source, struct media_codec_info *codec)
+int media_parser_get_codec_info(struct media_source_info *source, const char *cache_dir,
+                                struct media_codec_info *codec)
 {
     if (source == NULL || source->url == NULL || source->out_ringbuf == NULL || codec == NULL)
         return ESP_FAIL;
@@ -379,6 +491,7 @@ int media_parser_get_codec_info(struct media_source_info *source, struct media_c
         return ESP_FAIL;
     memcpy(&priv->source, source, sizeof(struct media_source_info));
     priv->ringbuf_size = rb_get_size(source->out_ringbuf);
+    priv->cache_dir = (char *)cache_dir;
 
     bool free_url = false;
     if (strstr(priv->source.url, ".m3u") != NULL) {
@@ -436,6 +549,8 @@ static void media_parser_cleanup(struct media_parser_priv *priv)
         os_cond_destroy(priv->cond);
     if (priv->source.url != NULL)
         audio_free(priv->source.url);
+    if (priv->cache_dir != NULL)
+        audio_free(priv->cache_dir);
     audio_free(priv);
 }
 
@@ -470,6 +585,7 @@ static void *media_parser_thread(void *arg)
 }
 
 media_parser_handle_t media_parser_start_async(struct media_source_info *source,
+                                               const char *cache_dir,
                                                media_parser_state_cb listener,
                                                void *listener_priv)
 {
@@ -487,6 +603,11 @@ media_parser_handle_t media_parser_start_async(struct media_source_info *source,
     priv->source.url = audio_strdup(source->url);
     if (priv->lock == NULL || priv->cond == NULL || priv->source.url == NULL)
         goto start_failed;
+    if (cache_dir != NULL) {
+        priv->cache_dir = audio_strdup(cache_dir);
+        if (priv->cache_dir == NULL)
+            goto start_failed;
+    }
 
     struct os_thread_attr attr = {
         .name = "ael-parser",
@@ -520,18 +641,53 @@ void media_parser_stop(media_parser_handle_t handle)
     }
 }
 
-long long media_parser_get_seek_offset(struct media_codec_info *codec, int seek_msec)
+static long long media_parser_get_ogg_seek_offset(struct media_source_info *source,
+                                                  struct media_codec_info *codec, int seek_msec)
+{
+    long long offset = -1;
+    if (source == NULL || source->url == NULL || source->source_ops == NULL || codec->content_len <= 0) {
+        OS_LOGE(TAG, "Unsupported seek for ogg without source length");
+        return -1;
+    }
+
+    // Bisect with a new source handle, the opened one may be read by decoder now
+    struct media_parser_priv *priv = audio_calloc(1, sizeof(struct media_parser_priv));
+    if (priv == NULL)
+        return -1;
+    memcpy(&priv->source, source, sizeof(struct media_source_info));
+    priv->source.source_handle =
+        priv->source.source_ops->open(priv->source.url, 0, priv->source.source_ops->priv_data);
+    if (priv->source.source_handle != NULL) {
+        long page_offset = 0;
+        // Decoder drops samples up to seek time, keep it same as the position player reports
+        if (ogg_opus_get_seek_offset(media_parser_fetch, priv, codec->content_len, (seek_msec/1000)*1000,
+                                     &(codec->detail.opus_info), &page_offset) == 0)
+            offset = page_offset;
+        priv->source.source_ops->close(priv->source.source_handle);
+    }
+    audio_free(priv);
+    return offset;
+}
+
+long long media_parser_get_seek_offset(struct media_source_info *source, struct media_codec_info *codec, int seek_msec)
 {
     if (codec == NULL || seek_msec < 0)
         return -1;
 
     long long offset = -1;
     switch (codec->codec_type) {
-    case AUDIO_CODEC_WAV:
-    case AUDIO_CODEC_MP3: {
+    case AUDIO_CODEC_WAV: {
         offset = (codec->bytes_per_sec*(seek_msec/1000));
         break;
     }
+    case AUDIO_CODEC_MP3: {
+        long toc_offset = 0;
+        if (mp3_get_seek_offset(seek_msec, codec->duration_ms, &(codec->detail.mp3_info), &toc_offset) == 0)
+            offset = toc_offset;
+        else
+            offset = (codec->bytes_per_sec*(seek_msec/1000));
+        break;
+    }
     case AUDIO_CODEC_M4A: {
         unsigned int sample_index = 0;
         unsigned int sample_offset = 0;
@@ -542,6 +698,33 @@ long long media_parser_get_seek_offset(struct media_codec_info *codec, int seek_
         codec->detail.m4a_info.stsz_samplesize_index = sample_index;
         break;
     }
+    case AUDIO_CODEC_AAC: {
+        long index_offset = 0;
+        if (aac_get_seek_offset(seek_msec, &(codec->detail.aac_info), &index_offset) != 0) {
+            OS_LOGE(TAG, "Unsupported seek for aac without frame index");
+            break;
+        }
+        offset = index_offset;
+        break;
+    }
+    case AUDIO_CODEC_FLAC: {
+        // Decoder drops samples up to seek time, keep it same as the position player reports
+        long table_offset = 0;
+        if (flac_get_seek_offset((seek_msec/1000)*1000, &(codec->detail.flac_info), &table_offset) == 0)
+            offset = table_offset;
+        else if (codec->bytes_per_sec > 0) {
+            // Back off a frame so decoder is likely to resync before the target
+            offset = (codec->bytes_per_sec*(seek_msec/1000)) - codec->detail.flac_info.max_framesize;
+            if (offset < 0)
+                offset = 0;
+        } else
+            OS_LOGE(TAG, "Unsupported seek for flac without SEEKTABLE and duration");
+        break;
+    }
+    case AUDIO_CODEC_OPUS: {
+        offset = media_parser_get_ogg_seek_offset(source, codec, seek_msec);
+        break;
+    }
     default:
         OS_LOGE(TAG, "Unsupported seek for codec: %d", codec->codec_type);
         break;
@@ -552,3 +735,37 @@ long long media_parser_get_seek_offset(struct media_codec_info *codec, int seek_
     }
     return offset;
 }
+
+void media_parser_release_codec_info(struct media_codec_info *codec)
+{
+    if (codec == NULL)
+        return;
+
+    if (codec->codec_type == AUDIO_CODEC_M4A) {
+        if (codec->detail.m4a_info.stsz_samplesize != NULL)
+            audio_free(codec->detail.m4a_info.stsz_samplesize);
+        if (codec->detail.m4a_info.stts_time2sample != NULL)
+            audio_free(codec->detail.m4a_info.stts_time2sample);
+        if (codec->detail.m4a_info.stsc_sample2chunk != NULL)
+            audio_free(codec->detail.m4a_info.stsc_sample2chunk);
+        if (codec->detail.m4a_info.stco_chunk2offset != NULL)
+            audio_free(codec->detail.m4a_info.stco_chunk2offset);
+        codec->detail.m4a_info.stsz_samplesize = NULL;
+        codec->detail.m4a_info.stts_time2sample = NULL;
+        codec->detail.m4a_info.stsc_sample2chunk = NULL;
+        codec->detail.m4a_info.stco_chunk2offset = NULL;
+    } else if (codec->codec_type == AUDIO_CODEC_AAC) {
+        if (codec->detail.aac_info.index != NULL)
+            audio_free(codec->detail.aac_info.index);
+        codec->detail.aac_info.index = NULL;
+    } else if (codec->codec_type == AUDIO_CODEC_WAV) {
+        if (codec->detail.wav_info.header_buff != NULL)
+            audio_free(codec->detail.wav_info.header_buff);
+        codec->detail.wav_info.header_buff = NULL;
+    } else if (codec->codec_type == AUDIO_CODEC_FLAC) {
+        if (codec->detail.flac_info.seektable != NULL)
+            audio_free(codec->detail.flac_info.seektable);
+        codec->detail.flac_info.seektable = NULL;
+        codec->detail.flac_info.seekpoint_count = 0;
+    }
+}
@@ -20,6 +20,8 @@
 #include "audio_extractor/aac_extractor.h"
 #include "audio_extractor/m4a_extractor.h"
 #include "audio_extractor/wav_extractor.h"
+#include "audio_extractor/flac_extractor.h"
+#include "audio_extractor/ogg_extractor.h"
 #include "liteplayer_source.h"
 
 #ifdef __cplusplus
@@ -45,8 +47,8 @@ struct media_codec_info {
         struct mp3_info mp3_info;
         struct aac_info aac_info;
         struct m4a_info m4a_info;
-        //struct opus_info opus_info;
-        //struct flac_info flac_info;
+        struct flac_info flac_info;
+        struct opus_info opus_info;
     } detail;
 };
 
@@ -54,11 +56,18 @@ typedef void (*media_parser_state_cb)(enum media_parser_state state, struct medi
 
 typedef void *media_parser_handle_t;
 
-int media_parser_get_codec_info(struct media_source_info *source, struct media_codec_info *codec);
+// cache_dir is optional, if set the parsed info is loaded from/saved to index cache
+int media_parser_get_codec_info(struct media_source_info *source, const char *cache_dir,
+                                struct media_codec_info *codec);
 
-long long media_parser_get_seek_offset(struct media_codec_info *codec, int seek_msec);
+// source is only used by codecs without seek table (ogg), which bisect pages over source
+long long media_parser_get_seek_offset(struct media_source_info *source, struct media_codec_info *codec, int seek_msec);
+
+// Free the tables allocated by extractors in codec->detail
+void media_parser_release_codec_info(struct media_codec_info *codec);
 
 media_parser_handle_t media_parser_start_async(struct media_source_info *source,
+                                               const char *cache_dir,
                                                media_parser_state_cb listener,
                                                void *listener_priv);
 
@@ -0,0 +1,614 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "osal/os_thread.h"
+#include "cutils/log_helper.h"
+#include "esp_adf/audio_common.h"
+#include "audio_crossfade/crossfade.h"
+#include "liteplayer_adapter.h"
+#include "liteplayer_config.h"
+#include "liteplayer_sinksession.h"
+
+#define TAG "[liteplayer]sinksession"
+
+enum sink_input_state {
+    SINK_INPUT_DIRECT = 0,      // written to the device
+    SINK_INPUT_INCOMING,        // next track of a crossfade, buffered and mixed by the primary input
+    SINK_INPUT_WAITING,         // next track in another format, blocked until the primary input closes
+    SINK_INPUT_PENDING,         // next track opened while the primary still uses the fifo and fade
+    SINK_INPUT_DROPPED,         // faded out or cancelled, written pcm is discarded
+};
+
+// One per player that holds the session open
+struct sink_input {
+    sink_session_handle_t   session;
+    int                     samplerate;
+    int                     channels;
+    int                     bits;
+    enum sink_input_state   state;
+    struct sink_input      *next;
+};
+
+struct sink_session {
+    struct sink_wrapper wrapper;  // the real sink
+    os_mutex            lock;
+    os_cond             cond;     // fifo space, input state changes
+    os_mutex            write_lock; // device writes and handle/mix_buffer changes, taken before lock
+    sink_handle_t       handle;   // real sink handle, kept open across tracks
+    int                 samplerate;
+    int                 channels;
+    int                 bits;
+    int                 users;    // players that currently hold the session open
+    struct sink_input  *inputs;
+
+    int                 crossfade_ms;
+    enum sink_session_fade_curve crossfade_curve;
+    struct sink_input  *primary;  // input that drives the device
+    struct sink_input  *incoming; // next track, fading in or waiting to, at most one
+    crossfade_handle_t  fade;     // kept after promotion until incoming reaches full gain
+    bool                fading;
+
+    char               *fifo;     // pcm of incoming input, frame aligned
+    int                 fifo_size;
+    int                 fifo_read;
+    int                 fifo_filled;
+    int                 prebuffer;
+    char               *mix_buffer;
+    int                 mix_buffer_size;
+
+    int                 xruns;        // device underruns, summed over reopens
+    int                 xruns_closed; // underruns of handles closed so far
+};
+
+static const char *sink_session_name()
+{
+    return "session";
+}
+
+static void sink_session_close_locked(sink_session_handle_t session)
+{
+    if (session->handle != NULL) {
+        OS_LOGI(TAG, "Closing sink: rate:%d, channels:%d, bits:%d",
+                session->samplerate, session->channels, session->bits);
+        session->wrapper.close(session->handle);
+        session->handle = NULL;
+        session->xruns_closed = session->xruns;
+    }
+}
+
+static int sink_session_frame_size(sink_session_handle_t session)
+{
+    return session->channels * session->bits / 8;
+}
+
+// Called with write_lock held only, the device may block for a whole period
+static int sink_session_device_write(sink_session_handle_t session, char *buffer, int size)
+{
+    if (session->handle == NULL) {
+        // closed by sink_session_close() or a format switch, reopen with current format
+        session->handle = session->wrapper.open(session->samplerate, session->channels, session->bits,
+                                                session->wrapper.priv_data);
+        if (session->handle == NULL) {
+            OS_LOGE(TAG, "Failed to reopen sink");
+            return -1;
+        }
+    }
+    int ret = session->wrapper.write(session->handle, buffer, size);
+    if (session->wrapper.xruns != NULL) {
+        int xruns = session->wrapper.xruns(session->handle);
+        if (xruns > 0)
+            __atomic_store_n(&session->xruns, session->xruns_closed + xruns, __ATOMIC_RELAXED);
+    }
+    return ret;
+}
+
+// Mixed pcm has consumed both inputs already, so it must be written out entirely
+static int sink_session_device_write_all(sink_session_handle_t session, char *buffer, int size)
+{
+    int offset = 0;
+    while (offset < size) {
+        int ret = sink_session_device_write(session, buffer + offset, size - offset);
+        if (ret <= 0 || ret > size - offset) {
+            OS_LOGE(TAG, "Failed to write pcm, ret:%d", ret);
+            return ESP_FAIL;
+        }
+        offset += ret;
+    }
+    return ESP_OK;
+}
+
+static int sink_session_reserve_mix_buffer(sink_session_handle_t session, int size)
+{
+    if (size > session->mix_buffer_size) {
+        char *buffer = audio_realloc(session->mix_buffer, size);
+        AUDIO_MEM_CHECK(TAG, buffer, return ESP_FAIL);
+        session->mix_buffer = buffer;
+        session->mix_buffer_size = size;
+    }
+    return ESP_OK;
+}
+
+static void sink_session_fifo_push_locked(sink_session_handle_t session, const char *buffer, int size)
+{
+    int pos = (session->fifo_read + session->fifo_filled) % session->fifo_size;
+    int first = session->fifo_size - pos;
+    if (first > size)
+        first = size;
+    memcpy(session->fifo + pos, buffer, first);
+    memcpy(session->fifo, buffer + first, size - first);
+    session->fifo_filled += size;
+}
+
+static void sink_session_fifo_pop_locked(sink_session_handle_t session, char *buffer, int size)
+{
+    int first = session->fifo_size - session->fifo_read;
+    if (first > size)
+        first = size;
+    memcpy(buffer, session->fifo + session->fifo_read, first);
+    memcpy(buffer + first, session->fifo, size - first);
+    session->fifo_read = (session->fifo_read + size) % session->fifo_size;
+    session->fifo_filled -= size;
+}
+
+static void sink_session_stop_fade_locked(sink_session_handle_t session)
+{
+    if (session->fade != NULL) {
+        crossfade_destroy(session->fade);
+        session->fade = NULL;
+    }
+    session->fading = false;
+    session->fifo_read = 0;
+    session->fifo_filled = 0;
+}
+
+static int sink_session_start_incoming_locked(sink_session_handle_t session, struct sink_input *input)
+{
+    // Fifo holds the prebuffer plus what decoder writes while the fade catches up
+    int frame_size = sink_session_frame_size(session);
+    int prebuffer = (int)((long long)session->samplerate * DEFAULT_CROSSFADE_PREBUFFER_MS / 1000) * frame_size;
+    int fifo_size = prebuffer * 2;
+    if (fifo_size > session->fifo_size) {
+        char *fifo = audio_realloc(session->fifo, fifo_size);
+        AUDIO_MEM_CHECK(TAG, fifo, return ESP_FAIL);
+        session->fifo = fifo;
+        session->fifo_size = fifo_size;
+    }
+
+    struct crossfade_cfg cfg = {
+        .samplerate = session->samplerate,
+        .channels = session->channels,
+        .bits = session->bits,
+        .duration_ms = session->crossfade_ms,
+        .curve = session->crossfade_curve == SINK_SESSION_FADE_EQUAL_POWER ?
+                 CROSSFADE_CURVE_EQUAL_POWER : CROSSFADE_CURVE_LINEAR,
+    };
+    sink_session_stop_fade_locked(session);
+    session->fade = crossfade_create(&cfg);
+    if (session->fade == NULL)
+        return ESP_FAIL;
+
+    // Drop a partial frame left by a fifo of another format
+    session->fifo_size -= session->fifo_size % frame_size;
+    session->prebuffer = prebuffer;
+    input->state = SINK_INPUT_INCOMING;
+    session->incoming = input;
+    OS_LOGI(TAG, "Next track opened, buffering %dms before %dms crossfade",
+            DEFAULT_CROSSFADE_PREBUFFER_MS, session->crossfade_ms);
+    return ESP_OK;
+}
+
+static int sink_session_open_incoming_locked(sink_session_handle_t session, struct sink_input *input)
+{
+    if (input->samplerate != session->samplerate || input->channels != session->channels ||
+        input->bits != session->bits) {
+        OS_LOGW(TAG, "Next track format differs: rate:%d->%d, channels:%d->%d, bits:%d->%d, no crossfade",
+                session->samplerate, input->samplerate, session->channels, input->channels,
+                session->bits, input->bits);
+        input->state = SINK_INPUT_WAITING;
+        session->incoming = input;
+        return ESP_OK;
+    }
+
+    // Primary promoted by the last crossfade hasn't played its buffered pcm or finished fading in
+    if (session->fifo_filled > 0 || session->fade != NULL) {
+        OS_LOGI(TAG, "Next track opened, waiting for the previous crossfade to finish");
+        input->state = SINK_INPUT_PENDING;
+        session->incoming = input;
+        return ESP_OK;
+    }
+    return sink_session_start_incoming_locked(session, input);
+}
+
+// Pending next track starts buffering once the primary is done with the fifo and fade
+static void sink_session_start_pending_locked(sink_session_handle_t session)
+{
+    struct sink_input *input = session->incoming;
+    if (input == NULL || input->state != SINK_INPUT_PENDING ||
+        session->fifo_filled > 0 || session->fade != NULL)
+        return;
+
+    if (sink_session_start_incoming_locked(session, input) != ESP_OK) {
+        OS_LOGE(TAG, "Failed to start crossfade, next track waits for the playing one to close");
+        input->state = SINK_INPUT_WAITING;
+    }
+    os_cond_broadcast(session->cond);
+}
+
+// Incoming input takes over the device, what it has buffered is played first
+static void sink_session_promote_locked(sink_session_handle_t session)
+{
+    struct sink_input *input = session->incoming;
+    session->incoming = NULL;
+    session->primary = input;
+    if (input == NULL)
+        return;
+
+    if (input->state == SINK_INPUT_WAITING) {
+        sink_session_close_locked(session);
+        session->samplerate = input->samplerate;
+        session->channels = input->channels;
+        session->bits = input->bits;
+    } else if (input->state == SINK_INPUT_PENDING) {
+        // Buffered pcm and fade in belong to the primary that just closed
+        sink_session_stop_fade_locked(session);
+    } else if (!session->fading || crossfade_is_done(session->fade)) {
+        // Outgoing ended before the prebuffer was ready, or the fade is over
+        crossfade_destroy(session->fade);
+        session->fade = NULL;
+    }
+    session->fading = false;
+    input->state = SINK_INPUT_DIRECT;
+    os_cond_broadcast(session->cond);
+}
+
+static int sink_session_write_mixed_locked(sink_session_handle_t session, char *buffer, int size,
+                                           char **pcm, int *pcm_size)
+{
+    int frame_size = sink_session_frame_size(session);
+    size -= size % frame_size;
+    if (sink_session_reserve_mix_buffer(session, size) != ESP_OK)
+        return -1;
+
+    // Incoming decoder lagging behind is mixed as silence rather than stalling the outgoing
+    int bytes = session->fifo_filled < size ? session->fifo_filled : size;
+    sink_session_fifo_pop_locked(session, session->mix_buffer, bytes);
+    memset(session->mix_buffer + bytes, 0, size - bytes);
+    crossfade_process(session->fade, buffer, session->mix_buffer, session->mix_buffer, size);
+    os_cond_broadcast(session->cond);
+
+    if (crossfade_is_done(session->fade)) {
+        OS_LOGI(TAG, "Crossfade done, dropping outgoing track");
+        session->primary->state = SINK_INPUT_DROPPED;
+        sink_session_promote_locked(session);
+    }
+
+    *pcm = session->mix_buffer;
+    *pcm_size = size;
+    return size;
+}
+
+// Fills *pcm with what goes to the device for this write and returns the bytes of buffer consumed.
+// *pcm is buffer itself when it goes out unchanged, the device may then take only part of it
+static int sink_session_write_primary_locked(sink_session_handle_t session, char *buffer, int size,
+                                             char **pcm, int *pcm_size)
+{
+    *pcm = buffer;
+    *pcm_size = size;
+
+    struct sink_input *incoming = session->incoming;
+    if (incoming != NULL && incoming->state == SINK_INPUT_INCOMING) {
+        if (!session->fading && session->fifo_filled >= session->prebuffer) {
+            OS_LOGI(TAG, "Next track buffered, crossfade started");
+            session->fading = true;
+        }
+        if (session->fading)
+            return sink_session_write_mixed_locked(session, buffer, size, pcm, pcm_size);
+        return size;
+    }
+
+    int buffered = session->fifo_filled;
+    if (buffered == 0 && session->fade == NULL) {
+        sink_session_start_pending_locked(session);
+        return size;
+    }
+
+    // Pcm of a promoted input buffered before it took over goes first, fade in goes on if not finished
+    size -= size % sink_session_frame_size(session);
+    if (sink_session_reserve_mix_buffer(session, buffered + size) != ESP_OK)
+        return -1;
+    sink_session_fifo_pop_locked(session, session->mix_buffer, buffered);
+    memcpy(session->mix_buffer + buffered, buffer, size);
+    if (session->fade != NULL) {
+        crossfade_process(session->fade, NULL, session->mix_buffer, session->mix_buffer, buffered + size);
+        if (crossfade_is_done(session->fade)) {
+            crossfade_destroy(session->fade);
+            session->fade = NULL;
+        }
+    }
+    sink_session_start_pending_locked(session);
+
+    *pcm = session->mix_buffer;
+    *pcm_size = buffered + size;
+    return size;
+}
+
+static sink_handle_t sink_session_open(int samplerate, int channels, int bits, void *priv_data)
+{
+    sink_session_handle_t session = (sink_session_handle_t)priv_data;
+    if (session == NULL)
+        return NULL;
+
+    struct sink_input *input = audio_calloc(1, sizeof(struct sink_input));
+    AUDIO_MEM_CHECK(TAG, input, return NULL);
+    input->session = session;
+    input->samplerate = samplerate;
+    input->channels = channels;
+    input->bits = bits;
+
+    os_mutex_lock(session->write_lock);
+    os_mutex_lock(session->lock);
+
+    // Another track is playing: it becomes the outgoing one of a crossfade
+    if (session->crossfade_ms > 0 && session->primary != NULL && session->incoming == NULL &&
+        sink_session_open_incoming_locked(session, input) == ESP_OK)
+        goto open_out;
+
+    if (session->handle != NULL &&
+        (session->samplerate != samplerate || session->channels != channels || session->bits != bits)) {
+        OS_LOGI(TAG, "Format changed: rate:%d->%d, channels:%d->%d, bits:%d->%d, reconfiguring",
+                session->samplerate, samplerate, session->channels, channels, session->bits, bits);
+        sink_session_close_locked(session);
+    }
+
+    if (session->handle == NULL) {
+        session->handle = session->wrapper.open(samplerate, channels, bits, session->wrapper.priv_data);
+        if (session->handle == NULL) {
+            OS_LOGE(TAG, "Failed to open sink");
+            os_mutex_unlock(session->lock);
+            os_mutex_unlock(session->write_lock);
+            audio_free(input);
+            return NULL;
+        }
+        session->samplerate = samplerate;
+        session->channels = channels;
+        session->bits = bits;
+    } else {
+        OS_LOGD(TAG, "Reusing opened sink: rate:%d, channels:%d, bits:%d", samplerate, channels, bits);
+    }
+    input->state = SINK_INPUT_DIRECT;
+    if (session->primary == NULL)
+        session->primary = input;
+
+open_out:
+    input->next = session->inputs;
+    session->inputs = input;
+    session->users++;
+    os_mutex_unlock(session->lock);
+    os_mutex_unlock(session->write_lock);
+    return (sink_handle_t)input;
+}
+
+static int sink_session_write(sink_handle_t handle, char *buffer, int size)
+{
+    struct sink_input *input = (struct sink_input *)handle;
+    sink_session_handle_t session = input->session;
+
+    os_mutex_lock(session->lock);
+
+    int frame_size = input->channels * input->bits / 8;
+    while (input->state == SINK_INPUT_WAITING || input->state == SINK_INPUT_PENDING ||
+           (input->state == SINK_INPUT_INCOMING && session->fifo_size - session->fifo_filled < frame_size))
+        os_cond_wait(session->cond, session->lock);
+
+    if (input->state == SINK_INPUT_INCOMING) {
+        int bytes = session->fifo_size - session->fifo_filled;
+        if (bytes > size)
+            bytes = size;
+        bytes -= bytes % frame_size;
+        sink_session_fifo_push_locked(session, buffer, bytes);
+        os_mutex_unlock(session->lock);
+        return bytes;
+    }
+    if (input->state == SINK_INPUT_DROPPED) {
+        os_mutex_unlock(session->lock);
+        return size;
+    }
+    os_mutex_unlock(session->lock);
+
+    // Only this input's own writes drop it, so it is still direct once both locks are held.
+    // The device write runs outside lock, the incoming input keeps buffering meanwhile
+    os_mutex_lock(session->write_lock);
+    os_mutex_lock(session->lock);
+    char *pcm = buffer;
+    int pcm_size = size;
+    int ret = 0;
+    if (input == session->primary)
+        ret = sink_session_write_primary_locked(session, buffer, size, &pcm, &pcm_size);
+    os_mutex_unlock(session->lock);
+
+    if (ret >= 0) {
+        if (pcm == buffer)
+            ret = sink_session_device_write(session, buffer, size);
+        else if (sink_session_device_write_all(session, pcm, pcm_size) != ESP_OK)
+            ret = -1;
+    }
+    os_mutex_unlock(session->write_lock);
+    return ret;
+}
+
+// Underruns of the shared device, players diff it against the value at their open
+static int sink_session_xruns(sink_handle_t handle)
+{
+    struct sink_input *input = (struct sink_input *)handle;
+    sink_session_handle_t session = input->session;
+    if (session->wrapper.xruns == NULL)
+        return -1;
+    return __atomic_load_n(&session->xruns, __ATOMIC_RELAXED);
+}
+
+static void sink_session_release(sink_handle_t handle)
+{
+    struct sink_input *input = (struct sink_input *)handle;
+    sink_session_handle_t session = input->session;
+
+    // Promoting an input in another format reopens the device
+    os_mutex_lock(session->write_lock);
+    os_mutex_lock(session->lock);
+
+    struct sink_input **link = &session->inputs;
+    while (*link != NULL && *link != input)
+        link = &(*link)->next;
+    if (*link != NULL)
+        *link = input->next;
+
+    if (input == session->incoming) {
+        OS_LOGI(TAG, "Next track closed before crossfade finished");
+        session->incoming = NULL;
+        // Fifo and fade are the incoming input's only once it started buffering
+        if (input->state == SINK_INPUT_INCOMING)
+            sink_session_stop_fade_locked(session);
+    } else if (input == session->primary) {
+        if (session->incoming != NULL) {
+            OS_LOGI(TAG, "Outgoing track closed, next track takes over");
+            sink_session_promote_locked(session);
+        } else {
+            // Players overlapping without crossfade, the one left drives the device
+            session->primary = NULL;
+            for (struct sink_input *it = session->inputs; it != NULL; it = it->next) {
+                if (it->state == SINK_INPUT_DIRECT) {
+                    session->primary = it;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (session->users > 0)
+        session->users--;
+    os_cond_broadcast(session->cond);
+    os_mutex_unlock(session->lock);
+    os_mutex_unlock(session->write_lock);
+    audio_free(input);
+}
+
+sink_session_handle_t sink_session_create(struct sink_wrapper *wrapper)
+{
+    if (wrapper == NULL || wrapper->open == NULL || wrapper->write == NULL || wrapper->close == NULL)
+        return NULL;
+
+    sink_session_handle_t session = audio_calloc(1, sizeof(struct sink_session));
+    if (session == NULL)
+        return NULL;
+
+    session->lock = os_mutex_create();
+    session->cond = os_cond_create();
+    session->write_lock = os_mutex_create();
+    if (session->lock == NULL || session->cond == NULL || session->write_lock == NULL) {
+        if (session->lock != NULL)
+            os_mutex_destroy(session->lock);
+        if (session->cond != NULL)
+            os_cond_destroy(session->cond);
+        if (session->write_lock != NULL)
+            os_mutex_destroy(session->write_lock);
+        audio_free(session);
+        return NULL;
+    }
+    memcpy(&session->wrapper, wrapper, sizeof(struct sink_wrapper));
+    session->crossfade_curve = SINK_SESSION_FADE_EQUAL_POWER;
+    return session;
+}
+
+int sink_session_get_wrapper(sink_session_handle_t session, struct sink_wrapper *wrapper)
+{
+    if (session == NULL || wrapper == NULL)
+        return ESP_FAIL;
+
+    wrapper->priv_data = session;
+    wrapper->name = sink_session_name;
+    wrapper->open = sink_session_open;
+    wrapper->write = sink_session_write;
+    wrapper->close = sink_session_release;
+    wrapper->xruns = sink_session_xruns;
+    return ESP_OK;
+}
+
+int sink_session_set_crossfade(sink_session_handle_t session, int duration_ms, enum sink_session_fade_curve curve)
+{
+    if (session == NULL)
+        return ESP_FAIL;
+
+    if (duration_ms < 0)
+        duration_ms = 0;
+    else if (duration_ms > SINK_SESSION_CROSSFADE_MAX_MS)
+        duration_ms = SINK_SESSION_CROSSFADE_MAX_MS;
+
+    os_mutex_lock(session->lock);
+    session->crossfade_ms = duration_ms;
+    session->crossfade_curve = curve;
+    os_mutex_unlock(session->lock);
+
+    OS_LOGI(TAG, "Crossfade: %dms, curve:%s", duration_ms,
+            curve == SINK_SESSION_FADE_EQUAL_POWER ? "equal-power" : "linear");
+    return ESP_OK;
+}
+
+void sink_session_cancel_crossfade(sink_session_handle_t session)
+{
+    if (session == NULL)
+        return;
+    os_mutex_lock(session->lock);
+    if (session->incoming != NULL) {
+        OS_LOGI(TAG, "Crossfade cancelled, dropping next track");
+        if (session->incoming->state == SINK_INPUT_INCOMING)
+            sink_session_stop_fade_locked(session);
+        session->incoming->state = SINK_INPUT_DROPPED;
+        session->incoming = NULL;
+        os_cond_broadcast(session->cond);
+    }
+    os_mutex_unlock(session->lock);
+}
+
+void sink_session_close(sink_session_handle_t session)
+{
+    if (session == NULL)
+        return;
+    os_mutex_lock(session->write_lock);
+    os_mutex_lock(session->lock);
+    sink_session_close_locked(session);
+    os_mutex_unlock(session->lock);
+    os_mutex_unlock(session->write_lock);
+}
+
+void sink_session_destroy(sink_session_handle_t session)
+{
+    if (session == NULL)
+        return;
+    os_mutex_lock(session->lock);
+    int users = session->users;
+    os_mutex_unlock(session->lock);
+    if (users > 0)
+        OS_LOGW(TAG, "Destroying session still used by %d player(s)", users);
+    sink_session_close(session);
+    crossfade_destroy(session->fade);
+    audio_free(session->fifo);
+    audio_free(session->mix_buffer);
+    os_cond_destroy(session->cond);
+    os_mutex_destroy(session->lock);
+    os_mutex_destroy(session->write_lock);
+    audio_free(session);
+}
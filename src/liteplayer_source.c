@@ -500,13 +500,6 @@ static void *media_source_thread(void *arg)
 {
     struct media_source_priv *priv = (struct media_source_priv *)arg;
     enum media_source_state state = MEDIA_SOURCE_READ_FAILED;
-    char *buffer = NULL;
-
-    buffer = audio_malloc(DEFAULT_MEDIA_SOURCE_BUFFER_SIZE);
-    if (buffer == NULL) {
-        OS_LOGE(TAG, "Failed to allocate response buffer");
-        goto thread_exit;
-    }
 
     if (priv->info.source_handle == NULL) {
         priv->info.source_handle = priv->info.source_ops->open(priv->info.url,
@@ -517,10 +510,38 @@ static void *media_source_thread(void *arg)
         }
     }
 
-    int bytes_read = 0, bytes_written = 0;
+    char *span = NULL;
+    int span_size = 0, bytes_read = 0;
     int ret = 0;
     while (!priv->stop) {
-        bytes_read = priv->info.source_ops->read(priv->info.source_handle, buffer, DEFAULT_MEDIA_SOURCE_BUFFER_SIZE);
+        // Read straight into the free space of ringbuf, no bounce buffer. The lock only
+        // keeps us from acquiring after media_source_stop, ringbuf itself is lock-free
+        os_mutex_lock(priv->lock);
+        ret = RB_DONE;
+        if (!priv->stop)
+            ret = rb_acquire_write(priv->info.out_ringbuf, &span, DEFAULT_MEDIA_SOURCE_BUFFER_SIZE, AUDIO_MAX_DELAY);
+        os_mutex_unlock(priv->lock);
+
+        if (ret <= 0) {
+            if (ret == RB_DONE || ret == RB_ABORT || ret == RB_OK) {
+                OS_LOGD(TAG, "Media source write done");
+                state = MEDIA_SOURCE_WRITE_DONE;
+            } else {
+                OS_LOGD(TAG, "Media source write failed");
+                state = MEDIA_SOURCE_WRITE_FAILED;
+            }
+            goto thread_exit;
+        }
+        span_size = ret;
+
+        bytes_read = priv->info.source_ops->read(priv->info.source_handle, span, span_size);
+
+        // Always commit to hand the span back, even if nothing was read. No need to
+        // check stop here, media_source_stop marks ringbuf done and the data is dropped.
+        // If the ringbuf was reset meanwhile, the span's buffer was left to us and the
+        // commit frees it
+        ret = rb_commit_write(priv->info.out_ringbuf, span, bytes_read > 0 ? bytes_read : 0);
+
         if (bytes_read < 0) {
             OS_LOGE(TAG, "Media source read failed");
             state = MEDIA_SOURCE_READ_FAILED;
@@ -529,29 +550,15 @@ static void *media_source_thread(void *arg)
             OS_LOGD(TAG, "Media source read done");
             state = MEDIA_SOURCE_READ_DONE;
             goto thread_exit;
+        } else if (ret == RB_DONE || ret == RB_ABORT) {
+            OS_LOGD(TAG, "Media source write done");
+            state = MEDIA_SOURCE_WRITE_DONE;
+            goto thread_exit;
+        } else if (ret < 0) {
+            OS_LOGE(TAG, "Media source commit failed, ret=%d", ret);
+            state = MEDIA_SOURCE_WRITE_FAILED;
+            goto thread_exit;
         }
-
-        bytes_written = 0;
-        do {
-            os_mutex_lock(priv->lock);
-            if (!priv->stop)
-                ret = rb_write(priv->info.out_ringbuf, &buffer[bytes_written], bytes_read, AUDIO_MAX_DELAY);
-            os_mutex_unlock(priv->lock);
-
-            if (ret > 0) {
-                bytes_read -= ret;
-                bytes_written += ret;
-            } else {
-                if (ret == RB_DONE || ret == RB_ABORT || ret == RB_OK) {
-                    OS_LOGD(TAG, "Media source write done");
-                    state = MEDIA_SOURCE_WRITE_DONE;
-                } else {
-                    OS_LOGD(TAG, "Media source write failed");
-                    state = MEDIA_SOURCE_WRITE_FAILED;
-                }
-                goto thread_exit;
-            }
-        } while (!priv->stop && bytes_read > 0);
     }
 
 thread_exit:
@@ -559,8 +566,6 @@ thread_exit:
         priv->info.source_ops->close(priv->info.source_handle);
         priv->info.source_handle = NULL;
     }
-    if (buffer != NULL)
-        audio_free(buffer);
 
     {
         os_mutex_lock(priv->lock);
@@ -94,6 +94,14 @@ int ttsplayer_register_sink_wrapper(ttsplayer_handle_t handle, struct sink_wrapp
     return liteplayer_register_sink_wrapper(handle->player, wrapper);
 }
 
+int ttsplayer_set_sink_format(ttsplayer_handle_t handle, int samplerate, int channels, int bits,
+                              enum liteplayer_resample_quality quality)
+{
+    if (handle == NULL)
+        return -1;
+    return liteplayer_set_sink_format(handle->player, samplerate, channels, bits, quality);
+}
+
 int ttsplayer_register_state_listener(ttsplayer_handle_t handle, liteplayer_state_cb listener, void *listener_priv)
 {
     if (handle == NULL || listener == NULL)
@@ -216,7 +224,7 @@ static int tts_source_read(source_handle_t handle, char *buffer, int size)
         if (size > DEFAULT_TTS_HEADER_SIZE)
             size = DEFAULT_TTS_HEADER_SIZE;
         if (size > rb_bytes_filled(priv->ringbuf)) {
-            OS_LOGE(TAG, "Insufficient data to prepare player, recommend mp3/aac without id3v2 for tts source");
+            OS_LOGE(TAG, "Insufficient data to prepare player, recommend mp3/aac without id3v2 or ogg opus for tts source");
             return -1;
         }
     }
@@ -249,7 +257,7 @@ static int tts_source_seek(source_handle_t handle, long offset)
         return -1;
     }
     if (!priv->has_prepared && (offset - priv->tts_offset) > rb_bytes_filled(priv->ringbuf)) {
-        OS_LOGE(TAG, "Insufficient data to prepare player, recommend mp3/aac without id3v2 for tts source");
+        OS_LOGE(TAG, "Insufficient data to prepare player, recommend mp3/aac without id3v2 or ogg opus for tts source");
         return -1;
     }
     int bytes_discard = (int)(offset - priv->tts_offset);
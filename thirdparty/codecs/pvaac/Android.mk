@@ -2,7 +2,8 @@ LOCAL_PATH:= $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
-	analysis_sub_band.cpp \
+	aac_simd.cpp \
+ 	analysis_sub_band.cpp \
  	apply_ms_synt.cpp \
  	apply_tns.cpp \
  	buf_getbits.cpp \
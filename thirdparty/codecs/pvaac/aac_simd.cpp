@@ -0,0 +1,648 @@
+/* ------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+
+ Pathname: ./src/aac_simd.cpp
+ Funtions: aac_simd_kernels
+           aac_simd_detect
+           aac_simd_get_kernels
+           aac_simd_select
+
+------------------------------------------------------------------------------
+ FUNCTION DESCRIPTION
+
+ SSE2, AVX2 and NEON versions of fft_rx4_long() and of the SBR QMF window
+ loops, and the runtime selection between them.
+
+ The kernel bodies are in aac_simd_impl.h, written once against a small set
+ of vector primitives and included in one namespace per instruction set.
+ Coefficients with a stride in the C loops (FFT twiddles, QMF prototype
+ filters) are transposed once, on first use, so lanes load them linearly.
+
+------------------------------------------------------------------------------
+*/
+
+
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <atomic>
+
+#include "aac_simd.h"
+
+#if defined(AAC_USE_X86)
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#include <immintrin.h>
+#define AAC_USE_AVX2
+#endif
+#elif defined(AAC_USE_NEON)
+#include <arm_neon.h>
+#endif
+
+/* after the intrinsics, calc_sbr_synfilterbank.h defines N */
+#include "fft_rx4.h"
+#ifdef LITEPLAYER_CONFIG_AAC_PLUS
+#include "calc_sbr_synfilterbank.h"
+#include "qmf_filterbank_coeff.h"
+#endif
+
+/*----------------------------------------------------------------------------
+; DEFINES
+; Include all pre-processor statements here. Include conditional
+; compile variables also.
+----------------------------------------------------------------------------*/
+#define FFT_RX4_STAGES      3       /* stages with twiddles, the last one has none */
+#define FFT_RX4_TWIDDLES    64      /* butterflies per group of the first stage */
+
+#define SBR_WINDOW_LANES    32      /* 31 outputs, lane 31 is zero padding */
+#define SBR_SYN_TAPS        10
+#define SBR_ANA_TAPS        5
+
+/*----------------------------------------------------------------------------
+; LOCAL STORE/BUFFER/POINTER DEFINITIONS
+; Variable declaration - defined here and used outside this module
+----------------------------------------------------------------------------*/
+#if defined(AAC_USE_X86) || defined(AAC_USE_NEON)
+
+/*
+ *  W_256rx4 split per stage and per twiddle, j = 0 is unused. Each exp_jw
+ *  is stored as the two operands cmplx_mul32_by_16() multiplies with:
+ *  stage[s][2k] = high half << 16, stage[s][2k + 1] = low half << 16
+ */
+struct aac_fft_twiddle
+{
+    alignas(32) Int32 stage[FFT_RX4_STAGES][6][FFT_RX4_TWIDDLES];
+
+    aac_fft_twiddle()
+    {
+        const Int32 *pw = W_256rx4;
+        Int n2 = FFT_RX4_LONG >> 2;
+
+        for (Int s = 0; s < FFT_RX4_STAGES; s++, n2 >>= 2)
+        {
+            for (Int j = 0; j < FFT_RX4_TWIDDLES; j++)
+            {
+                for (Int k = 0; k < 3; k++)
+                {
+                    UInt32 exp_jw = (j > 0 && j < n2) ? (UInt32)pw[3 * (j - 1) + k] : 0;
+                    stage[s][2 * k][j]     = (Int32)(exp_jw & 0xFFFF0000);
+                    stage[s][2 * k + 1][j] = (Int32)(exp_jw << 16);
+                }
+            }
+            pw += 3 * (n2 - 1);
+        }
+    }
+};
+
+static const aac_fft_twiddle *fft_rx4_long_twiddle(void)
+{
+    static const aac_fft_twiddle twiddle;
+    return &twiddle;
+}
+
+#ifdef LITEPLAYER_CONFIG_AAC_PLUS
+
+/*
+ *  sbrDecoderFilterbankCoefficients as coef[tap][output], the high half of
+ *  every entry is the tap of the even V[] offsets, the low half the odd ones
+ */
+struct sbr_synthesis_transposed
+{
+    alignas(32) Int32 coef[SBR_SYN_TAPS][SBR_WINDOW_LANES];
+
+    sbr_synthesis_transposed()
+    {
+        for (Int n = 0; n < SBR_WINDOW_LANES; n++)
+        {
+            for (Int m = 0; m < SBR_SYN_TAPS / 2; m++)
+            {
+                Int32 c = (n < SBR_WINDOW_LANES - 1) ? sbrDecoderFilterbankCoefficients[5 * n + m] : 0;
+                coef[2 * m][n]     = c >> 16;
+                coef[2 * m + 1][n] = (Int16)c;
+            }
+        }
+    }
+};
+
+static const Int32 (*sbr_synthesis_coef(void))[SBR_WINDOW_LANES]
+{
+    static const sbr_synthesis_transposed window;
+    return window.coef;
+}
+
+/*
+ *  sbrDecoderFilterbankCoefficients_an_filt(_LC) as coef[tap][output]
+ */
+struct sbr_analysis_transposed
+{
+    alignas(32) Int32 coef[SBR_ANA_TAPS][SBR_WINDOW_LANES];
+
+    explicit sbr_analysis_transposed(const Int32 *C)
+    {
+        for (Int n = 0; n < SBR_WINDOW_LANES; n++)
+        {
+            for (Int m = 0; m < SBR_ANA_TAPS; m++)
+            {
+                coef[m][n] = (n < SBR_WINDOW_LANES - 1) ? C[5 * n + m] : 0;
+            }
+        }
+    }
+};
+
+static const Int32 (*sbr_analysis_coef(const Int32 *C))[SBR_WINDOW_LANES]
+{
+    static const sbr_analysis_transposed window_LC(sbrDecoderFilterbankCoefficients_an_filt_LC);
+    if (C == sbrDecoderFilterbankCoefficients_an_filt_LC)
+        return window_LC.coef;
+#ifdef LITEPLAYER_CONFIG_HQ_SBR
+    static const sbr_analysis_transposed window(sbrDecoderFilterbankCoefficients_an_filt);
+    if (C == sbrDecoderFilterbankCoefficients_an_filt)
+        return window.coef;
+#endif
+    return NULL;
+}
+
+/* saturate2() of calc_sbr_synfilterbank.cpp, outputs are 2 samples apart */
+static void sbr_synthesis_window_store(Int16 *timeSig, const Int32 *out1, const Int32 *out2)
+{
+    for (Int n = 0; n < SBR_WINDOW_LANES - 1; n++)
+    {
+        Int32 a = out1[n];
+        Int32 b = out2[n];
+
+        a -= (a >> 2);
+        a  = (a >> N);
+        if ((a >> 15) != (a >> 31))
+        {
+            a = ((a >> 31) ^ INT16_MAX);
+        }
+        timeSig[2 + 2 * n] = (Int16)a;
+
+        b -= (b >> 2);
+        b  = (b >> N);
+        if ((b >> 15) != (b >> 31))
+        {
+            b = ((b >> 31) ^ INT16_MAX);
+        }
+        timeSig[126 - 2 * n] = (Int16)b;
+    }
+}
+
+#endif /* LITEPLAYER_CONFIG_AAC_PLUS */
+
+#endif /* AAC_USE_X86 || AAC_USE_NEON */
+
+/*----------------------------------------------------------------------------
+; SSE2
+----------------------------------------------------------------------------*/
+#if defined(AAC_USE_X86)
+
+namespace aac_sse2
+{
+
+typedef __m128i vec;
+#define AAC_LANES 4
+
+static inline vec v_set1(Int32 x)
+{
+    return _mm_set1_epi32(x);
+}
+
+static inline vec v_load(const Int32 *p)
+{
+    return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline void v_store(Int32 *p, vec x)
+{
+    _mm_storeu_si128((__m128i *)p, x);
+}
+
+static inline void v_load2(const Int32 *p, vec *re, vec *im)
+{
+    __m128 a = _mm_castsi128_ps(v_load(p));
+    __m128 b = _mm_castsi128_ps(v_load(p + 4));
+    *re = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    *im = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+static inline void v_store2(Int32 *p, vec re, vec im)
+{
+    v_store(p,     _mm_unpacklo_epi32(re, im));
+    v_store(p + 4, _mm_unpackhi_epi32(re, im));
+}
+
+static inline vec v_load16(const Int16 *p)
+{
+    __m128i x = _mm_loadl_epi64((const __m128i *)p);
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+static inline vec v_load16_rev(const Int16 *p)
+{
+    __m128i x = _mm_shufflelo_epi16(_mm_loadl_epi64((const __m128i *)p), _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+static inline vec v_add(vec a, vec b) { return _mm_add_epi32(a, b); }
+static inline vec v_sub(vec a, vec b) { return _mm_sub_epi32(a, b); }
+static inline vec v_or(vec a, vec b)  { return _mm_or_si128(a, b); }
+static inline vec v_xor(vec a, vec b) { return _mm_xor_si128(a, b); }
+static inline vec v_shl1(vec a)       { return _mm_slli_epi32(a, 1); }
+static inline vec v_shl16(vec a)      { return _mm_slli_epi32(a, 16); }
+static inline vec v_sar31(vec a)      { return _mm_srai_epi32(a, 31); }
+
+/* Signed high word from the unsigned 32x32->64 product of SSE2 */
+static inline vec v_mulhi(vec a, vec b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    __m128i hi   = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+    hi = _mm_sub_epi32(hi, _mm_and_si128(_mm_srai_epi32(a, 31), b));
+    return _mm_sub_epi32(hi, _mm_and_si128(_mm_srai_epi32(b, 31), a));
+}
+
+/* Operands are sign extended Int16, the high half of b is cleared for madd */
+static inline vec v_mul16(vec a, vec b)
+{
+    return _mm_madd_epi16(a, _mm_and_si128(b, _mm_set1_epi32(0xFFFF)));
+}
+
+/*
+ *  a * b >> 16 split as (a_hi * b) + (a_lo * b >> 16), a_lo signed, which
+ *  only needs 16 bits multiplies; a_hi must fit Int16, true for the SBR
+ *  analysis windows (below 2^28)
+ */
+static inline vec v_mul32_by_16(vec a, vec b)
+{
+    __m128i a_lo = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    __m128i a_hi = _mm_srai_epi32(_mm_sub_epi32(a, a_lo), 16);
+    __m128i lo   = _mm_mulhi_epi16(a_lo, b);
+    return _mm_add_epi32(v_mul16(b, a_hi), _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16));
+}
+
+static inline vec v_first(vec a, vec b)
+{
+    return _mm_castps_si128(_mm_move_ss(_mm_castsi128_ps(b), _mm_castsi128_ps(a)));
+}
+
+static inline Int32 v_hor_or(vec a)
+{
+    a = _mm_or_si128(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+    a = _mm_or_si128(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(a);
+}
+
+static inline void v_transpose4(vec *a, vec *b, vec *c, vec *d)
+{
+    __m128i t0 = _mm_unpacklo_epi32(*a, *b);
+    __m128i t1 = _mm_unpacklo_epi32(*c, *d);
+    __m128i t2 = _mm_unpackhi_epi32(*a, *b);
+    __m128i t3 = _mm_unpackhi_epi32(*c, *d);
+    *a = _mm_unpacklo_epi64(t0, t1);
+    *b = _mm_unpackhi_epi64(t0, t1);
+    *c = _mm_unpacklo_epi64(t2, t3);
+    *d = _mm_unpackhi_epi64(t2, t3);
+}
+
+#include "aac_simd_impl.h"
+
+#undef AAC_LANES
+
+} /* namespace aac_sse2 */
+
+#endif /* AAC_USE_X86 */
+
+/*----------------------------------------------------------------------------
+; AVX2
+----------------------------------------------------------------------------*/
+#if defined(AAC_USE_AVX2)
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace aac_avx2
+{
+
+typedef __m256i vec;
+#define AAC_LANES 8
+#define AAC_NARROW aac_sse2
+
+static inline vec v_set1(Int32 x)
+{
+    return _mm256_set1_epi32(x);
+}
+
+static inline vec v_load(const Int32 *p)
+{
+    return _mm256_loadu_si256((const __m256i *)p);
+}
+
+static inline void v_store(Int32 *p, vec x)
+{
+    _mm256_storeu_si256((__m256i *)p, x);
+}
+
+static inline void v_load2(const Int32 *p, vec *re, vec *im)
+{
+    __m256 a = _mm256_castsi256_ps(v_load(p));
+    __m256 b = _mm256_castsi256_ps(v_load(p + 8));
+    /* shuffle_ps works per 128 bits, the 64 bits permute restores the order */
+    *re = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+    *im = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+static inline void v_store2(Int32 *p, vec re, vec im)
+{
+    __m256i lo = _mm256_unpacklo_epi32(re, im);
+    __m256i hi = _mm256_unpackhi_epi32(re, im);
+    v_store(p,     _mm256_permute2x128_si256(lo, hi, 0x20));
+    v_store(p + 8, _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+static inline vec v_rev(vec a)
+{
+    return _mm256_permutevar8x32_epi32(a, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+static inline vec v_load16(const Int16 *p)
+{
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+
+static inline vec v_load16_rev(const Int16 *p)
+{
+    return v_rev(v_load16(p));
+}
+
+static inline vec v_add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+static inline vec v_sub(vec a, vec b) { return _mm256_sub_epi32(a, b); }
+static inline vec v_or(vec a, vec b)  { return _mm256_or_si256(a, b); }
+static inline vec v_xor(vec a, vec b) { return _mm256_xor_si256(a, b); }
+static inline vec v_shl1(vec a)       { return _mm256_slli_epi32(a, 1); }
+static inline vec v_shl16(vec a)      { return _mm256_slli_epi32(a, 16); }
+static inline vec v_sar31(vec a)      { return _mm256_srai_epi32(a, 31); }
+
+static inline vec v_mulhi(vec a, vec b)
+{
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd  = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+static inline vec v_mul16(vec a, vec b)
+{
+    return _mm256_mullo_epi32(a, b);
+}
+
+static inline vec v_first(vec a, vec b)
+{
+    return _mm256_blend_epi32(b, a, 0x01);
+}
+
+static inline vec v_mul32_by_16(vec a, vec b)
+{
+    return v_mulhi(a, v_shl16(b));
+}
+
+#include "aac_simd_impl.h"
+
+#undef AAC_NARROW
+#undef AAC_LANES
+
+} /* namespace aac_avx2 */
+
+#pragma GCC pop_options
+
+#endif /* AAC_USE_AVX2 */
+
+/*----------------------------------------------------------------------------
+; NEON
+----------------------------------------------------------------------------*/
+#if defined(AAC_USE_NEON)
+
+namespace aac_neon
+{
+
+typedef int32x4_t vec;
+#define AAC_LANES 4
+
+static inline vec v_set1(Int32 x)
+{
+    return vdupq_n_s32(x);
+}
+
+static inline vec v_load(const Int32 *p)
+{
+    return vld1q_s32(p);
+}
+
+static inline void v_store(Int32 *p, vec x)
+{
+    vst1q_s32(p, x);
+}
+
+static inline void v_load2(const Int32 *p, vec *re, vec *im)
+{
+    int32x4x2_t x = vld2q_s32(p);
+    *re = x.val[0];
+    *im = x.val[1];
+}
+
+static inline void v_store2(Int32 *p, vec re, vec im)
+{
+    int32x4x2_t x;
+    x.val[0] = re;
+    x.val[1] = im;
+    vst2q_s32(p, x);
+}
+
+static inline vec v_load16(const Int16 *p)
+{
+    return vmovl_s16(vld1_s16(p));
+}
+
+static inline vec v_load16_rev(const Int16 *p)
+{
+    return vmovl_s16(vrev64_s16(vld1_s16(p)));
+}
+
+static inline vec v_add(vec a, vec b) { return vaddq_s32(a, b); }
+static inline vec v_sub(vec a, vec b) { return vsubq_s32(a, b); }
+static inline vec v_or(vec a, vec b)  { return vorrq_s32(a, b); }
+static inline vec v_xor(vec a, vec b) { return veorq_s32(a, b); }
+static inline vec v_shl1(vec a)       { return vshlq_n_s32(a, 1); }
+static inline vec v_shl16(vec a)      { return vshlq_n_s32(a, 16); }
+static inline vec v_sar31(vec a)      { return vshrq_n_s32(a, 31); }
+
+static inline vec v_mulhi(vec a, vec b)
+{
+    int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+    int64x2_t hi = vmull_high_s32(a, b);
+    return vcombine_s32(vshrn_n_s64(lo, 32), vshrn_n_s64(hi, 32));
+}
+
+static inline vec v_mul16(vec a, vec b)
+{
+    return vmulq_s32(a, b);
+}
+
+static inline vec v_first(vec a, vec b)
+{
+    return vsetq_lane_s32(vgetq_lane_s32(a, 0), b, 0);
+}
+
+static inline vec v_mul32_by_16(vec a, vec b)
+{
+    return v_mulhi(a, v_shl16(b));
+}
+
+static inline Int32 v_hor_or(vec a)
+{
+    return vgetq_lane_s32(a, 0) | vgetq_lane_s32(a, 1) | vgetq_lane_s32(a, 2) | vgetq_lane_s32(a, 3);
+}
+
+static inline void v_transpose4(vec *a, vec *b, vec *c, vec *d)
+{
+    int32x4x2_t ab = vtrnq_s32(*a, *b);
+    int32x4x2_t cd = vtrnq_s32(*c, *d);
+    *a = vcombine_s32(vget_low_s32(ab.val[0]),  vget_low_s32(cd.val[0]));
+    *b = vcombine_s32(vget_low_s32(ab.val[1]),  vget_low_s32(cd.val[1]));
+    *c = vcombine_s32(vget_high_s32(ab.val[0]), vget_high_s32(cd.val[0]));
+    *d = vcombine_s32(vget_high_s32(ab.val[1]), vget_high_s32(cd.val[1]));
+}
+
+#include "aac_simd_impl.h"
+
+#undef AAC_LANES
+
+} /* namespace aac_neon */
+
+#endif /* AAC_USE_NEON */
+
+/*----------------------------------------------------------------------------
+; KERNEL TABLES
+----------------------------------------------------------------------------*/
+#ifdef LITEPLAYER_CONFIG_AAC_PLUS
+#define AAC_SBR_KERNELS(ns) , ns::sbr_synthesis_window, ns::sbr_analysis_window
+#else
+#define AAC_SBR_KERNELS(ns)
+#endif
+
+static const aac_kernels aac_kernels_c =
+{
+    AAC_SIMD_NONE, "c",
+    fft_rx4_long
+#ifdef LITEPLAYER_CONFIG_AAC_PLUS
+    , calc_sbr_synfilterbank_window, calc_sbr_anafilterbank_window
+#endif
+};
+
+#if defined(AAC_USE_X86)
+static const aac_kernels aac_kernels_sse2 =
+{
+    AAC_SIMD_SSE2, "sse2",
+    aac_sse2::fft_rx4_long_simd AAC_SBR_KERNELS(aac_sse2)
+};
+#endif
+
+#if defined(AAC_USE_AVX2)
+static const aac_kernels aac_kernels_avx2 =
+{
+    AAC_SIMD_AVX2, "avx2",
+    aac_avx2::fft_rx4_long_simd AAC_SBR_KERNELS(aac_avx2)
+};
+#endif
+
+#if defined(AAC_USE_NEON)
+static const aac_kernels aac_kernels_neon =
+{
+    AAC_SIMD_NEON, "neon",
+    aac_neon::fft_rx4_long_simd AAC_SBR_KERNELS(aac_neon)
+};
+#endif
+
+/* Resolved on the first frame of any decoder, which may run on several threads */
+static std::atomic<const aac_kernels *> aac_kernels_active(NULL);
+
+/*----------------------------------------------------------------------------
+; FUNCTION CODE
+----------------------------------------------------------------------------*/
+
+e_aac_simd aac_simd_detect(void)
+{
+#if defined(AAC_USE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return AAC_SIMD_AVX2;
+#endif
+#if defined(AAC_USE_X86)
+    return AAC_SIMD_SSE2;
+#elif defined(AAC_USE_NEON)
+    return AAC_SIMD_NEON;
+#else
+    return AAC_SIMD_NONE;
+#endif
+}
+
+const aac_kernels *aac_simd_get_kernels(e_aac_simd level)
+{
+    switch (level)
+    {
+        case AAC_SIMD_NONE:
+            return &aac_kernels_c;
+#if defined(AAC_USE_X86)
+        case AAC_SIMD_SSE2:
+            return &aac_kernels_sse2;
+#endif
+#if defined(AAC_USE_AVX2)
+        case AAC_SIMD_AVX2:
+            return (aac_simd_detect() == AAC_SIMD_AVX2) ? &aac_kernels_avx2 : NULL;
+#endif
+#if defined(AAC_USE_NEON)
+        case AAC_SIMD_NEON:
+            return &aac_kernels_neon;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+Int aac_simd_select(e_aac_simd level)
+{
+    const aac_kernels *kernels = aac_simd_get_kernels(level);
+    if (kernels == NULL)
+        return -1;
+    aac_kernels_active.store(kernels, std::memory_order_release);
+    return 0;
+}
+
+const aac_kernels *aac_simd_kernels(void)
+{
+    const aac_kernels *kernels = aac_kernels_active.load(std::memory_order_acquire);
+    if (kernels == NULL)
+    {
+        /* Keep a level forced by aac_simd_select() meanwhile, else store the detected one */
+        const aac_kernels *detected = aac_simd_get_kernels(aac_simd_detect());
+        if (aac_kernels_active.compare_exchange_strong(kernels, detected, std::memory_order_acq_rel))
+            kernels = detected;
+    }
+    return kernels;
+}
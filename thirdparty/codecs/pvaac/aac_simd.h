@@ -0,0 +1,133 @@
+/* ------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+
+ Pathname: ./include/aac_simd.h
+
+------------------------------------------------------------------------------
+ INCLUDE DESCRIPTION
+
+ Runtime dispatch of the long block FFT and the SBR QMF window kernels.
+
+ SSE2 (x86), AVX2 (x86, detected at runtime) and NEON (AArch64) versions
+ are bit-exact with the C kernels: products are truncated per lane like
+ fxp_mul32_c_equivalent.h, and int32 sums only differ in order.
+
+ The PS hybrid filterbank and the IMDCT pre/post rotations stay scalar.
+ Measured on a mono HE-AAC v2 stream, hybrid analysis and synthesis take
+ 3.6% of the decode and the rotations 2%, most of the PS time is in
+ ps_decorrelate (19%). The rotations reach 6% on stereo HE-AAC.
+
+ test/aac_decode_test checks whole decodes are bit-exact at every level.
+
+ Define AAC_DISABLE_SIMD to build the C kernels only.
+
+------------------------------------------------------------------------------
+*/
+
+/*----------------------------------------------------------------------------
+; CONTINUE ONLY IF NOT ALREADY DEFINED
+----------------------------------------------------------------------------*/
+#ifndef AAC_SIMD_H
+#define AAC_SIMD_H
+
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+#include "pv_audio_type_defs.h"
+
+/*----------------------------------------------------------------------------
+; DEFINES
+; Include all pre-processor statements here.
+----------------------------------------------------------------------------*/
+#if !defined(AAC_DISABLE_SIMD) && \
+    !defined(PV_ARM_V5) && !defined(PV_ARM_V4) && !defined(PV_ARM_GCC_V5) && !defined(PV_ARM_GCC_V4)
+#if defined(__SSE2__) || defined(_M_X64)
+#define AAC_USE_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define AAC_USE_NEON
+#endif
+#endif
+
+/*----------------------------------------------------------------------------
+; ENUMERATED TYPEDEF'S
+----------------------------------------------------------------------------*/
+typedef enum
+{
+    AAC_SIMD_NONE = 0,
+    AAC_SIMD_SSE2,
+    AAC_SIMD_AVX2,
+    AAC_SIMD_NEON,
+    AAC_SIMD_LEVELS
+} e_aac_simd;
+
+/*----------------------------------------------------------------------------
+; STRUCTURES TYPEDEF'S
+----------------------------------------------------------------------------*/
+typedef struct
+{
+    e_aac_simd  level;
+    const char *name;
+
+    /* fft_rx4_long(), 256 points complex FFT of the long block IMDCT */
+    void (*fft_rx4_long)(Int32 Data[], Int32 *peak_value);
+
+#ifdef LITEPLAYER_CONFIG_AAC_PLUS
+    /* Loop of calc_sbr_synfilterbank(_LC), timeSig[2..62] and timeSig[66..126] */
+    void (*sbr_synthesis_window)(Int16 *timeSig, const Int16 V[1280]);
+
+    /* Loop of calc_sbr_anafilterbank(_LC), Y[1..31] and Y[33..63] */
+    void (*sbr_analysis_window)(Int32 *Y, const Int16 *X, const Int32 *C);
+#endif
+} aac_kernels;
+
+/*----------------------------------------------------------------------------
+; GLOBAL FUNCTION DEFINITIONS
+; Function Prototype declaration
+----------------------------------------------------------------------------*/
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Kernels of the best level supported by the cpu, resolved on first call */
+    const aac_kernels *aac_simd_kernels(void);
+
+    /* Best level supported by this build and cpu */
+    e_aac_simd aac_simd_detect(void);
+
+    /* Kernels of a given level, NULL if not supported, for tests and benchmarks */
+    const aac_kernels *aac_simd_get_kernels(e_aac_simd level);
+
+    /* Force the level used by the decoder, returns 0 on success */
+    Int aac_simd_select(e_aac_simd level);
+
+#ifdef LITEPLAYER_CONFIG_AAC_PLUS
+    void calc_sbr_synfilterbank_window(Int16 *timeSig, const Int16 V[1280]);
+
+    void calc_sbr_anafilterbank_window(Int32 *Y, const Int16 *X, const Int32 *C);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/*----------------------------------------------------------------------------
+; END
+----------------------------------------------------------------------------*/
+#endif  /* AAC_SIMD_H */
@@ -0,0 +1,278 @@
+/* ------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+
+ Pathname: ./include/aac_simd_impl.h
+
+------------------------------------------------------------------------------
+ INCLUDE DESCRIPTION
+
+ Kernel bodies shared by every instruction set, included by aac_simd.cpp
+ once per instruction set namespace, after the vector primitives:
+
+    vec, AAC_LANES              vector of AAC_LANES Int32
+    AAC_NARROW                  namespace of a 4 lanes instruction set, used
+                                by wider ones for the short last stages
+    v_set1                      all lanes set to a value
+    v_load, v_store             unaligned Int32 load and store
+    v_load2, v_store2           AAC_LANES interleaved complex <-> re, im vectors
+    v_load16, v_load16_rev      AAC_LANES Int16 sign extended, in memory order
+                                or reversed
+    v_add, v_sub, v_or, v_xor   per lane, wrapping
+    v_shl1, v_shl16, v_sar31    shifts by a constant
+    v_mulhi                     (Int32)(((int64_t)a * b) >> 32)
+    v_mul16                     a * b, both in the Int16 range
+    v_mul32_by_16               fxp_mul32_by_16(a, b), b in the Int16 range
+    v_first                     lane 0 of a, other lanes of b
+    v_hor_or                    OR of all lanes
+    v_transpose4                4x4 transpose, 4 lanes instruction sets only
+
+ There is no include guard on purpose.
+
+------------------------------------------------------------------------------
+*/
+
+/*
+ *  One radix-4 stage of fft_rx4_long() with n1 points per group, lanes are
+ *  consecutive butterflies j of a group, j = 0 has no twiddle and is taken
+ *  from the unscaled results
+ */
+static void fft_rx4_long_stage(Int32 Data[], Int n1, const Int32 (*tw)[FFT_RX4_TWIDDLES])
+{
+    const Int n2 = n1 >> 2;
+
+    for (Int i = 0; i < FFT_RX4_LONG; i += n1)
+    {
+        for (Int j = 0; j < n2; j += AAC_LANES)
+        {
+            Int32 *pData1 = &Data[(i + j) << 1];
+            Int32 *pData3 = pData1 + (n2 << 1);
+            Int32 *pData2 = pData1 + (n2 << 2);
+            Int32 *pData4 = pData3 + (n2 << 2);
+            vec a_re, a_im, b_re, b_im, c_re, c_im, d_re, d_im;
+
+            v_load2(pData1, &a_re, &a_im);
+            v_load2(pData3, &b_re, &b_im);
+            v_load2(pData2, &c_re, &c_im);
+            v_load2(pData4, &d_re, &d_im);
+
+            vec r1 = v_add(a_re, c_re);
+            vec r2 = v_sub(a_re, c_re);
+            vec r3 = v_add(b_re, d_re);
+            vec r4 = v_sub(b_re, d_re);
+            vec s1 = v_add(a_im, c_im);
+            vec s2 = v_sub(a_im, c_im);
+            vec t1 = v_add(b_im, d_im);
+            vec t2 = v_sub(b_im, d_im);
+
+            vec o_a_re = v_add(r1, r3);
+            vec o_a_im = v_add(s1, t1);
+
+            vec u_c_re = v_sub(r1, r3);
+            vec u_c_im = v_sub(s1, t1);
+            vec u_b_im = v_sub(s2, r4);
+            vec u_d_im = v_add(s2, r4);
+            vec u_b_re = v_add(r2, t2);
+            vec u_d_re = v_sub(r2, t2);
+
+            vec x, y, zero = v_set1(0);
+
+            x = v_shl1(u_c_im);
+            y = v_shl1(u_c_re);
+            vec o_c_im = v_add(v_mulhi(x, v_load(&tw[2][j])), v_mulhi(v_sub(zero, y), v_load(&tw[3][j])));
+            vec o_c_re = v_add(v_mulhi(y, v_load(&tw[2][j])), v_mulhi(x, v_load(&tw[3][j])));
+
+            x = v_shl1(u_b_im);
+            y = v_shl1(u_b_re);
+            vec o_b_im = v_add(v_mulhi(x, v_load(&tw[0][j])), v_mulhi(v_sub(zero, y), v_load(&tw[1][j])));
+            vec o_b_re = v_add(v_mulhi(y, v_load(&tw[0][j])), v_mulhi(x, v_load(&tw[1][j])));
+
+            x = v_shl1(u_d_im);
+            y = v_shl1(u_d_re);
+            vec o_d_im = v_add(v_mulhi(x, v_load(&tw[4][j])), v_mulhi(v_sub(zero, y), v_load(&tw[5][j])));
+            vec o_d_re = v_add(v_mulhi(y, v_load(&tw[4][j])), v_mulhi(x, v_load(&tw[5][j])));
+
+            if (j == 0)
+            {
+                o_b_re = v_first(u_b_re, o_b_re);
+                o_b_im = v_first(u_b_im, o_b_im);
+                o_c_re = v_first(u_c_re, o_c_re);
+                o_c_im = v_first(u_c_im, o_c_im);
+                o_d_re = v_first(u_d_re, o_d_re);
+                o_d_im = v_first(u_d_im, o_d_im);
+            }
+
+            v_store2(pData1, o_a_re, o_a_im);
+            v_store2(pData3, o_b_re, o_b_im);
+            v_store2(pData2, o_c_re, o_c_im);
+            v_store2(pData4, o_d_re, o_d_im);
+        }
+    }
+}
+
+#if AAC_LANES == 4
+
+/*
+ *  Last stage of fft_rx4_long(), radix-4 butterflies of 4 consecutive
+ *  points, lanes are consecutive butterflies
+ */
+static Int32 fft_rx4_long_last_stage(Int32 Data[])
+{
+    vec max = v_set1(0);
+
+    for (Int i = 0; i < FFT_RX4_LONG; i += 4 * AAC_LANES)
+    {
+        Int32 *pData = &Data[i << 1];
+        vec a_re = v_load(pData + 0);
+        vec a_im = v_load(pData + 8);
+        vec b_re = v_load(pData + 16);
+        vec b_im = v_load(pData + 24);
+        vec c_re = v_load(pData + 4);
+        vec c_im = v_load(pData + 12);
+        vec d_re = v_load(pData + 20);
+        vec d_im = v_load(pData + 28);
+
+        /* rows are butterflies of [a b] and [c d], one transpose each */
+        v_transpose4(&a_re, &a_im, &b_re, &b_im);
+        v_transpose4(&c_re, &c_im, &d_re, &d_im);
+
+        vec r1 = v_add(a_re, c_re);
+        vec r2 = v_sub(a_re, c_re);
+        vec t1 = v_add(b_re, d_re);
+        vec t2 = v_sub(b_re, d_re);
+        vec s1 = v_add(a_im, c_im);
+        vec s2 = v_sub(a_im, c_im);
+        vec u1 = v_add(b_im, d_im);
+        vec u2 = v_sub(b_im, d_im);
+
+        a_re = v_add(r1, t1);
+        c_re = v_sub(r1, t1);
+        d_im = v_add(s2, t2);
+        b_im = v_sub(s2, t2);
+        a_im = v_add(s1, u1);
+        c_im = v_sub(s1, u1);
+        d_re = v_sub(r2, u2);
+        b_re = v_add(r2, u2);
+
+        max = v_or(max, v_xor(v_sar31(a_re), a_re));
+        max = v_or(max, v_xor(v_sar31(a_im), a_im));
+        max = v_or(max, v_xor(v_sar31(b_re), b_re));
+        max = v_or(max, v_xor(v_sar31(b_im), b_im));
+        max = v_or(max, v_xor(v_sar31(c_re), c_re));
+        max = v_or(max, v_xor(v_sar31(c_im), c_im));
+        max = v_or(max, v_xor(v_sar31(d_re), d_re));
+        max = v_or(max, v_xor(v_sar31(d_im), d_im));
+
+        v_transpose4(&a_re, &a_im, &b_re, &b_im);
+        v_transpose4(&c_re, &c_im, &d_re, &d_im);
+
+        v_store(pData + 0,  a_re);
+        v_store(pData + 8,  a_im);
+        v_store(pData + 16, b_re);
+        v_store(pData + 24, b_im);
+        v_store(pData + 4,  c_re);
+        v_store(pData + 12, c_im);
+        v_store(pData + 20, d_re);
+        v_store(pData + 28, d_im);
+    }
+
+    return v_hor_or(max);
+}
+
+#endif /* AAC_LANES == 4 */
+
+static void fft_rx4_long_simd(Int32 Data[], Int32 *peak_value)
+{
+    const aac_fft_twiddle *tw = fft_rx4_long_twiddle();
+
+    fft_rx4_long_stage(Data, FFT_RX4_LONG,      tw->stage[0]);
+    fft_rx4_long_stage(Data, FFT_RX4_LONG >> 2, tw->stage[1]);
+#if AAC_LANES == 4
+    fft_rx4_long_stage(Data, FFT_RX4_LONG >> 4, tw->stage[2]);
+    *peak_value = fft_rx4_long_last_stage(Data);
+#else
+    AAC_NARROW::fft_rx4_long_stage(Data, FFT_RX4_LONG >> 4, tw->stage[2]);
+    *peak_value = AAC_NARROW::fft_rx4_long_last_stage(Data);
+#endif
+}
+
+#ifdef LITEPLAYER_CONFIG_AAC_PLUS
+
+static void sbr_synthesis_window(Int16 *timeSig, const Int16 V[1280])
+{
+    const Int32 (*coef)[SBR_WINDOW_LANES] = sbr_synthesis_coef();
+    static const Int V1_offset[SBR_SYN_TAPS] = { 1, 193, 257, 449, 513, 705, 769, 961, 1025, 1217 };
+    static const Int V2_offset[SBR_SYN_TAPS] = { 1279, 1087, 1023, 831, 767, 575, 511, 319, 255, 63 };
+    Int32 out1[SBR_WINDOW_LANES];
+    Int32 out2[SBR_WINDOW_LANES];
+
+    for (Int n = 0; n < SBR_WINDOW_LANES; n += AAC_LANES)
+    {
+        vec acc1 = v_set1(ROUND_SYNFIL);
+        vec acc2 = acc1;
+
+        for (Int m = 0; m < SBR_SYN_TAPS; m++)
+        {
+            vec c = v_load(&coef[m][n]);
+            acc1 = v_add(acc1, v_mul16(v_load16(&V[V1_offset[m] + n]), c));
+            acc2 = v_add(acc2, v_mul16(v_load16_rev(&V[V2_offset[m] - n - (AAC_LANES - 1)]), c));
+        }
+
+        v_store(&out1[n], acc1);
+        v_store(&out2[n], acc2);
+    }
+
+    sbr_synthesis_window_store(timeSig, out1, out2);
+}
+
+static void sbr_analysis_window(Int32 *Y, const Int16 *X, const Int32 *C)
+{
+    const Int32 (*coef)[SBR_WINDOW_LANES] = sbr_analysis_coef(C);
+    Int32 out1[SBR_WINDOW_LANES];
+    Int32 out2[SBR_WINDOW_LANES];
+
+    if (coef == NULL)
+    {
+        calc_sbr_anafilterbank_window(Y, X, C);
+        return;
+    }
+
+    for (Int n = 0; n < SBR_WINDOW_LANES; n += AAC_LANES)
+    {
+        vec acc1 = v_set1(0);
+        vec acc2 = acc1;
+
+        for (Int m = 0; m < SBR_ANA_TAPS; m++)
+        {
+            vec c = v_load(&coef[m][n]);
+            acc1 = v_add(acc1, v_mul32_by_16(c, v_load16_rev(&X[-1 - 64 * m - n - (AAC_LANES - 1)])));
+            acc2 = v_add(acc2, v_mul32_by_16(c, v_load16(&X[-319 + 64 * m + n])));
+        }
+
+        v_store(&out1[n], acc1);
+        v_store(&out2[n], acc2);
+    }
+
+    for (Int n = 0; n < SBR_WINDOW_LANES - 1; n++)
+    {
+        Y[1 + n]  = out1[n];
+        Y[63 - n] = out2[n];
+    }
+}
+
+#endif /* LITEPLAYER_CONFIG_AAC_PLUS */
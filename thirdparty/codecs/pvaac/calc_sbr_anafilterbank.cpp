@@ -91,6 +91,7 @@ Copyright (c) ISO/IEC 2002.
 #include    "analysis_sub_band.h"
 
 #include    "aac_mem_funcs.h"
+#include    "aac_simd.h"
 #include    "fxp_mul32.h"
 
 
@@ -131,119 +132,93 @@ Copyright (c) ISO/IEC 2002.
 ; FUNCTION CODE
 ----------------------------------------------------------------------------*/
 
-void calc_sbr_anafilterbank_LC(Int32 * Sr,
-                               Int16 * X,
-                               Int32 scratch_mem[][64],
-                               Int32 maxBand)
+/*
+ *  Window of Y[1..31] and Y[33..63], C version of aac_kernels::sbr_analysis_window
+ */
+void calc_sbr_anafilterbank_window(Int32 * Y,
+                                   const Int16 * X,
+                                   const Int32 * C)
 {
-
     Int i;
     Int32   *p_Y_1;
     Int32   *p_Y_2;
 
-    Int16 * pt_X_1;
-    Int16 * pt_X_2;
+    const Int32 * pt_C;
+    const Int16 * pt_X_1;
+    const Int16 * pt_X_2;
     Int32 realAccu1;
     Int32 realAccu2;
 
     Int32 tmp1;
     Int32 tmp2;
 
-
-    const Int32 * pt_C;
-
-    p_Y_1 = scratch_mem[0];
-
-
-    p_Y_2 = p_Y_1 + 63;
-    pt_C   = &sbrDecoderFilterbankCoefficients_an_filt_LC[0];
-
-    pt_X_1 = X;
-
-
-    realAccu1  =  fxp_mul32_by_16(Qfmt27(-0.51075594183097F),   pt_X_1[-192]);
-
-    realAccu1  =  fxp_mac32_by_16(Qfmt27(-0.51075594183097F), -pt_X_1[-128], realAccu1);
-    realAccu1  =  fxp_mac32_by_16(Qfmt27(-0.01876919066980F),  pt_X_1[-256], realAccu1);
-    *(p_Y_1++) =  fxp_mac32_by_16(Qfmt27(-0.01876919066980F), -pt_X_1[ -64], realAccu1);
-
-
-    /* create array Y */
+    p_Y_1 = Y + 1;
+    p_Y_2 = Y + 63;
+    pt_C  = C;
 
     pt_X_1 = &X[-1];
     pt_X_2 = &X[-319];
 
-
-    for (i = 15; i != 0; i--)
+    for (i = 31; i != 0; i--)
     {
         tmp1 = *(pt_X_1--);
         tmp2 = *(pt_X_2++);
-
         realAccu1  = fxp_mul32_by_16(*(pt_C), tmp1);
         realAccu2  = fxp_mul32_by_16(*(pt_C++), tmp2);
         tmp1 = pt_X_1[ -63];
-        tmp2 = pt_X_2[ +63];
+        tmp2 = pt_X_2[  63];
         realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
         realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
         tmp1 = pt_X_1[ -127];
-        tmp2 = pt_X_2[ +127];
+        tmp2 = pt_X_2[  127];
         realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
         realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
         tmp1 = pt_X_1[ -191];
-        tmp2 = pt_X_2[ +191];
+        tmp2 = pt_X_2[  191];
         realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
         realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
         tmp1 = pt_X_1[ -255];
-        tmp2 = pt_X_2[ +255];
+        tmp2 = pt_X_2[  255];
         *(p_Y_1++) = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
         *(p_Y_2--) = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
+    }
+}
 
-        tmp1 = *(pt_X_1--);
-        tmp2 = *(pt_X_2++);
-        realAccu1  = fxp_mul32_by_16(*(pt_C), tmp1);
-        realAccu2  = fxp_mul32_by_16(*(pt_C++), tmp2);
 
-        tmp1 = pt_X_1[ -63];
-        tmp2 = pt_X_2[ +63];
-        realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-        tmp1 = pt_X_1[ -127];
-        tmp2 = pt_X_2[ +127];
-        realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-        tmp1 = pt_X_1[ -191];
-        tmp2 = pt_X_2[ +191];
-        realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-        tmp1 = pt_X_1[ -255];
-        tmp2 = pt_X_2[ +255];
-        *(p_Y_1++) = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        *(p_Y_2--) = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
 
-    }
+void calc_sbr_anafilterbank_LC(Int32 * Sr,
+                               Int16 * X,
+                               Int32 scratch_mem[][64],
+                               Int32 maxBand)
+{
+
+    Int32   *p_Y_1;
+
+    Int16 * pt_X_1;
+    Int32 realAccu1;
+    Int32 realAccu2;
 
 
-    tmp1 = *(pt_X_1--);
-    tmp2 = *(pt_X_2++);
-    realAccu1  = fxp_mul32_by_16(*(pt_C), tmp1);
-    realAccu2  = fxp_mul32_by_16(*(pt_C++), tmp2);
-
-    tmp1 = pt_X_1[ -63];
-    tmp2 = pt_X_2[ +63];
-    realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-    realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-    tmp1 = pt_X_1[ -127];
-    tmp2 = pt_X_2[ +127];
-    realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-    realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-    tmp1 = pt_X_1[ -191];
-    tmp2 = pt_X_2[ +191];
-    realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-    realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-    tmp1 = pt_X_1[ -255];
-    tmp2 = pt_X_2[ +255];
-    *(p_Y_1++) = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-    *(p_Y_2--) = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
+    const Int32 * pt_C;
+
+    p_Y_1 = scratch_mem[0];
+
+    pt_C   = &sbrDecoderFilterbankCoefficients_an_filt_LC[0];
+
+    pt_X_1 = X;
+
+
+    realAccu1  =  fxp_mul32_by_16(Qfmt27(-0.51075594183097F),   pt_X_1[-192]);
+
+    realAccu1  =  fxp_mac32_by_16(Qfmt27(-0.51075594183097F), -pt_X_1[-128], realAccu1);
+    realAccu1  =  fxp_mac32_by_16(Qfmt27(-0.01876919066980F),  pt_X_1[-256], realAccu1);
+    *(p_Y_1++) =  fxp_mac32_by_16(Qfmt27(-0.01876919066980F), -pt_X_1[ -64], realAccu1);
+
+
+    /* create array Y */
+
+    aac_simd_kernels()->sbr_analysis_window(scratch_mem[0], X, pt_C);
+    p_Y_1 += 31;
 
 
     pt_X_1 = X;
@@ -273,27 +248,18 @@ void calc_sbr_anafilterbank(Int32 * Sr,
                             Int32 scratch_mem[][64],
                             Int32   maxBand)
 {
-    Int i;
     Int32   *p_Y_1;
-    Int32   *p_Y_2;
 
 
 
 
     const Int32 * pt_C;
-    Int16 * pt_X_1;
-    Int16 * pt_X_2;
     Int32 realAccu1;
     Int32 realAccu2;
 
-    Int32 tmp1;
-    Int32 tmp2;
-
 
     p_Y_1 = scratch_mem[0];
 
-
-    p_Y_2 = p_Y_1 + 63;
     pt_C   = &sbrDecoderFilterbankCoefficients_an_filt[0];
 
     realAccu1  =  fxp_mul32_by_16(Qfmt27(-0.36115899F),   X[-192]);
@@ -305,33 +271,8 @@ void calc_sbr_anafilterbank(Int32 * Sr,
 
     /* create array Y */
 
-    pt_X_1 = &X[-1];
-    pt_X_2 = &X[-319];
-
-
-    for (i = 31; i != 0; i--)
-    {
-        tmp1 = *(pt_X_1--);
-        tmp2 = *(pt_X_2++);
-        realAccu1  = fxp_mul32_by_16(*(pt_C), tmp1);
-        realAccu2  = fxp_mul32_by_16(*(pt_C++), tmp2);
-        tmp1 = pt_X_1[ -63];
-        tmp2 = pt_X_2[  63];
-        realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-        tmp1 = pt_X_1[ -127];
-        tmp2 = pt_X_2[  127];
-        realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-        tmp1 = pt_X_1[ -191];
-        tmp2 = pt_X_2[  191];
-        realAccu1  = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        realAccu2  = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-        tmp1 = pt_X_1[ -255];
-        tmp2 = pt_X_2[  255];
-        *(p_Y_1++) = fxp_mac32_by_16(*(pt_C), tmp1, realAccu1);
-        *(p_Y_2--) = fxp_mac32_by_16(*(pt_C++), tmp2, realAccu2);
-    }
+    aac_simd_kernels()->sbr_analysis_window(scratch_mem[0], X, pt_C);
+    p_Y_1 += 31;
 
 
     realAccu2  = fxp_mul32_by_16(Qfmt27(0.002620176F), X[ -32]);
@@ -88,6 +88,7 @@ Copyright (c) ISO/IEC 2002.
 #include    "synthesis_sub_band.h"
 #include    "fxp_mul32.h"
 #include    "aac_mem_funcs.h"
+#include    "aac_simd.h"
 
 /*----------------------------------------------------------------------------
 ; MACROS
@@ -231,6 +232,95 @@ __inline Int16 sat(Int32 y)
 ; FUNCTION CODE
 ----------------------------------------------------------------------------*/
 
+/*
+ *  Window of the 31 output pairs following timeSig[0] and timeSig[64],
+ *  C version of aac_kernels::sbr_synthesis_window
+ */
+void calc_sbr_synfilterbank_window(Int16 * timeSig,
+                                   const Int16 V[1280])
+{
+    Int32 i;
+
+    Int32   realAccu1;
+    Int32   realAccu2;
+    const Int32 *pt_C2;
+
+    const Int16 *pt_V1;
+    const Int16 *pt_V2;
+
+    Int16 *pt_timeSig;
+    Int16 *pt_timeSig_2;
+    Int32  test1;
+    Int16  tmp1;
+    Int16  tmp2;
+
+    pt_timeSig   = &timeSig[2];
+    pt_timeSig_2 = &timeSig[126];
+
+    pt_V1 = &V[1];
+    pt_V2 = &V[1279];
+
+    pt_C2 = &sbrDecoderFilterbankCoefficients[0];
+
+    for (i = 31; i != 0; i--)
+    {
+        test1 = *(pt_C2++);
+        tmp1 = *(pt_V1++);
+        tmp2 = *(pt_V2--);
+        realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, ROUND_SYNFIL);
+        realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, ROUND_SYNFIL);
+        tmp1 = pt_V1[  191];
+        tmp2 = pt_V2[ -191];
+        realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
+
+        test1 = *(pt_C2++);
+        tmp1 = pt_V1[  255];
+        tmp2 = pt_V2[ -255];
+        realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
+        tmp1 = pt_V1[  447];
+        tmp2 = pt_V2[ -447];
+        realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
+
+        test1 = *(pt_C2++);
+        tmp1 = pt_V1[  511];
+        tmp2 = pt_V2[ -511];
+        realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
+        tmp1 = pt_V1[  703];
+        tmp2 = pt_V2[ -703];
+        realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
+
+        test1 = *(pt_C2++);
+        tmp1 = pt_V1[  767];
+        tmp2 = pt_V2[ -767];
+        realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
+        tmp1 = pt_V1[  959];
+        tmp2 = pt_V2[ -959];
+        realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
+
+        test1 = *(pt_C2++);
+        tmp1 = pt_V1[  1023];
+        tmp2 = pt_V2[ -1023];
+        realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
+        tmp1 = pt_V1[  1215];
+        tmp2 = pt_V2[ -1215];
+        realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
+        realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
+
+        saturate2(realAccu1, realAccu2, pt_timeSig, pt_timeSig_2);
+
+    }
+}
+
+
+
 void calc_sbr_synfilterbank_LC(Int32 * Sr,
                                Int16 * timeSig,
                                Int16   V[1280],
@@ -249,7 +339,6 @@ void calc_sbr_synfilterbank_LC(Int32 * Sr,
     Int16 *pt_timeSig;
 
     Int16 *pt_timeSig_2;
-    Int32  test1;
     Int16  tmp1;
     Int16  tmp2;
 
@@ -312,68 +401,7 @@ void calc_sbr_synfilterbank_LC(Int32 * Sr,
 
         saturate2(realAccu1, realAccu2, pt_timeSig, pt_timeSig_2);
 
-        pt_timeSig_2 = &timeSig[126];
-
-        pt_V1 = &V[1];
-        pt_V2 = &V[1279];
-
-        pt_C2 = &sbrDecoderFilterbankCoefficients[0];
-
-        for (i = 31; i != 0; i--)
-        {
-            test1 = *(pt_C2++);
-            tmp1 = *(pt_V1++);
-            tmp2 = *(pt_V2--);
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, ROUND_SYNFIL);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, ROUND_SYNFIL);
-            tmp1 = pt_V1[  191];
-            tmp2 = pt_V2[ -191];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  255];
-            tmp2 = pt_V2[ -255];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  447];
-            tmp2 = pt_V2[ -447];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  511];
-            tmp2 = pt_V2[ -511];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  703];
-            tmp2 = pt_V2[ -703];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  767];
-            tmp2 = pt_V2[ -767];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  959];
-            tmp2 = pt_V2[ -959];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  1023];
-            tmp2 = pt_V2[ -1023];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  1215];
-            tmp2 = pt_V2[ -1215];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            saturate2(realAccu1, realAccu2, pt_timeSig, pt_timeSig_2);
-
-        }
+        aac_simd_kernels()->sbr_synthesis_window(timeSig, V);
     }
     else
     {
@@ -455,7 +483,6 @@ void calc_sbr_synfilterbank(Int32 * Sr,
     Int16 *pt_timeSig;
 
     Int16 *pt_timeSig_2;
-    Int32  test1;
     Int16  tmp1;
     Int16  tmp2;
 
@@ -510,67 +537,7 @@ void calc_sbr_synfilterbank(Int32 * Sr,
 
         saturate2(realAccu1, realAccu2, pt_timeSig, pt_timeSig_2);
 
-        pt_timeSig_2 = &timeSig[126];
-
-        pt_V1 = &V[1];
-        pt_V2 = &V[1279];
-
-        pt_C2 = &sbrDecoderFilterbankCoefficients[0];
-
-        for (i = 31; i != 0; i--)
-        {
-            test1 = *(pt_C2++);
-            tmp1 = *(pt_V1++);
-            tmp2 = *(pt_V2--);
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, ROUND_SYNFIL);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, ROUND_SYNFIL);
-            tmp1 = pt_V1[  191];
-            tmp2 = pt_V2[ -191];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  255];
-            tmp2 = pt_V2[ -255];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  447];
-            tmp2 = pt_V2[ -447];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  511];
-            tmp2 = pt_V2[ -511];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  703];
-            tmp2 = pt_V2[ -703];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  767];
-            tmp2 = pt_V2[ -767];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  959];
-            tmp2 = pt_V2[ -959];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            test1 = *(pt_C2++);
-            tmp1 = pt_V1[  1023];
-            tmp2 = pt_V2[ -1023];
-            realAccu1 =  fxp_mac_16_by_16_bt(tmp1 , test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bt(tmp2 , test1, realAccu2);
-            tmp1 = pt_V1[  1215];
-            tmp2 = pt_V2[ -1215];
-            realAccu1 =  fxp_mac_16_by_16_bb(tmp1, test1, realAccu1);
-            realAccu2 =  fxp_mac_16_by_16_bb(tmp2, test1, realAccu2);
-
-            saturate2(realAccu1, realAccu2, pt_timeSig, pt_timeSig_2);
-        }
+        aac_simd_kernels()->sbr_synthesis_window(timeSig, V);
 
     }
     else
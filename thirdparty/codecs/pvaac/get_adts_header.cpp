@@ -520,6 +520,16 @@ Int get_adts_header(
                     pVars->winmap, /* changed from pVars->pWinSeqInfo, */
                     pVars->SFBWidth128);
 
+            /*
+             *  Same default as an audio specific config, so the first frame
+             *  can tell implicit signalling with no sbr content
+             */
+            if (pVars->bno == 0)
+            {
+                pVars->mc_info.ExtendedAudioObjectType =
+                    (tMP4AudioObjectType)(pVars->prog_config.profile + 1);
+            }
+
         } /* if (status == SUCCESS) */
 
 
@@ -122,6 +122,7 @@
 #include "fft_rx4.h"
 #include "mix_radix_fft.h"
 #include "pv_normalize.h"
+#include "aac_simd.h"
 
 #include "fxp_mul32.h"
 
@@ -301,12 +302,12 @@ Int mix_radix_fft(
     }/* for i  */
 
 
-    fft_rx4_long(
+    aac_simd_kernels()->fft_rx4_long(
         Data,
         &max1);
 
 
-    fft_rx4_long(
+    aac_simd_kernels()->fft_rx4_long(
         &Data[FFT_RX4_LENGTH_FOR_LONG],
         &max2);
 
@@ -142,12 +142,6 @@ Int32 ps_allocate_decoder(SBRDECODER_DATA *self,
     Int32 status;
 
     Int32 *ptr1;
-    Int32 *ptr2;
-    Int32 *ptr3;
-    Int32 *ptr4;
-    Int32 *ptr5;
-    Int32 *ptr6;
-    Int32 *ptr7;
 
     const Int32 pHybridResolution[] = { HYBRID_8_CPLX,
                                         HYBRID_2_REAL,
@@ -163,28 +157,46 @@ Int32 ps_allocate_decoder(SBRDECODER_DATA *self,
 
     /*
      *  Reuse AAC+ HQ right channel, which is not used when PS is enabled
+     *
+     *  Pointer tables come first, while the buffer is still pointer aligned,
+     *  and take sizeof(Int32 *) / sizeof(Int32) words per entry; delay lines
+     *  follow back to back.
+     *  Whole allocation requires 1628 words (1831 with 64-bit pointers),
+     *  codecQmfBufferReal through codecQmfBufferImag has more than 2800 words
      */
-    ptr1 = (Int32 *)(self->SbrChannel[1].frameData.codecQmfBufferReal[0]);   /*  reuse un-used right channel QMF_FILTER Synthesis buffer */
+    ptr1 = (Int32 *)(self->SbrChannel[1].frameData.codecQmfBufferReal[0]);
 
-    ptr2 = (&ptr1[658]);  /*  reuse un-used right channel QMF_FILTER Synthesis buffer */
-    /* 1162 - 658 = 504
-     *            = NO_QMF_ALLPASS_CHANNELS*2 (Re&Im)*( 3 + 4 + 5) + ( 3 + 4 + 5)*2 (Re&Im)
-     */
+    h_ps_dec->aaRealDelayBufferQmf = (Int32 **)ptr1;
+    ptr1 += NO_QMF_ICC_CHANNELS * sizeof(Int32 *) / sizeof(Int32);
 
-    ptr3 = (&ptr1[1162]);  /*  reuse un-used right channel QMF_FILTER Synthesis buffer */
-    /* 1426 - 1162 = 264
-     *            = SUBQMF_GROUPS*2 (Re&Im)*( 3 + 4 + 5) + ( 3 + 4 + 5)*2 (Re&Im)
-     */
+    h_ps_dec->aaImagDelayBufferQmf = (Int32 **)ptr1;
+    ptr1 += NO_QMF_ICC_CHANNELS * sizeof(Int32 *) / sizeof(Int32);
+
+    h_ps_dec->aaRealDelayBufferSubQmf = (Int32 **)ptr1;
+    ptr1 += SUBQMF_GROUPS * sizeof(Int32 *) / sizeof(Int32);
 
-    ptr4 = (&ptr1[1426]);  /*  high freq generation buffers */
+    h_ps_dec->aaImagDelayBufferSubQmf = (Int32 **)ptr1;
+    ptr1 += SUBQMF_GROUPS * sizeof(Int32 *) / sizeof(Int32);
+
+    for (i = 0 ; i < NO_SERIAL_ALLPASS_LINKS ; i++) /*  NO_SERIAL_ALLPASS_LINKS == 3 */
+    {
+        h_ps_dec->aaaRealDelayRBufferSerQmf[i] = (Int32 **)ptr1;
+        ptr1 += aRevLinkDelaySer[i] * sizeof(Int32 *) / sizeof(Int32);
 
-    ptr5 = (&ptr1[1490]);  /*  high freq generation buffers */
+        h_ps_dec->aaaImagDelayRBufferSerQmf[i] = (Int32 **)ptr1;
+        ptr1 += aRevLinkDelaySer[i] * sizeof(Int32 *) / sizeof(Int32);
 
-    ptr6 = (&ptr1[1618]);  /*  high freq generation buffers */
+        h_ps_dec->aaaRealDelayRBufferSerSubQmf[i] = (Int32 **)ptr1;
+        ptr1 += aRevLinkDelaySer[i] * sizeof(Int32 *) / sizeof(Int32);
 
-    ptr7 = (&ptr1[1810]);  /*  high freq generation buffers */
+        h_ps_dec->aaaImagDelayRBufferSerSubQmf[i] = (Int32 **)ptr1;
+        ptr1 += aRevLinkDelaySer[i] * sizeof(Int32 *) / sizeof(Int32);
+    }
 
-    /*  whole allocation requires 1871 words, sbrQmfBufferImag has 1920 words */
+    status = ps_hybrid_filter_bank_allocation(&h_ps_dec->hHybrid,
+             NO_QMF_CHANNELS_IN_HYBRID,
+             pHybridResolution,
+             &ptr1);
 
 
     h_ps_dec->aPeakDecayFast =  ptr1;
@@ -196,12 +208,6 @@ Int32 ps_allocate_decoder(SBRDECODER_DATA *self,
     h_ps_dec->aPrevPeakDiff = ptr1;
     ptr1 += NO_BINS;
 
-
-
-    status = ps_hybrid_filter_bank_allocation(&h_ps_dec->hHybrid,
-             NO_QMF_CHANNELS_IN_HYBRID,
-             pHybridResolution,
-             &ptr1);
     h_ps_dec->mHybridRealLeft = ptr1;
     ptr1 += SUBQMF_GROUPS;
 
@@ -232,18 +238,6 @@ Int32 ps_allocate_decoder(SBRDECODER_DATA *self,
     }
 
 
-    h_ps_dec->aaRealDelayBufferQmf = (Int32 **)ptr6;
-    ptr6 += NO_QMF_ICC_CHANNELS * sizeof(Int32 *) / sizeof(Int32);
-
-    h_ps_dec->aaImagDelayBufferQmf = (Int32 **)ptr7;
-    ptr7 += NO_QMF_ICC_CHANNELS * sizeof(Int32 *) / sizeof(Int32);
-
-    h_ps_dec->aaRealDelayBufferSubQmf = (Int32 **)ptr1;
-    ptr1 += SUBQMF_GROUPS * sizeof(Int32 *) / sizeof(Int32);
-
-    h_ps_dec->aaImagDelayBufferSubQmf = (Int32 **)ptr1;
-    ptr1 += SUBQMF_GROUPS * sizeof(Int32 *) / sizeof(Int32);
-
     for (i = 0; i < NO_QMF_ICC_CHANNELS; i++)   /* 61 */
     {
         int delay;
@@ -251,30 +245,21 @@ Int32 ps_allocate_decoder(SBRDECODER_DATA *self,
         if (i < NO_QMF_ALLPASS_CHANNELS)    /* 20 */
         {
             delay = 2;
-            h_ps_dec->aaRealDelayBufferQmf[i] = (Int32 *)ptr4;
-            ptr4 += delay;
-
-            h_ps_dec->aaImagDelayBufferQmf[i] = (Int32 *)ptr5;
-            ptr5 += delay;
+        }
+        else if (i >= (NO_QMF_ALLPASS_CHANNELS + SHORT_DELAY_START))
+        {
+            delay = SHORT_DELAY;
         }
         else
         {
+            delay = LONG_DELAY;
+        }
 
-            if (i >= (NO_QMF_ALLPASS_CHANNELS + SHORT_DELAY_START))
-            {
-                delay = SHORT_DELAY;
-            }
-            else
-            {
-                delay = LONG_DELAY;
-            }
-
-            h_ps_dec->aaRealDelayBufferQmf[i] = (Int32 *)ptr1;
-            ptr1 += delay;
+        h_ps_dec->aaRealDelayBufferQmf[i] = (Int32 *)ptr1;
+        ptr1 += delay;
 
-            h_ps_dec->aaImagDelayBufferQmf[i] = (Int32 *)ptr1;
-            ptr1 += delay;
-        }
+        h_ps_dec->aaImagDelayBufferQmf[i] = (Int32 *)ptr1;
+        ptr1 += delay;
     }
 
     for (i = 0; i < SUBQMF_GROUPS; i++)
@@ -287,36 +272,24 @@ Int32 ps_allocate_decoder(SBRDECODER_DATA *self,
 
     }
 
-    for (i = 0 ; i < NO_SERIAL_ALLPASS_LINKS ; i++) /*  NO_SERIAL_ALLPASS_LINKS == 3 */
+    for (i = 0 ; i < NO_SERIAL_ALLPASS_LINKS ; i++)
     {
 
         h_ps_dec->aDelayRBufIndexSer[i] = 0;
 
-        h_ps_dec->aaaRealDelayRBufferSerQmf[i] = (Int32 **)ptr2;
-        ptr2 += aRevLinkDelaySer[i];
-
-        h_ps_dec->aaaImagDelayRBufferSerQmf[i] = (Int32 **)ptr2;
-        ptr2 += aRevLinkDelaySer[i];
-
-        h_ps_dec->aaaRealDelayRBufferSerSubQmf[i] = (Int32 **)ptr3;
-        ptr3 += aRevLinkDelaySer[i];
-
-        h_ps_dec->aaaImagDelayRBufferSerSubQmf[i] = (Int32 **)ptr3;
-        ptr3 += aRevLinkDelaySer[i];
-
         for (j = 0; j < aRevLinkDelaySer[i]; j++)
         {
-            h_ps_dec->aaaRealDelayRBufferSerQmf[i][j] = ptr2;
-            ptr2 += NO_QMF_ALLPASS_CHANNELS;    /* NO_QMF_ALLPASS_CHANNELS == 20 */
+            h_ps_dec->aaaRealDelayRBufferSerQmf[i][j] = ptr1;
+            ptr1 += NO_QMF_ALLPASS_CHANNELS;    /* NO_QMF_ALLPASS_CHANNELS == 20 */
 
-            h_ps_dec->aaaImagDelayRBufferSerQmf[i][j] = ptr2;
-            ptr2 += NO_QMF_ALLPASS_CHANNELS;
+            h_ps_dec->aaaImagDelayRBufferSerQmf[i][j] = ptr1;
+            ptr1 += NO_QMF_ALLPASS_CHANNELS;
 
-            h_ps_dec->aaaRealDelayRBufferSerSubQmf[i][j] = ptr3;
-            ptr3 += SUBQMF_GROUPS;
+            h_ps_dec->aaaRealDelayRBufferSerSubQmf[i][j] = ptr1;
+            ptr1 += SUBQMF_GROUPS;
 
-            h_ps_dec->aaaImagDelayRBufferSerSubQmf[i][j] = ptr3;
-            ptr3 += SUBQMF_GROUPS;
+            h_ps_dec->aaaImagDelayRBufferSerSubQmf[i][j] = ptr1;
+            ptr1 += SUBQMF_GROUPS;
 
         }
     }
@@ -148,6 +148,13 @@ Int32 ps_hybrid_filter_bank_allocation(HYBRID **phHybrid,
 
     ptr += sizeof(HYBRID) / sizeof(*ptr);
 
+    /* pointer tables before the Int32 arrays keep them pointer aligned */
+    hs->mQmfBufferReal = (Int32 **)ptr;
+    ptr += noBands * sizeof(ptr) / sizeof(*ptr);
+
+    hs->mQmfBufferImag = (Int32 **)ptr;
+    ptr += noBands * sizeof(ptr) / sizeof(*ptr);
+
     hs->pResolution = (Int32*)ptr;
 
     ptr += noBands * sizeof(Int32) / sizeof(*ptr);
@@ -173,12 +180,6 @@ Int32 ps_hybrid_filter_bank_allocation(HYBRID **phHybrid,
     hs->nQmfBands     = noBands;
     hs->qmfBufferMove = HYBRID_FILTER_LENGTH - 1;
 
-    hs->mQmfBufferReal = (Int32 **)ptr;
-    ptr += noBands * sizeof(ptr) / sizeof(*ptr);
-
-    hs->mQmfBufferImag = (Int32 **)ptr;
-    ptr += noBands * sizeof(ptr) / sizeof(*ptr);
-
     tmp = hs->qmfBufferMove;        /*  HYBRID_FILTER_LENGTH == 13 */
 
     for (i = 0; i < noBands; i++)
@@ -246,6 +246,23 @@ extern "C"
          * require the SBR and PS tools disabled
          */
         bool    aacPlusEnabled;
+
+        /*
+         * INPUT:
+         * Run SBR in downsampled mode: SBR is decoded as usual but only the
+         * lower half of the QMF bands is synthesized, so the output keeps the
+         * core AAC sampling rate and half the bandwidth. Set before calling
+         * PVMP4AudioDecoderInitLibrary, unused when aacPlusEnabled is off
+         */
+        bool    aacPlusDownSampledSbr;
+
+        /*
+         * INPUT:
+         * Ignore parametric stereo data, enhanced AAC+ streams are decoded as
+         * AAC+ mono with the low complexity (real valued) SBR. Set before
+         * calling PVMP4AudioDecoderInitLibrary
+         */
+        bool    aacPlusDisablePS;
         /*
          * INPUT:
          * (Currently not being used inside the AAC library.)
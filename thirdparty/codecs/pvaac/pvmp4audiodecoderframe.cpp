@@ -1157,6 +1157,13 @@ OSCL_EXPORT_REF Int PVMP4AudioDecodeFrame(
             {
                 if (sbrDec->outSampleRate == 0) /* do it only once (disregarding of signaling type) */
                 {
+                    if (pVars->aacPlusDownSampledSbr)
+                    {
+                        /*
+                         *  Same as a downsampled sbr stream, single rate synthesis
+                         */
+                        pVars->mc_info.bDownSampledSbr = true;
+                    }
                     sbr_open(samp_rate_info[pVars->mc_info.sampling_rate_idx].samp_rate,
                              sbrDec,
                              sbrDecoderData,
@@ -1372,8 +1379,9 @@ OSCL_EXPORT_REF Int PVMP4AudioDecodeFrame(
             if (pMC_Info->upsamplingFactor == 2)
             {
                 pExt->samplingRate *= pMC_Info->upsamplingFactor;
-                pExt->aacPlusUpsamplingFactor = pMC_Info->upsamplingFactor;
             }
+            /* config may have announced 2 before sbr was set to single rate */
+            pExt->aacPlusUpsamplingFactor = pMC_Info->upsamplingFactor;
 
 #endif
 
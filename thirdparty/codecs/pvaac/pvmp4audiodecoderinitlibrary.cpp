@@ -319,10 +319,14 @@ OSCL_EXPORT_REF Int PVMP4AudioDecoderInitLibrary(
     pExt->samplingRate = 0;
     pExt->aacPlusUpsamplingFactor = 1;  /*  Default for regular AAC */
     pVars->aacPlusEnabled = pExt->aacPlusEnabled;
+    pVars->aacPlusDownSampledSbr = pExt->aacPlusDownSampledSbr;
+    pVars->aacPlusDisablePS = pExt->aacPlusDisablePS;
 
 
 #if defined(LITEPLAYER_CONFIG_AAC_PLUS)
     pVars->sbrDecoderData.setStreamType = 1;        /* Enable Lock for AAC stream type setting  */
+    pVars->mc_info.upsamplingFactor = 1;            /* Adts and adif don't go through an audio config */
+    pVars->mc_info.bDownSampledSbr = false;
 #endif
 
     /*
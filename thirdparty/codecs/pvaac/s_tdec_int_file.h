@@ -147,6 +147,8 @@ extern "C"
         Int            status;  /* save the status */
 
         bool           aacPlusEnabled;
+        bool           aacPlusDownSampledSbr;
+        bool           aacPlusDisablePS;
         bool           aacConfigUtilityEnabled;
 
         Int            current_program;
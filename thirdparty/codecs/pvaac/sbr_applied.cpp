@@ -201,6 +201,11 @@ SBR_ERROR  sbr_applied(SBRDECODER_DATA * self,
 
             Int sbrEnablePS = self->hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->psDetected;
 
+            if (pVars->aacPlusDisablePS)
+            {
+                sbrEnablePS = 0;
+            }
+
             pVars->mc_info.psPresentFlag  = sbrEnablePS;
 
             if (sbrEnablePS)   /* Initialize PS arrays */
@@ -216,13 +221,14 @@ SBR_ERROR  sbr_applied(SBRDECODER_DATA * self,
                 /*
                  *  Do not downgrade stream type from eaac+, if it has been explicitly declared
                  */
-                if (pVars->mc_info.ExtendedAudioObjectType != MP4AUDIO_PS)
+                if (pVars->mc_info.ExtendedAudioObjectType != MP4AUDIO_PS ||
+                        pVars->aacPlusDisablePS)
                 {
                     pVars->mc_info.ExtendedAudioObjectType = MP4AUDIO_SBR;
 
-                    if (pVars->mc_info.nch > 1)
+                    if (pVars->mc_info.nch > 1 || pVars->aacPlusDisablePS)
                     {
-                        sbrDec->LC_aacP_DecoderFlag = ON;    /* Enable LC for stereo */
+                        sbrDec->LC_aacP_DecoderFlag = ON;    /* Enable LC for stereo, or when PS is ignored */
                     }
                     else
                     {
@@ -563,10 +563,10 @@ void sbr_dec(Int16 *inPcmData,
 
             pv_memmove(&scratch_mem[2][32 + j     ],
                        hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferReal[i],
-                       HYBRID_FILTER_LENGTH_m_1*sizeof(*hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferReal));
+                       HYBRID_FILTER_LENGTH_m_1*sizeof(**hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferReal));
             pv_memmove(&scratch_mem[2][32 + j + 44],
                        hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferImag[i],
-                       HYBRID_FILTER_LENGTH_m_1*sizeof(*hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferImag));
+                       HYBRID_FILTER_LENGTH_m_1*sizeof(**hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferImag));
             j += 88;
         }
 
@@ -630,11 +630,11 @@ void sbr_dec(Int16 *inPcmData,
         {
             pv_memmove(hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferReal[i],
                        &scratch_mem[2][ 64 + j     ],
-                       HYBRID_FILTER_LENGTH_m_1*sizeof(*hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferReal));
+                       HYBRID_FILTER_LENGTH_m_1*sizeof(**hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferReal));
 
             pv_memmove(hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferImag[i],
                        &scratch_mem[2][ 64 + j + 44],
-                       HYBRID_FILTER_LENGTH_m_1*sizeof(*hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferImag));
+                       HYBRID_FILTER_LENGTH_m_1*sizeof(**hLITEPLAYER_CONFIG_PARAMETRICSTEREODec->hHybrid->mQmfBufferImag));
 
             j += 88;
         }
@@ -0,0 +1,225 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Decodes a real stream (ADTS or MP4/M4A) through the pvaac API with the C
+// kernels, then with every SIMD level supported by this build and cpu, in
+// each decode mode of the player. Checks the PCM is bit-exact with the C
+// decode and prints us/frame, the best of [passes] decodes.
+//
+//   aac_decode_test <file.aac|file.m4a> [passes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "pvmp4audiodecoder_api.h"
+#include "aac_simd.h"
+#include "aacreader.h"
+
+#define DECODE_PASSES       3
+
+enum {
+    kInputBufferSize = 8192 + 16,   // largest ADTS frame, plus some read-ahead padding
+    kOutputBufferSize = 4096,       // 2048 frames of stereo for AAC+
+};
+
+static const char *level_names[AAC_SIMD_LEVELS] = { "c", "sse2", "avx2", "neon" };
+
+// Decode modes of the player, see aac_pvaac_wrapper.c
+static const struct {
+    const char *name;
+    bool aacPlusEnabled;
+    bool aacPlusDownSampledSbr;
+    bool aacPlusDisablePS;
+} modes[] = {
+    { "full",        true,  false, false },
+    { "ps-to-mono",  true,  false, true  },
+    { "downsampled", true,  true,  false },
+    { "core-only",   false, false, false },
+};
+
+struct decode_result {
+    std::vector<Int16> pcm;
+    int frames;
+    int errors;
+    int64_t ns;
+};
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static bool decode(AacReader *reader, int mode, decode_result *result)
+{
+    static UChar input[kInputBufferSize];
+    static Int16 output[kOutputBufferSize];
+    tPVMP4AudioDecoderExternal config;
+    const uint8_t *frame;
+    uint32_t size;
+
+    memset(&config, 0, sizeof(config));
+    config.outputFormat = OUTPUTFORMAT_16PCM_INTERLEAVED;
+    config.aacPlusEnabled = modes[mode].aacPlusEnabled;
+    config.aacPlusDownSampledSbr = modes[mode].aacPlusDownSampledSbr;
+    config.aacPlusDisablePS = modes[mode].aacPlusDisablePS;
+    config.desiredChannels = 2;
+
+    void *decoderBuf = malloc(PVMP4AudioDecoderGetMemRequirements());
+    if (decoderBuf == NULL)
+        return false;
+    if (PVMP4AudioDecoderInitLibrary(&config, decoderBuf) != MP4AUDEC_SUCCESS) {
+        free(decoderBuf);
+        return false;
+    }
+
+    const uint8_t *asc = reader->getConfig(&size);
+    if (asc != NULL) {
+        memcpy(input, asc, size);
+        config.pInputBuffer = input;
+        config.inputBufferCurrentLength = size;
+        config.inputBufferMaxLength = 0;
+        if (PVMP4AudioDecoderConfig(&config, decoderBuf) != MP4AUDEC_SUCCESS) {
+            free(decoderBuf);
+            return false;
+        }
+    }
+
+    result->pcm.clear();
+    result->pcm.reserve(reader->getNumFrames() * kOutputBufferSize);
+    result->frames = 0;
+    result->errors = 0;
+    result->ns = 0;
+
+    reader->rewind();
+    while (reader->getFrame(&frame, &size)) {
+        if (size > kInputBufferSize - 16) {
+            result->errors++;
+            continue;
+        }
+        memcpy(input, frame, size);
+        memset(&input[size], 0, 16);
+
+        config.pInputBuffer = input;
+        config.inputBufferCurrentLength = size;
+        config.inputBufferMaxLength = 0;
+        config.inputBufferUsedLength = 0;
+        config.remainderBits = 0;
+        config.pOutputBuffer = output;
+        config.pOutputBuffer_plus = &output[2048];
+        config.repositionFlag = false;
+
+        // only the decoder is timed, not the PCM copy
+        int64_t start = now_ns();
+        Int ret = PVMP4AudioDecodeFrame(&config, decoderBuf);
+        result->ns += now_ns() - start;
+
+        result->frames++;
+        if (ret != MP4AUDEC_SUCCESS) {
+            result->errors++;
+            continue;
+        }
+        int samples = config.frameLength * config.desiredChannels * config.aacPlusUpsamplingFactor;
+        result->pcm.insert(result->pcm.end(), output, output + samples);
+    }
+
+    free(decoderBuf);
+    return true;
+}
+
+// Best time of several passes, the PCM of the last one
+static bool decode_passes(AacReader *reader, int mode, int passes, decode_result *result)
+{
+    int64_t best = INT64_MAX;
+    for (int pass = 0; pass < passes; pass++) {
+        if (!decode(reader, mode, result))
+            return false;
+        if (result->ns < best)
+            best = result->ns;
+    }
+    result->ns = best;
+    return true;
+}
+
+static void print_result(int mode, const char *level, const decode_result *result,
+                         const decode_result *ref, const char *status)
+{
+    double us = result->frames > 0 ? (double)result->ns / 1000 / result->frames : 0;
+    double ref_us = ref->frames > 0 ? (double)ref->ns / 1000 / ref->frames : 0;
+    printf("%-11s %-5s %6d frames %4d errors %8.2f us/frame %5.2fx  %s\n",
+           modes[mode].name, level, result->frames, result->errors, us,
+           us > 0 ? ref_us / us : 0, status);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage %s <file.aac|file.m4a> [passes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int passes = argc > 2 ? atoi(argv[2]) : DECODE_PASSES;
+    if (passes < 1)
+        passes = 1;
+
+    AacReader reader;
+    if (!reader.init(argv[1])) {
+        fprintf(stderr, "Failed to read frames of %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    uint32_t ascSize;
+    printf("%s: %u frames, %s, detected level: %s\n", argv[1], reader.getNumFrames(),
+           reader.getConfig(&ascSize) != NULL ? "mp4" : "adts", level_names[aac_simd_detect()]);
+
+    int failed = 0;
+    for (int mode = 0; mode < (int)(sizeof(modes) / sizeof(modes[0])); mode++) {
+        decode_result ref, simd;
+
+        aac_simd_select(AAC_SIMD_NONE);
+        if (!decode_passes(&reader, mode, passes, &ref)) {
+            printf("%-11s c     decoder init failed\n", modes[mode].name);
+            failed++;
+            continue;
+        }
+        print_result(mode, "c", &ref, &ref, "reference");
+
+        for (int level = AAC_SIMD_NONE + 1; level < AAC_SIMD_LEVELS; level++) {
+            if (aac_simd_select((e_aac_simd)level) != 0)
+                continue;
+            if (!decode_passes(&reader, mode, passes, &simd)) {
+                printf("%-11s %-5s decoder init failed\n", modes[mode].name, level_names[level]);
+                failed++;
+                continue;
+            }
+
+            if (simd.errors != ref.errors || simd.pcm != ref.pcm) {
+                size_t i = 0;
+                while (i < simd.pcm.size() && i < ref.pcm.size() && simd.pcm[i] == ref.pcm[i])
+                    i++;
+                char status[64];
+                snprintf(status, sizeof(status), "MISMATCH at sample %zu", i);
+                print_result(mode, level_names[level], &simd, &ref, status);
+                failed++;
+                continue;
+            }
+            print_result(mode, level_names[level], &simd, &ref, "bit-exact with c");
+        }
+    }
+
+    aac_simd_select(aac_simd_detect());
+    return failed;
+}
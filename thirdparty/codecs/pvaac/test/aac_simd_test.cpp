@@ -0,0 +1,217 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks every SIMD kernel supported by this build and cpu is bit-exact with
+// the C kernel, then prints ns/call of every kernel at every level.
+//
+//   aac_simd_test [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "aac_simd.h"
+#include "fft_rx4.h"
+#include "qmf_filterbank_coeff.h"
+
+#define TEST_ROUNDS         2000
+#define BENCH_ITERATIONS    100000
+
+#define FFT_SIZE            (2 * FFT_RX4_LONG)
+#define SYN_SIZE            1280
+#define ANA_SIZE            320
+
+static const char *level_names[AAC_SIMD_LEVELS] = { "c", "sse2", "avx2", "neon" };
+
+static UInt32 rand_state = 0x12345678;
+
+static Int32 rand32()
+{
+    rand_state = rand_state * 1664525 + 1013904223;
+    return (Int32)rand_state;
+}
+
+// Random values within +/-2^bits, with edge values every few samples, kept
+// small enough that the C kernels never overflow a signed sum
+static void fill_random(Int32 *buf, Int count, Int bits)
+{
+    const Int32 limit = (Int32)1 << bits;
+    for (Int i = 0; i < count; i++) {
+        switch (rand32() & 15) {
+        case 0:  buf[i] = limit - 1; break;
+        case 1:  buf[i] = -limit;    break;
+        case 2:  buf[i] = 0;         break;
+        case 3:  buf[i] = -1;        break;
+        default: buf[i] = rand32() >> (31 - bits); break;
+        }
+    }
+}
+
+static void fill_random16(Int16 *buf, Int count)
+{
+    for (Int i = 0; i < count; i++) {
+        switch (rand32() & 15) {
+        case 0:  buf[i] = INT16_MAX; break;
+        case 1:  buf[i] = INT16_MIN; break;
+        case 2:  buf[i] = 0;         break;
+        default: buf[i] = (Int16)(rand32() >> 16); break;
+        }
+    }
+}
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int test_fft(const aac_kernels *ref, const aac_kernels *simd)
+{
+    Int32 data_ref[FFT_SIZE];
+    Int32 data_simd[FFT_SIZE];
+    Int32 peak_ref, peak_simd;
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        // 4 radix-4 stages grow the input by up to 2^8
+        fill_random(data_ref, FFT_SIZE, (round & 1) ? 22 : 16);
+        memcpy(data_simd, data_ref, sizeof(data_ref));
+        ref->fft_rx4_long(data_ref, &peak_ref);
+        simd->fft_rx4_long(data_simd, &peak_simd);
+        if (memcmp(data_ref, data_simd, sizeof(data_ref)) != 0 || peak_ref != peak_simd) {
+            printf("[%s] fft_rx4_long mismatch, round=%d\n", simd->name, round);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int test_synthesis(const aac_kernels *ref, const aac_kernels *simd)
+{
+    Int16 V[SYN_SIZE];
+    Int16 time_ref[128];
+    Int16 time_simd[128];
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        // full scale inputs saturate the output
+        fill_random16(V, SYN_SIZE);
+        if (round & 1) {
+            for (Int i = 0; i < SYN_SIZE; i++)
+                V[i] >>= 4;
+        }
+        memset(time_ref, 0, sizeof(time_ref));
+        memset(time_simd, 0, sizeof(time_simd));
+        ref->sbr_synthesis_window(time_ref, V);
+        simd->sbr_synthesis_window(time_simd, V);
+        if (memcmp(time_ref, time_simd, sizeof(time_ref)) != 0) {
+            printf("[%s] sbr_synthesis_window mismatch, round=%d\n", simd->name, round);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int test_analysis(const aac_kernels *ref, const aac_kernels *simd)
+{
+    static const Int32 *tables[2] = {
+        sbrDecoderFilterbankCoefficients_an_filt_LC,
+        sbrDecoderFilterbankCoefficients_an_filt,
+    };
+    Int16 X[ANA_SIZE];
+    Int32 Y_ref[64];
+    Int32 Y_simd[64];
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        const Int32 *C = tables[round & 1];
+        fill_random16(X, ANA_SIZE);
+        memset(Y_ref, 0, sizeof(Y_ref));
+        memset(Y_simd, 0, sizeof(Y_simd));
+        ref->sbr_analysis_window(Y_ref, &X[ANA_SIZE], C);
+        simd->sbr_analysis_window(Y_simd, &X[ANA_SIZE], C);
+        if (memcmp(Y_ref, Y_simd, sizeof(Y_ref)) != 0) {
+            printf("[%s] sbr_analysis_window mismatch, round=%d\n", simd->name, round);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void bench(const aac_kernels *kernels, int iterations)
+{
+    static Int32 data[FFT_SIZE];
+    static Int32 input[FFT_SIZE];
+    static Int16 V[SYN_SIZE];
+    static Int16 X[ANA_SIZE];
+    static Int16 timeSig[128];
+    static Int32 Y[64];
+    Int32 peak;
+    int64_t start;
+    double fft_ns, synthesis_ns, analysis_ns;
+
+    fill_random(input, FFT_SIZE, 16);
+    fill_random16(V, SYN_SIZE);
+    fill_random16(X, ANA_SIZE);
+
+    // the FFT grows its data, restart from the same input every call
+    start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        memcpy(data, input, sizeof(data));
+        kernels->fft_rx4_long(data, &peak);
+    }
+    fft_ns = (double)(now_ns() - start) / iterations;
+
+    start = now_ns();
+    for (int i = 0; i < iterations; i++)
+        kernels->sbr_synthesis_window(timeSig, V);
+    synthesis_ns = (double)(now_ns() - start) / iterations;
+
+    start = now_ns();
+    for (int i = 0; i < iterations; i++)
+        kernels->sbr_analysis_window(Y, &X[ANA_SIZE], sbrDecoderFilterbankCoefficients_an_filt);
+    analysis_ns = (double)(now_ns() - start) / iterations;
+
+    printf("%-6s fft_rx4_long %8.1f ns, sbr_synthesis_window %7.1f ns, sbr_analysis_window %7.1f ns\n",
+           kernels->name, fft_ns, synthesis_ns, analysis_ns);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : BENCH_ITERATIONS;
+    const aac_kernels *ref = aac_simd_get_kernels(AAC_SIMD_NONE);
+    int failed = 0;
+
+    printf("detected level: %s\n", level_names[aac_simd_detect()]);
+
+    for (int level = AAC_SIMD_NONE + 1; level < AAC_SIMD_LEVELS; level++) {
+        const aac_kernels *simd = aac_simd_get_kernels((e_aac_simd)level);
+        if (simd == NULL) {
+            printf("[%s] not supported, skipped\n", level_names[level]);
+            continue;
+        }
+        if (test_fft(ref, simd) != 0 || test_synthesis(ref, simd) != 0 || test_analysis(ref, simd) != 0) {
+            failed++;
+            continue;
+        }
+        printf("[%s] bit-exact with c\n", simd->name);
+    }
+
+    for (int level = AAC_SIMD_NONE; level < AAC_SIMD_LEVELS && iterations > 0; level++) {
+        const aac_kernels *kernels = aac_simd_get_kernels((e_aac_simd)level);
+        if (kernels != NULL)
+            bench(kernels, iterations);
+    }
+
+    return failed;
+}
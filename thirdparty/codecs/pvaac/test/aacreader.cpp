@@ -0,0 +1,295 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "aacreader.h"
+
+static uint32_t read_u16(const uint8_t *p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+static uint32_t read_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static uint64_t read_u64(const uint8_t *p)
+{
+    return ((uint64_t)read_u32(p) << 32) | read_u32(&p[4]);
+}
+
+// Steps over the box at *pos, returns its type and body
+static bool next_box(const uint8_t *data, uint32_t size, uint32_t *pos,
+                     const uint8_t **body, uint32_t *bodySize, const uint8_t **type)
+{
+    if (*pos + 8 > size)
+        return false;
+
+    const uint8_t *box = &data[*pos];
+    uint64_t boxSize = read_u32(box);
+    uint32_t header = 8;
+    if (boxSize == 1) {
+        if (*pos + 16 > size)
+            return false;
+        boxSize = read_u64(&box[8]);
+        header = 16;
+    } else if (boxSize == 0) {
+        boxSize = size - *pos;
+    }
+    if (boxSize < header || boxSize > size - *pos)
+        return false;
+
+    *type = &box[4];
+    *body = &box[header];
+    *bodySize = (uint32_t)boxSize - header;
+    *pos += (uint32_t)boxSize;
+    return true;
+}
+
+static const uint8_t *find_box(const uint8_t *data, uint32_t size, const char *type, uint32_t *bodySize)
+{
+    const uint8_t *body, *boxType;
+    uint32_t pos = 0;
+    while (next_box(data, size, &pos, &body, bodySize, &boxType)) {
+        if (memcmp(boxType, type, 4) == 0)
+            return body;
+    }
+    return NULL;
+}
+
+static bool read_descriptor(const uint8_t *data, uint32_t size, uint32_t *pos, uint8_t *tag, uint32_t *length)
+{
+    if (*pos >= size)
+        return false;
+    *tag = data[(*pos)++];
+
+    *length = 0;
+    for (int i = 0; i < 4; i++) {
+        if (*pos >= size)
+            return false;
+        uint8_t byte = data[(*pos)++];
+        *length = (*length << 7) | (byte & 0x7f);
+        if ((byte & 0x80) == 0)
+            break;
+    }
+    return *length <= size - *pos;
+}
+
+// ES_Descriptor > DecoderConfigDescriptor > DecoderSpecificInfo (AudioSpecificConfig)
+static bool parse_esds(const uint8_t *esds, uint32_t size, std::vector<uint8_t> &config)
+{
+    uint32_t pos = 4;   // version and flags
+    uint32_t length;
+    uint8_t tag;
+
+    if (!read_descriptor(esds, size, &pos, &tag, &length) || tag != 0x03 || length < 3)
+        return false;
+    uint8_t flags = esds[pos + 2];
+    pos += 3;
+    if (flags & 0x80)
+        pos += 2;   // dependsOn_ES_ID
+    if ((flags & 0x40) && pos < size)
+        pos += 1 + esds[pos];   // URL
+    if (flags & 0x20)
+        pos += 2;   // OCR_ES_Id
+
+    if (!read_descriptor(esds, size, &pos, &tag, &length) || tag != 0x04 || length < 13)
+        return false;
+    pos += 13;
+
+    if (!read_descriptor(esds, size, &pos, &tag, &length) || tag != 0x05 || length == 0)
+        return false;
+    config.assign(&esds[pos], &esds[pos + length]);
+    return true;
+}
+
+AacReader::AacReader()
+    : mFrameIndex(0)
+{
+}
+
+AacReader::~AacReader()
+{
+    close();
+}
+
+bool AacReader::init(const char *file)
+{
+    FILE *fp = fopen(file, "rb");
+    if (fp == NULL)
+        return false;
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size > 0) {
+        mData.resize(size);
+        if (fread(&mData[0], 1, size, fp) != (size_t)size)
+            mData.clear();
+    }
+    fclose(fp);
+    if (mData.size() < 8)
+        return false;
+
+    mFrameIndex = 0;
+    if (memcmp(&mData[4], "ftyp", 4) == 0)
+        return parseMp4();
+    return parseAdts();
+}
+
+const uint8_t *AacReader::getConfig(uint32_t *size)
+{
+    if (mConfig.empty())
+        return NULL;
+    *size = mConfig.size();
+    return &mConfig[0];
+}
+
+bool AacReader::getFrame(const uint8_t **frame, uint32_t *size)
+{
+    if (mFrameIndex >= mFrameOffsets.size())
+        return false;
+    *frame = &mData[mFrameOffsets[mFrameIndex]];
+    *size = mFrameSizes[mFrameIndex];
+    mFrameIndex++;
+    return true;
+}
+
+void AacReader::close()
+{
+    mData.clear();
+    mConfig.clear();
+    mFrameOffsets.clear();
+    mFrameSizes.clear();
+    mFrameIndex = 0;
+}
+
+bool AacReader::parseAdts()
+{
+    const uint8_t *data = &mData[0];
+    uint32_t size = mData.size();
+    uint32_t pos = 0;
+
+    // skip an ID3v2 tag, its size is syncsafe
+    if (size >= 10 && memcmp(data, "ID3", 3) == 0) {
+        pos = 10 + ((data[6] & 0x7f) << 21 | (data[7] & 0x7f) << 14 |
+                    (data[8] & 0x7f) << 7 | (data[9] & 0x7f));
+    }
+
+    while (pos + 7 <= size) {
+        const uint8_t *header = &data[pos];
+        if (header[0] != 0xff || (header[1] & 0xf6) != 0xf0)
+            break;
+        uint32_t frameSize = ((header[3] & 0x03) << 11) | (header[4] << 3) | (header[5] >> 5);
+        if (frameSize < 7 || frameSize > size - pos)
+            break;
+        mFrameOffsets.push_back(pos);
+        mFrameSizes.push_back(frameSize);
+        pos += frameSize;
+    }
+    return !mFrameOffsets.empty();
+}
+
+bool AacReader::parseMp4()
+{
+    const uint8_t *body, *type;
+    uint32_t moovSize, bodySize;
+    uint32_t pos = 0;
+
+    const uint8_t *moov = find_box(&mData[0], mData.size(), "moov", &moovSize);
+    if (moov == NULL)
+        return false;
+
+    while (next_box(moov, moovSize, &pos, &body, &bodySize, &type)) {
+        if (memcmp(type, "trak", 4) == 0 && parseTrack(body, bodySize))
+            return true;
+    }
+    return false;
+}
+
+bool AacReader::parseTrack(const uint8_t *trak, uint32_t size)
+{
+    uint32_t mdiaSize, hdlrSize, minfSize, stblSize;
+    uint32_t stsdSize, mp4aSize, esdsSize, stszSize, stscSize, stcoSize;
+    bool co64 = false;
+
+    const uint8_t *mdia = find_box(trak, size, "mdia", &mdiaSize);
+    if (mdia == NULL)
+        return false;
+    const uint8_t *hdlr = find_box(mdia, mdiaSize, "hdlr", &hdlrSize);
+    if (hdlr == NULL || hdlrSize < 12 || memcmp(&hdlr[8], "soun", 4) != 0)
+        return false;
+    const uint8_t *minf = find_box(mdia, mdiaSize, "minf", &minfSize);
+    if (minf == NULL)
+        return false;
+    const uint8_t *stbl = find_box(minf, minfSize, "stbl", &stblSize);
+    if (stbl == NULL)
+        return false;
+
+    // sample entry, version 1 and 2 (QuickTime) have 16 and 36 more bytes
+    const uint8_t *stsd = find_box(stbl, stblSize, "stsd", &stsdSize);
+    if (stsd == NULL || stsdSize < 8)
+        return false;
+    const uint8_t *mp4a = find_box(&stsd[8], stsdSize - 8, "mp4a", &mp4aSize);
+    if (mp4a == NULL || mp4aSize < 28)
+        return false;
+    uint32_t version = read_u16(&mp4a[8]);
+    uint32_t entrySize = 28 + (version == 1 ? 16 : version == 2 ? 36 : 0);
+    if (mp4aSize < entrySize)
+        return false;
+    const uint8_t *esds = find_box(&mp4a[entrySize], mp4aSize - entrySize, "esds", &esdsSize);
+    if (esds == NULL || !parse_esds(esds, esdsSize, mConfig))
+        return false;
+
+    const uint8_t *stsz = find_box(stbl, stblSize, "stsz", &stszSize);
+    const uint8_t *stsc = find_box(stbl, stblSize, "stsc", &stscSize);
+    const uint8_t *stco = find_box(stbl, stblSize, "stco", &stcoSize);
+    if (stco == NULL) {
+        stco = find_box(stbl, stblSize, "co64", &stcoSize);
+        co64 = true;
+    }
+    if (stsz == NULL || stszSize < 12 || stsc == NULL || stscSize < 8 || stco == NULL || stcoSize < 8)
+        return false;
+
+    uint32_t sampleSize = read_u32(&stsz[4]);
+    uint32_t sampleCount = read_u32(&stsz[8]);
+    uint32_t stscCount = read_u32(&stsc[4]);
+    uint32_t chunkCount = read_u32(&stco[4]);
+    if ((sampleSize == 0 && (stszSize - 12) / 4 < sampleCount) ||
+        stscCount == 0 || (stscSize - 8) / 12 < stscCount ||
+        (stcoSize - 8) / (co64 ? 8 : 4) < chunkCount)
+        return false;
+
+    // stsc runs are sorted by their 1-based first chunk
+    uint32_t sample = 0, entry = 0;
+    for (uint32_t chunk = 0; chunk < chunkCount && sample < sampleCount; chunk++) {
+        while (entry + 1 < stscCount && read_u32(&stsc[8 + (entry + 1) * 12]) <= chunk + 1)
+            entry++;
+        uint32_t samplesPerChunk = read_u32(&stsc[8 + entry * 12 + 4]);
+        uint64_t offset = co64 ? read_u64(&stco[8 + chunk * 8]) : read_u32(&stco[8 + chunk * 4]);
+
+        for (uint32_t i = 0; i < samplesPerChunk && sample < sampleCount; i++, sample++) {
+            uint32_t frameSize = sampleSize != 0 ? sampleSize : read_u32(&stsz[12 + sample * 4]);
+            if (offset + frameSize > mData.size())
+                return false;
+            mFrameOffsets.push_back((uint32_t)offset);
+            mFrameSizes.push_back(frameSize);
+            offset += frameSize;
+        }
+    }
+    return !mFrameOffsets.empty();
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AACREADER_H_
+#define AACREADER_H_
+
+#include <stdint.h>
+#include <vector>
+
+// Frames of an ADTS stream, or of the first AAC track of an MP4/M4A file.
+// The whole file is loaded, frames are returned in decoding order.
+class AacReader {
+public:
+    AacReader();
+    bool init(const char *file);
+    // AudioSpecificConfig of the MP4 track, NULL for ADTS
+    const uint8_t *getConfig(uint32_t *size);
+    // ADTS frames keep their header, MP4 frames are raw access units
+    bool getFrame(const uint8_t **frame, uint32_t *size);
+    uint32_t getNumFrames() { return mFrameOffsets.size(); }
+    void rewind() { mFrameIndex = 0; }
+    void close();
+    ~AacReader();
+private:
+    bool parseAdts();
+    bool parseMp4();
+    bool parseTrack(const uint8_t *trak, uint32_t size);
+
+    std::vector<uint8_t>  mData;
+    std::vector<uint8_t>  mConfig;
+    std::vector<uint32_t> mFrameOffsets;
+    std::vector<uint32_t> mFrameSizes;
+    uint32_t mFrameIndex;
+};
+
+#endif /* AACREADER_H_ */
@@ -94,6 +94,7 @@ Input
 
 #include "pvmp3_alias_reduction.h"
 #include "pv_mp3dec_fxd_op.h"
+#include "pvmp3_simd.h"
 
 
 /*----------------------------------------------------------------------------
@@ -154,10 +155,11 @@ const int32 c_alias [ NUM_BUTTERFLIES ] =
 ; FUNCTION CODE
 ----------------------------------------------------------------------------*/
 
-void pvmp3_alias_reduction(int32 *input_buffer,         /* Ptr to spec values of current channel */
-                           granuleInfo *gr_info,
-                           int32  *used_freq_lines,
-                           mp3Header *info)
+/*
+ *  NUM_BUTTERFLIES (=8) butterflies across each of the first sblim sub-band
+ *  boundaries, C version of pvmp3_kernels::alias_butterflies
+ */
+void pvmp3_alias_butterflies(int32 *input_buffer, int32 sblim, const int32 *csi, const int32 *csa)
 {
     int32 *ptr1;
     int32 *ptr2;
@@ -165,40 +167,13 @@ void pvmp3_alias_reduction(int32 *input_buffer,         /* Ptr to spec values of
     int32 *ptr4;
     const int32 *ptr_csi;
     const int32 *ptr_csa;
-    int32  sblim;
 
     int32 i, j;
 
-    *used_freq_lines = fxp_mul32_Q32(*used_freq_lines << 16, (int32)(0x7FFFFFFF / (float)18 - 1.0f)) >> 15;
-
-
-    if (gr_info->window_switching_flag &&  gr_info->block_type == 2)
-    {
-        if (gr_info->mixed_block_flag)
-        {
-            sblim = ((info->version_x == MPEG_2_5) && (info->sampling_frequency == 2)) ? 3 : 1;
-        }
-        else
-        {
-            return;  /* illegal parameter */
-        }
-    }
-    else
-    {
-        sblim = *used_freq_lines + 1;
-
-        if (sblim > SUBBANDS_NUMBER - 1)
-        {
-            sblim = SUBBANDS_NUMBER - 1;  /* default */
-        }
-
-    }
-
-
     ptr3 = &input_buffer[17];
     ptr4 = &input_buffer[18];
-    ptr_csi = c_signal;
-    ptr_csa = c_alias;
+    ptr_csi = csi;
+    ptr_csa = csa;
 
     /*   NUM_BUTTERFLIES (=8) butterflies between each pair of sub-bands*/
 
@@ -257,5 +232,40 @@ void pvmp3_alias_reduction(int32 *input_buffer,         /* Ptr to spec values of
             *ptr2    = fxp_mac32_Q32(fxp_mul32_Q32(y << 1, csi2), x, csa2);
         }
     }
+}
+
+void pvmp3_alias_reduction(int32 *input_buffer,         /* Ptr to spec values of current channel */
+                           granuleInfo *gr_info,
+                           int32  *used_freq_lines,
+                           mp3Header *info)
+{
+    int32  sblim;
+
+    *used_freq_lines = fxp_mul32_Q32(*used_freq_lines << 16, (int32)(0x7FFFFFFF / (float)18 - 1.0f)) >> 15;
+
+
+    if (gr_info->window_switching_flag &&  gr_info->block_type == 2)
+    {
+        if (gr_info->mixed_block_flag)
+        {
+            sblim = ((info->version_x == MPEG_2_5) && (info->sampling_frequency == 2)) ? 3 : 1;
+        }
+        else
+        {
+            return;  /* illegal parameter */
+        }
+    }
+    else
+    {
+        sblim = *used_freq_lines + 1;
+
+        if (sblim > SUBBANDS_NUMBER - 1)
+        {
+            sblim = SUBBANDS_NUMBER - 1;  /* default */
+        }
+
+    }
+
 
+    pvmp3_simd_kernels()->alias_butterflies(input_buffer, sblim, c_signal, c_alias);
 }
@@ -78,6 +78,9 @@ extern "C"
 {
 #endif
 
+    /* Also used by the SIMD version of the DCT 32 */
+    extern const int32 CosTable_dct32[16];
+
     void pvmp3_dct_16(int32 vec[], int32 flag);
 
     void pvmp3_merge_in_place_N32(int32 vec[]);
@@ -100,6 +100,7 @@ Overlapping and adding with previous block
 #include "pvmp3_dec_defs.h"
 #include "pvmp3_mdct_18.h"
 #include "pvmp3_mdct_6.h"
+#include "pvmp3_simd.h"
 #include "mp3_mem_funcs.h"
 
 
@@ -213,6 +214,20 @@ const int32 short_win[12] =
 ; FUNCTION CODE
 ----------------------------------------------------------------------------*/
 
+/*
+ *  pvmp3_mdct_18() of bands consecutive bands sharing a window, C version of
+ *  pvmp3_kernels::mdct_18
+ */
+void pvmp3_mdct_18_bands(int32 *vec, int32 *history, const int32 *window, int32 bands)
+{
+    for (; bands != 0; bands--)
+    {
+        pvmp3_mdct_18(vec, history, window);
+        vec     += FILTERBANK_BANDS;
+        history += FILTERBANK_BANDS;
+    }
+}
+
 void pvmp3_imdct_synth(int32  in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
                        int32  overlap[SUBBANDS_NUMBER*FILTERBANK_BANDS],
                        uint32 blk_type,
@@ -222,7 +237,9 @@ void pvmp3_imdct_synth(int32  in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
 {
 
     int32 band;
+    int32 bands;
     int32 bands2process = used_freq_lines + 2;
+    const pvmp3_kernels *kernels = pvmp3_simd_kernels();
 
     if (bands2process > SUBBANDS_NUMBER)
     {
@@ -236,35 +253,40 @@ void pvmp3_imdct_synth(int32  in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
      */
 
 
-    for (band = 0; band < bands2process; band++)
+    for (band = 0; band < bands2process; band += bands)
     {
         uint32 current_blk_type = (band < mx_band) ? LONG : blk_type;
 
         int32 * out     = in      + (band * FILTERBANK_BANDS);
         int32 * history = overlap + (band * FILTERBANK_BANDS);
 
+        /* long blocks up to the next change of block type share a window */
+        bands = ((band < mx_band) && (mx_band < bands2process)) ? mx_band - band : bands2process - band;
+
         switch (current_blk_type)
         {
             case LONG:
 
-                pvmp3_mdct_18(out, history, normal_win);
+                kernels->mdct_18(out, history, normal_win, bands);
 
                 break;
 
             case START:
 
-                pvmp3_mdct_18(out, history, start_win);
+                kernels->mdct_18(out, history, start_win, bands);
 
                 break;
 
             case STOP:
 
-                pvmp3_mdct_18(out, history, stop_win);
+                kernels->mdct_18(out, history, stop_win, bands);
 
                 break;
 
             case SHORT:
             {
+                bands = 1;
+
                 int32 *tmp_prev_ovr = &Scratch_mem[FILTERBANK_BANDS];
                 int32 i;
 
@@ -314,16 +336,18 @@ void pvmp3_imdct_synth(int32  in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
          *     processing by the polyphase filter
          */
 
-        if (band & 1)
+        for (int32 odd = band | 1; odd < band + bands; odd += 2)
         {
+            int32 * odd_out = in + (odd * FILTERBANK_BANDS);
+
             for (int32 slot = 1; slot < FILTERBANK_BANDS; slot += 6)
             {
-                int32 temp1 = out[slot  ];
-                int32 temp2 = out[slot+2];
-                int32 temp3 = out[slot+4];
-                out[slot  ] = -temp1;
-                out[slot+2] = -temp2;
-                out[slot+4] = -temp3;
+                int32 temp1 = odd_out[slot  ];
+                int32 temp2 = odd_out[slot+2];
+                int32 temp3 = odd_out[slot+4];
+                odd_out[slot  ] = -temp1;
+                odd_out[slot+2] = -temp2;
+                odd_out[slot+4] = -temp3;
             }
         }
     }
@@ -63,6 +63,23 @@
 #define Qfmt1(a)   (Int32)((a)*((Int32)0x7FFFFFFF))
 #define Qfmt2(a)   (Int32)((a)*((Int32)1<<27))
 
+/* pvmp3_dct_9() terms, also used by the SIMD version of pvmp3_mdct_18() */
+#define Qfmt31(a)   (int32)((a)*(0x7FFFFFFF))
+
+#define cos_pi_9    Qfmt31( 0.93969262078591f)
+#define cos_2pi_9   Qfmt31( 0.76604444311898f)
+#define cos_4pi_9   Qfmt31( 0.17364817766693f)
+#define cos_5pi_9   Qfmt31(-0.17364817766693f)
+#define cos_7pi_9   Qfmt31(-0.76604444311898f)
+#define cos_8pi_9   Qfmt31(-0.93969262078591f)
+#define cos_pi_6    Qfmt31( 0.86602540378444f)
+#define cos_5pi_6   Qfmt31(-0.86602540378444f)
+#define cos_5pi_18  Qfmt31( 0.64278760968654f)
+#define cos_7pi_18  Qfmt31( 0.34202014332567f)
+#define cos_11pi_18 Qfmt31(-0.34202014332567f)
+#define cos_13pi_18 Qfmt31(-0.64278760968654f)
+#define cos_17pi_18 Qfmt31(-0.98480775301221f)
+
 /*----------------------------------------------------------------------------
 ; EXTERNAL VARIABLES REFERENCES
 ; Declare variables used in this module but defined elsewhere
@@ -89,6 +106,10 @@ extern "C"
 {
 #endif
 
+    /* Also used by the SIMD version of pvmp3_mdct_18() */
+    extern const int32 cosTerms_dct18[9];
+    extern const int32 cosTerms_1_ov_cos_phi[18];
+
     void pvmp3_mdct_18(int32 vec[], int32 *history, const int32 *window);
 
     void pvmp3_dct_9(int32 vec[]);
@@ -79,6 +79,7 @@
 #include "pvmp3_dec_defs.h"
 #include "pvmp3_dct_16.h"
 #include "pvmp3_equalizer.h"
+#include "pvmp3_simd.h"
 #include "mp3_mem_funcs.h"
 
 
@@ -119,6 +120,25 @@
 ; FUNCTION CODE
 ----------------------------------------------------------------------------*/
 
+/*
+ *  DCT 32 of blocks consecutive blocks of SUBBANDS_NUMBER samples, C version
+ *  of pvmp3_kernels::dct_32
+ */
+void pvmp3_dct_32(int32 *vec, int32 blocks)
+{
+    for (; blocks != 0; blocks--)
+    {
+        pvmp3_split(&vec[16]);
+
+        pvmp3_dct_16(&vec[16], 0);
+        pvmp3_dct_16(vec, 1);     // Even terms
+
+        pvmp3_merge_in_place_N32(vec);
+
+        vec += SUBBANDS_NUMBER;
+    }
+}
+
 void pvmp3_poly_phase_synthesis(tmp3dec_chan   *pChVars,
                                 int32          numChannels,
                                 e_equalization equalizerType,
@@ -133,48 +153,32 @@ void pvmp3_poly_phase_synthesis(tmp3dec_chan   *pChVars,
 
 
     int16 * ptr_out = outPcm;
+    const pvmp3_kernels *kernels = pvmp3_simd_kernels();
+
+    /*
+     *   DCT 32 of all the slots at once, the window of a slot only reads
+     *   that slot and the older ones, at higher addresses
+     */
+
+    kernels->dct_32(pChVars->circ_buffer, FILTERBANK_BANDS);
 
 
     for (int32  band = 0; band < FILTERBANK_BANDS; band += 2)
     {
         int32 *inData  = &pChVars->circ_buffer[544 - (band<<5)];
 
-        /*
-         *   DCT 32
-         */
-
-        pvmp3_split(&inData[16]);
-
-        pvmp3_dct_16(&inData[16], 0);
-        pvmp3_dct_16(inData, 1);     // Even terms
-
-        pvmp3_merge_in_place_N32(inData);
-
-        pvmp3_polyphase_filter_window(inData,
-                                      ptr_out,
-                                      numChannels);
+        kernels->polyphase_filter_window(inData,
+                                         ptr_out,
+                                         numChannels);
 
         inData  -= SUBBANDS_NUMBER;
 
-        /*
-         *   DCT 32
-         */
-
-        pvmp3_split(&inData[16]);
-
-        pvmp3_dct_16(&inData[16], 0);
-        pvmp3_dct_16(inData, 1);     // Even terms
-
-        pvmp3_merge_in_place_N32(inData);
-
-        pvmp3_polyphase_filter_window(inData,
-                                      ptr_out + (numChannels << 5),
-                                      numChannels);
+        kernels->polyphase_filter_window(inData,
+                                         ptr_out + (numChannels << 5),
+                                         numChannels);
 
         ptr_out += (numChannels << 6);
 
-        inData  -= SUBBANDS_NUMBER;
-
     }/* end band loop */
 
     pv_memmove(&pChVars->circ_buffer[576],
@@ -0,0 +1,508 @@
+/* ------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+   MP3 Decoder Library
+
+   Filename: pvmp3_simd.cpp
+
+------------------------------------------------------------------------------
+ FUNCTION DESCRIPTION
+
+    SIMD versions of pvmp3_polyphase_filter_window(), the DCT 32, the long
+    block IMDCT and the alias reduction butterflies, and the runtime
+    selection between them.
+
+    Polyphase window: the 15 output pairs j = 1..15 are computed in lanes,
+    pt_1[] inputs of consecutive j are contiguous and pt_2[] ones are
+    contiguous in reverse, the window is transposed once to [tap][j].
+    DCT 32 and IMDCT: one block per lane, see pvmp3_simd_lanes.h.
+    Alias reduction: butterflies are computed in lanes, the lower half of
+    every butterfly is loaded and stored in reverse.
+
+    fxp_mul32_Qn(a, b) is bits n..n+31 of the signed 64 bit product.
+
+------------------------------------------------------------------------------
+*/
+
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <atomic>
+
+#include "pvmp3_simd.h"
+#include "pvmp3_polyphase_filter_window.h"
+#include "pvmp3_dct_16.h"
+#include "pvmp3_mdct_18.h"
+#include "pv_mp3dec_fxd_op.h"
+#include "pvmp3_dec_defs.h"
+#include "pvmp3_tables.h"
+
+#if defined(PVMP3_USE_X86) && defined(__GNUC__)
+#include <immintrin.h>
+#define PVMP3_USE_AVX2
+#define PVMP3_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(PVMP3_USE_NEON)
+#include <arm_neon.h>
+#endif
+
+/*----------------------------------------------------------------------------
+; DEFINES
+----------------------------------------------------------------------------*/
+#define WINDOW_TAPS         16      /* window taps of every j = 1..15 */
+#define WINDOW_LANES        16      /* j = 1..16, lane of j = 16 has zero window */
+#define SPLIT_Q27_TERMS     6       /* first butterflies of pvmp3_split() use Q27 */
+
+/*----------------------------------------------------------------------------
+; LOCAL STORE/BUFFER/POINTER DEFINITIONS
+----------------------------------------------------------------------------*/
+#if defined(PVMP3_USE_AVX2) || defined(PVMP3_USE_NEON)
+
+struct pvmp3_window_transposed
+{
+    alignas(32) int32 coef[WINDOW_TAPS][WINDOW_LANES];
+
+    pvmp3_window_transposed()
+    {
+        for (int32 k = 0; k < WINDOW_TAPS; k++)
+        {
+            for (int32 j = 1; j <= WINDOW_LANES; j++)
+            {
+                coef[k][j - 1] = (j < SUBBANDS_NUMBER / 2) ? pqmfSynthWin[(j - 1) * WINDOW_TAPS + k] : 0;
+            }
+        }
+    }
+};
+
+static const int32(*pvmp3_window_coef(void))[WINDOW_LANES]
+{
+    static const pvmp3_window_transposed window;
+    return window.coef;
+}
+
+/*
+ *  Outputs of j = 0 and j = 16, same as the tail of pvmp3_polyphase_filter_window()
+ */
+static void pvmp3_polyphase_filter_window_edge(int32 *synth_buffer,
+        int16 *outPcm,
+        int32 numChannels)
+{
+    const int32 *winPtr = &pqmfSynthWin[(SUBBANDS_NUMBER / 2 - 1) * WINDOW_TAPS];
+    int32 sum1 = 0x00000020;
+    int32 sum2 = 0x00000020;
+
+    for (int32 i = 16; i < HAN_SIZE + 16; i += (SUBBANDS_NUMBER << 2))
+    {
+        int32 *pt_synth = &synth_buffer[i];
+        int32 temp1 = pt_synth[ 0                ];
+        int32 temp2 = pt_synth[ SUBBANDS_NUMBER  ];
+        int32 temp3 = pt_synth[ SUBBANDS_NUMBER/2];
+
+        sum1 = fxp_mac32_Q32(sum1, temp1, winPtr[0]) ;
+        sum1 = fxp_mac32_Q32(sum1, temp2, winPtr[1]) ;
+        sum2 = fxp_mac32_Q32(sum2, temp3, winPtr[2]) ;
+
+        temp1 = pt_synth[ SUBBANDS_NUMBER<<1 ];
+        temp2 = pt_synth[ 3*SUBBANDS_NUMBER  ];
+        temp3 = pt_synth[ SUBBANDS_NUMBER*5/2];
+
+        sum1 = fxp_mac32_Q32(sum1, temp1, winPtr[3]) ;
+        sum1 = fxp_mac32_Q32(sum1, temp2, winPtr[4]) ;
+        sum2 = fxp_mac32_Q32(sum2, temp3, winPtr[5]) ;
+
+        winPtr += 6;
+    }
+
+    outPcm[0] = saturate16(sum1 >> 6);
+    outPcm[(SUBBANDS_NUMBER/2)<<(numChannels-1)] = saturate16(sum2 >> 6);
+}
+
+static void pvmp3_polyphase_filter_window_store(const int32 *sum1,
+        const int32 *sum2,
+        int16 *outPcm,
+        int32 numChannels)
+{
+    for (int32 j = 1; j < SUBBANDS_NUMBER / 2; j++)
+    {
+        int32 k = j << (numChannels - 1);
+        outPcm[k] = saturate16(sum1[j - 1]);
+        outPcm[(numChannels<<5) - k] = saturate16(sum2[j - 1]);
+    }
+}
+
+#endif
+
+/*----------------------------------------------------------------------------
+; AVX2
+----------------------------------------------------------------------------*/
+#if defined(PVMP3_USE_AVX2)
+
+PVMP3_TARGET_AVX2 static inline __m256i pvmp3_avx2_rev(__m256i x)
+{
+    return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+PVMP3_TARGET_AVX2 static inline __m256i pvmp3_avx2_mul_Q32(__m256i a, __m256i b)
+{
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd  = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+PVMP3_TARGET_AVX2 static inline __m256i pvmp3_avx2_mul_Q28(__m256i a, __m256i b)
+{
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd  = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 28), _mm256_slli_epi64(odd, 4), 0xAA);
+}
+
+PVMP3_TARGET_AVX2 static inline __m256i pvmp3_avx2_mul_Q27(__m256i a, __m256i b)
+{
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd  = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 27), _mm256_slli_epi64(odd, 5), 0xAA);
+}
+
+/* 8x8 transpose of r[] */
+PVMP3_TARGET_AVX2 static inline void pvmp3_avx2_transpose(__m256i *r)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+    r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+PVMP3_TARGET_AVX2 static void pvmp3_polyphase_filter_window_avx2(int32 *synth_buffer,
+        int16 *outPcm,
+        int32 numChannels)
+{
+    const int32(*win)[WINDOW_LANES] = pvmp3_window_coef();
+    const int32 *base = &synth_buffer[SUBBANDS_NUMBER >> 1];
+    int32 out1[WINDOW_LANES];
+    int32 out2[WINDOW_LANES];
+
+    for (int32 j = 1; j < SUBBANDS_NUMBER / 2; j += 8)
+    {
+        const int32 *pt_1 = base + j;       /* pt_1[] of lanes j..j+7 */
+        const int32 *pt_2 = base - j - 7;   /* pt_2[] of lanes j+7..j */
+        __m256i sum1 = _mm256_set1_epi32(0x00000020);
+        __m256i sum2 = _mm256_set1_epi32(0x00000020);
+
+        for (int32 n = 0; n < 4; n++)
+        {
+            __m256i temp1 = _mm256_loadu_si256((const __m256i *)&pt_1[SUBBANDS_NUMBER * (2 * n)]);
+            __m256i temp3 = pvmp3_avx2_rev(_mm256_loadu_si256((const __m256i *)&pt_2[SUBBANDS_NUMBER * (15 - 2 * n)]));
+            __m256i temp2 = pvmp3_avx2_rev(_mm256_loadu_si256((const __m256i *)&pt_2[SUBBANDS_NUMBER * (2 * n + 1)]));
+            __m256i temp4 = _mm256_loadu_si256((const __m256i *)&pt_1[SUBBANDS_NUMBER * (14 - 2 * n)]);
+            __m256i w0 = _mm256_load_si256((const __m256i *)&win[4 * n + 0][j - 1]);
+            __m256i w1 = _mm256_load_si256((const __m256i *)&win[4 * n + 1][j - 1]);
+            __m256i w2 = _mm256_load_si256((const __m256i *)&win[4 * n + 2][j - 1]);
+            __m256i w3 = _mm256_load_si256((const __m256i *)&win[4 * n + 3][j - 1]);
+
+            sum1 = _mm256_add_epi32(sum1, pvmp3_avx2_mul_Q32(temp1, w0));
+            sum2 = _mm256_add_epi32(sum2, pvmp3_avx2_mul_Q32(temp3, w0));
+            sum2 = _mm256_add_epi32(sum2, pvmp3_avx2_mul_Q32(temp1, w1));
+            sum1 = _mm256_sub_epi32(sum1, pvmp3_avx2_mul_Q32(temp3, w1));
+            sum1 = _mm256_add_epi32(sum1, pvmp3_avx2_mul_Q32(temp2, w2));
+            sum2 = _mm256_sub_epi32(sum2, pvmp3_avx2_mul_Q32(temp4, w2));
+            sum2 = _mm256_add_epi32(sum2, pvmp3_avx2_mul_Q32(temp2, w3));
+            sum1 = _mm256_add_epi32(sum1, pvmp3_avx2_mul_Q32(temp4, w3));
+        }
+
+        _mm256_storeu_si256((__m256i *)&out1[j - 1], _mm256_srai_epi32(sum1, 6));
+        _mm256_storeu_si256((__m256i *)&out2[j - 1], _mm256_srai_epi32(sum2, 6));
+    }
+
+    pvmp3_polyphase_filter_window_store(out1, out2, outPcm, numChannels);
+    pvmp3_polyphase_filter_window_edge(synth_buffer, outPcm, numChannels);
+}
+
+PVMP3_TARGET_AVX2 static void pvmp3_alias_butterflies_avx2(int32 *input_buffer, int32 sblim, const int32 *csi, const int32 *csa)
+{
+    int32 *ptr = &input_buffer[FILTERBANK_BANDS];
+    __m256i cs = _mm256_loadu_si256((const __m256i *)csi);
+    __m256i ca = _mm256_loadu_si256((const __m256i *)csa);
+
+    for (int32 sb = sblim; sb != 0; sb--)
+    {
+        __m256i x  = _mm256_slli_epi32(pvmp3_avx2_rev(_mm256_loadu_si256((const __m256i *)&ptr[-8])), 1);
+        __m256i y  = _mm256_slli_epi32(_mm256_loadu_si256((const __m256i *)ptr), 1);
+        __m256i lo = _mm256_sub_epi32(pvmp3_avx2_mul_Q32(x, cs), pvmp3_avx2_mul_Q32(y, ca));
+        __m256i hi = _mm256_add_epi32(pvmp3_avx2_mul_Q32(y, cs), pvmp3_avx2_mul_Q32(x, ca));
+        _mm256_storeu_si256((__m256i *)&ptr[-8], pvmp3_avx2_rev(lo));
+        _mm256_storeu_si256((__m256i *)ptr, hi);
+        ptr += FILTERBANK_BANDS;
+    }
+}
+
+#define PVMP3_LANES         8
+#define PVMP3_LANE          __m256i
+#define PVMP3_LANE_TARGET   PVMP3_TARGET_AVX2
+#define PVMP3_LANE_FN(f)    f##_avx2
+#define LANE_LOADU(p)       _mm256_loadu_si256((const __m256i *)(p))
+#define LANE_STOREU(p, a)   _mm256_storeu_si256((__m256i *)(p), a)
+#define LANE_TRANSPOSE(v)   pvmp3_avx2_transpose(v)
+#define LANE_DUP(x)         _mm256_set1_epi32(x)
+#define LANE_ADD(a, b)      _mm256_add_epi32(a, b)
+#define LANE_SUB(a, b)      _mm256_sub_epi32(a, b)
+#define LANE_NEG(a)         _mm256_sub_epi32(_mm256_setzero_si256(), a)
+#define LANE_SHL(a, n)      _mm256_slli_epi32(a, n)
+#define LANE_SHR(a, n)      _mm256_srai_epi32(a, n)
+#define LANE_Q32(a, b)      pvmp3_avx2_mul_Q32(a, b)
+#define LANE_Q28(a, b)      pvmp3_avx2_mul_Q28(a, b)
+#define LANE_Q27(a, b)      pvmp3_avx2_mul_Q27(a, b)
+#include "pvmp3_simd_lanes.h"
+
+#endif /* PVMP3_USE_AVX2 */
+
+/*----------------------------------------------------------------------------
+; NEON
+----------------------------------------------------------------------------*/
+#if defined(PVMP3_USE_NEON)
+
+static inline int32x4_t pvmp3_neon_rev(int32x4_t x)
+{
+    x = vrev64q_s32(x);
+    return vcombine_s32(vget_high_s32(x), vget_low_s32(x));
+}
+
+static inline int32x4_t pvmp3_neon_mul_Q32(int32x4_t a, int32x4_t b)
+{
+    int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+    int64x2_t hi = vmull_high_s32(a, b);
+    return vcombine_s32(vshrn_n_s64(lo, 32), vshrn_n_s64(hi, 32));
+}
+
+static inline int32x4_t pvmp3_neon_mul_Q28(int32x4_t a, int32x4_t b)
+{
+    int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+    int64x2_t hi = vmull_high_s32(a, b);
+    return vcombine_s32(vshrn_n_s64(lo, 28), vshrn_n_s64(hi, 28));
+}
+
+static inline int32x4_t pvmp3_neon_mul_Q27(int32x4_t a, int32x4_t b)
+{
+    int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+    int64x2_t hi = vmull_high_s32(a, b);
+    return vcombine_s32(vshrn_n_s64(lo, 27), vshrn_n_s64(hi, 27));
+}
+
+/* 4x4 transpose of r[] */
+static inline void pvmp3_neon_transpose(int32x4_t *r)
+{
+    int32x4x2_t t01 = vtrnq_s32(r[0], r[1]);
+    int32x4x2_t t23 = vtrnq_s32(r[2], r[3]);
+    r[0] = vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0]));
+    r[1] = vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1]));
+    r[2] = vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0]));
+    r[3] = vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]));
+}
+
+static void pvmp3_polyphase_filter_window_neon(int32 *synth_buffer,
+        int16 *outPcm,
+        int32 numChannels)
+{
+    const int32(*win)[WINDOW_LANES] = pvmp3_window_coef();
+    const int32 *base = &synth_buffer[SUBBANDS_NUMBER >> 1];
+    int32 out1[WINDOW_LANES];
+    int32 out2[WINDOW_LANES];
+
+    for (int32 j = 1; j < SUBBANDS_NUMBER / 2; j += 4)
+    {
+        const int32 *pt_1 = base + j;       /* pt_1[] of lanes j..j+3 */
+        const int32 *pt_2 = base - j - 3;   /* pt_2[] of lanes j+3..j */
+        int32x4_t sum1 = vdupq_n_s32(0x00000020);
+        int32x4_t sum2 = vdupq_n_s32(0x00000020);
+
+        for (int32 n = 0; n < 4; n++)
+        {
+            int32x4_t temp1 = vld1q_s32(&pt_1[SUBBANDS_NUMBER * (2 * n)]);
+            int32x4_t temp3 = pvmp3_neon_rev(vld1q_s32(&pt_2[SUBBANDS_NUMBER * (15 - 2 * n)]));
+            int32x4_t temp2 = pvmp3_neon_rev(vld1q_s32(&pt_2[SUBBANDS_NUMBER * (2 * n + 1)]));
+            int32x4_t temp4 = vld1q_s32(&pt_1[SUBBANDS_NUMBER * (14 - 2 * n)]);
+            int32x4_t w0 = vld1q_s32(&win[4 * n + 0][j - 1]);
+            int32x4_t w1 = vld1q_s32(&win[4 * n + 1][j - 1]);
+            int32x4_t w2 = vld1q_s32(&win[4 * n + 2][j - 1]);
+            int32x4_t w3 = vld1q_s32(&win[4 * n + 3][j - 1]);
+
+            sum1 = vaddq_s32(sum1, pvmp3_neon_mul_Q32(temp1, w0));
+            sum2 = vaddq_s32(sum2, pvmp3_neon_mul_Q32(temp3, w0));
+            sum2 = vaddq_s32(sum2, pvmp3_neon_mul_Q32(temp1, w1));
+            sum1 = vsubq_s32(sum1, pvmp3_neon_mul_Q32(temp3, w1));
+            sum1 = vaddq_s32(sum1, pvmp3_neon_mul_Q32(temp2, w2));
+            sum2 = vsubq_s32(sum2, pvmp3_neon_mul_Q32(temp4, w2));
+            sum2 = vaddq_s32(sum2, pvmp3_neon_mul_Q32(temp2, w3));
+            sum1 = vaddq_s32(sum1, pvmp3_neon_mul_Q32(temp4, w3));
+        }
+
+        vst1q_s32(&out1[j - 1], vshrq_n_s32(sum1, 6));
+        vst1q_s32(&out2[j - 1], vshrq_n_s32(sum2, 6));
+    }
+
+    pvmp3_polyphase_filter_window_store(out1, out2, outPcm, numChannels);
+    pvmp3_polyphase_filter_window_edge(synth_buffer, outPcm, numChannels);
+}
+
+static void pvmp3_alias_butterflies_neon(int32 *input_buffer, int32 sblim, const int32 *csi, const int32 *csa)
+{
+    int32 *ptr = &input_buffer[FILTERBANK_BANDS];
+
+    for (int32 sb = sblim; sb != 0; sb--)
+    {
+        for (int32 i = 0; i < 8; i += 4)
+        {
+            int32x4_t cs = vld1q_s32(&csi[i]);
+            int32x4_t ca = vld1q_s32(&csa[i]);
+            int32x4_t x  = vshlq_n_s32(pvmp3_neon_rev(vld1q_s32(&ptr[-4 - i])), 1);
+            int32x4_t y  = vshlq_n_s32(vld1q_s32(&ptr[i]), 1);
+            int32x4_t lo = vsubq_s32(pvmp3_neon_mul_Q32(x, cs), pvmp3_neon_mul_Q32(y, ca));
+            int32x4_t hi = vaddq_s32(pvmp3_neon_mul_Q32(y, cs), pvmp3_neon_mul_Q32(x, ca));
+            vst1q_s32(&ptr[-4 - i], pvmp3_neon_rev(lo));
+            vst1q_s32(&ptr[i], hi);
+        }
+        ptr += FILTERBANK_BANDS;
+    }
+}
+
+#define PVMP3_LANES         4
+#define PVMP3_LANE          int32x4_t
+#define PVMP3_LANE_TARGET
+#define PVMP3_LANE_FN(f)    f##_neon
+#define LANE_LOADU(p)       vld1q_s32(p)
+#define LANE_STOREU(p, a)   vst1q_s32(p, a)
+#define LANE_TRANSPOSE(v)   pvmp3_neon_transpose(v)
+#define LANE_DUP(x)         vdupq_n_s32(x)
+#define LANE_ADD(a, b)      vaddq_s32(a, b)
+#define LANE_SUB(a, b)      vsubq_s32(a, b)
+#define LANE_NEG(a)         vnegq_s32(a)
+#define LANE_SHL(a, n)      vshlq_n_s32(a, n)
+#define LANE_SHR(a, n)      vshrq_n_s32(a, n)
+#define LANE_Q32(a, b)      pvmp3_neon_mul_Q32(a, b)
+#define LANE_Q28(a, b)      pvmp3_neon_mul_Q28(a, b)
+#define LANE_Q27(a, b)      pvmp3_neon_mul_Q27(a, b)
+#include "pvmp3_simd_lanes.h"
+
+#endif /* PVMP3_USE_NEON */
+
+/*----------------------------------------------------------------------------
+; KERNEL TABLES
+----------------------------------------------------------------------------*/
+static const pvmp3_kernels pvmp3_kernels_c =
+{
+    PVMP3_SIMD_NONE, "c",
+    pvmp3_polyphase_filter_window, pvmp3_dct_32, pvmp3_mdct_18_bands, pvmp3_alias_butterflies
+};
+
+#if defined(PVMP3_USE_AVX2)
+static const pvmp3_kernels pvmp3_kernels_avx2 =
+{
+    PVMP3_SIMD_AVX2, "avx2",
+    pvmp3_polyphase_filter_window_avx2, pvmp3_dct_32_avx2, pvmp3_mdct_18_bands_avx2, pvmp3_alias_butterflies_avx2
+};
+#endif
+
+#if defined(PVMP3_USE_NEON)
+static const pvmp3_kernels pvmp3_kernels_neon =
+{
+    PVMP3_SIMD_NEON, "neon",
+    pvmp3_polyphase_filter_window_neon, pvmp3_dct_32_neon, pvmp3_mdct_18_bands_neon, pvmp3_alias_butterflies_neon
+};
+#endif
+
+/* Resolved on the first frame of any decoder, which may run on several threads */
+static std::atomic<const pvmp3_kernels *> pvmp3_kernels_active(NULL);
+
+/*----------------------------------------------------------------------------
+; FUNCTION CODE
+----------------------------------------------------------------------------*/
+
+e_pvmp3_simd pvmp3_simd_detect(void)
+{
+#if defined(PVMP3_USE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return PVMP3_SIMD_AVX2;
+#endif
+#if defined(PVMP3_USE_NEON)
+    return PVMP3_SIMD_NEON;
+#else
+    return PVMP3_SIMD_NONE;
+#endif
+}
+
+const pvmp3_kernels *pvmp3_simd_get_kernels(e_pvmp3_simd level)
+{
+    switch (level)
+    {
+        case PVMP3_SIMD_NONE:
+            return &pvmp3_kernels_c;
+#if defined(PVMP3_USE_AVX2)
+        case PVMP3_SIMD_AVX2:
+            return (pvmp3_simd_detect() == PVMP3_SIMD_AVX2) ? &pvmp3_kernels_avx2 : NULL;
+#endif
+#if defined(PVMP3_USE_NEON)
+        case PVMP3_SIMD_NEON:
+            return &pvmp3_kernels_neon;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+int32 pvmp3_simd_select(e_pvmp3_simd level)
+{
+    const pvmp3_kernels *kernels = pvmp3_simd_get_kernels(level);
+    if (kernels == NULL)
+        return -1;
+    pvmp3_kernels_active.store(kernels, std::memory_order_release);
+    return 0;
+}
+
+const pvmp3_kernels *pvmp3_simd_kernels(void)
+{
+    const pvmp3_kernels *kernels = pvmp3_kernels_active.load(std::memory_order_acquire);
+    if (kernels == NULL)
+    {
+        /* Keep a level forced by pvmp3_simd_select() meanwhile, else store the detected one */
+        const pvmp3_kernels *detected = pvmp3_simd_get_kernels(pvmp3_simd_detect());
+        if (pvmp3_kernels_active.compare_exchange_strong(kernels, detected, std::memory_order_acq_rel))
+            kernels = detected;
+    }
+    return kernels;
+}
@@ -0,0 +1,125 @@
+/* ------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+   MP3 Decoder Library
+
+   Filename: pvmp3_simd.h
+
+------------------------------------------------------------------------------
+ INCLUDE DESCRIPTION
+
+    Runtime dispatch of the synthesis, IMDCT and alias reduction kernels.
+
+    AVX2 (x86, detected at runtime) and NEON (AArch64) versions are bit-exact with the C kernels: every fxp_mul32_Qxx product is
+    truncated per lane exactly like the C code, and the int32 accumulations
+    only differ in order, which does not change a wrapping sum.
+
+    Define PVMP3_DISABLE_SIMD to build the C kernels only.
+
+------------------------------------------------------------------------------
+*/
+
+/*----------------------------------------------------------------------------
+; CONTINUE ONLY IF NOT ALREADY DEFINED
+----------------------------------------------------------------------------*/
+#ifndef PVMP3_SIMD_H
+#define PVMP3_SIMD_H
+
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+#include "pvmp3_audio_type_defs.h"
+
+/*----------------------------------------------------------------------------
+; DEFINES
+; Include all pre-processor statements here.
+----------------------------------------------------------------------------*/
+#if !defined(PVMP3_DISABLE_SIMD) && \
+    !defined(PV_ARM_V5) && !defined(PV_ARM_V4) && !defined(PV_ARM_GCC_V5) && !defined(PV_ARM_GCC_V4)
+#if defined(__SSE2__) || defined(_M_X64)
+#define PVMP3_USE_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define PVMP3_USE_NEON
+#endif
+#endif
+
+/*----------------------------------------------------------------------------
+; ENUMERATED TYPEDEF'S
+----------------------------------------------------------------------------*/
+typedef enum
+{
+    PVMP3_SIMD_NONE = 0,
+    PVMP3_SIMD_AVX2,
+    PVMP3_SIMD_NEON,
+    PVMP3_SIMD_LEVELS
+} e_pvmp3_simd;
+
+/*----------------------------------------------------------------------------
+; STRUCTURES TYPEDEF'S
+----------------------------------------------------------------------------*/
+typedef struct
+{
+    e_pvmp3_simd level;
+    const char  *name;
+
+    /* pvmp3_polyphase_filter_window() */
+    void (*polyphase_filter_window)(int32 *synth_buffer, int16 *outPcm, int32 numChannels);
+
+    /* DCT 32 of blocks consecutive blocks of SUBBANDS_NUMBER samples */
+    void (*dct_32)(int32 *vec, int32 blocks);
+
+    /* pvmp3_mdct_18() of bands consecutive bands sharing a window */
+    void (*mdct_18)(int32 *vec, int32 *history, const int32 *window, int32 bands);
+
+    /* butterflies of pvmp3_alias_reduction() between the first sblim + 1 subbands */
+    void (*alias_butterflies)(int32 *input_buffer, int32 sblim, const int32 *csi, const int32 *csa);
+} pvmp3_kernels;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Kernels of the best level supported by the cpu, resolved on first call */
+    const pvmp3_kernels *pvmp3_simd_kernels(void);
+
+    /* Best level supported by this build and cpu */
+    e_pvmp3_simd pvmp3_simd_detect(void);
+
+    /* Kernels of a given level, NULL if not supported, for tests and benchmarks */
+    const pvmp3_kernels *pvmp3_simd_get_kernels(e_pvmp3_simd level);
+
+    /* Force the level used by the decoder, returns 0 on success */
+    int32 pvmp3_simd_select(e_pvmp3_simd level);
+
+    void pvmp3_dct_32(int32 *vec, int32 blocks);
+
+    void pvmp3_mdct_18_bands(int32 *vec, int32 *history, const int32 *window, int32 bands);
+
+    void pvmp3_alias_butterflies(int32 *input_buffer, int32 sblim, const int32 *csi, const int32 *csa);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*----------------------------------------------------------------------------
+; END
+----------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,550 @@
+/* ------------------------------------------------------------------
+ * Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+   MP3 Decoder Library
+
+   Filename: pvmp3_simd_lanes.h
+
+------------------------------------------------------------------------------
+ INCLUDE DESCRIPTION
+
+    DCT 32 and long block IMDCT of several blocks at once, one block per
+    lane. Only included by pvmp3_simd.cpp, once per instruction set, after
+    defining the following, which are undefined again at the end:
+
+        PVMP3_LANES             blocks per vector
+        PVMP3_LANE              vector type of PVMP3_LANES int32
+        PVMP3_LANE_TARGET       function attributes
+        PVMP3_LANE_FN(f)        name of the function f for this instruction set
+        LANE_LOADU(p)           load from p
+        LANE_STOREU(p, a)       store to p
+        LANE_TRANSPOSE(v)       transpose the PVMP3_LANES vectors at v
+        LANE_DUP(x), LANE_ADD(a, b), LANE_SUB(a, b), LANE_NEG(a)
+        LANE_SHL(a, n), LANE_SHR(a, n)      n is a constant, SHR is arithmetic
+        LANE_Q32(a, b), LANE_Q28(a, b), LANE_Q27(a, b)
+                                fxp_mul32_Qxx() in every lane
+
+    The lane code is the C code of pvmp3_split(), pvmp3_dct_16(),
+    pvmp3_merge_in_place_N32(), pvmp3_mdct_18() and pvmp3_dct_9() line by
+    line, so the result is bit-exact. Blocks are transposed to [sample][lane]
+    on the way in and back on the way out, PVMP3_LANES samples at a time, the
+    remaining blocks that do not fill a vector go through the C code.
+
+------------------------------------------------------------------------------
+*/
+
+/*----------------------------------------------------------------------------
+; TRANSPOSES
+----------------------------------------------------------------------------*/
+
+/*
+ *  Lane l of v[k] = block[l * stride + k] for k < count, count is at least
+ *  PVMP3_LANES and the last PVMP3_LANES samples may overlap the previous ones
+ */
+PVMP3_LANE_TARGET static inline void PVMP3_LANE_FN(pvmp3_lanes_load)(PVMP3_LANE *v,
+        const int32 *block,
+        int32 stride,
+        int32 count)
+{
+    for (int32 k = 0; k < count; k += PVMP3_LANES)
+    {
+        int32 first = (k + PVMP3_LANES <= count) ? k : count - PVMP3_LANES;
+
+        for (int32 l = 0; l < PVMP3_LANES; l++)
+            v[first + l] = LANE_LOADU(&block[l * stride + first]);
+        LANE_TRANSPOSE(&v[first]);
+    }
+}
+
+PVMP3_LANE_TARGET static inline void PVMP3_LANE_FN(pvmp3_lanes_store)(int32 *block,
+        const PVMP3_LANE *v,
+        int32 stride,
+        int32 count)
+{
+    for (int32 k = 0; k < count; k += PVMP3_LANES)
+    {
+        int32 first = (k + PVMP3_LANES <= count) ? k : count - PVMP3_LANES;
+        PVMP3_LANE rows[PVMP3_LANES];
+
+        for (int32 l = 0; l < PVMP3_LANES; l++)
+            rows[l] = v[first + l];
+        LANE_TRANSPOSE(rows);
+        for (int32 l = 0; l < PVMP3_LANES; l++)
+            LANE_STOREU(&block[l * stride + first], rows[l]);
+    }
+}
+
+/*----------------------------------------------------------------------------
+; DCT 32
+----------------------------------------------------------------------------*/
+
+/* pvmp3_split(&vec[16]) */
+PVMP3_LANE_TARGET static inline void PVMP3_LANE_FN(pvmp3_split_lanes)(PVMP3_LANE *vec)
+{
+    for (int32 i = 0; i < 16; i++)
+    {
+        PVMP3_LANE tmp2 = vec[16 + i];
+        PVMP3_LANE tmp1 = vec[15 - i];
+        PVMP3_LANE cosx = LANE_DUP(CosTable_dct32[15 - i]);
+        vec[15 - i] = LANE_ADD(tmp1, tmp2);
+        if (i < SPLIT_Q27_TERMS)
+            vec[16 + i] = LANE_Q27(LANE_SUB(tmp1, tmp2), cosx);
+        else
+            vec[16 + i] = LANE_Q32(LANE_SHL(LANE_SUB(tmp1, tmp2), 1), cosx);
+    }
+}
+
+PVMP3_LANE_TARGET static inline void PVMP3_LANE_FN(pvmp3_dct_16_lanes)(PVMP3_LANE *vec, int32 flag)
+{
+    PVMP3_LANE tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+    PVMP3_LANE tmp_o0, tmp_o1, tmp_o2, tmp_o3, tmp_o4, tmp_o5, tmp_o6, tmp_o7;
+    PVMP3_LANE itmp_e0, itmp_e1, itmp_e2;
+
+    /*  split input vector */
+
+    tmp_o0 = LANE_Q32(LANE_SUB(vec[ 0], vec[15]), LANE_DUP(Qfmt_31(0.50241928618816F)));
+    tmp0   = LANE_ADD(vec[ 0], vec[15]);
+
+    tmp_o7 = LANE_Q32(LANE_SHL(LANE_SUB(vec[ 7], vec[ 8]), 3), LANE_DUP(Qfmt_31(0.63764357733614F)));
+    tmp7   = LANE_ADD(vec[ 7], vec[ 8]);
+
+    itmp_e0 = LANE_Q32(LANE_SUB(tmp0, tmp7), LANE_DUP(Qfmt_31(0.50979557910416F)));
+    tmp7    = LANE_ADD(tmp0, tmp7);
+
+    tmp_o1 = LANE_Q32(LANE_SUB(vec[ 1], vec[14]), LANE_DUP(Qfmt_31(0.52249861493969F)));
+    tmp1   = LANE_ADD(vec[ 1], vec[14]);
+
+    tmp_o6 = LANE_Q32(LANE_SHL(LANE_SUB(vec[ 6], vec[ 9]), 1), LANE_DUP(Qfmt_31(0.86122354911916F)));
+    tmp6   = LANE_ADD(vec[ 6], vec[ 9]);
+
+    itmp_e1 = LANE_ADD(tmp1, tmp6);
+    tmp6    = LANE_Q32(LANE_SUB(tmp1, tmp6), LANE_DUP(Qfmt_31(0.60134488693505F)));
+
+    tmp_o2 = LANE_Q32(LANE_SUB(vec[ 2], vec[13]), LANE_DUP(Qfmt_31(0.56694403481636F)));
+    tmp2   = LANE_ADD(vec[ 2], vec[13]);
+    tmp_o5 = LANE_Q32(LANE_SHL(LANE_SUB(vec[ 5], vec[10]), 1), LANE_DUP(Qfmt_31(0.53033884299517F)));
+    tmp5   = LANE_ADD(vec[ 5], vec[10]);
+
+    itmp_e2 = LANE_ADD(tmp2, tmp5);
+    tmp5    = LANE_Q32(LANE_SUB(tmp2, tmp5), LANE_DUP(Qfmt_31(0.89997622313642F)));
+
+    tmp_o3 = LANE_Q32(LANE_SUB(vec[ 3], vec[12]), LANE_DUP(Qfmt_31(0.64682178335999F)));
+    tmp3   = LANE_ADD(vec[ 3], vec[12]);
+    tmp_o4 = LANE_Q32(LANE_SUB(vec[ 4], vec[11]), LANE_DUP(Qfmt_31(0.78815462345125F)));
+    tmp4   = LANE_ADD(vec[ 4], vec[11]);
+
+    tmp1 = LANE_ADD(tmp3, tmp4);
+    tmp4 = LANE_Q32(LANE_SHL(LANE_SUB(tmp3, tmp4), 2), LANE_DUP(Qfmt_31(0.64072886193538F)));
+
+    /*  split even part of tmp_e */
+
+    tmp0 = LANE_ADD(tmp7, tmp1);
+    tmp1 = LANE_Q32(LANE_SUB(tmp7, tmp1), LANE_DUP(Qfmt_31(0.54119610014620F)));
+
+    tmp3 = LANE_Q32(LANE_SHL(LANE_SUB(itmp_e1, itmp_e2), 1), LANE_DUP(Qfmt_31(0.65328148243819F)));
+    tmp7 = LANE_ADD(itmp_e1, itmp_e2);
+
+    vec[ 0] = LANE_SHR(LANE_ADD(tmp0, tmp7), 1);
+    vec[ 8] = LANE_Q32(LANE_SUB(tmp0, tmp7), LANE_DUP(Qfmt_31(0.70710678118655F)));
+    tmp0    = LANE_Q32(LANE_SHL(LANE_SUB(tmp1, tmp3), 1), LANE_DUP(Qfmt_31(0.70710678118655F)));
+    vec[ 4] = LANE_ADD(LANE_ADD(tmp1, tmp3), tmp0);
+    vec[12] = tmp0;
+
+    /*  split odd part of tmp_e */
+
+    tmp1 = LANE_Q32(LANE_SHL(LANE_SUB(itmp_e0, tmp4), 1), LANE_DUP(Qfmt_31(0.54119610014620F)));
+    tmp7 = LANE_ADD(itmp_e0, tmp4);
+
+    tmp3 = LANE_Q32(LANE_SHL(LANE_SUB(tmp6, tmp5), 2), LANE_DUP(Qfmt_31(0.65328148243819F)));
+    tmp6 = LANE_ADD(tmp6, tmp5);
+
+    tmp4 = LANE_Q32(LANE_SHL(LANE_SUB(tmp7, tmp6), 1), LANE_DUP(Qfmt_31(0.70710678118655F)));
+    tmp6 = LANE_ADD(tmp6, tmp7);
+    tmp7 = LANE_Q32(LANE_SHL(LANE_SUB(tmp1, tmp3), 1), LANE_DUP(Qfmt_31(0.70710678118655F)));
+
+    tmp1    = LANE_ADD(tmp1, LANE_ADD(tmp3, tmp7));
+    vec[ 2] = LANE_ADD(tmp1, tmp6);
+    vec[ 6] = LANE_ADD(tmp1, tmp4);
+    vec[10] = LANE_ADD(tmp7, tmp4);
+    vec[14] = tmp7;
+
+    /* dct8 */
+
+    tmp1 = LANE_Q32(LANE_SHL(LANE_SUB(tmp_o0, tmp_o7), 1), LANE_DUP(Qfmt_31(0.50979557910416F)));
+    tmp7 = LANE_ADD(tmp_o0, tmp_o7);
+
+    tmp6   = LANE_ADD(tmp_o1, tmp_o6);
+    tmp_o1 = LANE_Q32(LANE_SHL(LANE_SUB(tmp_o1, tmp_o6), 1), LANE_DUP(Qfmt_31(0.60134488693505F)));
+
+    tmp5   = LANE_ADD(tmp_o2, tmp_o5);
+    tmp_o5 = LANE_Q32(LANE_SHL(LANE_SUB(tmp_o2, tmp_o5), 1), LANE_DUP(Qfmt_31(0.89997622313642F)));
+
+    tmp0 = LANE_Q32(LANE_SHL(LANE_SUB(tmp_o3, tmp_o4), 3), LANE_DUP(Qfmt_31(0.6407288619354F)));
+    tmp4 = LANE_ADD(tmp_o3, tmp_o4);
+
+    if (!flag)
+    {
+        tmp7   = LANE_NEG(tmp7);
+        tmp1   = LANE_NEG(tmp1);
+        tmp6   = LANE_NEG(tmp6);
+        tmp_o1 = LANE_NEG(tmp_o1);
+        tmp5   = LANE_NEG(tmp5);
+        tmp_o5 = LANE_NEG(tmp_o5);
+        tmp4   = LANE_NEG(tmp4);
+        tmp0   = LANE_NEG(tmp0);
+    }
+
+    tmp2   = LANE_Q32(LANE_SHL(LANE_SUB(tmp1, tmp0), 1), LANE_DUP(Qfmt_31(0.54119610014620F)));
+    tmp0   = LANE_ADD(tmp0, tmp1);
+    tmp1   = LANE_Q32(LANE_SHL(LANE_SUB(tmp7, tmp4), 1), LANE_DUP(Qfmt_31(0.54119610014620F)));
+    tmp7   = LANE_ADD(tmp7, tmp4);
+    tmp4   = LANE_Q32(LANE_SHL(LANE_SUB(tmp6, tmp5), 2), LANE_DUP(Qfmt_31(0.65328148243819F)));
+    tmp6   = LANE_ADD(tmp6, tmp5);
+    tmp5   = LANE_Q32(LANE_SHL(LANE_SUB(tmp_o1, tmp_o5), 2), LANE_DUP(Qfmt_31(0.65328148243819F)));
+    tmp_o1 = LANE_ADD(tmp_o1, tmp_o5);
+
+    vec[13] = LANE_Q32(LANE_SHL(LANE_SUB(tmp1, tmp4), 1), LANE_DUP(Qfmt_31(0.70710678118655F)));
+    vec[ 5] = LANE_ADD(LANE_ADD(tmp1, tmp4), vec[13]);
+
+    vec[ 9] = LANE_Q32(LANE_SHL(LANE_SUB(tmp7, tmp6), 1), LANE_DUP(Qfmt_31(0.70710678118655F)));
+    vec[ 1] = LANE_ADD(tmp7, tmp6);
+
+    tmp4 = LANE_Q32(LANE_SHL(LANE_SUB(tmp0, tmp_o1), 1), LANE_DUP(Qfmt_31(0.70710678118655F)));
+    tmp0 = LANE_ADD(tmp0, tmp_o1);
+    tmp6 = LANE_Q32(LANE_SHL(LANE_SUB(tmp2, tmp5), 1), LANE_DUP(Qfmt_31(0.70710678118655F)));
+    tmp2 = LANE_ADD(tmp2, LANE_ADD(tmp5, tmp6));
+    tmp0 = LANE_ADD(tmp0, tmp2);
+
+    vec[ 1] = LANE_ADD(vec[ 1], tmp0);
+    vec[ 3] = LANE_ADD(tmp0, vec[ 5]);
+    tmp2    = LANE_ADD(tmp2, tmp4);
+    vec[ 5] = LANE_ADD(tmp2, vec[ 5]);
+    vec[ 7] = LANE_ADD(tmp2, vec[ 9]);
+    tmp4    = LANE_ADD(tmp4, tmp6);
+    vec[ 9] = LANE_ADD(tmp4, vec[ 9]);
+    vec[11] = LANE_ADD(tmp4, vec[13]);
+    vec[13] = LANE_ADD(tmp6, vec[13]);
+    vec[15] = tmp6;
+}
+
+PVMP3_LANE_TARGET static inline void PVMP3_LANE_FN(pvmp3_merge_in_place_N32_lanes)(PVMP3_LANE *vec)
+{
+    PVMP3_LANE temp0, temp1, temp2, temp3;
+
+    temp0   = vec[14];
+    vec[14] = vec[ 7];
+    temp1   = vec[12];
+    vec[12] = vec[ 6];
+    temp2   = vec[10];
+    vec[10] = vec[ 5];
+    temp3   = vec[ 8];
+    vec[ 8] = vec[ 4];
+    vec[ 6] = vec[ 3];
+    vec[ 4] = vec[ 2];
+    vec[ 2] = vec[ 1];
+
+    vec[ 1] = LANE_ADD(vec[16], vec[17]);
+    vec[16] = temp3;
+    vec[ 3] = LANE_ADD(vec[18], vec[17]);
+    vec[ 5] = LANE_ADD(vec[19], vec[18]);
+    vec[18] = vec[9];
+
+    vec[ 7] = LANE_ADD(vec[20], vec[19]);
+    vec[ 9] = LANE_ADD(vec[21], vec[20]);
+    vec[20] = temp2;
+    temp2   = vec[13];
+    temp3   = vec[11];
+    vec[11] = LANE_ADD(vec[22], vec[21]);
+    vec[13] = LANE_ADD(vec[23], vec[22]);
+    vec[22] = temp3;
+    temp3   = vec[15];
+
+    vec[15] = LANE_ADD(vec[24], vec[23]);
+    vec[17] = LANE_ADD(vec[25], vec[24]);
+    vec[19] = LANE_ADD(vec[26], vec[25]);
+    vec[21] = LANE_ADD(vec[27], vec[26]);
+    vec[23] = LANE_ADD(vec[28], vec[27]);
+    vec[24] = temp1;
+    vec[25] = LANE_ADD(vec[29], vec[28]);
+    vec[26] = temp2;
+    vec[27] = LANE_ADD(vec[30], vec[29]);
+    vec[28] = temp0;
+    vec[29] = LANE_ADD(vec[30], vec[31]);
+    vec[30] = temp3;
+}
+
+PVMP3_LANE_TARGET static void PVMP3_LANE_FN(pvmp3_dct_32)(int32 *vec, int32 blocks)
+{
+    PVMP3_LANE v[SUBBANDS_NUMBER];
+
+    for (; blocks >= PVMP3_LANES; blocks -= PVMP3_LANES)
+    {
+        PVMP3_LANE_FN(pvmp3_lanes_load)(v, vec, SUBBANDS_NUMBER, SUBBANDS_NUMBER);
+
+        PVMP3_LANE_FN(pvmp3_split_lanes)(v);
+        PVMP3_LANE_FN(pvmp3_dct_16_lanes)(&v[16], 0);
+        PVMP3_LANE_FN(pvmp3_dct_16_lanes)(v, 1);     // Even terms
+        PVMP3_LANE_FN(pvmp3_merge_in_place_N32_lanes)(v);
+
+        PVMP3_LANE_FN(pvmp3_lanes_store)(vec, v, SUBBANDS_NUMBER, SUBBANDS_NUMBER);
+
+        vec += PVMP3_LANES * SUBBANDS_NUMBER;
+    }
+
+    pvmp3_dct_32(vec, blocks);
+}
+
+/*----------------------------------------------------------------------------
+; LONG BLOCK IMDCT
+----------------------------------------------------------------------------*/
+
+PVMP3_LANE_TARGET static inline void PVMP3_LANE_FN(pvmp3_dct_9_lanes)(PVMP3_LANE *vec)
+{
+    /*  split input vector */
+
+    PVMP3_LANE tmp0 = LANE_ADD(vec[8], vec[0]);
+    PVMP3_LANE tmp8 = LANE_SUB(vec[8], vec[0]);
+    PVMP3_LANE tmp1 = LANE_ADD(vec[7], vec[1]);
+    PVMP3_LANE tmp7 = LANE_SUB(vec[7], vec[1]);
+    PVMP3_LANE tmp2 = LANE_ADD(vec[6], vec[2]);
+    PVMP3_LANE tmp6 = LANE_SUB(vec[6], vec[2]);
+    PVMP3_LANE tmp3 = LANE_ADD(vec[5], vec[3]);
+    PVMP3_LANE tmp5 = LANE_SUB(vec[5], vec[3]);
+    PVMP3_LANE even = LANE_ADD(LANE_ADD(tmp0, tmp2), tmp3);
+    PVMP3_LANE odd  = LANE_ADD(tmp1, vec[4]);
+    PVMP3_LANE vec2, vec4, vec8;
+
+    vec[0] = LANE_ADD(even, odd);
+    vec[6] = LANE_SUB(LANE_SHR(even, 1), odd);
+    vec2   = LANE_SUB(LANE_SHR(tmp1, 1), vec[4]);
+    vec4   = LANE_NEG(vec2);
+    vec8   = LANE_NEG(vec2);
+
+    tmp0 = LANE_SHL(tmp0, 1);
+    tmp2 = LANE_SHL(tmp2, 1);
+    tmp3 = LANE_SHL(tmp3, 1);
+    vec4 = LANE_ADD(vec4, LANE_Q32(tmp0, LANE_DUP(cos_2pi_9)));
+    vec8 = LANE_ADD(vec8, LANE_Q32(tmp0, LANE_DUP(cos_4pi_9)));
+    vec2 = LANE_ADD(vec2, LANE_Q32(tmp0, LANE_DUP(cos_pi_9)));
+    vec2 = LANE_ADD(vec2, LANE_Q32(tmp2, LANE_DUP(cos_5pi_9)));
+    vec4 = LANE_ADD(vec4, LANE_Q32(tmp2, LANE_DUP(cos_8pi_9)));
+    vec8 = LANE_ADD(vec8, LANE_Q32(tmp2, LANE_DUP(cos_2pi_9)));
+    vec8 = LANE_ADD(vec8, LANE_Q32(tmp3, LANE_DUP(cos_8pi_9)));
+    vec4 = LANE_ADD(vec4, LANE_Q32(tmp3, LANE_DUP(cos_4pi_9)));
+    vec2 = LANE_ADD(vec2, LANE_Q32(tmp3, LANE_DUP(cos_7pi_9)));
+    vec[2] = vec2;
+    vec[4] = vec4;
+    vec[8] = vec8;
+
+    vec[3] = LANE_Q32(LANE_SHL(LANE_SUB(LANE_ADD(tmp5, tmp6), tmp8), 1), LANE_DUP(cos_pi_6));
+
+    tmp5 = LANE_SHL(tmp5, 1);
+    tmp6 = LANE_SHL(tmp6, 1);
+    tmp7 = LANE_SHL(tmp7, 1);
+    tmp8 = LANE_SHL(tmp8, 1);
+    vec[1] = LANE_Q32(tmp5, LANE_DUP(cos_11pi_18));
+    vec[1] = LANE_ADD(vec[1], LANE_Q32(tmp6, LANE_DUP(cos_13pi_18)));
+    vec[1] = LANE_ADD(vec[1], LANE_Q32(tmp7, LANE_DUP(cos_5pi_6)));
+    vec[1] = LANE_ADD(vec[1], LANE_Q32(tmp8, LANE_DUP(cos_17pi_18)));
+    vec[5] = LANE_Q32(tmp5, LANE_DUP(cos_17pi_18));
+    vec[5] = LANE_ADD(vec[5], LANE_Q32(tmp6, LANE_DUP(cos_7pi_18)));
+    vec[5] = LANE_ADD(vec[5], LANE_Q32(tmp7, LANE_DUP(cos_pi_6)));
+    vec[5] = LANE_ADD(vec[5], LANE_Q32(tmp8, LANE_DUP(cos_13pi_18)));
+    vec[7] = LANE_Q32(tmp5, LANE_DUP(cos_5pi_18));
+    vec[7] = LANE_ADD(vec[7], LANE_Q32(tmp6, LANE_DUP(cos_17pi_18)));
+    vec[7] = LANE_ADD(vec[7], LANE_Q32(tmp7, LANE_DUP(cos_pi_6)));
+    vec[7] = LANE_ADD(vec[7], LANE_Q32(tmp8, LANE_DUP(cos_11pi_18)));
+}
+
+/* fxp_mac32_Q32(acc, a, window[i]) */
+#define LANE_MAC_WIN(acc, a, i)     LANE_ADD(acc, LANE_Q32(a, LANE_DUP(window[i])))
+
+PVMP3_LANE_TARGET static inline void PVMP3_LANE_FN(pvmp3_mdct_18_lanes)(PVMP3_LANE *vec,
+        PVMP3_LANE *history,
+        const int32 *window)
+{
+    PVMP3_LANE tmp, tmp1, tmp2, tmp3, tmp4;
+    int32 i;
+
+    for (i = 0; i < 9; i++)
+    {
+        tmp  = LANE_Q32(LANE_SHL(vec[i], 1), LANE_DUP(cosTerms_1_ov_cos_phi[i]));
+        tmp1 = LANE_Q27(vec[17 - i], LANE_DUP(cosTerms_1_ov_cos_phi[17 - i]));
+        vec[i]      = LANE_ADD(tmp, tmp1);
+        vec[17 - i] = LANE_Q28(LANE_SUB(tmp, tmp1), LANE_DUP(cosTerms_dct18[i]));
+    }
+
+    PVMP3_LANE_FN(pvmp3_dct_9_lanes)(vec);         // Even terms
+    PVMP3_LANE_FN(pvmp3_dct_9_lanes)(&vec[9]);     // Odd  terms
+
+    tmp3    = vec[16];
+    vec[16] = vec[ 8];
+    tmp4    = vec[14];
+    vec[14] = vec[ 7];
+    tmp     = vec[12];
+    vec[12] = vec[ 6];
+    tmp2    = vec[10];
+    vec[10] = vec[ 5];
+    vec[ 8] = vec[ 4];
+    vec[ 6] = vec[ 3];
+    vec[ 4] = vec[ 2];
+    vec[ 2] = vec[ 1];
+    vec[ 1] = LANE_SUB(vec[ 9], tmp2);
+    vec[ 3] = LANE_SUB(vec[11], tmp2);
+    vec[ 5] = LANE_SUB(vec[11], tmp);
+    vec[ 7] = LANE_SUB(vec[13], tmp);
+    vec[ 9] = LANE_SUB(vec[13], tmp4);
+    vec[11] = LANE_SUB(vec[15], tmp4);
+    vec[13] = LANE_SUB(vec[15], tmp3);
+    vec[15] = LANE_SUB(vec[17], tmp3);
+
+    /* overlap and add */
+
+    tmp2 = vec[0];
+    tmp3 = vec[9];
+
+    for (i = 0; i < 6; i++)
+    {
+        tmp  = history[i];
+        tmp4 = vec[i + 10];
+        vec[i + 10] = LANE_ADD(tmp3, tmp4);
+        tmp1 = vec[i + 1];
+        vec[i] = LANE_MAC_WIN(tmp, vec[i + 10], i);
+        tmp3 = tmp4;
+        history[i] = LANE_NEG(LANE_ADD(tmp2, tmp1));
+        tmp2 = tmp1;
+    }
+
+    tmp  = history[6];
+    tmp4 = vec[16];
+    vec[16] = LANE_ADD(tmp3, tmp4);
+    tmp1 = vec[7];
+    vec[ 6] = LANE_MAC_WIN(tmp, LANE_SHL(vec[16], 1), 6);
+    tmp  = history[7];
+    history[6] = LANE_NEG(LANE_ADD(tmp2, tmp1));
+    history[7] = LANE_NEG(LANE_ADD(tmp1, vec[8]));
+
+    tmp1 = history[8];
+    tmp4 = LANE_ADD(vec[17], tmp4);
+    vec[ 7] = LANE_MAC_WIN(tmp, LANE_SHL(tmp4, 1), 7);
+    history[8] = LANE_NEG(LANE_ADD(vec[8], vec[9]));
+    vec[ 8] = LANE_MAC_WIN(tmp1, LANE_SHL(vec[17], 1), 8);
+
+    tmp  = history[9];
+    tmp1 = history[17];
+    tmp2 = history[16];
+    vec[ 9] = LANE_MAC_WIN(tmp,  LANE_SHL(vec[17], 1), 9);
+
+    vec[17] = LANE_MAC_WIN(tmp1, LANE_SHL(vec[10], 1), 17);
+    vec[10] = LANE_NEG(vec[16]);
+    vec[16] = LANE_MAC_WIN(tmp2, LANE_SHL(vec[11], 1), 16);
+    tmp1 = history[15];
+    tmp2 = history[14];
+    vec[11] = LANE_NEG(vec[15]);
+    vec[15] = LANE_MAC_WIN(tmp1, LANE_SHL(vec[12], 1), 15);
+    vec[12] = LANE_NEG(vec[14]);
+    vec[14] = LANE_MAC_WIN(tmp2, LANE_SHL(vec[13], 1), 14);
+
+    tmp  = history[13];
+    tmp1 = history[12];
+    tmp2 = history[11];
+    tmp3 = history[10];
+    vec[13] = LANE_MAC_WIN(tmp,  LANE_SHL(vec[12], 1), 13);
+    vec[12] = LANE_MAC_WIN(tmp1, LANE_SHL(vec[11], 1), 12);
+    vec[11] = LANE_MAC_WIN(tmp2, LANE_SHL(vec[10], 1), 11);
+    vec[10] = LANE_MAC_WIN(tmp3, LANE_SHL(tmp4, 1), 10);
+
+    /* next iteration overlap */
+
+    tmp1 = LANE_SHL(history[8], 1);
+    tmp3 = LANE_SHL(history[7], 1);
+    tmp2 = LANE_SHL(history[1], 1);
+    tmp  = LANE_SHL(history[0], 1);
+
+    history[ 0] = LANE_Q32(tmp1, LANE_DUP(window[18]));
+    history[17] = LANE_Q32(tmp1, LANE_DUP(window[35]));
+    history[ 1] = LANE_Q32(tmp3, LANE_DUP(window[19]));
+    history[16] = LANE_Q32(tmp3, LANE_DUP(window[34]));
+
+    history[ 7] = LANE_Q32(tmp2, LANE_DUP(window[25]));
+    history[10] = LANE_Q32(tmp2, LANE_DUP(window[28]));
+    history[ 8] = LANE_Q32(tmp,  LANE_DUP(window[26]));
+    history[ 9] = LANE_Q32(tmp,  LANE_DUP(window[27]));
+
+    tmp1 = LANE_SHL(history[6], 1);
+    tmp3 = LANE_SHL(history[5], 1);
+    tmp4 = LANE_SHL(history[4], 1);
+    tmp2 = LANE_SHL(history[3], 1);
+    tmp  = LANE_SHL(history[2], 1);
+
+    history[ 2] = LANE_Q32(tmp1, LANE_DUP(window[20]));
+    history[15] = LANE_Q32(tmp1, LANE_DUP(window[33]));
+    history[ 3] = LANE_Q32(tmp3, LANE_DUP(window[21]));
+    history[14] = LANE_Q32(tmp3, LANE_DUP(window[32]));
+    history[ 4] = LANE_Q32(tmp4, LANE_DUP(window[22]));
+    history[13] = LANE_Q32(tmp4, LANE_DUP(window[31]));
+    history[ 5] = LANE_Q32(tmp2, LANE_DUP(window[23]));
+    history[12] = LANE_Q32(tmp2, LANE_DUP(window[30]));
+    history[ 6] = LANE_Q32(tmp,  LANE_DUP(window[24]));
+    history[11] = LANE_Q32(tmp,  LANE_DUP(window[29]));
+}
+
+#undef LANE_MAC_WIN
+
+PVMP3_LANE_TARGET static void PVMP3_LANE_FN(pvmp3_mdct_18_bands)(int32 *vec,
+        int32 *history,
+        const int32 *window,
+        int32 bands)
+{
+    PVMP3_LANE v[FILTERBANK_BANDS];
+    PVMP3_LANE h[FILTERBANK_BANDS];
+
+    for (; bands >= PVMP3_LANES; bands -= PVMP3_LANES)
+    {
+        PVMP3_LANE_FN(pvmp3_lanes_load)(v, vec, FILTERBANK_BANDS, FILTERBANK_BANDS);
+        PVMP3_LANE_FN(pvmp3_lanes_load)(h, history, FILTERBANK_BANDS, FILTERBANK_BANDS);
+
+        PVMP3_LANE_FN(pvmp3_mdct_18_lanes)(v, h, window);
+
+        PVMP3_LANE_FN(pvmp3_lanes_store)(vec, v, FILTERBANK_BANDS, FILTERBANK_BANDS);
+        PVMP3_LANE_FN(pvmp3_lanes_store)(history, h, FILTERBANK_BANDS, FILTERBANK_BANDS);
+
+        vec     += PVMP3_LANES * FILTERBANK_BANDS;
+        history += PVMP3_LANES * FILTERBANK_BANDS;
+    }
+
+    pvmp3_mdct_18_bands(vec, history, window, bands);
+}
+
+#undef PVMP3_LANES
+#undef PVMP3_LANE
+#undef PVMP3_LANE_TARGET
+#undef PVMP3_LANE_FN
+#undef LANE_LOADU
+#undef LANE_STOREU
+#undef LANE_TRANSPOSE
+#undef LANE_DUP
+#undef LANE_ADD
+#undef LANE_SUB
+#undef LANE_NEG
+#undef LANE_SHL
+#undef LANE_SHR
+#undef LANE_Q32
+#undef LANE_Q28
+#undef LANE_Q27
@@ -0,0 +1,245 @@
+// Copyright (c) 2019-2022 Qinglong<sysu.zqlong@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks every SIMD kernel supported by this build and cpu is bit-exact with
+// the C kernel, then prints ns/call of every kernel at every level.
+//
+//   pvmp3_simd_test [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pvmp3_simd.h"
+#include "pvmp3_dec_defs.h"
+
+#define TEST_ROUNDS         2000
+#define BENCH_ITERATIONS    200000
+
+#define SYNTH_SIZE          (HAN_SIZE + SUBBANDS_NUMBER)
+#define SPEC_SIZE           (SUBBANDS_NUMBER * FILTERBANK_BANDS)
+
+// Same tables as pvmp3_alias_reduction.cpp
+#define Q31_fmt(a)    (int32(double(0x7FFFFFFF)*(a)))
+
+static const int32 c_signal[8] = {
+    Q31_fmt(0.85749292571254f), Q31_fmt(0.88174199731771f),
+    Q31_fmt(0.94962864910273f), Q31_fmt(0.98331459249179f),
+    Q31_fmt(0.99551781606759f), Q31_fmt(0.99916055817815f),
+    Q31_fmt(0.99989919524445f), Q31_fmt(0.99999315507028f)
+};
+
+static const int32 c_alias[8] = {
+    Q31_fmt(-0.51449575542753f), Q31_fmt(-0.47173196856497f),
+    Q31_fmt(-0.31337745420390f), Q31_fmt(-0.18191319961098f),
+    Q31_fmt(-0.09457419252642f), Q31_fmt(-0.04096558288530f),
+    Q31_fmt(-0.01419856857247f), Q31_fmt(-0.00369997467376f)
+};
+
+static const char *level_names[PVMP3_SIMD_LEVELS] = { "c", "avx2", "neon" };
+
+static uint32 rand_state = 0x12345678;
+
+static int32 rand32()
+{
+    rand_state = rand_state * 1664525 + 1013904223;
+    return (int32)rand_state;
+}
+
+// Random values within +/-2^bits, with edge values every few samples, kept
+// small enough that the C kernels never overflow a signed sum
+static void fill_random(int32 *buf, int32 count, int32 bits)
+{
+    const int32 limit = (int32)1 << bits;
+    for (int32 i = 0; i < count; i++) {
+        switch (rand32() & 15) {
+        case 0:  buf[i] = limit - 1; break;
+        case 1:  buf[i] = -limit;    break;
+        case 2:  buf[i] = 0;         break;
+        case 3:  buf[i] = -1;        break;
+        default: buf[i] = rand32() >> (31 - bits); break;
+        }
+    }
+}
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int test_polyphase(const pvmp3_kernels *ref, const pvmp3_kernels *simd)
+{
+    int32 synth[SYNTH_SIZE];
+    int16 pcm_ref[2 * SUBBANDS_NUMBER];
+    int16 pcm_simd[2 * SUBBANDS_NUMBER];
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        int32 channels = 1 + (round & 1);
+        // large inputs saturate the output, small ones don't
+        fill_random(synth, SYNTH_SIZE, (round & 2) ? 27 : 22);
+        memset(pcm_ref, 0, sizeof(pcm_ref));
+        memset(pcm_simd, 0, sizeof(pcm_simd));
+        ref->polyphase_filter_window(synth, pcm_ref, channels);
+        simd->polyphase_filter_window(synth, pcm_simd, channels);
+        if (memcmp(pcm_ref, pcm_simd, sizeof(pcm_ref)) != 0) {
+            printf("[%s] polyphase_filter_window mismatch, round=%d\n", simd->name, round);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int test_dct_32(const pvmp3_kernels *ref, const pvmp3_kernels *simd)
+{
+    int32 vec_ref[SPEC_SIZE];
+    int32 vec_simd[SPEC_SIZE];
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        // every count of blocks left over after the full vectors
+        int32 blocks = 1 + round % FILTERBANK_BANDS;
+        fill_random(vec_ref, SPEC_SIZE, (round & 1) ? 26 : 22);
+        memcpy(vec_simd, vec_ref, sizeof(vec_ref));
+        ref->dct_32(vec_ref, blocks);
+        simd->dct_32(vec_simd, blocks);
+        if (memcmp(vec_ref, vec_simd, sizeof(vec_ref)) != 0) {
+            printf("[%s] dct_32 mismatch, round=%d, blocks=%d\n", simd->name, round, (int)blocks);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int test_mdct_18(const pvmp3_kernels *ref, const pvmp3_kernels *simd)
+{
+    int32 window[2 * FILTERBANK_BANDS];
+    int32 vec_ref[SPEC_SIZE];
+    int32 vec_simd[SPEC_SIZE];
+    int32 history_ref[SPEC_SIZE];
+    int32 history_simd[SPEC_SIZE];
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        int32 bands = 1 + round % SUBBANDS_NUMBER;
+        fill_random(window, 2 * FILTERBANK_BANDS, 30);
+        fill_random(vec_ref, SPEC_SIZE, (round & 1) ? 26 : 22);
+        fill_random(history_ref, SPEC_SIZE, (round & 1) ? 26 : 22);
+        memcpy(vec_simd, vec_ref, sizeof(vec_ref));
+        memcpy(history_simd, history_ref, sizeof(history_ref));
+        ref->mdct_18(vec_ref, history_ref, window, bands);
+        simd->mdct_18(vec_simd, history_simd, window, bands);
+        if (memcmp(vec_ref, vec_simd, sizeof(vec_ref)) != 0 ||
+            memcmp(history_ref, history_simd, sizeof(history_ref)) != 0) {
+            printf("[%s] mdct_18 mismatch, round=%d, bands=%d\n", simd->name, round, (int)bands);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int test_alias(const pvmp3_kernels *ref, const pvmp3_kernels *simd)
+{
+    int32 spec_ref[SPEC_SIZE];
+    int32 spec_simd[SPEC_SIZE];
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        int32 sblim = 1 + round % (SUBBANDS_NUMBER - 1);
+        fill_random(spec_ref, SPEC_SIZE, (round & 1) ? 29 : 24);
+        memcpy(spec_simd, spec_ref, sizeof(spec_ref));
+        ref->alias_butterflies(spec_ref, sblim, c_signal, c_alias);
+        simd->alias_butterflies(spec_simd, sblim, c_signal, c_alias);
+        if (memcmp(spec_ref, spec_simd, sizeof(spec_ref)) != 0) {
+            printf("[%s] alias_butterflies mismatch, round=%d, sblim=%d\n", simd->name, round, (int)sblim);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void bench(const pvmp3_kernels *kernels, int iterations)
+{
+    static int32 synth[SYNTH_SIZE];
+    static int32 spec[SPEC_SIZE];
+    static int32 input[SPEC_SIZE];
+    static int32 history[SPEC_SIZE];
+    static int32 window[2 * FILTERBANK_BANDS];
+    static int16 pcm[2 * SUBBANDS_NUMBER];
+    int64_t start;
+    double polyphase_ns, dct_32_ns, mdct_18_ns, alias_ns;
+
+    fill_random(synth, SYNTH_SIZE, 24);
+    fill_random(input, SPEC_SIZE, 22);
+    fill_random(history, SPEC_SIZE, 22);
+    fill_random(window, 2 * FILTERBANK_BANDS, 30);
+
+    start = now_ns();
+    for (int i = 0; i < iterations; i++)
+        kernels->polyphase_filter_window(synth, pcm, 2);
+    polyphase_ns = (double)(now_ns() - start) / iterations;
+
+    // one granule of every kernel, including the copy of the input
+    start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        memcpy(spec, input, sizeof(spec));
+        kernels->dct_32(spec, FILTERBANK_BANDS);
+    }
+    dct_32_ns = (double)(now_ns() - start) / iterations;
+
+    start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        memcpy(spec, input, sizeof(spec));
+        kernels->mdct_18(spec, history, window, SUBBANDS_NUMBER);
+    }
+    mdct_18_ns = (double)(now_ns() - start) / iterations;
+
+    fill_random(spec, SPEC_SIZE, 24);
+    start = now_ns();
+    for (int i = 0; i < iterations; i++)
+        kernels->alias_butterflies(spec, SUBBANDS_NUMBER - 1, c_signal, c_alias);
+    alias_ns = (double)(now_ns() - start) / iterations;
+
+    printf("%-6s polyphase_filter_window %8.1f ns, dct_32 x%d %8.1f ns, mdct_18 x%d %8.1f ns, alias_butterflies %7.1f ns\n",
+           kernels->name, polyphase_ns, FILTERBANK_BANDS, dct_32_ns, SUBBANDS_NUMBER, mdct_18_ns, alias_ns);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : BENCH_ITERATIONS;
+    const pvmp3_kernels *ref = pvmp3_simd_get_kernels(PVMP3_SIMD_NONE);
+    int failed = 0;
+
+    printf("detected level: %s\n", level_names[pvmp3_simd_detect()]);
+
+    for (int level = PVMP3_SIMD_NONE + 1; level < PVMP3_SIMD_LEVELS; level++) {
+        const pvmp3_kernels *simd = pvmp3_simd_get_kernels((e_pvmp3_simd)level);
+        if (simd == NULL) {
+            printf("[%s] not supported, skipped\n", level_names[level]);
+            continue;
+        }
+        if (test_polyphase(ref, simd) != 0 || test_dct_32(ref, simd) != 0 || test_mdct_18(ref, simd) != 0 || test_alias(ref, simd) != 0) {
+            failed++;
+            continue;
+        }
+        printf("[%s] bit-exact with c\n", simd->name);
+    }
+
+    for (int level = PVMP3_SIMD_NONE; level < PVMP3_SIMD_LEVELS && iterations > 0; level++) {
+        const pvmp3_kernels *kernels = pvmp3_simd_get_kernels((e_pvmp3_simd)level);
+        if (kernels != NULL)
+            bench(kernels, iterations);
+    }
+
+    return failed;
+}
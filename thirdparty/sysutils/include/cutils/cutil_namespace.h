@@ -66,6 +66,7 @@
 
 // ringbuf.h
 #define rb_create                      SYSUTILS_CUTILS_NAMESPACE(rb_create)
+#define rb_create_spsc                 SYSUTILS_CUTILS_NAMESPACE(rb_create_spsc)
 #define rb_destroy                     SYSUTILS_CUTILS_NAMESPACE(rb_destroy)
 #define rb_abort                       SYSUTILS_CUTILS_NAMESPACE(rb_abort)
 #define rb_reset                       SYSUTILS_CUTILS_NAMESPACE(rb_reset)
@@ -76,6 +77,10 @@
 #define rb_write                       SYSUTILS_CUTILS_NAMESPACE(rb_write)
 #define rb_read_chunk                  SYSUTILS_CUTILS_NAMESPACE(rb_read_chunk)
 #define rb_write_chunk                 SYSUTILS_CUTILS_NAMESPACE(rb_write_chunk)
+#define rb_acquire_write               SYSUTILS_CUTILS_NAMESPACE(rb_acquire_write)
+#define rb_commit_write                SYSUTILS_CUTILS_NAMESPACE(rb_commit_write)
+#define rb_acquire_read                SYSUTILS_CUTILS_NAMESPACE(rb_acquire_read)
+#define rb_release_read                SYSUTILS_CUTILS_NAMESPACE(rb_release_read)
 #define rb_done_write                  SYSUTILS_CUTILS_NAMESPACE(rb_done_write)
 #define rb_done_read                   SYSUTILS_CUTILS_NAMESPACE(rb_done_read)
 #define rb_unblock_reader              SYSUTILS_CUTILS_NAMESPACE(rb_unblock_reader)
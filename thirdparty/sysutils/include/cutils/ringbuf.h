@@ -53,6 +53,19 @@ typedef struct ringbuf *ringbuf_handle;
  */
 ringbuf_handle rb_create(int size);
 
+/**
+ * @brief      Create ringbuffer for exactly one reader thread and one writer thread.
+ *             Reading/writing don't take the lock unless ringbuffer is empty/full, other
+ *             functions behave the same. rb_reset must not run concurrently with reading/writing,
+ *             except with a writer blocked between rb_acquire_write and rb_commit_write.
+ *             Falls back to rb_create if atomics are not supported.
+ *
+ * @param[in]  size   Size of ringbuffer
+ *
+ * @return     ringbuf_handle
+ */
+ringbuf_handle rb_create_spsc(int size);
+
 /**
  * @brief      Cleanup and free all memory created by ringbuf_handle
  *
@@ -151,6 +164,57 @@ int rb_read_chunk(ringbuf_handle rb, char *buf, int size, unsigned int timeout_m
  */
 int rb_write_chunk(ringbuf_handle rb, char *buf, int size, unsigned int timeout_ms);
 
+/**
+ * @brief      Get a contiguous span of free space to be filled in place, wait `timeout_ms` milliseconds
+ *             until there is free space. The span may be shorter than free space when it wraps around.
+ *             Must be followed by rb_commit_write. rb_reset/rb_destroy don't wait for it: the writer
+ *             keeps the old buffer, its commit frees it and drops the data (rb_destroy completes then).
+ *
+ * @param[in]  rb             The Ringbuffer handle
+ * @param[out] buf            Start of the span
+ * @param[in]  len            The max length wanted
+ * @param[in]  timeout_ms     The time to wait, if zero, wait forever
+ *
+ * @return     Size of the span, or RB_DONE/RB_ABORT/RB_TIMEOUT/RB_FAIL
+ */
+int rb_acquire_write(ringbuf_handle rb, char **buf, int len, unsigned int timeout_ms);
+
+/**
+ * @brief      Commit `len` bytes written into the span from rb_acquire_write, zero to cancel
+ *
+ * @param[in]  rb    The Ringbuffer handle
+ * @param[in]  buf   Start of the span
+ * @param[in]  len   The length filled
+ *
+ * @return     Number of bytes committed, RB_DONE/RB_ABORT if the data is dropped, or RB_FAIL
+ *             if buf is not the span held by the writer
+ */
+int rb_commit_write(ringbuf_handle rb, char *buf, int len);
+
+/**
+ * @brief      Get a contiguous span of filled data to be parsed in place, wait `timeout_ms` milliseconds
+ *             until `len` bytes are filled. The span may be shorter than `len` when it wraps around,
+ *             or when writing is done. Must be followed by rb_release_read.
+ *
+ * @param[in]  rb             The Ringbuffer handle
+ * @param[out] buf            Start of the span
+ * @param[in]  len            The length wanted
+ * @param[in]  timeout_ms     The time to wait, if zero, wait forever
+ *
+ * @return     Size of the span, or RB_DONE/RB_ABORT/RB_TIMEOUT/RB_FAIL
+ */
+int rb_acquire_read(ringbuf_handle rb, char **buf, int len, unsigned int timeout_ms);
+
+/**
+ * @brief      Release `len` bytes consumed from the span of rb_acquire_read, zero to keep all
+ *
+ * @param[in]  rb    The Ringbuffer handle
+ * @param[in]  len   The length consumed
+ *
+ * @return     Number of bytes released
+ */
+int rb_release_read(ringbuf_handle rb, int len);
+
 /**
  * @brief      Set status of writing to ringbuffer is done
  *
@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include "osal/os_thread.h"
 #include "cutils/memory_helper.h"
@@ -34,21 +35,55 @@
 
 #define LOG_TAG "ringbuf"
 
+#if defined(__STDC_NO_ATOMICS__)
+// SPSC mode falls back to locked mode, see rb_create_spsc
+#define ATOMIC_DECLARE(obj)         int obj
+#define ATOMIC_LOAD(obj)            obj
+#define ATOMIC_STORE(obj, val)      obj = val
+#define ATOMIC_FETCH_ADD(obj, val)  obj += val
+#define ATOMIC_FETCH_SUB(obj, val)  obj -= val
+#define ATOMIC_CAS(obj, expected, desired) \
+    ((obj) == (expected) ? ((obj) = (desired), true) : ((expected) = (obj), false))
+#else
+#include <stdatomic.h>
+#define ATOMIC_DECLARE(obj)         atomic_int obj
+#define ATOMIC_LOAD(obj)            atomic_load(&(obj))
+#define ATOMIC_STORE(obj, val)      atomic_store(&(obj), val)
+#define ATOMIC_FETCH_ADD(obj, val)  atomic_fetch_add(&(obj), val)
+#define ATOMIC_FETCH_SUB(obj, val)  atomic_fetch_sub(&(obj), val)
+#define ATOMIC_CAS(obj, expected, desired) atomic_compare_exchange_strong(&(obj), &(expected), desired)
+#endif
+
+struct rb_orphan {
+    char *buf;
+    struct rb_orphan *next;
+};
+
 struct ringbuf {
     char *p_o;                   /**< Original pointer */
     char *volatile p_r;          /**< Read pointer */
     char *volatile p_w;          /**< Write pointer */
-    int  fill_cnt;               /**< Number of filled slots */
+    ATOMIC_DECLARE(fill_cnt);    /**< Number of filled slots */
     int  threshold_cnt;          /**< Number of threshold slots */
     int  size;                   /**< Buffer size */
     os_cond can_read;
     os_cond can_write;
+    os_cond span_released;       /**< Signaled when an acquired span is committed/released */
     os_mutex lock;
+    bool spsc;                   /**< Single producer/consumer, data path doesn't take lock */
+    ATOMIC_DECLARE(reader_waiting); /**< SPSC: reader sleeps on can_read */
+    ATOMIC_DECLARE(writer_waiting); /**< SPSC: writer sleeps on can_write */
+    ATOMIC_DECLARE(span_waiting);   /**< SPSC: reset/destroy sleeps on span_released */
+    ATOMIC_DECLARE(write_acquired); /**< Writer holds a span from rb_acquire_write, 2 while committing */
+    ATOMIC_DECLARE(read_acquired);  /**< Reader holds a span from rb_acquire_read */
+    char *write_span;            /**< Start of the span held by the writer, set before write_acquired */
+    struct rb_orphan *orphans;   /**< Buffers left to writers whose span was dropped by reset/destroy */
+    bool destroy_pending;        /**< rb_destroy ran with orphans left, the last orphan commit frees ringbuf */
     bool abort_read;
     bool abort_write;
-    bool is_done_write;          /**< To signal that we are done writing */
+    ATOMIC_DECLARE(is_done_write);  /**< To signal that we are done writing */
     bool unblock_reader_flag;    /**< To unblock instantly from rb_read */
-    bool is_reach_threshold;
+    ATOMIC_DECLARE(is_reach_threshold);
 };
 
 ringbuf_handle rb_create(int size)
@@ -61,7 +96,8 @@ ringbuf_handle rb_create(int size)
             (buf            = OS_CALLOC(1, size)) &&
             (rb->lock       = os_mutex_create()) &&
             (rb->can_read   = os_cond_create()) &&
-            (rb->can_write  = os_cond_create())
+            (rb->can_write  = os_cond_create()) &&
+            (rb->span_released = os_cond_create())
         );
 
     if (!_success) {
@@ -78,24 +114,102 @@ ringbuf_handle rb_create(int size)
     return rb;
 }
 
-void rb_destroy(ringbuf_handle rb)
+ringbuf_handle rb_create_spsc(int size)
+{
+    ringbuf_handle rb = rb_create(size);
+#if !defined(__STDC_NO_ATOMICS__)
+    if (rb != NULL)
+        rb->spsc = true;
+#endif
+    return rb;
+}
+
+static void rb_wait_span_released(ringbuf_handle rb)
+{
+    // Spans point into the buffer, wait until they are handed back
+    ATOMIC_STORE(rb->span_waiting, 1);
+    while (rb->write_acquired || rb->read_acquired)
+        os_cond_wait(rb->span_released, rb->lock);
+    ATOMIC_STORE(rb->span_waiting, 0);
+}
+
+// Writer is blocked between rb_acquire_write and rb_commit_write, e.g. in a network read.
+// Leave it the buffer it is writing into and carry on with a new one (none when destroying),
+// its commit frees the old buffer. Returns false if no span is held, or if allocation
+// fails and the caller has to wait for the commit. Caller holds the lock
+static bool rb_orphan_write_span(ringbuf_handle rb, bool renew)
+{
+    struct rb_orphan *orphan = OS_CALLOC(1, sizeof(struct rb_orphan));
+    char *buf = NULL;
+    int acquired = 1;
+    if (orphan == NULL)
+        return false;
+    if (renew && (buf = OS_CALLOC(1, rb->size)) == NULL) {
+        OS_FREE(orphan);
+        return false;
+    }
+    // SPSC commit doesn't take the lock, whoever moves write_acquired from 1 first wins.
+    // 2 is a commit in progress, or a stale writer checking its span, both done shortly
+    while (!ATOMIC_CAS(rb->write_acquired, acquired, 0)) {
+        if (acquired != 2) {
+            OS_FREE(buf);
+            OS_FREE(orphan);
+            return false;
+        }
+        os_mutex_unlock(rb->lock);
+        os_thread_sleep_usec(100);
+        os_mutex_lock(rb->lock);
+        acquired = 1;
+    }
+
+    orphan->buf = rb->p_o;
+    orphan->next = rb->orphans;
+    rb->orphans = orphan;
+    rb->p_o = rb->p_r = rb->p_w = buf;
+    return true;
+}
+
+static void rb_free(ringbuf_handle rb)
 {
-    if (rb == NULL)
-        return;
     if (rb->p_o)
         OS_FREE(rb->p_o);
     if (rb->can_read)
         os_cond_destroy(rb->can_read);
     if (rb->can_write)
         os_cond_destroy(rb->can_write);
+    if (rb->span_released)
+        os_cond_destroy(rb->span_released);
     if (rb->lock)
         os_mutex_destroy(rb->lock);
     OS_FREE(rb);
 }
 
+void rb_destroy(ringbuf_handle rb)
+{
+    if (rb == NULL)
+        return;
+    if (rb->lock && rb->span_released) {
+        os_mutex_lock(rb->lock);
+        rb_orphan_write_span(rb, false);
+        rb_wait_span_released(rb);
+        if (rb->orphans != NULL) {
+            rb->destroy_pending = true;
+            os_mutex_unlock(rb->lock);
+            return;
+        }
+        os_mutex_unlock(rb->lock);
+    }
+    rb_free(rb);
+}
+
 void rb_reset(ringbuf_handle rb)
 {
     os_mutex_lock(rb->lock);
+    // Don't wait for the writer, it may be blocked for long. Reader is stopped before
+    // reset, so this only waits for a commit in progress or if allocation fails
+    if (rb->write_acquired)
+        rb_orphan_write_span(rb, true);
+    rb_wait_span_released(rb);
     rb->p_r = rb->p_w = rb->p_o;
     rb->fill_cnt = 0;
     rb->is_done_write = false;
@@ -116,12 +230,344 @@ int rb_bytes_filled(ringbuf_handle rb)
     return rb->fill_cnt;
 }
 
+/*
+ * SPSC mode: the reader owns p_r and the writer owns p_w, fill_cnt is the only shared
+ * counter. Data is moved without taking the lock, the lock and condvars are only used
+ * to sleep when ringbuf is empty/full, and to wake the other side if it is sleeping.
+ */
+
+static void rb_spsc_wake(ringbuf_handle rb, int waiting, os_cond cond)
+{
+    if (waiting) {
+        os_mutex_lock(rb->lock);
+        os_cond_signal(cond);
+        os_mutex_unlock(rb->lock);
+    }
+}
+
+// Wait until `len` bytes are filled and threshold reached, returns RB_OK or error
+static int rb_spsc_wait_filled(ringbuf_handle rb, int len, unsigned int timeout_ms)
+{
+    int ret_val = RB_OK;
+
+    os_mutex_lock(rb->lock);
+    ATOMIC_STORE(rb->reader_waiting, 1);
+    while (ATOMIC_LOAD(rb->fill_cnt) < len || !ATOMIC_LOAD(rb->is_reach_threshold)) {
+        if (rb->is_done_write) {
+            ret_val = RB_DONE;
+            break;
+        }
+        if (rb->abort_read) {
+            ret_val = RB_ABORT;
+            break;
+        }
+        if (rb->unblock_reader_flag) {
+            //reader_unblock is nothing but forced timeout
+            ret_val = RB_TIMEOUT;
+            break;
+        }
+        if (len > rb->size) {
+            ret_val = RB_FAIL;
+            break;
+        }
+        //wait till enough data available to read
+        if (timeout_ms == 0)
+            ret_val = os_cond_wait(rb->can_read, rb->lock);
+        else
+            ret_val = os_cond_timedwait(rb->can_read, rb->lock, timeout_ms*1000);
+        if (ret_val != 0) {
+            ret_val = RB_TIMEOUT;
+            break;
+        }
+    }
+    ATOMIC_STORE(rb->reader_waiting, 0);
+    os_mutex_unlock(rb->lock);
+    return ret_val;
+}
+
+// Wait until `len` bytes are free, returns RB_OK or error
+static int rb_spsc_wait_available(ringbuf_handle rb, int len, unsigned int timeout_ms)
+{
+    int ret_val = RB_OK;
+
+    os_mutex_lock(rb->lock);
+    ATOMIC_STORE(rb->writer_waiting, 1);
+    while (rb->size - ATOMIC_LOAD(rb->fill_cnt) < len) {
+        if (rb->is_done_write) {
+            ret_val = RB_DONE;
+            rb->is_reach_threshold = true;
+            break;
+        }
+        if (rb->abort_write) {
+            ret_val = RB_ABORT;
+            rb->is_reach_threshold = true;
+            break;
+        }
+        if (len > rb->size) {
+            ret_val = RB_FAIL;
+            rb->is_reach_threshold = true;
+            break;
+        }
+        os_cond_signal(rb->can_read);
+        //wait till we have some empty space to write
+        if (timeout_ms == 0)
+            ret_val = os_cond_wait(rb->can_write, rb->lock);
+        else
+            ret_val = os_cond_timedwait(rb->can_write, rb->lock, timeout_ms*1000);
+        if (ret_val != 0) {
+            ret_val = RB_TIMEOUT;
+            break;
+        }
+    }
+    ATOMIC_STORE(rb->writer_waiting, 0);
+    os_mutex_unlock(rb->lock);
+    return ret_val;
+}
+
+static void rb_spsc_consume(ringbuf_handle rb, char *buf, int len)
+{
+    if (buf != NULL) {
+        if ((rb->p_r + len) > (rb->p_o + rb->size)) {
+            int rlen1 = rb->p_o + rb->size - rb->p_r;
+            memcpy(buf, rb->p_r, rlen1);
+            memcpy(buf + rlen1, rb->p_o, len - rlen1);
+        } else {
+            memcpy(buf, rb->p_r, len);
+        }
+    }
+    rb->p_r += len;
+    if (rb->p_r >= rb->p_o + rb->size)
+        rb->p_r -= rb->size;
+    ATOMIC_FETCH_SUB(rb->fill_cnt, len);
+    rb_spsc_wake(rb, ATOMIC_LOAD(rb->writer_waiting), rb->can_write);
+}
+
+static void rb_spsc_produce(ringbuf_handle rb, char *buf, int len)
+{
+    if (buf != NULL) {
+        if ((rb->p_w + len) > (rb->p_o + rb->size)) {
+            int wlen1 = rb->p_o + rb->size - rb->p_w;
+            memcpy(rb->p_w, buf, wlen1);
+            memcpy(rb->p_o, buf + wlen1, len - wlen1);
+        } else {
+            memcpy(rb->p_w, buf, len);
+        }
+    }
+    rb->p_w += len;
+    if (rb->p_w >= rb->p_o + rb->size)
+        rb->p_w -= rb->size;
+    int filled = ATOMIC_FETCH_ADD(rb->fill_cnt, len) + len;
+    if (!ATOMIC_LOAD(rb->is_reach_threshold) && filled >= rb->threshold_cnt)
+        ATOMIC_STORE(rb->is_reach_threshold, 1);
+    rb_spsc_wake(rb, ATOMIC_LOAD(rb->reader_waiting), rb->can_read);
+}
+
+static int rb_spsc_read(ringbuf_handle rb, char *buf, int buf_len, bool chunk, unsigned int timeout_ms)
+{
+    int total_read_size = 0;
+    int ret_val = 0;
+
+    while (buf_len > 0) {
+        // rb_read returns what it got so far, rb_read_chunk waits for the whole chunk
+        int wanted = chunk ? buf_len : 1;
+        int filled = ATOMIC_LOAD(rb->fill_cnt);
+        if (filled < wanted || !ATOMIC_LOAD(rb->is_reach_threshold)) {
+            ret_val = rb_spsc_wait_filled(rb, wanted, timeout_ms);
+            filled = ATOMIC_LOAD(rb->fill_cnt);
+            if (ret_val == RB_DONE && chunk && filled > 0 && ATOMIC_LOAD(rb->is_reach_threshold))
+                ret_val = RB_OK;
+            else if (ret_val != RB_OK)
+                break;
+        }
+        int read_size = filled < buf_len ? filled : buf_len;
+        rb_spsc_consume(rb, buf, read_size);
+        buf_len -= read_size;
+        total_read_size += read_size;
+        buf += read_size;
+        if (chunk)
+            break;
+    }
+
+    if ((ret_val == RB_FAIL) || (ret_val == RB_ABORT)) {
+        total_read_size = ret_val;
+    }
+    return total_read_size > 0 ? total_read_size : ret_val;
+}
+
+static int rb_spsc_write(ringbuf_handle rb, char *buf, int buf_len, bool chunk, unsigned int timeout_ms)
+{
+    int total_write_size = 0;
+    int ret_val = 0;
+
+    while (buf_len > 0) {
+        int wanted = chunk ? buf_len : 1;
+        int available = rb->size - ATOMIC_LOAD(rb->fill_cnt);
+        if (available < wanted) {
+            ret_val = rb_spsc_wait_available(rb, wanted, timeout_ms);
+            available = rb->size - ATOMIC_LOAD(rb->fill_cnt);
+            if (ret_val == RB_DONE && chunk && available > 0)
+                ret_val = RB_OK;
+            else if (ret_val != RB_OK)
+                break;
+        }
+        int write_size = available < buf_len ? available : buf_len;
+        rb_spsc_produce(rb, buf, write_size);
+        buf_len -= write_size;
+        total_write_size += write_size;
+        buf += write_size;
+        if (chunk)
+            break;
+    }
+
+    if ((ret_val == RB_FAIL) || (ret_val == RB_ABORT)) {
+        total_write_size = ret_val;
+    }
+    return total_write_size > 0 ? total_write_size : ret_val;
+}
+
+static int rb_spsc_acquire_write(ringbuf_handle rb, char **buf, int len, unsigned int timeout_ms)
+{
+    if (ATOMIC_LOAD(rb->write_acquired))
+        return RB_FAIL;
+
+    int ret_val = RB_OK;
+    if (rb->size - ATOMIC_LOAD(rb->fill_cnt) == 0) {
+        ret_val = rb_spsc_wait_available(rb, 1, timeout_ms);
+        if (ret_val != RB_OK)
+            return ret_val;
+    }
+    if (ATOMIC_LOAD(rb->is_done_write))
+        return RB_DONE;
+
+    // free space is contiguous up to the end of buffer at most
+    int write_size = rb->size - ATOMIC_LOAD(rb->fill_cnt);
+    if (write_size > rb->p_o + rb->size - rb->p_w)
+        write_size = rb->p_o + rb->size - rb->p_w;
+    if (write_size > len)
+        write_size = len;
+    *buf = rb->p_w;
+    rb->write_span = rb->p_w;
+    ATOMIC_STORE(rb->write_acquired, 1);
+    return write_size;
+}
+
+// Commit of a span whose buffer was left to the writer by rb_reset/rb_destroy,
+// free the buffer and drop the data. Returns false if the span is not an orphan
+static bool rb_commit_orphan(ringbuf_handle rb, char *buf)
+{
+    bool found = false;
+    bool free_rb = false;
+
+    os_mutex_lock(rb->lock);
+    for (struct rb_orphan **p = &rb->orphans; *p != NULL; p = &(*p)->next) {
+        struct rb_orphan *orphan = *p;
+        if ((uintptr_t)buf >= (uintptr_t)orphan->buf &&
+            (uintptr_t)buf < (uintptr_t)orphan->buf + rb->size) {
+            *p = orphan->next;
+            OS_FREE(orphan->buf);
+            OS_FREE(orphan);
+            found = true;
+            break;
+        }
+    }
+    free_rb = found && rb->destroy_pending && rb->orphans == NULL;
+    os_mutex_unlock(rb->lock);
+
+    if (free_rb)
+        rb_free(rb);
+    return found;
+}
+
+static int rb_spsc_commit_write(ringbuf_handle rb, char *buf, int len)
+{
+    int ret_val = RB_OK;
+    int acquired = 1;
+
+    while (!ATOMIC_CAS(rb->write_acquired, acquired, 2)) {
+        // Span was taken by rb_reset/rb_destroy
+        if (acquired != 2)
+            return rb_commit_orphan(rb, buf) ? RB_ABORT : RB_FAIL;
+        // A stale writer is checking its span against ours, it backs off at once
+        os_thread_sleep_usec(10);
+        acquired = 1;
+    }
+    // After a reset a new writer may hold the live span while a writer whose span was
+    // orphaned commits late. write_span was stored before the flag, safe to read now
+    if (buf != rb->write_span) {
+        ATOMIC_STORE(rb->write_acquired, 1);
+        return rb_commit_orphan(rb, buf) ? RB_ABORT : RB_FAIL;
+    }
+
+    if (len < 0 || len > rb->size - ATOMIC_LOAD(rb->fill_cnt)) {
+        ret_val = RB_FAIL;
+        len = 0;
+    } else if (ATOMIC_LOAD(rb->is_done_write)) {
+        // the reader is gone, drop the data
+        ret_val = RB_DONE;
+        len = 0;
+    }
+
+    if (len > 0) {
+        rb_spsc_produce(rb, NULL, len);
+        ret_val = len;
+    }
+
+    ATOMIC_STORE(rb->write_acquired, 0);
+    rb_spsc_wake(rb, ATOMIC_LOAD(rb->span_waiting), rb->span_released);
+    return ret_val;
+}
+
+static int rb_spsc_acquire_read(ringbuf_handle rb, char **buf, int len, unsigned int timeout_ms)
+{
+    if (ATOMIC_LOAD(rb->read_acquired) || len > rb->size)
+        return RB_FAIL;
+
+    int ret_val = RB_OK;
+    if (ATOMIC_LOAD(rb->fill_cnt) < len || !ATOMIC_LOAD(rb->is_reach_threshold)) {
+        ret_val = rb_spsc_wait_filled(rb, len, timeout_ms);
+        if (ret_val == RB_DONE && ATOMIC_LOAD(rb->fill_cnt) > 0)
+            ret_val = RB_OK;
+        else if (ret_val != RB_OK)
+            return ret_val;
+    }
+
+    // filled data is contiguous up to the end of buffer at most
+    int read_size = ATOMIC_LOAD(rb->fill_cnt);
+    if (read_size > rb->p_o + rb->size - rb->p_r)
+        read_size = rb->p_o + rb->size - rb->p_r;
+    *buf = rb->p_r;
+    ATOMIC_STORE(rb->read_acquired, 1);
+    return read_size;
+}
+
+static int rb_spsc_release_read(ringbuf_handle rb, int len)
+{
+    int ret_val = RB_OK;
+
+    if (!ATOMIC_LOAD(rb->read_acquired) || len < 0 || len > ATOMIC_LOAD(rb->fill_cnt)) {
+        ret_val = RB_FAIL;
+        len = 0;
+    }
+
+    if (len > 0) {
+        rb_spsc_consume(rb, NULL, len);
+        ret_val = len;
+    }
+
+    ATOMIC_STORE(rb->read_acquired, 0);
+    rb_spsc_wake(rb, ATOMIC_LOAD(rb->span_waiting), rb->span_released);
+    return ret_val;
+}
+
 int rb_read(ringbuf_handle rb, char *buf, int buf_len, unsigned int timeout_ms)
 {
     int read_size = 0;
     int total_read_size = 0;
     int ret_val = 0;
 
+    if (rb->spsc)
+        return rb_spsc_read(rb, buf, buf_len, false, timeout_ms);
+
     //take buffer lock
     os_mutex_lock(rb->lock);
 
@@ -202,6 +648,9 @@ int rb_write(ringbuf_handle rb, char *buf, int buf_len, unsigned int timeout_ms)
     int total_write_size = 0;
     int ret_val = 0;
 
+    if (rb->spsc)
+        return rb_spsc_write(rb, buf, buf_len, false, timeout_ms);
+
     //take buffer lock
     os_mutex_lock(rb->lock);
 
@@ -272,6 +721,9 @@ int rb_read_chunk(ringbuf_handle rb, char *buf, int size, unsigned int timeout_m
     int total_read_size = 0;
     int ret_val = 0;
 
+    if (rb->spsc)
+        return rb_spsc_read(rb, buf, size, true, timeout_ms);
+
     //take buffer lock
     os_mutex_lock(rb->lock);
 
@@ -346,6 +798,9 @@ int rb_write_chunk(ringbuf_handle rb, char *buf, int size, unsigned int timeout_
     int total_write_size = 0;
     int ret_val = 0;
 
+    if (rb->spsc)
+        return rb_spsc_write(rb, buf, size, true, timeout_ms);
+
     //take buffer lock
     os_mutex_lock(rb->lock);
 
@@ -415,6 +870,192 @@ write_done:
     return total_write_size > 0 ? total_write_size : ret_val;
 }
 
+int rb_acquire_write(ringbuf_handle rb, char **buf, int len, unsigned int timeout_ms)
+{
+    int write_size = 0;
+    int ret_val = 0;
+
+    if (buf == NULL || len <= 0)
+        return RB_FAIL;
+    if (rb->spsc)
+        return rb_spsc_acquire_write(rb, buf, len, timeout_ms);
+
+    os_mutex_lock(rb->lock);
+
+    if (rb->write_acquired) {
+        ret_val = RB_FAIL;
+        goto acquire_done;
+    }
+
+    while (rb_bytes_available(rb) == 0) {
+        if (rb->is_done_write) {
+            ret_val = RB_DONE;
+            rb->is_reach_threshold = true;
+            goto acquire_done;
+        }
+        if (rb->abort_write) {
+            ret_val = RB_ABORT;
+            rb->is_reach_threshold = true;
+            goto acquire_done;
+        }
+        os_cond_signal(rb->can_read);
+        //wait till we have some empty space to write
+        if (timeout_ms == 0)
+            ret_val = os_cond_wait(rb->can_write, rb->lock);
+        else
+            ret_val = os_cond_timedwait(rb->can_write, rb->lock, timeout_ms*1000);
+        if (ret_val != 0) {
+            ret_val = RB_TIMEOUT;
+            goto acquire_done;
+        }
+    }
+    if (rb->is_done_write) {
+        ret_val = RB_DONE;
+        goto acquire_done;
+    }
+
+    // free space is contiguous up to the end of buffer at most
+    write_size = rb_bytes_available(rb);
+    if (write_size > rb->p_o + rb->size - rb->p_w)
+        write_size = rb->p_o + rb->size - rb->p_w;
+    if (write_size > len)
+        write_size = len;
+    *buf = rb->p_w;
+    rb->write_span = rb->p_w;
+    rb->write_acquired = true;
+
+acquire_done:
+    os_mutex_unlock(rb->lock);
+    return write_size > 0 ? write_size : ret_val;
+}
+
+int rb_commit_write(ringbuf_handle rb, char *buf, int len)
+{
+    int ret_val = RB_OK;
+
+    if (rb->spsc)
+        return rb_spsc_commit_write(rb, buf, len);
+
+    os_mutex_lock(rb->lock);
+
+    // Span taken by rb_reset/rb_destroy, possibly held by a new writer since
+    if (!rb->write_acquired || buf != rb->write_span) {
+        os_mutex_unlock(rb->lock);
+        return rb_commit_orphan(rb, buf) ? RB_ABORT : RB_FAIL;
+    }
+    if (len < 0 || len > rb_bytes_available(rb)) {
+        ret_val = RB_FAIL;
+        len = 0;
+    } else if (rb->is_done_write || rb->abort_write) {
+        // the reader is gone, drop the data
+        ret_val = rb->is_done_write ? RB_DONE : RB_ABORT;
+        len = 0;
+    }
+
+    if (len > 0) {
+        rb->p_w += len;
+        if (rb->p_w >= rb->p_o + rb->size)
+            rb->p_w = rb->p_o;
+        rb->fill_cnt += len;
+        if (!rb->is_reach_threshold && rb->fill_cnt >= rb->threshold_cnt)
+            rb->is_reach_threshold = true;
+        if (rb->is_reach_threshold)
+            os_cond_signal(rb->can_read);
+        ret_val = len;
+    }
+
+    rb->write_acquired = false;
+    os_cond_signal(rb->span_released);
+    os_mutex_unlock(rb->lock);
+    return ret_val;
+}
+
+int rb_acquire_read(ringbuf_handle rb, char **buf, int len, unsigned int timeout_ms)
+{
+    int read_size = 0;
+    int ret_val = 0;
+
+    if (buf == NULL || len <= 0)
+        return RB_FAIL;
+    if (rb->spsc)
+        return rb_spsc_acquire_read(rb, buf, len, timeout_ms);
+
+    os_mutex_lock(rb->lock);
+
+    if (rb->read_acquired || len > rb->size) {
+        ret_val = RB_FAIL;
+        goto acquire_done;
+    }
+
+    while (rb->fill_cnt < len || !rb->is_reach_threshold) {
+        if (rb->is_done_write) {
+            if (rb->fill_cnt > 0)
+                break;
+            ret_val = RB_DONE;
+            goto acquire_done;
+        }
+        if (rb->abort_read) {
+            ret_val = RB_ABORT;
+            goto acquire_done;
+        }
+        if (rb->unblock_reader_flag) {
+            //reader_unblock is nothing but forced timeout
+            ret_val = RB_TIMEOUT;
+            goto acquire_done;
+        }
+        os_cond_signal(rb->can_write);
+        //wait till enough data available to read
+        if (timeout_ms == 0)
+            ret_val = os_cond_wait(rb->can_read, rb->lock);
+        else
+            ret_val = os_cond_timedwait(rb->can_read, rb->lock, timeout_ms*1000);
+        if (ret_val != 0) {
+            ret_val = RB_TIMEOUT;
+            goto acquire_done;
+        }
+    }
+
+    // filled data is contiguous up to the end of buffer at most
+    read_size = rb->fill_cnt;
+    if (read_size > rb->p_o + rb->size - rb->p_r)
+        read_size = rb->p_o + rb->size - rb->p_r;
+    *buf = rb->p_r;
+    rb->read_acquired = true;
+
+acquire_done:
+    os_mutex_unlock(rb->lock);
+    return read_size > 0 ? read_size : ret_val;
+}
+
+int rb_release_read(ringbuf_handle rb, int len)
+{
+    int ret_val = RB_OK;
+
+    if (rb->spsc)
+        return rb_spsc_release_read(rb, len);
+
+    os_mutex_lock(rb->lock);
+
+    if (!rb->read_acquired || len < 0 || len > rb->fill_cnt) {
+        ret_val = RB_FAIL;
+        len = 0;
+    }
+
+    if (len > 0) {
+        rb->p_r += len;
+        if (rb->p_r >= rb->p_o + rb->size)
+            rb->p_r = rb->p_o;
+        rb->fill_cnt -= len;
+        os_cond_signal(rb->can_write);
+        ret_val = len;
+    }
+
+    rb->read_acquired = false;
+    os_cond_signal(rb->span_released);
+    os_mutex_unlock(rb->lock);
+    return ret_val;
+}
+
 static void rb_abort_read(ringbuf_handle rb)
 {
     os_mutex_lock(rb->lock);
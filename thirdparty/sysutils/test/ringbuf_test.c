@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "osal/os_thread.h"
+#include "cutils/memory_helper.h"
+#include "cutils/log_helper.h"
+#include "cutils/ringbuf.h"
+
+#define LOG_TAG "ringbuf_test"
+
+#define RINGBUF_SIZE        1000 // not a multiple of chunk, spans will wrap around
+#define CHUNK_SIZE          64
+#define TOTAL_BYTES         (1024*1024)
+
+struct ringbuf_test {
+    const char *name;
+    ringbuf_handle (*create)(int size);
+    bool use_span;
+};
+
+static ringbuf_handle rb = NULL;
+
+static void *ringbuf_write_thread(void *arg)
+{
+    struct ringbuf_test *test = (struct ringbuf_test *)arg;
+    char chunk[CHUNK_SIZE];
+    unsigned char seq = 0;
+    int total = 0;
+
+    while (total < TOTAL_BYTES) {
+        char *span = chunk;
+        int wanted = TOTAL_BYTES - total;
+        if (wanted > CHUNK_SIZE)
+            wanted = CHUNK_SIZE;
+        int ret = wanted;
+        if (test->use_span)
+            ret = rb_acquire_write(rb, &span, wanted, 1000);
+        if (ret <= 0) {
+            OS_LOGE(LOG_TAG, "Failed to acquire write span, ret=%d", ret);
+            break;
+        }
+        for (int i = 0; i < ret; i++)
+            span[i] = (char)(seq++);
+        if (test->use_span)
+            rb_commit_write(rb, span, ret);
+        else
+            ret = rb_write(rb, chunk, ret, 1000);
+        if (ret <= 0) {
+            OS_LOGE(LOG_TAG, "Failed to write, ret=%d", ret);
+            break;
+        }
+        total += ret;
+    }
+
+    rb_done_write(rb);
+    OS_LOGI(LOG_TAG, "Writer done, total=%d", total);
+    return NULL;
+}
+
+static int ringbuf_test_run(struct ringbuf_test *test)
+{
+    char chunk[CHUNK_SIZE];
+    unsigned char seq = 0;
+    int total = 0;
+    int errors = 0;
+
+    rb = test->create(RINGBUF_SIZE);
+    if (rb == NULL) {
+        OS_LOGE(LOG_TAG, "Failed to allocate ringbuf");
+        return -1;
+    }
+
+    struct os_thread_attr attr = {
+        .name = "ringbuf_writer",
+        .priority = OS_THREAD_PRIO_NORMAL,
+        .stacksize = 4096,
+        .joinable = true,
+    };
+    os_thread tid = os_thread_create(&attr, ringbuf_write_thread, test);
+
+    while (true) {
+        char *span = chunk;
+        int ret = 0;
+        if (test->use_span)
+            ret = rb_acquire_read(rb, &span, CHUNK_SIZE, 1000);
+        else
+            ret = rb_read_chunk(rb, chunk, CHUNK_SIZE, 1000);
+        if (ret == RB_DONE) {
+            break;
+        } else if (ret <= 0) {
+            OS_LOGE(LOG_TAG, "Failed to read, ret=%d", ret);
+            errors++;
+            break;
+        }
+        for (int i = 0; i < ret; i++) {
+            if ((unsigned char)span[i] != seq++)
+                errors++;
+        }
+        if (test->use_span)
+            rb_release_read(rb, ret);
+        total += ret;
+    }
+
+    os_thread_join(tid, NULL);
+    rb_destroy(rb);
+
+    if (total != TOTAL_BYTES || errors != 0) {
+        OS_LOGE(LOG_TAG, "[%s] test failed, total=%d, errors=%d", test->name, total, errors);
+        return -1;
+    }
+    OS_LOGI(LOG_TAG, "[%s] test passed, total=%d", test->name, total);
+    return 0;
+}
+
+static atomic_bool stalled_acquired = false;
+static atomic_int stalled_commit_ret = RB_OK;
+
+// Writer stuck in a slow read while holding a span
+static void *ringbuf_stalled_write_thread(void *arg)
+{
+    char *span = NULL;
+    int ret = rb_acquire_write(rb, &span, CHUNK_SIZE, 1000);
+    if (ret <= 0) {
+        stalled_commit_ret = ret;
+        return NULL;
+    }
+    stalled_acquired = true;
+    os_thread_sleep_msec(500);
+    memset(span, 0xff, ret);
+    stalled_commit_ret = rb_commit_write(rb, span, ret);
+    return NULL;
+}
+
+// rb_reset/rb_destroy must not wait for the stalled writer, its late commit is dropped.
+// After reset a new writer already holds a span of the new buffer when the late commit
+// comes, as a new source thread does after seeking
+static int ringbuf_stall_test_run(ringbuf_handle (*create)(int size), bool destroy)
+{
+    const char *name = destroy ? "destroy with stalled writer" : "reset with stalled writer";
+    char chunk[CHUNK_SIZE];
+    char *span = NULL;
+    int errors = 0;
+
+    rb = create(RINGBUF_SIZE);
+    if (rb == NULL) {
+        OS_LOGE(LOG_TAG, "Failed to allocate ringbuf");
+        return -1;
+    }
+    stalled_acquired = false;
+    stalled_commit_ret = RB_OK;
+
+    struct os_thread_attr attr = {
+        .name = "ringbuf_stalled",
+        .priority = OS_THREAD_PRIO_NORMAL,
+        .stacksize = 4096,
+        .joinable = true,
+    };
+    os_thread tid = os_thread_create(&attr, ringbuf_stalled_write_thread, NULL);
+    while (!stalled_acquired && stalled_commit_ret == RB_OK)
+        os_thread_sleep_msec(1);
+
+    if (destroy) {
+        rb_destroy(rb);
+    } else {
+        rb_reset(rb);
+        // Reset returned before the writer committed, and the ringbuf is usable again
+        if (stalled_commit_ret != RB_OK)
+            errors++;
+        if (rb_acquire_write(rb, &span, CHUNK_SIZE, 1000) != CHUNK_SIZE)
+            errors++;
+        else
+            memset(span, 0x5a, CHUNK_SIZE);
+    }
+
+    os_thread_join(tid, NULL);
+    if (stalled_commit_ret != RB_ABORT)
+        errors++;
+
+    if (!destroy) {
+        // The late commit left the new writer's span alone
+        if (span == NULL || rb_commit_write(rb, span, CHUNK_SIZE) != CHUNK_SIZE)
+            errors++;
+        rb_done_write(rb);
+    }
+
+    if (!destroy) {
+        // The late commit must not land in the new buffer
+        memset(chunk, 0, sizeof(chunk));
+        if (rb_read_chunk(rb, chunk, sizeof(chunk), 1000) != sizeof(chunk) ||
+            (unsigned char)chunk[0] != 0x5a || rb_bytes_filled(rb) != 0)
+            errors++;
+        rb_destroy(rb);
+    }
+
+    if (errors != 0) {
+        OS_LOGE(LOG_TAG, "[%s] test failed, commit=%d, errors=%d", name, stalled_commit_ret, errors);
+        return -1;
+    }
+    OS_LOGI(LOG_TAG, "[%s] test passed", name);
+    return 0;
+}
+
+int main()
+{
+    struct ringbuf_test tests[] = {
+        { "locked copy", rb_create,      false },
+        { "locked span", rb_create,      true  },
+        { "spsc copy",   rb_create_spsc, false },
+        { "spsc span",   rb_create_spsc, true  },
+    };
+    int failed = 0;
+
+    for (int i = 0; i < sizeof(tests)/sizeof(tests[0]); i++) {
+        if (ringbuf_test_run(&tests[i]) != 0)
+            failed++;
+        if (tests[i].use_span) {
+            if (ringbuf_stall_test_run(tests[i].create, false) != 0)
+                failed++;
+            if (ringbuf_stall_test_run(tests[i].create, true) != 0)
+                failed++;
+        }
+    }
+    return failed;
+}